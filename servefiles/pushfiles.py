@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+# coding: utf-8 -*-
+
+import os
+import socket
+import struct
+import sys
+import zlib
+
+# Inflating on the target can cost more than it saves on fast networks, so compression can be turned off.
+allow_compression = '--no-compression' not in sys.argv[1:]
+args = [arg for arg in sys.argv[1:] if arg != '--no-compression']
+
+if len(args) < 2 or len(args) > 3:
+    print('Usage: ' + sys.argv[0] + ' [--no-compression] <target ip> <file / directory> [target port]')
+    sys.exit(1)
+
+push_magic = 0x46424950  # FBIP
+push_version = 2
+push_types = {'.cia': 1, '.tik': 2, '.cetk': 2, '.3dsx': 3}
+accepted_extension = tuple(push_types.keys())
+chunk_size = 128 * 1024
+frame_max = 128 * 1024
+compression_none = 0
+compression_deflate = 1
+
+target_ip = args[0]
+target_path = args[1].strip()
+target_port = int(args[2]) if len(args) == 3 else 5000
+
+if not os.path.exists(target_path):
+    print(target_path + ': No such file or directory.')
+    sys.exit(1)
+
+if os.path.isfile(target_path):
+    if not target_path.endswith(accepted_extension):
+        print('Unsupported file extension. Supported extensions are: ' + ', '.join(accepted_extension))
+        sys.exit(1)
+
+    files = [target_path]
+else:
+    files = [os.path.join(target_path, file) for file in sorted(next(os.walk(target_path))[2]) if file.endswith(accepted_extension)]
+
+files = [file for file in files if os.path.getsize(file) > 0]
+
+if len(files) == 0:
+    print('No files to push.')
+    sys.exit(1)
+
+if len(files) > 128:
+    print('Too many files; at most 128 can be pushed at once.')
+    sys.exit(1)
+
+
+def choose_compression(file):
+    # CIAs mostly compress through their padding; skip files whose first chunk does not shrink noticeably.
+    with open(file, 'rb') as f:
+        sample = f.read(1024 * 1024)
+
+    if len(zlib.compress(sample, 1)) < len(sample) * 0.9:
+        return compression_deflate
+
+    return compression_none
+
+
+def send_frames(sock, data):
+    for start in range(0, len(data), frame_max):
+        frame = data[start:start + frame_max]
+        sock.sendall(struct.pack('!L', len(frame)) + frame)
+
+
+def recv_exact(sock, size):
+    data = b''
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if len(chunk) == 0:
+            raise IOError('Connection closed by target.')
+
+        data += chunk
+
+    return data
+
+
+try:
+    print('Connecting to ' + target_ip + ' on port ' + str(target_port) + '...')
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.connect((target_ip, target_port))
+
+    sock.sendall(struct.pack('!LL', push_magic, push_version))
+    version = struct.unpack('!L', recv_exact(sock, 4))[0]
+    if version == 0:
+        raise IOError('Target does not support pushed installs.')
+
+    compression = [choose_compression(file) if version >= 2 and allow_compression else compression_none for file in files]
+
+    header = struct.pack('!L', len(files))
+    for file, method in zip(files, compression):
+        name = os.path.basename(file).encode('utf-8')
+        header += struct.pack('!H', len(name)) + name
+        header += struct.pack('!QB', os.path.getsize(file), push_types[os.path.splitext(file)[1].lower()])
+        if version >= 2:
+            header += struct.pack('!B', method)
+
+    sock.sendall(header)
+
+    print('Waiting for confirmation on the target...')
+    if recv_exact(sock, 1) != b'\x01':
+        raise IOError('Install declined on the target.')
+
+    for file, method in zip(files, compression):
+        print('Pushing ' + os.path.basename(file) + (' (compressed)...' if method == compression_deflate else '...'))
+        compressor = zlib.compressobj(1) if method == compression_deflate else None
+        with open(file, 'rb') as f:
+            while True:
+                chunk = f.read(chunk_size)
+                if len(chunk) == 0:
+                    break
+
+                if compressor is not None:
+                    send_frames(sock, compressor.compress(chunk))
+                else:
+                    sock.sendall(chunk)
+
+        if compressor is not None:
+            send_frames(sock, compressor.flush())
+            sock.sendall(struct.pack('!L', 0))
+
+    recv_exact(sock, 1)
+    sock.close()
+except Exception as e:
+    print('An error occurred: ' + str(e))
+    sys.exit(1)
+
+print('Done.')
@@ -2,6 +2,7 @@
 # coding: utf-8 -*-
 
 import os
+import re
 import socket
 import struct
 import sys
@@ -11,12 +12,12 @@ import urllib
 
 try:
     from SimpleHTTPServer import SimpleHTTPRequestHandler
-    from SocketServer import TCPServer
+    from SocketServer import TCPServer, ThreadingMixIn
     from urllib import quote
     input = raw_input
 except ImportError:
     from http.server import SimpleHTTPRequestHandler
-    from socketserver import TCPServer
+    from socketserver import TCPServer, ThreadingMixIn
     from urllib.parse import quote
 
 interactive = False
@@ -113,14 +114,101 @@ if directory and directory != '.':  # doesn't need to move if it's already the c
 print('\nURLs:')
 print(file_list_payload + '\n')
 
-class MyServer(TCPServer):
+class RangeRequestHandler(SimpleHTTPRequestHandler):
+    # HTTP/1.1 keeps connections open across the 3DS's back-to-back Range requests.
+    protocol_version = 'HTTP/1.1'
+
+    def send_head(self):
+        self.range = None
+
+        path = self.translate_path(self.path)
+        if os.path.isdir(path):
+            return SimpleHTTPRequestHandler.send_head(self)
+
+        try:
+            f = open(path, 'rb')
+        except IOError:
+            self.send_error(404, 'File not found')
+            return None
+
+        stat = os.fstat(f.fileno())
+        size = stat.st_size
+        etag = '"%x-%x"' % (int(stat.st_mtime), size)
+        last_modified = self.date_time_string(stat.st_mtime)
+
+        start = 0
+        end = size - 1
+
+        # Only single byte ranges are served; anything else falls back to the whole file.
+        match = re.match(r'^bytes=(\d*)-(\d*)$', self.headers.get('Range', '').strip())
+        if_range = self.headers.get('If-Range')
+        if match and (match.group(1) or match.group(2)) and (if_range is None or if_range in (etag, last_modified)):
+            if match.group(1):
+                start = int(match.group(1))
+                if match.group(2):
+                    end = min(int(match.group(2)), size - 1)
+            else:
+                start = max(size - int(match.group(2)), 0)
+
+            if start >= size or start > end:
+                f.close()
+                self.send_response(416)
+                self.send_header('Content-Range', 'bytes */%d' % size)
+                self.send_header('Content-Length', '0')
+                self.end_headers()
+                return None
+
+            self.send_response(206)
+            self.send_header('Content-Range', 'bytes %d-%d/%d' % (start, end, size))
+        else:
+            self.send_response(200)
+
+        self.send_header('Content-Type', self.guess_type(path))
+        self.send_header('Content-Length', str(end - start + 1))
+        self.send_header('Accept-Ranges', 'bytes')
+        self.send_header('ETag', etag)
+        self.send_header('Last-Modified', last_modified)
+        self.end_headers()
+
+        self.range = (start, end - start + 1)
+        return f
+
+    def copyfile(self, source, outputfile):
+        if self.range is None:
+            return SimpleHTTPRequestHandler.copyfile(self, source, outputfile)
+
+        offset, remaining = self.range
+        if hasattr(os, 'sendfile'):
+            # Zero-copy from the page cache straight into the socket.
+            outputfile.flush()
+            while remaining > 0:
+                sent = os.sendfile(self.connection.fileno(), source.fileno(), offset, min(remaining, 0x40000000))
+                if sent == 0:
+                    break
+
+                offset += sent
+                remaining -= sent
+        else:
+            source.seek(offset)
+            while remaining > 0:
+                chunk = source.read(min(remaining, 1024 * 1024))
+                if not chunk:
+                    break
+
+                outputfile.write(chunk)
+                remaining -= len(chunk)
+
+class MyServer(ThreadingMixIn, TCPServer):
+    daemon_threads = True
+    request_queue_size = 64
+
     def server_bind(self):
         import socket
         self.socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
         self.socket.bind(self.server_address)
 
 print('Opening HTTP server on port ' + str(hostPort))
-server = MyServer(('', hostPort), SimpleHTTPRequestHandler)
+server = MyServer(('', hostPort), RangeRequestHandler)
 thread = threading.Thread(target=server.serve_forever)
 thread.start()
 
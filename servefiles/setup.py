@@ -6,7 +6,7 @@ from setuptools import setup
 setup(
 	name="servefiles",
 	version="2.4.12",
-	scripts=["servefiles.py", "sendurls.py"],
+	scripts=["servefiles.py", "sendurls.py", "pushfiles.py"],
 	author="Steveice10",
 	author_email="Steveice10@gmail.com",
 	description="Simple Python script for serving local files to FBI's remote installer.",
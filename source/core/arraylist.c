@@ -0,0 +1,203 @@
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arraylist.h"
+#include "linkedlist.h"
+
+#define ARRAY_LIST_MIN_CAPACITY 16
+
+void array_list_init(array_list* list) {
+    list->values = NULL;
+    list->size = 0;
+    list->capacity = 0;
+}
+
+void array_list_destroy(array_list* list) {
+    if(list->values != NULL) {
+        free(list->values);
+    }
+
+    array_list_init(list);
+}
+
+unsigned int array_list_size(array_list* list) {
+    return list->size;
+}
+
+void array_list_clear(array_list* list) {
+    list->size = 0;
+}
+
+bool array_list_reserve(array_list* list, unsigned int capacity) {
+    if(capacity <= list->capacity) {
+        return true;
+    }
+
+    void** values = (void**) realloc(list->values, capacity * sizeof(void*));
+    if(values == NULL) {
+        return false;
+    }
+
+    list->values = values;
+    list->capacity = capacity;
+    return true;
+}
+
+static bool array_list_grow(array_list* list, unsigned int required) {
+    if(required <= list->capacity) {
+        return true;
+    }
+
+    unsigned int capacity = list->capacity < ARRAY_LIST_MIN_CAPACITY ? ARRAY_LIST_MIN_CAPACITY : list->capacity;
+    while(capacity < required) {
+        capacity *= 2;
+    }
+
+    return array_list_reserve(list, capacity);
+}
+
+bool array_list_contains(array_list* list, void* value) {
+    return array_list_index_of(list, value) != -1;
+}
+
+int array_list_index_of(array_list* list, void* value) {
+    for(unsigned int i = 0; i < list->size; i++) {
+        if(list->values[i] == value) {
+            return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+void* array_list_get(array_list* list, unsigned int index) {
+    return index < list->size ? list->values[index] : NULL;
+}
+
+bool array_list_add(array_list* list, void* value) {
+    if(!array_list_grow(list, list->size + 1)) {
+        return false;
+    }
+
+    list->values[list->size++] = value;
+    return true;
+}
+
+bool array_list_add_at(array_list* list, unsigned int index, void* value) {
+    if(index > list->size || !array_list_grow(list, list->size + 1)) {
+        return false;
+    }
+
+    memmove(&list->values[index + 1], &list->values[index], (list->size - index) * sizeof(void*));
+
+    list->values[index] = value;
+    list->size++;
+    return true;
+}
+
+bool array_list_add_sorted(array_list* list, void* value, void* userData, int (*compare)(void* userData, const void* p1, const void* p2)) {
+    if(compare == NULL) {
+        return array_list_add(list, value);
+    }
+
+    // Insert after any equal values, matching linked_list_add_sorted.
+    unsigned int low = 0;
+    unsigned int high = list->size;
+    while(low < high) {
+        unsigned int mid = low + (high - low) / 2;
+        if(compare(userData, value, list->values[mid]) < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    return array_list_add_at(list, low, value);
+}
+
+bool array_list_add_all(array_list* list, linked_list* values) {
+    if(!array_list_grow(list, list->size + linked_list_size(values))) {
+        return false;
+    }
+
+    linked_list_iter iter;
+    linked_list_iterate(values, &iter);
+
+    while(linked_list_iter_has_next(&iter)) {
+        list->values[list->size++] = linked_list_iter_next(&iter);
+    }
+
+    return true;
+}
+
+bool array_list_remove(array_list* list, void* value) {
+    unsigned int kept = 0;
+    for(unsigned int i = 0; i < list->size; i++) {
+        if(list->values[i] != value) {
+            list->values[kept++] = list->values[i];
+        }
+    }
+
+    bool found = kept != list->size;
+    list->size = kept;
+    return found;
+}
+
+bool array_list_remove_at(array_list* list, unsigned int index) {
+    if(index >= list->size) {
+        return false;
+    }
+
+    memmove(&list->values[index], &list->values[index + 1], (list->size - index - 1) * sizeof(void*));
+
+    list->size--;
+    return true;
+}
+
+bool array_list_sort(array_list* list, void* userData, int (*compare)(void* userData, const void* p1, const void* p2)) {
+    if(list->size < 2) {
+        return true;
+    }
+
+    void** temp = (void**) malloc(list->size * sizeof(void*));
+    if(temp == NULL) {
+        return false;
+    }
+
+    // Bottom-up merge sort; stable, like linked_list_sort.
+    void** src = list->values;
+    void** dst = temp;
+    for(unsigned int width = 1; width < list->size; width *= 2) {
+        for(unsigned int start = 0; start < list->size; start += width * 2) {
+            unsigned int mid = start + width < list->size ? start + width : list->size;
+            unsigned int end = start + width * 2 < list->size ? start + width * 2 : list->size;
+
+            unsigned int left = start;
+            unsigned int right = mid;
+            unsigned int out = start;
+            while(left < mid && right < end) {
+                dst[out++] = compare(userData, src[left], src[right]) <= 0 ? src[left++] : src[right++];
+            }
+
+            while(left < mid) {
+                dst[out++] = src[left++];
+            }
+
+            while(right < end) {
+                dst[out++] = src[right++];
+            }
+        }
+
+        void** swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if(src != list->values) {
+        memcpy(list->values, src, list->size * sizeof(void*));
+    }
+
+    free(temp);
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+
+typedef struct linked_list_s linked_list;
+
+typedef struct array_list_s {
+    void** values;
+    unsigned int size;
+    unsigned int capacity;
+} array_list;
+
+void array_list_init(array_list* list);
+void array_list_destroy(array_list* list);
+
+unsigned int array_list_size(array_list* list);
+void array_list_clear(array_list* list);
+bool array_list_reserve(array_list* list, unsigned int capacity);
+bool array_list_contains(array_list* list, void* value);
+int array_list_index_of(array_list* list, void* value);
+void* array_list_get(array_list* list, unsigned int index);
+bool array_list_add(array_list* list, void* value);
+bool array_list_add_at(array_list* list, unsigned int index, void* value);
+bool array_list_add_sorted(array_list* list, void* value, void* userData, int (*compare)(void* userData, const void* p1, const void* p2));
+bool array_list_add_all(array_list* list, linked_list* values);
+bool array_list_remove(array_list* list, void* value);
+bool array_list_remove_at(array_list* list, unsigned int index);
+bool array_list_sort(array_list* list, void* userData, int (*compare)(void* userData, const void* p1, const void* p2));
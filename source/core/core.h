@@ -4,11 +4,17 @@
 #include "task/task.h"
 #include "ui/ui.h"
 
+#include "arraylist.h"
 #include "clipboard.h"
 #include "error.h"
 #include "fs.h"
 #include "http.h"
+#include "iconatlas.h"
 #include "linkedlist.h"
 #include "screen.h"
 #include "spi.h"
-#include "stringutil.h"
\ No newline at end of file
+#include "spritebatch.h"
+#include "stringutil.h"
+#include "textlayout.h"
+#include "textureids.h"
+#include "zip.h"
\ No newline at end of file
@@ -5,7 +5,7 @@
 #include "tmd.h"
 #include "../error.h"
 
-Result cia_get_title_id(u64* titleId, u8* cia, size_t size) {
+Result cia_get_tmd(u8** tmd, size_t* tmdSize, u8* cia, size_t size) {
     if(cia == NULL) {
         return R_APP_INVALID_ARGUMENT;
     }
@@ -23,7 +23,64 @@ Result cia_get_title_id(u64* titleId, u8* cia, size_t size) {
         return R_APP_BAD_DATA;
     }
 
-    return tmd_get_title_id(titleId, &cia[offset], size - offset);
+    *tmd = &cia[offset];
+    *tmdSize = size - offset;
+    return 0;
+}
+
+Result cia_get_title_id(u64* titleId, u8* cia, size_t size) {
+    u8* tmd = NULL;
+    size_t tmdSize = 0;
+    Result res = cia_get_tmd(&tmd, &tmdSize, cia, size);
+    if(R_FAILED(res)) {
+        return res;
+    }
+
+    return tmd_get_title_id(titleId, tmd, tmdSize);
+}
+
+Result cia_get_title_version(u16* version, u8* cia, size_t size) {
+    u8* tmd = NULL;
+    size_t tmdSize = 0;
+    Result res = cia_get_tmd(&tmd, &tmdSize, cia, size);
+    if(R_FAILED(res)) {
+        return res;
+    }
+
+    return tmd_get_title_version(version, tmd, tmdSize);
+}
+
+Result cia_get_content_offset(u64* offset, u8* cia, size_t size) {
+    if(cia == NULL || offset == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    if(size < 0x14) {
+        return R_APP_BAD_DATA;
+    }
+
+    u32 headerSize = ((*(u32*) &cia[0x00]) + 0x3F) & ~0x3F;
+    u32 certSize = ((*(u32*) &cia[0x08]) + 0x3F) & ~0x3F;
+    u32 ticketSize = ((*(u32*) &cia[0x0C]) + 0x3F) & ~0x3F;
+    u32 tmdSize = ((*(u32*) &cia[0x10]) + 0x3F) & ~0x3F;
+
+    *offset = (u64) headerSize + certSize + ticketSize + tmdSize;
+    return 0;
+}
+
+Result cia_has_content(bool* present, u8* cia, size_t size, u16 index) {
+    if(cia == NULL || present == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    // Content index bitmap, most significant bit first.
+    u32 pos = 0x20 + (index / 8);
+    if(pos >= size || pos >= *(u32*) &cia[0x00]) {
+        return R_APP_BAD_DATA;
+    }
+
+    *present = (cia[pos] & (0x80 >> (index % 8))) != 0;
+    return 0;
 }
 
 Result cia_file_get_smdh(SMDH* smdh, Handle handle) {
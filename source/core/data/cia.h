@@ -2,5 +2,9 @@
 
 typedef struct SMDH_s SMDH;
 
+Result cia_get_tmd(u8** tmd, size_t* tmdSize, u8* cia, size_t size);
 Result cia_get_title_id(u64* titleId, u8* cia, size_t size);
+Result cia_get_title_version(u16* version, u8* cia, size_t size);
+Result cia_get_content_offset(u64* offset, u8* cia, size_t size);
+Result cia_has_content(bool* present, u8* cia, size_t size, u16 index);
 Result cia_file_get_smdh(SMDH* smdh, Handle handle);
\ No newline at end of file
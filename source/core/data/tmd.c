@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include <3ds.h>
 
 #include "tmd.h"
@@ -46,6 +48,20 @@ Result tmd_get_title_id(u64* titleId, u8* tmd, size_t size) {
     return 0;
 }
 
+Result tmd_get_title_version(u16* version, u8* tmd, size_t size) {
+    u8* data = NULL;
+    Result res = tmd_get(&data, tmd, size, 0x9C, sizeof(u16));
+    if(R_FAILED(res)) {
+        return res;
+    }
+
+    if(version != NULL) {
+        *version = __builtin_bswap16(*(u16*) data);
+    }
+
+    return 0;
+}
+
 Result tmd_get_content_count(u16* contentCount, u8* tmd, size_t size) {
     u8* data = NULL;
     Result res = tmd_get(&data, tmd, size, 0x9E, sizeof(u16));
@@ -86,4 +102,48 @@ Result tmd_get_content_index(u16* index, u8* tmd, size_t size, u32 num) {
     }
 
     return 0;
-}
\ No newline at end of file
+}
+Result tmd_get_content_type(u16* type, u8* tmd, size_t size, u32 num) {
+    u8* data = NULL;
+    Result res = tmd_get(&data, tmd, size, 0x9C4 + (num * 0x30) + 0x6, sizeof(u16));
+    if(R_FAILED(res)) {
+        return res;
+    }
+
+    if(type != NULL) {
+        *type = __builtin_bswap16(*(u16*) data);
+    }
+
+    return 0;
+}
+
+Result tmd_get_content_size(u64* contentSize, u8* tmd, size_t size, u32 num) {
+    u8* data = NULL;
+    Result res = tmd_get(&data, tmd, size, 0x9C4 + (num * 0x30) + 0x8, sizeof(u64));
+    if(R_FAILED(res)) {
+        return res;
+    }
+
+    if(contentSize != NULL) {
+        u64 value = 0;
+        memcpy(&value, data, sizeof(value));
+
+        *contentSize = __builtin_bswap64(value);
+    }
+
+    return 0;
+}
+
+Result tmd_get_content_hash(u8* hash, u8* tmd, size_t size, u32 num) {
+    u8* data = NULL;
+    Result res = tmd_get(&data, tmd, size, 0x9C4 + (num * 0x30) + 0x10, TMD_CONTENT_HASH_SIZE);
+    if(R_FAILED(res)) {
+        return res;
+    }
+
+    if(hash != NULL) {
+        memcpy(hash, data, TMD_CONTENT_HASH_SIZE);
+    }
+
+    return 0;
+}
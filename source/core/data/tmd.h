@@ -1,6 +1,13 @@
 #pragma once
 
+#define TMD_CONTENT_HASH_SIZE 0x20
+#define TMD_CONTENT_TYPE_ENCRYPTED 0x1
+
 Result tmd_get_title_id(u64* titleId, u8* tmd, size_t size);
+Result tmd_get_title_version(u16* version, u8* tmd, size_t size);
 Result tmd_get_content_count(u16* contentCount, u8* tmd, size_t size);
 Result tmd_get_content_id(u32* id, u8* tmd, size_t size, u32 num);
-Result tmd_get_content_index(u16* index, u8* tmd, size_t size, u32 num);
\ No newline at end of file
+Result tmd_get_content_index(u16* index, u8* tmd, size_t size, u32 num);
+Result tmd_get_content_type(u16* type, u8* tmd, size_t size, u32 num);
+Result tmd_get_content_size(u64* contentSize, u8* tmd, size_t size, u32 num);
+Result tmd_get_content_hash(u8* hash, u8* tmd, size_t size, u32 num);
\ No newline at end of file
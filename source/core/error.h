@@ -17,6 +17,9 @@
 #define R_APP_CURL_ERROR_BASE (R_APP_CURL_INIT_FAILED + 1)
 #define R_APP_CURL_ERROR_END (R_APP_CURL_ERROR_BASE + 100)
 
+#define R_APP_CONNECTION_CLOSED R_APP_CURL_ERROR_END
+#define R_APP_HASH_MISMATCH (R_APP_CONNECTION_CLOSED + 1)
+
 #define R_APP_NOT_IMPLEMENTED MAKERESULT(RL_PERMANENT, RS_INTERNAL, RM_APPLICATION, RD_NOT_IMPLEMENTED)
 #define R_APP_OUT_OF_MEMORY MAKERESULT(RL_FATAL, RS_OUTOFRESOURCE, RM_APPLICATION, RD_OUT_OF_MEMORY)
 #define R_APP_OUT_OF_RANGE MAKERESULT(RL_PERMANENT, RS_INVALIDARG, RM_APPLICATION, RD_OUT_OF_RANGE)
@@ -226,4 +226,20 @@ bool fs_filter_tickets(void* data, const char* name, u32 attributes) {
 
     size_t len = strlen(name);
     return (len >= 4 && strncasecmp(name + len - 4, ".tik", 4) == 0) || (len >= 5 && strncasecmp(name + len - 5, ".cetk", 5) == 0);
+}
+
+bool fs_filter_compressed(void* data, const char* name, u32 attributes) {
+    if(data != NULL) {
+        fs_filter_data* filterData = (fs_filter_data*) data;
+        if(filterData->parentFilter != NULL && !filterData->parentFilter(filterData->parentFilterData, name, attributes)) {
+            return false;
+        }
+    }
+
+    if((attributes & FS_ATTRIBUTE_DIRECTORY) != 0) {
+        return false;
+    }
+
+    size_t len = strlen(name);
+    return (len >= 4 && strncasecmp(name + len - 4, ".zip", 4) == 0) || (len >= 3 && strncasecmp(name + len - 3, ".gz", 3) == 0);
 }
\ No newline at end of file
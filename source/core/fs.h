@@ -28,4 +28,5 @@ int fs_make_smdh_path(char* out, const char* name, size_t size);
 FS_MediaType fs_get_title_destination(u64 titleId);
 
 bool fs_filter_cias(void* data, const char* name, u32 attributes);
-bool fs_filter_tickets(void* data, const char* name, u32 attributes);
\ No newline at end of file
+bool fs_filter_tickets(void* data, const char* name, u32 attributes);
+bool fs_filter_compressed(void* data, const char* name, u32 attributes);
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,13 +21,46 @@
 #define HTTP_TIMEOUT_SEC 15
 #define HTTP_TIMEOUT_NS ((u64) HTTP_TIMEOUT_SEC * 1000000000)
 
+#define HTTP_URL_MAX 1024
+
+#define HTTP_RANGE_SEGMENT_SIZE (512 * 1024)
+#define HTTP_RANGE_MAX_CONNECTIONS 8
+#define HTTP_RANGE_RETRIES 3
+#define HTTP_RANGE_WAIT_NS 100000000
+
+#define HTTP_PREFETCH_WAIT_NS 100000000
+
+#define HTTP_CURL_DIRECT_MIN (16 * 1024)
+
+#define HTTP_INFLATE_WINDOW_MIN (32 * 1024)
+#define HTTP_INFLATE_WINDOW_MAX (256 * 1024)
+
+#define HTTP_POOL_KEY_MAX 256
+#define HTTP_POOL_MAX_HANDLES 4
+#define HTTP_POOL_IDLE_MS 30000
+
 struct httpc_context_s {
     httpcContext httpc;
 
+    char url[HTTP_URL_MAX];
+    bool partial;
+
     bool compressed;
+    bool inflateEnded;
     z_stream inflate;
-    u8 buffer[32 * 1024];
-    u32 bufferSize;
+    // Received input not yet inflated: inputUsed bytes from inputStart. Refilled only once drained, so it never needs compacting.
+    u8* input;
+    u32 inputSize;
+    u32 inputStart;
+    u32 inputUsed;
+    bool inputFilled;
+    u32 downloadPos;
+    bool downloadDone;
+
+    // Body bytes read ahead by a prefetch; served before any further data is received.
+    u8* head;
+    u32 headSize;
+    u32 headPos;
 };
 
 typedef struct httpc_context_s* httpc_context;
@@ -60,7 +94,7 @@ static void httpc_resolve_redirect(char* oldUrl, const char* redirectTo, size_t
     }
 }
 
-static Result httpc_open(httpc_context* context, const char* url, bool userAgent) {
+static Result httpc_open(httpc_context* context, const char* url, bool userAgent, const char* range, const char* ifRange) {
     if(url == NULL) {
         return R_APP_INVALID_ARGUMENT;
     }
@@ -69,8 +103,8 @@ static Result httpc_open(httpc_context* context, const char* url, bool userAgent
 
     httpc_context ctx = (httpc_context) calloc(1, sizeof(struct httpc_context_s));
     if(ctx != NULL) {
-        char currUrl[1024];
-        string_copy(currUrl, url, sizeof(currUrl));
+        char* currUrl = ctx->url;
+        string_copy(currUrl, url, HTTP_URL_MAX);
 
         bool resolved = false;
         u32 redirectCount = 0;
@@ -79,7 +113,10 @@ static Result httpc_open(httpc_context* context, const char* url, bool userAgent
                 u32 response = 0;
                 if(R_SUCCEEDED(res = httpcSetSSLOpt(&ctx->httpc, SSLCOPT_DisableVerify))
                    && (!userAgent || R_SUCCEEDED(res = httpcAddRequestHeaderField(&ctx->httpc, "User-Agent", HTTP_USER_AGENT)))
-                   && R_SUCCEEDED(res = httpcAddRequestHeaderField(&ctx->httpc, "Accept-Encoding", "gzip, deflate"))
+                   // Ranges are byte offsets into the raw entity, so ranged requests must not be content-encoded.
+                   && (range != NULL || R_SUCCEEDED(res = httpcAddRequestHeaderField(&ctx->httpc, "Accept-Encoding", "gzip, deflate")))
+                   && (range == NULL || R_SUCCEEDED(res = httpcAddRequestHeaderField(&ctx->httpc, "Range", range)))
+                   && (ifRange == NULL || R_SUCCEEDED(res = httpcAddRequestHeaderField(&ctx->httpc, "If-Range", ifRange)))
                    && R_SUCCEEDED(res = httpcSetKeepAlive(&ctx->httpc, HTTPC_KEEPALIVE_ENABLED))
                    && R_SUCCEEDED(res = httpcBeginRequest(&ctx->httpc))
                    && R_SUCCEEDED(res = httpcGetResponseStatusCodeTimeout(&ctx->httpc, &response, HTTP_TIMEOUT_NS))) {
@@ -91,12 +128,14 @@ static Result httpc_open(httpc_context* context, const char* url, bool userAgent
                         if(R_SUCCEEDED(res = httpcGetResponseHeader(&ctx->httpc, "Location", redirectTo, sizeof(redirectTo)))) {
                             httpcCloseContext(&ctx->httpc);
 
-                            httpc_resolve_redirect(currUrl, redirectTo, sizeof(currUrl));
+                            httpc_resolve_redirect(currUrl, redirectTo, HTTP_URL_MAX);
                         }
                     } else {
                         resolved = true;
 
-                        if(response == 200) {
+                        ctx->partial = range != NULL && response == 206;
+
+                        if(response == 200 || ctx->partial) {
                             char encoding[32];
                             if(R_SUCCEEDED(httpcGetResponseHeader(&ctx->httpc, "Content-Encoding", encoding, sizeof(encoding)))) {
                                 bool gzip = strncmp(encoding, "gzip", sizeof(encoding)) == 0;
@@ -152,6 +191,14 @@ static Result httpc_close(httpc_context context) {
         inflateEnd(&context->inflate);
     }
 
+    if(context->input != NULL) {
+        free(context->input);
+    }
+
+    if(context->head != NULL) {
+        free(context->head);
+    }
+
     Result res = httpcCloseContext(&context->httpc);
     free(context);
     return res;
@@ -165,11 +212,148 @@ static Result httpc_get_size(httpc_context context, u32* size) {
     return httpcGetDownloadSizeState(&context->httpc, NULL, size);
 }
 
+static Result httpc_get_range_total(httpc_context context, u64* total) {
+    if(context == NULL || total == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    if(!context->partial) {
+        return R_APP_BAD_DATA;
+    }
+
+    Result res = 0;
+
+    // e.g. Content-Range: bytes 0-524287/1048576
+    char contentRange[64];
+    memset(contentRange, '\0', sizeof(contentRange));
+    if(R_SUCCEEDED(res = httpcGetResponseHeader(&context->httpc, "Content-Range", contentRange, sizeof(contentRange)))) {
+        char* totalStr = strrchr(contentRange, '/');
+        if(totalStr != NULL && totalStr[1] != '*' && totalStr[1] != '\0') {
+            *total = strtoull(totalStr + 1, NULL, 10);
+        } else {
+            res = R_APP_BAD_DATA;
+        }
+    }
+
+    return res;
+}
+
+static void httpc_get_validator(httpc_context context, char* validator, size_t size) {
+    memset(validator, '\0', size);
+
+    // Weak entity tags cannot be used with If-Range, so fall back to Last-Modified for those.
+    if(R_FAILED(httpcGetResponseHeader(&context->httpc, "ETag", validator, size)) || string_is_empty(validator) || strncmp(validator, "W/", 2) == 0) {
+        memset(validator, '\0', size);
+
+        if(R_FAILED(httpcGetResponseHeader(&context->httpc, "Last-Modified", validator, size))) {
+            memset(validator, '\0', size);
+        }
+    }
+}
+
+static Result httpc_receive_input(httpc_context context) {
+    // The window doubles whenever a receive fills it, so fast, highly compressed transfers make fewer round trips.
+    if(context->input != NULL && context->inputFilled && context->inputSize < HTTP_INFLATE_WINDOW_MAX) {
+        free(context->input);
+        context->input = NULL;
+        context->inputSize *= 2;
+    }
+
+    if(context->input == NULL) {
+        if(context->inputSize == 0) {
+            context->inputSize = HTTP_INFLATE_WINDOW_MIN;
+        }
+
+        if((context->input = (u8*) malloc(context->inputSize)) == NULL) {
+            return R_APP_OUT_OF_MEMORY;
+        }
+    }
+
+    Result res = httpcReceiveDataTimeout(&context->httpc, context->input, context->inputSize, HTTP_TIMEOUT_NS);
+    if(R_SUCCEEDED(res)) {
+        context->downloadDone = true;
+    } else if(res != HTTPC_RESULTCODE_DOWNLOADPENDING) {
+        return res;
+    }
+
+    // The received size is only reported through the download position.
+    u32 currPos = 0;
+    if(R_SUCCEEDED(res = httpcGetDownloadSizeState(&context->httpc, &currPos, NULL))) {
+        context->inputStart = 0;
+        context->inputUsed = currPos - context->downloadPos;
+        context->inputFilled = context->inputUsed == context->inputSize;
+        context->downloadPos = currPos;
+    }
+
+    return res;
+}
+
+static Result httpc_read_compressed(httpc_context context, u32* bytesRead, void* buffer, u32 size) {
+    Result res = 0;
+
+    context->inflate.next_out = (Bytef*) buffer;
+    context->inflate.avail_out = size;
+
+    while(context->inflate.avail_out > 0 && !context->inflateEnded) {
+        if(context->inputUsed == 0) {
+            if(context->downloadDone) {
+                // The body ended before the compressed stream did.
+                res = R_APP_BAD_DATA;
+                break;
+            }
+
+            if(R_FAILED(res = httpc_receive_input(context)) || context->inputUsed == 0) {
+                break;
+            }
+        }
+
+        context->inflate.next_in = context->input + context->inputStart;
+        context->inflate.avail_in = context->inputUsed;
+
+        int inflateRes = inflate(&context->inflate, Z_SYNC_FLUSH);
+
+        u32 consumed = context->inputUsed - context->inflate.avail_in;
+        context->inputStart += consumed;
+        context->inputUsed -= consumed;
+
+        if(inflateRes == Z_STREAM_END) {
+            context->inflateEnded = true;
+        } else if(inflateRes != Z_OK && inflateRes != Z_BUF_ERROR) {
+            res = R_APP_BAD_DATA;
+            break;
+        }
+    }
+
+    if(R_SUCCEEDED(res) && bytesRead != NULL) {
+        *bytesRead = size - context->inflate.avail_out;
+    }
+
+    return res;
+}
+
 static Result httpc_read(httpc_context context, u32* bytesRead, void* buffer, u32 size) {
     if(context == NULL || buffer == NULL) {
         return R_APP_INVALID_ARGUMENT;
     }
 
+    if(context->headPos < context->headSize) {
+        u32 headRemaining = context->headSize - context->headPos;
+        u32 headRead = size < headRemaining ? size : headRemaining;
+
+        memcpy(buffer, context->head + context->headPos, headRead);
+        context->headPos += headRead;
+
+        if(bytesRead != NULL) {
+            *bytesRead = headRead;
+        }
+
+        return 0;
+    }
+
+    if(context->compressed) {
+        return httpc_read_compressed(context, bytesRead, buffer, size);
+    }
+
     Result res = 0;
 
     u32 startPos = 0;
@@ -177,43 +361,14 @@ static Result httpc_read(httpc_context context, u32* bytesRead, void* buffer, u3
         res = HTTPC_RESULTCODE_DOWNLOADPENDING;
 
         u32 outPos = 0;
-        if(context->compressed) {
-            u32 lastPos = context->bufferSize;
-            while(res == HTTPC_RESULTCODE_DOWNLOADPENDING && outPos < size) {
-                if((context->bufferSize > 0
-                    || R_SUCCEEDED(res = httpcReceiveDataTimeout(&context->httpc, &context->buffer[context->bufferSize], sizeof(context->buffer) - context->bufferSize, HTTP_TIMEOUT_NS))
-                    || res == HTTPC_RESULTCODE_DOWNLOADPENDING)) {
-                    Result posRes = 0;
-                    u32 currPos = 0;
-                    if(R_SUCCEEDED(posRes = httpcGetDownloadSizeState(&context->httpc, &currPos, NULL))) {
-                        context->bufferSize += currPos - lastPos;
-
-                        context->inflate.next_in = context->buffer;
-                        context->inflate.next_out = buffer + outPos;
-                        context->inflate.avail_in = context->bufferSize;
-                        context->inflate.avail_out = size - outPos;
-                        inflate(&context->inflate, Z_SYNC_FLUSH);
-
-                        memcpy(context->buffer, context->buffer + (context->bufferSize - context->inflate.avail_in), context->inflate.avail_in);
-                        context->bufferSize = context->inflate.avail_in;
-
-                        lastPos = currPos;
-                        outPos = size - context->inflate.avail_out;
-                    } else {
-                        res = posRes;
-                    }
-                }
-            }
-        } else {
-            while(res == HTTPC_RESULTCODE_DOWNLOADPENDING && outPos < size) {
-                if(R_SUCCEEDED(res = httpcReceiveDataTimeout(&context->httpc, &((u8*) buffer)[outPos], size - outPos, HTTP_TIMEOUT_NS)) || res == HTTPC_RESULTCODE_DOWNLOADPENDING) {
-                    Result posRes = 0;
-                    u32 currPos = 0;
-                    if(R_SUCCEEDED(posRes = httpcGetDownloadSizeState(&context->httpc, &currPos, NULL))) {
-                        outPos = currPos - startPos;
-                    } else {
-                        res = posRes;
-                    }
+        while(res == HTTPC_RESULTCODE_DOWNLOADPENDING && outPos < size) {
+            if(R_SUCCEEDED(res = httpcReceiveDataTimeout(&context->httpc, &((u8*) buffer)[outPos], size - outPos, HTTP_TIMEOUT_NS)) || res == HTTPC_RESULTCODE_DOWNLOADPENDING) {
+                Result posRes = 0;
+                u32 currPos = 0;
+                if(R_SUCCEEDED(posRes = httpcGetDownloadSizeState(&context->httpc, &currPos, NULL))) {
+                    outPos = currPos - startPos;
+                } else {
+                    res = posRes;
                 }
             }
         }
@@ -241,6 +396,7 @@ typedef struct {
 
     void* buf;
     u32 pos;
+    bool delivered;
 
     Result res;
 } http_curl_data;
@@ -248,10 +404,32 @@ typedef struct {
 static size_t http_curl_write_callback(char* ptr, size_t size, size_t nmemb, void* userdata) {
     http_curl_data* curlData = (http_curl_data*) userdata;
 
+    // The first block is staged to a full buffer, as sinks inspect it to open their destination.
+    // After that, chunks of at least HTTP_CURL_DIRECT_MIN go straight to the sink, and staging only
+    // coalesces smaller fragments up to that size.
+    u32 directMin = curlData->bufferSize < HTTP_CURL_DIRECT_MIN ? curlData->bufferSize : HTTP_CURL_DIRECT_MIN;
+
     size_t srcPos = 0;
     size_t available = size * nmemb;
     while(R_SUCCEEDED(curlData->res) && available > 0) {
-        size_t remaining = curlData->bufferSize - curlData->pos;
+        if(curlData->delivered && available >= directMin) {
+            // Flush staged fragments short rather than topping them up, or staging would stay out of step with
+            // curl's chunks and take every byte from then on.
+            if(curlData->pos != 0) {
+                curlData->res = curlData->callback(curlData->userData, curlData->buf, curlData->pos);
+                curlData->pos = 0;
+            }
+
+            if(R_SUCCEEDED(curlData->res)) {
+                curlData->res = curlData->callback(curlData->userData, ptr + srcPos, available);
+            }
+
+            break;
+        }
+
+        u32 target = curlData->delivered ? directMin : curlData->bufferSize;
+
+        size_t remaining = target - curlData->pos;
         size_t copySize = available < remaining ? available : remaining;
 
         memcpy((u8*) curlData->buf + curlData->pos, ptr + srcPos, copySize);
@@ -260,9 +438,10 @@ static size_t http_curl_write_callback(char* ptr, size_t size, size_t nmemb, voi
         srcPos += copySize;
         available -= copySize;
 
-        if(curlData->pos == curlData->bufferSize) {
-            curlData->res = curlData->callback(curlData->userData, curlData->buf, curlData->bufferSize);
+        if(curlData->pos == target) {
+            curlData->res = curlData->callback(curlData->userData, curlData->buf, curlData->pos);
             curlData->pos = 0;
+            curlData->delivered = true;
         }
     }
 
@@ -283,45 +462,795 @@ int http_curl_xfer_info_callback(void* clientp, curl_off_t dltotal, curl_off_t d
     return 0;
 }
 
-Result http_download_callback(const char* url, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
-                                                                               Result (*checkRunning)(void* userData),
-                                                                               Result (*progress)(void* userData, u64 total, u64 curr)) {
+typedef struct {
+    char key[HTTP_POOL_KEY_MAX];
+    CURL* curl;
+    u64 lastUsed;
+} http_pool_entry;
+
+// Idle curl handles keyed by scheme, host and port; each keeps its own connections open for reuse.
+static http_pool_entry http_pool[HTTP_POOL_MAX_HANDLES];
+static LightLock http_pool_lock;
+static u32 http_pool_hits = 0;
+static u32 http_pool_misses = 0;
+
+// DNS and TLS sessions are shared between all handles, so a miss to a known host still skips the full handshake.
+static CURLSH* http_share = NULL;
+static LightLock http_share_locks[CURL_LOCK_DATA_LAST];
+
+static void http_share_lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr) {
+    LightLock_Lock(&http_share_locks[data]);
+}
+
+static void http_share_unlock(CURL* handle, curl_lock_data data, void* userptr) {
+    LightLock_Unlock(&http_share_locks[data]);
+}
+
+// e.g. https://www.example.com/file.cia -> https://www.example.com:443
+static void http_pool_make_key(char* key, size_t size, const char* url) {
+    const char* host = strstr(url, "://");
+    size_t schemeLen = host != NULL ? (size_t) (host - url) : 0;
+    host = host != NULL ? host + 3 : url;
+
+    size_t hostLen = strcspn(host, "/?#");
+
+    const char* userEnd = (const char*) memchr(host, '@', hostLen);
+    if(userEnd != NULL) {
+        hostLen -= userEnd + 1 - host;
+        host = userEnd + 1;
+    }
+
+    const char* portStart = NULL;
+    for(size_t i = hostLen; i > 0 && host[i - 1] != ']'; i--) {
+        if(host[i - 1] == ':') {
+            portStart = &host[i - 1];
+            break;
+        }
+    }
+
+    char scheme[16] = {'\0'};
+    for(size_t i = 0; i < schemeLen && i < sizeof(scheme) - 1; i++) {
+        scheme[i] = (char) tolower((unsigned char) url[i]);
+    }
+
+    if(string_is_empty(scheme)) {
+        string_copy(scheme, "http", sizeof(scheme));
+    }
+
+    if(portStart != NULL) {
+        snprintf(key, size, "%s://%.*s", scheme, (int) hostLen, host);
+    } else {
+        snprintf(key, size, "%s://%.*s:%s", scheme, (int) hostLen, host, strcmp(scheme, "https") == 0 ? "443" : "80");
+    }
+
+    for(char* c = key + strlen(scheme) + 3; *c != '\0'; c++) {
+        *c = (char) tolower((unsigned char) *c);
+    }
+}
+
+static CURL* http_pool_acquire(const char* key) {
+    CURL* curl = NULL;
+
+    CURL* expired[HTTP_POOL_MAX_HANDLES];
+    u32 expiredCount = 0;
+
+    u64 now = osGetTime();
+
+    LightLock_Lock(&http_pool_lock);
+
+    for(u32 i = 0; i < HTTP_POOL_MAX_HANDLES; i++) {
+        http_pool_entry* entry = &http_pool[i];
+        if(entry->curl == NULL) {
+            continue;
+        }
+
+        if(now - entry->lastUsed >= HTTP_POOL_IDLE_MS) {
+            expired[expiredCount++] = entry->curl;
+            entry->curl = NULL;
+        } else if(curl == NULL && strncmp(entry->key, key, HTTP_POOL_KEY_MAX) == 0) {
+            curl = entry->curl;
+            entry->curl = NULL;
+        }
+    }
+
+    if(curl != NULL) {
+        http_pool_hits++;
+    } else {
+        http_pool_misses++;
+    }
+
+    LightLock_Unlock(&http_pool_lock);
+
+    for(u32 i = 0; i < expiredCount; i++) {
+        curl_easy_cleanup(expired[i]);
+    }
+
+    if(curl != NULL) {
+        // Options are cleared, but open connections and caches are kept.
+        curl_easy_reset(curl);
+    } else {
+        curl = curl_easy_init();
+    }
+
+    if(curl != NULL && http_share != NULL) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, http_share);
+    }
+
+    return curl;
+}
+
+static void http_pool_release(const char* key, CURL* curl, bool reusable) {
+    if(curl == NULL) {
+        return;
+    }
+
+    if(!reusable) {
+        curl_easy_cleanup(curl);
+        return;
+    }
+
+    CURL* evicted = NULL;
+
+    LightLock_Lock(&http_pool_lock);
+
+    // Take a free slot, or replace the least recently used handle.
+    http_pool_entry* slot = &http_pool[0];
+    for(u32 i = 0; i < HTTP_POOL_MAX_HANDLES; i++) {
+        http_pool_entry* entry = &http_pool[i];
+        if(entry->curl == NULL) {
+            slot = entry;
+            break;
+        }
+
+        if(entry->lastUsed < slot->lastUsed) {
+            slot = entry;
+        }
+    }
+
+    evicted = slot->curl;
+
+    string_copy(slot->key, key, HTTP_POOL_KEY_MAX);
+    slot->curl = curl;
+    slot->lastUsed = osGetTime();
+
+    LightLock_Unlock(&http_pool_lock);
+
+    if(evicted != NULL) {
+        curl_easy_cleanup(evicted);
+    }
+}
+
+void http_get_pool_stats(u32* hits, u32* misses) {
+    LightLock_Lock(&http_pool_lock);
+
+    if(hits != NULL) {
+        *hits = http_pool_hits;
+    }
+
+    if(misses != NULL) {
+        *misses = http_pool_misses;
+    }
+
+    LightLock_Unlock(&http_pool_lock);
+}
+
+void http_init() {
+    LightLock_Init(&http_pool_lock);
+
+    memset(http_pool, 0, sizeof(http_pool));
+    http_pool_hits = 0;
+    http_pool_misses = 0;
+
+    for(u32 i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        LightLock_Init(&http_share_locks[i]);
+    }
+
+    if((http_share = curl_share_init()) != NULL) {
+        curl_share_setopt(http_share, CURLSHOPT_LOCKFUNC, http_share_lock);
+        curl_share_setopt(http_share, CURLSHOPT_UNLOCKFUNC, http_share_unlock);
+        curl_share_setopt(http_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(http_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+}
+
+void http_exit() {
+    LightLock_Lock(&http_pool_lock);
+
+    for(u32 i = 0; i < HTTP_POOL_MAX_HANDLES; i++) {
+        if(http_pool[i].curl != NULL) {
+            curl_easy_cleanup(http_pool[i].curl);
+            http_pool[i].curl = NULL;
+        }
+    }
+
+    LightLock_Unlock(&http_pool_lock);
+
+    // Handles are removed from the share as they are cleaned up, so it can only go once they are all gone.
+    if(http_share != NULL) {
+        curl_share_cleanup(http_share);
+        http_share = NULL;
+    }
+}
+
+typedef struct {
+    u8* buffer;
+    u32 size;
+    bool ready;
+    Result res;
+} http_range_slot;
+
+typedef struct {
+    char url[HTTP_URL_MAX];
+    u64 total;
+
+    u32 segmentCount;
+    u32 nextSegment;
+    u32 deliveredSegments;
+
+    http_range_slot slots[HTTP_RANGE_MAX_CONNECTIONS * 2];
+    u32 slotCount;
+
+    LightLock lock;
+    CondVar cond;
+    volatile bool stop;
+} http_range_data;
+
+static Result http_range_fetch(http_range_data* range, u64 start, u32 size, u8* buffer) {
+    char rangeHeader[64];
+    snprintf(rangeHeader, sizeof(rangeHeader), "bytes=%llu-%llu", start, start + size - 1);
+
+    Result res = 0;
+
+    httpc_context context = NULL;
+    if(R_SUCCEEDED(res = httpc_open(&context, range->url, true, rangeHeader, NULL))) {
+        if(context->partial) {
+            u32 pos = 0;
+            while(pos < size && !range->stop) {
+                u32 bytesRead = 0;
+                if(R_FAILED(res = httpc_read(context, &bytesRead, buffer + pos, size - pos))) {
+                    break;
+                }
+
+                if(bytesRead == 0) {
+                    res = R_APP_BAD_DATA;
+                    break;
+                }
+
+                pos += bytesRead;
+            }
+
+            if(R_SUCCEEDED(res) && range->stop) {
+                res = R_APP_CANCELLED;
+            }
+        } else {
+            res = R_APP_BAD_DATA;
+        }
+
+        Result closeRes = httpc_close(context);
+        if(R_SUCCEEDED(res)) {
+            res = closeRes;
+        }
+    }
+
+    return res;
+}
+
+static void http_range_worker_thread(void* arg) {
+    http_range_data* range = (http_range_data*) arg;
+
+    LightLock_Lock(&range->lock);
+
+    while(!range->stop && range->nextSegment < range->segmentCount) {
+        // Segment 0 is streamed from the probe request, so ranged segments start at 1.
+        u32 segment = range->nextSegment;
+        if(segment - 1 >= range->deliveredSegments + range->slotCount) {
+            CondVar_Wait(&range->cond, &range->lock);
+            continue;
+        }
+
+        range->nextSegment++;
+
+        LightLock_Unlock(&range->lock);
+
+        http_range_slot* slot = &range->slots[(segment - 1) % range->slotCount];
+
+        u64 start = (u64) segment * HTTP_RANGE_SEGMENT_SIZE;
+        u32 size = range->total - start < HTTP_RANGE_SEGMENT_SIZE ? (u32) (range->total - start) : HTTP_RANGE_SEGMENT_SIZE;
+
+        Result res = 0;
+        for(u32 attempt = 0; attempt < HTTP_RANGE_RETRIES && !range->stop; attempt++) {
+            if(R_SUCCEEDED(res = http_range_fetch(range, start, size, slot->buffer)) || res == R_APP_CANCELLED) {
+                break;
+            }
+        }
+
+        LightLock_Lock(&range->lock);
+
+        slot->size = size;
+        slot->res = res;
+        slot->ready = true;
+
+        CondVar_Broadcast(&range->cond);
+    }
+
+    LightLock_Unlock(&range->lock);
+}
+
+static Result http_range_wait_slot(http_range_data* range, http_range_slot* slot, void* userData, Result (*checkRunning)(void* userData)) {
+    Result res = 0;
+
+    LightLock_Lock(&range->lock);
+
+    while(!slot->ready) {
+        LightLock_Unlock(&range->lock);
+
+        if(checkRunning != NULL && R_FAILED(res = checkRunning(userData))) {
+            return res;
+        }
+
+        LightLock_Lock(&range->lock);
+
+        if(!slot->ready) {
+            CondVar_WaitTimeout(&range->cond, &range->lock, HTTP_RANGE_WAIT_NS);
+        }
+    }
+
+    res = slot->res;
+
+    LightLock_Unlock(&range->lock);
+
+    return res;
+}
+
+static void http_range_stop(http_range_data* range, Thread* workers, u32 connections) {
+    LightLock_Lock(&range->lock);
+    range->stop = true;
+    CondVar_Broadcast(&range->cond);
+    LightLock_Unlock(&range->lock);
+
+    for(u32 i = 0; i < connections; i++) {
+        if(workers[i] != NULL) {
+            threadJoin(workers[i], U64_MAX);
+            threadFree(workers[i]);
+            workers[i] = NULL;
+        }
+    }
+
+    for(u32 i = 0; i < range->slotCount; i++) {
+        if(range->slots[i].buffer != NULL) {
+            free(range->slots[i].buffer);
+            range->slots[i].buffer = NULL;
+        }
+    }
+}
+
+static Result http_download_remainder(const char* url, u64 start, u64 total, u32 bufferSize, void* buf, void* userData,
+                                      Result (*callback)(void* userData, void* buffer, size_t size),
+                                      Result (*checkRunning)(void* userData),
+                                      Result (*progress)(void* userData, u64 total, u64 curr)) {
+    char rangeHeader[64];
+    snprintf(rangeHeader, sizeof(rangeHeader), "bytes=%llu-", start);
+
+    Result res = 0;
+
+    httpc_context context = NULL;
+    if(R_SUCCEEDED(res = httpc_open(&context, url, true, rangeHeader, NULL))) {
+        if(context->partial) {
+            u64 curr = start;
+            u32 currSize = 0;
+            while(curr < total
+                  && (checkRunning == NULL || R_SUCCEEDED(res = checkRunning(userData)))
+                  && R_SUCCEEDED(res = httpc_read(context, &currSize, buf, bufferSize))) {
+                if(currSize == 0) {
+                    res = R_APP_BAD_DATA;
+                    break;
+                }
+
+                if(R_FAILED(res = callback(userData, buf, currSize))) {
+                    break;
+                }
+
+                curr += currSize;
+
+                if(progress != NULL) {
+                    progress(userData, total, curr);
+                }
+            }
+        } else {
+            res = R_APP_BAD_DATA;
+        }
+
+        Result closeRes = httpc_close(context);
+        if(R_SUCCEEDED(res)) {
+            res = closeRes;
+        }
+    }
+
+    return res;
+}
+
+static Result http_download_ranged(httpc_context context, u64 total, u32 connections, u32 bufferSize, void* buf, void* userData,
+                                   Result (*callback)(void* userData, void* buffer, size_t size),
+                                   Result (*checkRunning)(void* userData),
+                                   Result (*progress)(void* userData, u64 total, u64 curr)) {
+    Result res = 0;
+
+    if(connections > HTTP_RANGE_MAX_CONNECTIONS) {
+        connections = HTTP_RANGE_MAX_CONNECTIONS;
+    }
+
+    Thread workers[HTTP_RANGE_MAX_CONNECTIONS];
+    memset(workers, 0, sizeof(workers));
+
+    // If the slot ring or a worker cannot be set up, the rest is fetched sequentially on a single connection instead.
+    http_range_data* range = (http_range_data*) calloc(1, sizeof(http_range_data));
+    if(range != NULL) {
+        string_copy(range->url, context->url, HTTP_URL_MAX);
+        range->total = total;
+        range->segmentCount = (u32) ((total + HTTP_RANGE_SEGMENT_SIZE - 1) / HTTP_RANGE_SEGMENT_SIZE);
+        range->nextSegment = 1;
+        range->deliveredSegments = 0;
+        range->slotCount = connections * 2;
+        range->stop = false;
+
+        LightLock_Init(&range->lock);
+        CondVar_Init(&range->cond);
+
+        bool ready = true;
+
+        for(u32 i = 0; i < range->slotCount && ready; i++) {
+            ready = (range->slots[i].buffer = (u8*) malloc(HTTP_RANGE_SEGMENT_SIZE)) != NULL;
+        }
+
+        for(u32 i = 0; i < connections && ready; i++) {
+            ready = (workers[i] = threadCreate(http_range_worker_thread, range, 0x4000, 0x18, 1, false)) != NULL;
+        }
+
+        if(!ready) {
+            http_range_stop(range, workers, connections);
+
+            free(range);
+            range = NULL;
+        }
+    }
+
+    u64 curr = 0;
+
+    if(progress != NULL) {
+        progress(userData, total, 0);
+    }
+
+    // Stream segment 0 from the probe request while the workers fetch ahead.
+    u32 firstSize = 0;
+    if(R_SUCCEEDED(res = httpc_get_size(context, &firstSize))) {
+        u32 currSize = 0;
+        while(curr < firstSize
+              && (checkRunning == NULL || R_SUCCEEDED(res = checkRunning(userData)))
+              && R_SUCCEEDED(res = httpc_read(context, &currSize, buf, bufferSize))
+              && R_SUCCEEDED(res = callback(userData, buf, currSize))) {
+            curr += currSize;
+
+            if(progress != NULL) {
+                progress(userData, total, curr);
+            }
+        }
+    }
+
+    if(range == NULL) {
+        if(R_SUCCEEDED(res) && curr < total) {
+            res = http_download_remainder(context->url, curr, total, bufferSize, buf, userData, callback, checkRunning, progress);
+        }
+
+        return res;
+    }
+
+    for(u32 segment = 1; segment < range->segmentCount && R_SUCCEEDED(res); segment++) {
+        http_range_slot* slot = &range->slots[(segment - 1) % range->slotCount];
+        if(R_FAILED(res = http_range_wait_slot(range, slot, userData, checkRunning))) {
+            break;
+        }
+
+        for(u32 pos = 0; pos < slot->size && R_SUCCEEDED(res); pos += bufferSize) {
+            u32 chunkSize = slot->size - pos < bufferSize ? slot->size - pos : bufferSize;
+
+            if((checkRunning == NULL || R_SUCCEEDED(res = checkRunning(userData)))
+               && R_SUCCEEDED(res = callback(userData, slot->buffer + pos, chunkSize))) {
+                curr += chunkSize;
+
+                if(progress != NULL) {
+                    progress(userData, total, curr);
+                }
+            }
+        }
+
+        LightLock_Lock(&range->lock);
+
+        slot->ready = false;
+        range->deliveredSegments++;
+
+        CondVar_Broadcast(&range->cond);
+
+        LightLock_Unlock(&range->lock);
+    }
+
+    http_range_stop(range, workers, connections);
+
+    free(range);
+
+    return res;
+}
+
+struct http_prefetch_s {
+    char url[HTTP_URL_MAX];
+    bool probe;
+    u32 headMax;
+
+    Thread thread;
+    volatile bool stop;
+
+    // Guards finished and detached; a prefetch closed before its thread finishes is freed by that thread.
+    LightLock lock;
+    bool finished;
+    bool detached;
+
+    httpc_context context;
+    Result res;
+};
+
+static void http_prefetch_thread(void* arg) {
+    http_prefetch prefetch = (http_prefetch) arg;
+
+    // Issue the same request http_download_callback would, so the response can be handed over as-is.
+    char rangeHeader[64];
+    const char* range = NULL;
+    if(prefetch->probe) {
+        snprintf(rangeHeader, sizeof(rangeHeader), "bytes=0-%u", HTTP_RANGE_SEGMENT_SIZE - 1);
+        range = rangeHeader;
+    }
+
+    Result res = 0;
+
+    httpc_context context = NULL;
+    if(R_SUCCEEDED(res = httpc_open(&context, prefetch->url, true, range, NULL)) && prefetch->headMax > 0) {
+        u32 headMax = prefetch->headMax;
+
+        u32 dlSize = 0;
+        if(!context->compressed && R_SUCCEEDED(httpc_get_size(context, &dlSize)) && dlSize < headMax) {
+            headMax = dlSize;
+        }
+
+        u8* head = (u8*) malloc(headMax);
+        if(head != NULL) {
+            u32 headSize = 0;
+            while(headSize < headMax && !prefetch->stop) {
+                u32 bytesRead = 0;
+                if(R_FAILED(res = httpc_read(context, &bytesRead, head + headSize, headMax - headSize)) || bytesRead == 0) {
+                    break;
+                }
+
+                headSize += bytesRead;
+            }
+
+            context->head = head;
+            context->headSize = headSize;
+            context->headPos = 0;
+        }
+    }
+
+    if(R_FAILED(res) && context != NULL) {
+        httpc_close(context);
+        context = NULL;
+    }
+
+    LightLock_Lock(&prefetch->lock);
+
+    prefetch->context = context;
+    prefetch->res = res;
+    prefetch->finished = true;
+
+    bool detached = prefetch->detached;
+
+    LightLock_Unlock(&prefetch->lock);
+
+    if(detached) {
+        if(prefetch->context != NULL) {
+            httpc_close(prefetch->context);
+        }
+
+        free(prefetch);
+    }
+}
+
+Result http_prefetch_open(http_prefetch* prefetch, const char* url, u32 connections, u32 headSize) {
+    if(prefetch == NULL || url == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    Result res = 0;
+
+    http_prefetch data = (http_prefetch) calloc(1, sizeof(struct http_prefetch_s));
+    if(data != NULL) {
+        string_copy(data->url, url, HTTP_URL_MAX);
+        data->probe = connections > 1;
+        data->headMax = headSize;
+        data->stop = false;
+
+        LightLock_Init(&data->lock);
+
+        if((data->thread = threadCreate(http_prefetch_thread, data, 0x4000, 0x19, 1, false)) != NULL) {
+            *prefetch = data;
+        } else {
+            free(data);
+            res = R_APP_THREAD_CREATE_FAILED;
+        }
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+void http_prefetch_close(http_prefetch prefetch) {
+    if(prefetch == NULL) {
+        return;
+    }
+
+    prefetch->stop = true;
+
+    // Connecting does not observe stop, so rather than wait out a slow server, leave the thread to clean up.
+    LightLock_Lock(&prefetch->lock);
+
+    if(!prefetch->finished) {
+        prefetch->detached = true;
+        threadDetach(prefetch->thread);
+
+        LightLock_Unlock(&prefetch->lock);
+        return;
+    }
+
+    LightLock_Unlock(&prefetch->lock);
+
+    threadJoin(prefetch->thread, U64_MAX);
+    threadFree(prefetch->thread);
+
+    if(prefetch->context != NULL) {
+        httpc_close(prefetch->context);
+    }
+
+    free(prefetch);
+}
+
+// Hands over the prefetched response if it was made for the same request; the prefetch is always consumed.
+static Result http_prefetch_take(http_prefetch prefetch, const char* url, bool probe, httpc_context* context, void* userData, Result (*checkRunning)(void* userData)) {
+    Result res = 0;
+
+    if(strncmp(prefetch->url, url, HTTP_URL_MAX) == 0 && prefetch->probe == probe) {
+        Result joinRes = 0;
+        while((joinRes = threadJoin(prefetch->thread, checkRunning != NULL ? HTTP_PREFETCH_WAIT_NS : U64_MAX)) != 0 && R_DESCRIPTION(joinRes) == RD_TIMEOUT) {
+            if(R_FAILED(res = checkRunning(userData))) {
+                break;
+            }
+        }
+
+        if(R_SUCCEEDED(res) && R_SUCCEEDED(prefetch->res) && prefetch->context != NULL) {
+            *context = prefetch->context;
+            prefetch->context = NULL;
+        }
+    }
+
+    http_prefetch_close(prefetch);
+
+    return res;
+}
+
+Result http_download_callback(const char* url, u32 bufferSize, u32 connections, http_resume_info* resume, http_prefetch* prefetch, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                                        Result (*checkRunning)(void* userData),
+                                                                                                                        Result (*progress)(void* userData, u64 total, u64 curr)) {
     Result res = 0;
 
     void* buf = malloc(bufferSize);
     if(buf != NULL) {
+        char rangeHeader[64];
+        const char* range = NULL;
+        const char* ifRange = NULL;
+
+        if(resume != NULL && resume->offset > 0 && !string_is_empty(resume->validator)) {
+            // If-Range makes the server send the whole entity instead when it has changed since the partial transfer.
+            snprintf(rangeHeader, sizeof(rangeHeader), "bytes=%llu-", resume->offset);
+            range = rangeHeader;
+            ifRange = resume->validator;
+        } else if(connections > 1) {
+            // With multiple connections, probe for range support by requesting the first segment only.
+            snprintf(rangeHeader, sizeof(rangeHeader), "bytes=0-%u", HTTP_RANGE_SEGMENT_SIZE - 1);
+            range = rangeHeader;
+        }
+
         httpc_context context = NULL;
-        if(R_SUCCEEDED(res = httpc_open(&context, url, true))) {
-            u32 dlSize = 0;
-            if(R_SUCCEEDED(res = httpc_get_size(context, &dlSize))) {
-                if(progress != NULL) {
-                    progress(userData, dlSize, 0);
+        if(prefetch != NULL && *prefetch != NULL) {
+            res = http_prefetch_take(*prefetch, url, range != NULL && ifRange == NULL, &context, userData, checkRunning);
+            *prefetch = NULL;
+        }
+
+        if(R_SUCCEEDED(res) && context == NULL) {
+            if(R_FAILED(res = httpc_open(&context, url, true, range, ifRange)) && ifRange != NULL && res != R_HTTP_TLS_VERIFY_FAILED) {
+                // e.g. 416 when the entity shrank; restart the transfer from the beginning.
+                range = NULL;
+                ifRange = NULL;
+                res = httpc_open(&context, url, true, NULL, NULL);
+            }
+        }
+
+        if(R_SUCCEEDED(res)) {
+            u64 rangeTotal = 0;
+            if(ifRange == NULL && context->partial && R_FAILED(httpc_get_range_total(context, &rangeTotal))) {
+                // A partial response without a usable total cannot be split, so fall back to a plain request.
+                httpc_close(context);
+                context = NULL;
+
+                range = NULL;
+                res = httpc_open(&context, url, true, NULL, NULL);
+            }
+        }
+
+        if(R_SUCCEEDED(res)) {
+            u64 baseOffset = 0;
+            if(resume != NULL) {
+                if(ifRange != NULL && context->partial) {
+                    baseOffset = resume->offset;
+                } else {
+                    resume->offset = 0;
                 }
 
-                u32 total = 0;
-                u32 currSize = 0;
-                while(total < dlSize
-                      && (checkRunning == NULL || R_SUCCEEDED(res = checkRunning(userData)))
-                      && R_SUCCEEDED(res = httpc_read(context, &currSize, buf, bufferSize))
-                      && R_SUCCEEDED(res = callback(userData, buf, currSize))) {
+                httpc_get_validator(context, resume->validator, sizeof(resume->validator));
+            }
+
+            u64 rangeTotal = 0;
+            if(ifRange == NULL && context->partial && R_SUCCEEDED(httpc_get_range_total(context, &rangeTotal)) && rangeTotal > HTTP_RANGE_SEGMENT_SIZE) {
+                res = http_download_ranged(context, rangeTotal, connections, bufferSize, buf, userData, callback, checkRunning, progress);
+            } else {
+                // Servers without range support answer with the whole entity, which is streamed as usual.
+                u32 dlSize = 0;
+                if(R_SUCCEEDED(res = httpc_get_size(context, &dlSize))) {
                     if(progress != NULL) {
-                        progress(userData, dlSize, total);
+                        progress(userData, baseOffset + dlSize, baseOffset);
                     }
 
-                    total += currSize;
-                }
+                    // The size of a content-encoded entity counts encoded bytes, so those run until inflate stops producing output.
+                    u32 total = 0;
+                    u32 currSize = 0;
+                    while((context->compressed || total < dlSize)
+                          && (checkRunning == NULL || R_SUCCEEDED(res = checkRunning(userData)))
+                          && R_SUCCEEDED(res = httpc_read(context, &currSize, buf, bufferSize))
+                          && (!context->compressed || currSize > 0)
+                          && R_SUCCEEDED(res = callback(userData, buf, currSize))) {
+                        if(progress != NULL) {
+                            progress(userData, baseOffset + dlSize, baseOffset + total);
+                        }
 
-                Result closeRes = httpc_close(context);
-                if(R_SUCCEEDED(res)) {
-                    res = closeRes;
+                        total += currSize;
+                    }
                 }
             }
+
+            Result closeRes = httpc_close(context);
+            if(R_SUCCEEDED(res)) {
+                res = closeRes;
+            }
         } else if(res == R_HTTP_TLS_VERIFY_FAILED) {
             res = 0;
 
-            CURL* curl = curl_easy_init();
+            // The curl fallback always transfers the whole entity.
+            if(resume != NULL) {
+                resume->offset = 0;
+                memset(resume->validator, '\0', sizeof(resume->validator));
+            }
+
+            char poolKey[HTTP_POOL_KEY_MAX];
+            http_pool_make_key(poolKey, sizeof(poolKey), url);
+
+            CURL* curl = http_pool_acquire(poolKey);
             if(curl != NULL) {
-                http_curl_data curlData = {bufferSize, userData, callback, checkRunning, progress, buf, 0, 0};
+                http_curl_data curlData = {bufferSize, userData, callback, checkRunning, progress, buf, 0, false, 0};
 
                 curl_easy_setopt(curl, CURLOPT_URL, url);
                 curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, bufferSize);
@@ -359,7 +1288,8 @@ Result http_download_callback(const char* url, u32 bufferSize, void* userData, R
                     }
                 }
 
-                curl_easy_cleanup(curl);
+                // Only a handle whose transfer completed is known to leave its connection in a reusable state.
+                http_pool_release(poolKey, curl, ret == CURLE_OK);
             } else {
                 res = R_APP_CURL_INIT_FAILED;
             }
@@ -400,7 +1330,7 @@ static Result http_download_buffer_callback(void* userData, void* buffer, size_t
 
 Result http_download_buffer(const char* url, u32* downloadedSize, void* buf, size_t size) {
     http_buffer_data data = {buf, size, 0};
-    Result res = http_download_callback(url, size, &data, http_download_buffer_callback, NULL, NULL);
+    Result res = http_download_callback(url, size, 1, NULL, NULL, &data, http_download_buffer_callback, NULL, NULL);
 
     if(R_SUCCEEDED(res)) {
         *downloadedSize = data.pos;
@@ -409,6 +1339,39 @@ Result http_download_buffer(const char* url, u32* downloadedSize, void* buf, siz
     return res;
 }
 
+Result http_download_head(const char* url, u32* downloadedSize, u64* total, void* buf, size_t size) {
+    if(url == NULL || downloadedSize == NULL || total == NULL || buf == NULL || size == 0) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    Result res = 0;
+
+    char range[64];
+    snprintf(range, sizeof(range), "bytes=0-%u", (u32) size - 1);
+
+    // Servers without range support send the whole entity; only the head of it is read before closing.
+    httpc_context context = NULL;
+    if(R_SUCCEEDED(res = httpc_open(&context, url, true, range, NULL))) {
+        u32 dlSize = 0;
+        if(context->partial) {
+            res = httpc_get_range_total(context, total);
+        } else if(R_SUCCEEDED(res = httpc_get_size(context, &dlSize))) {
+            *total = dlSize;
+        }
+
+        if(R_SUCCEEDED(res)) {
+            res = httpc_read(context, downloadedSize, buf, size);
+        }
+
+        Result closeRes = httpc_close(context);
+        if(R_SUCCEEDED(res)) {
+            res = closeRes;
+        }
+    }
+
+    return res;
+}
+
 Result http_download_json(const char* url, json_t** json, size_t maxSize) {
     if(url == NULL || json == NULL) {
         return R_APP_INVALID_ARGUMENT;
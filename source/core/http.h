@@ -1,8 +1,32 @@
 #pragma once
 
-Result http_download_callback(const char* url, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
-                                                                               Result (*checkRunning)(void* userData),
-                                                                               Result (*progress)(void* userData, u64 total, u64 curr));
+#define HTTP_VALIDATOR_MAX 128
+
+typedef struct http_resume_info_s {
+    // In: first byte to request. Out: first byte actually delivered; 0 if the server sent the whole entity.
+    u64 offset;
+    // In: ETag or Last-Modified of the partial transfer. Out: validator of the response.
+    char validator[HTTP_VALIDATOR_MAX];
+} http_resume_info;
+
+typedef struct http_prefetch_s* http_prefetch;
+
+void http_init();
+void http_exit();
+
+// Counts curl transfers that reused a pooled handle for the same scheme, host and port, and those that did not.
+void http_get_pool_stats(u32* hits, u32* misses);
+
+// Opens url and buffers up to headSize bytes of its body in the background, to be handed to a later
+// http_download_callback for the same url and connection count.
+Result http_prefetch_open(http_prefetch* prefetch, const char* url, u32 connections, u32 headSize);
+void http_prefetch_close(http_prefetch prefetch);
+
+Result http_download_callback(const char* url, u32 bufferSize, u32 connections, http_resume_info* resume, http_prefetch* prefetch, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                                        Result (*checkRunning)(void* userData),
+                                                                                                                        Result (*progress)(void* userData, u64 total, u64 curr));
 Result http_download_buffer(const char* url, u32* downloadedSize, void* buf, size_t size);
+// Fetches only the first size bytes of url with a Range request; total receives the size of the whole entity.
+Result http_download_head(const char* url, u32* downloadedSize, u64* total, void* buf, size_t size);
 Result http_download_json(const char* url, json_t** json, size_t maxSize);
 Result http_download_seed(u64 titleId);
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <3ds.h>
+
+#include "error.h"
+#include "iconatlas.h"
+#include "screen.h"
+
+#define ICON_ATLAS_ENTRIES_MIN 64
+#define ICON_ATLAS_PAGES_MAX 4
+#define ICON_ATLAS_PIXELS_MAX (48 * 48 * 2)
+
+typedef struct {
+    // Icon handle using this slot, or ICON_ATLAS_NONE.
+    u32 icon;
+    u32 lastUsed;
+} icon_atlas_slot;
+
+typedef struct {
+    u32 width;
+    u32 height;
+    GPU_TEXCOLOR format;
+    bool tiled;
+    u32 pixelSize;
+
+    u32 pageWidth;
+    u32 pageHeight;
+    u32 maxPages;
+
+    u32 pages[ICON_ATLAS_PAGES_MAX];
+    u32 pageCount;
+    icon_atlas_slot* slots;
+} icon_atlas_pool;
+
+typedef struct {
+    bool used;
+    // Set when the loader fails, so a missing icon is not reloaded every frame.
+    bool failed;
+    u32 pool;
+    s32 slot;
+    icon_atlas_loader load;
+    void* data;
+
+    u32 nextFree;
+} icon_atlas_entry;
+
+// Pages are allocated as needed, so linear memory use is capped at 4 * 512 KiB + 2 * 128 KiB.
+static icon_atlas_pool pools[] = {
+    {48, 48, GPU_RGB565, true, 2, 512, 512, 4},
+    {32, 32, GPU_RGBA5551, false, 2, 256, 256, 2}
+};
+
+#define ICON_ATLAS_POOLS (sizeof(pools) / sizeof(pools[0]))
+
+static bool atlas_initialized;
+static LightLock atlas_lock;
+
+static icon_atlas_entry* entries;
+static u32 entry_capacity;
+// Handle of the first unused entry, or ICON_ATLAS_NONE.
+static u32 free_entry;
+
+static u32 use_clock;
+static u8 pixel_buffer[ICON_ATLAS_PIXELS_MAX];
+
+static u32 icon_atlas_slots_per_page(icon_atlas_pool* pool) {
+    return (pool->pageWidth / pool->width) * (pool->pageHeight / pool->height);
+}
+
+static void icon_atlas_get_slot_pos(u32* page, u32* x, u32* y, icon_atlas_pool* pool, u32 slot) {
+    u32 perPage = icon_atlas_slots_per_page(pool);
+    u32 columns = pool->pageWidth / pool->width;
+    u32 index = slot % perPage;
+
+    *page = pool->pages[slot / perPage];
+    *x = (index % columns) * pool->width;
+    *y = (index / columns) * pool->height;
+}
+
+static s32 icon_atlas_acquire_slot(icon_atlas_pool* pool, u32 icon, bool evict) {
+    u32 perPage = icon_atlas_slots_per_page(pool);
+    u32 total = pool->pageCount * perPage;
+
+    s32 slot = -1;
+    for(u32 i = 0; i < total; i++) {
+        if(pool->slots[i].icon == ICON_ATLAS_NONE) {
+            slot = (s32) i;
+            break;
+        }
+    }
+
+    if(slot == -1 && pool->pageCount < pool->maxPages) {
+        u32 page = screen_allocate_free_texture();
+        screen_create_texture(page, pool->pageWidth, pool->pageHeight, pool->format, false);
+
+        pool->pages[pool->pageCount++] = page;
+        slot = (s32) total;
+    }
+
+    if(slot == -1) {
+        if(!evict || total == 0) {
+            return -1;
+        }
+
+        slot = 0;
+        for(u32 i = 1; i < total; i++) {
+            if(pool->slots[i].lastUsed < pool->slots[slot].lastUsed) {
+                slot = (s32) i;
+            }
+        }
+
+        entries[pool->slots[slot].icon - 1].slot = -1;
+    }
+
+    pool->slots[slot].icon = icon;
+    pool->slots[slot].lastUsed = ++use_clock;
+    return slot;
+}
+
+static void icon_atlas_upload(icon_atlas_pool* pool, u32 slot, const void* pixels) {
+    u32 page = 0;
+    u32 x = 0;
+    u32 y = 0;
+    icon_atlas_get_slot_pos(&page, &x, &y, pool, slot);
+
+    screen_load_texture_region(page, (void*) pixels, pool->width * pool->height * pool->pixelSize, x, y, pool->width, pool->height, pool->tiled);
+}
+
+static icon_atlas_entry* icon_atlas_get_entry(u32 icon) {
+    if(icon == ICON_ATLAS_NONE || icon > entry_capacity || !entries[icon - 1].used) {
+        return NULL;
+    }
+
+    return &entries[icon - 1];
+}
+
+void icon_atlas_init() {
+    LightLock_Init(&atlas_lock);
+
+    for(u32 i = 0; i < ICON_ATLAS_POOLS; i++) {
+        icon_atlas_pool* pool = &pools[i];
+
+        pool->pageCount = 0;
+        pool->slots = (icon_atlas_slot*) calloc(pool->maxPages * icon_atlas_slots_per_page(pool), sizeof(icon_atlas_slot));
+        if(pool->slots == NULL) {
+            error_panic("Failed to allocate icon atlas slots.");
+            return;
+        }
+    }
+
+    atlas_initialized = true;
+}
+
+void icon_atlas_exit() {
+    if(!atlas_initialized) {
+        return;
+    }
+
+    LightLock_Lock(&atlas_lock);
+
+    for(u32 i = 0; i < ICON_ATLAS_POOLS; i++) {
+        icon_atlas_pool* pool = &pools[i];
+
+        for(u32 page = 0; page < pool->pageCount; page++) {
+            screen_unload_texture(pool->pages[page]);
+        }
+
+        pool->pageCount = 0;
+
+        free(pool->slots);
+        pool->slots = NULL;
+    }
+
+    if(entries != NULL) {
+        free(entries);
+        entries = NULL;
+    }
+
+    entry_capacity = 0;
+    free_entry = ICON_ATLAS_NONE;
+    atlas_initialized = false;
+
+    LightLock_Unlock(&atlas_lock);
+}
+
+u32 icon_atlas_add(u32 width, u32 height, GPU_TEXCOLOR format, bool tiled, const void* pixels, icon_atlas_loader load, void* data) {
+    u32 poolIndex = 0;
+    while(poolIndex < ICON_ATLAS_POOLS && (pools[poolIndex].width != width || pools[poolIndex].height != height || pools[poolIndex].format != format || pools[poolIndex].tiled != tiled)) {
+        poolIndex++;
+    }
+
+    if(!atlas_initialized || poolIndex >= ICON_ATLAS_POOLS) {
+        return ICON_ATLAS_NONE;
+    }
+
+    LightLock_Lock(&atlas_lock);
+
+    if(free_entry == ICON_ATLAS_NONE) {
+        u32 capacity = entry_capacity < ICON_ATLAS_ENTRIES_MIN ? ICON_ATLAS_ENTRIES_MIN : entry_capacity * 2;
+
+        icon_atlas_entry* newEntries = (icon_atlas_entry*) realloc(entries, capacity * sizeof(icon_atlas_entry));
+        if(newEntries == NULL) {
+            LightLock_Unlock(&atlas_lock);
+            return ICON_ATLAS_NONE;
+        }
+
+        memset(&newEntries[entry_capacity], 0, (capacity - entry_capacity) * sizeof(icon_atlas_entry));
+        for(u32 i = entry_capacity; i < capacity - 1; i++) {
+            newEntries[i].nextFree = i + 2;
+        }
+
+        entries = newEntries;
+        free_entry = entry_capacity + 1;
+        entry_capacity = capacity;
+    }
+
+    u32 icon = free_entry;
+    icon_atlas_entry* entry = &entries[icon - 1];
+    free_entry = entry->nextFree;
+
+    entry->used = true;
+    entry->failed = false;
+    entry->pool = poolIndex;
+    entry->slot = -1;
+    entry->load = load;
+    entry->data = data;
+    entry->nextFree = ICON_ATLAS_NONE;
+
+    if(pixels != NULL) {
+        icon_atlas_pool* pool = &pools[poolIndex];
+
+        s32 slot = icon_atlas_acquire_slot(pool, icon, false);
+        if(slot != -1) {
+            icon_atlas_upload(pool, (u32) slot, pixels);
+            entry->slot = slot;
+        }
+    }
+
+    LightLock_Unlock(&atlas_lock);
+
+    return icon;
+}
+
+void icon_atlas_remove(u32 icon) {
+    if(!atlas_initialized) {
+        return;
+    }
+
+    LightLock_Lock(&atlas_lock);
+
+    icon_atlas_entry* entry = icon_atlas_get_entry(icon);
+    if(entry != NULL) {
+        if(entry->slot != -1) {
+            pools[entry->pool].slots[entry->slot].icon = ICON_ATLAS_NONE;
+        }
+
+        memset(entry, 0, sizeof(*entry));
+        entry->nextFree = free_entry;
+        free_entry = icon;
+    }
+
+    LightLock_Unlock(&atlas_lock);
+}
+
+void icon_atlas_get_size(u32* width, u32* height, u32 icon) {
+    u32 w = 0;
+    u32 h = 0;
+
+    if(atlas_initialized) {
+        LightLock_Lock(&atlas_lock);
+
+        icon_atlas_entry* entry = icon_atlas_get_entry(icon);
+        if(entry != NULL) {
+            w = pools[entry->pool].width;
+            h = pools[entry->pool].height;
+        }
+
+        LightLock_Unlock(&atlas_lock);
+    }
+
+    if(width != NULL) {
+        *width = w;
+    }
+
+    if(height != NULL) {
+        *height = h;
+    }
+}
+
+void icon_atlas_draw(u32 icon, float x, float y, float width, float height) {
+    if(!atlas_initialized) {
+        return;
+    }
+
+    LightLock_Lock(&atlas_lock);
+
+    icon_atlas_entry* entry = icon_atlas_get_entry(icon);
+    if(entry != NULL) {
+        icon_atlas_pool* pool = &pools[entry->pool];
+
+        if(entry->slot == -1 && !entry->failed && entry->load != NULL) {
+            u32 size = pool->width * pool->height * pool->pixelSize;
+
+            s32 slot = icon_atlas_acquire_slot(pool, icon, true);
+            if(slot != -1) {
+                memset(pixel_buffer, 0, size);
+
+                if(entry->load(entry->data, pixel_buffer, size)) {
+                    icon_atlas_upload(pool, (u32) slot, pixel_buffer);
+                    entry->slot = slot;
+                } else {
+                    pool->slots[slot].icon = ICON_ATLAS_NONE;
+                    pool->slots[slot].lastUsed = 0;
+                    entry->failed = true;
+                }
+            }
+        }
+
+        if(entry->slot != -1) {
+            pool->slots[entry->slot].lastUsed = ++use_clock;
+
+            u32 page = 0;
+            u32 srcX = 0;
+            u32 srcY = 0;
+            icon_atlas_get_slot_pos(&page, &srcX, &srcY, pool, (u32) entry->slot);
+
+            screen_draw_texture_region(page, x, y, width, height, srcX, srcY, pool->width, pool->height);
+        }
+    }
+
+    LightLock_Unlock(&atlas_lock);
+}
\ No newline at end of file
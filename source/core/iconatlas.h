@@ -0,0 +1,16 @@
+#pragma once
+
+#define ICON_ATLAS_NONE 0
+
+// Called with the atlas locked; must not call back into the atlas.
+typedef bool (*icon_atlas_loader)(void* data, void* pixels, u32 size);
+
+void icon_atlas_init();
+void icon_atlas_exit();
+
+// Icons are 48x48 tiled RGB565, as in SMDHs, or 32x32 untiled RGBA5551. Returns ICON_ATLAS_NONE for other shapes.
+// pixels are stored immediately when a slot is free; otherwise, and after eviction, load is called when the icon is next drawn.
+u32 icon_atlas_add(u32 width, u32 height, GPU_TEXCOLOR format, bool tiled, const void* pixels, icon_atlas_loader load, void* data);
+void icon_atlas_remove(u32 icon);
+void icon_atlas_get_size(u32* width, u32* height, u32 icon);
+void icon_atlas_draw(u32 icon, float x, float y, float width, float height);
\ No newline at end of file
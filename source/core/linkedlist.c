@@ -1,12 +1,14 @@
 #include <malloc.h>
 #include <stdlib.h>
 
+#include "arraylist.h"
 #include "linkedlist.h"
 
 void linked_list_init(linked_list* list) {
     list->first = NULL;
     list->last = NULL;
     list->size = 0;
+    list->modCount = 0;
 }
 
 void linked_list_destroy(linked_list* list) {
@@ -28,6 +30,7 @@ void linked_list_clear(linked_list* list) {
     list->first = NULL;
     list->last = NULL;
     list->size = 0;
+    list->modCount++;
 }
 
 bool linked_list_contains(linked_list* list, void* value) {
@@ -102,6 +105,7 @@ bool linked_list_add(linked_list* list, void* value) {
     }
 
     list->size++;
+    list->modCount++;
     return true;
 }
 
@@ -138,6 +142,7 @@ bool linked_list_add_at(linked_list* list, unsigned int index, void* value) {
     }
 
     list->size++;
+    list->modCount++;
     return true;
 }
 
@@ -159,6 +164,47 @@ void linked_list_add_sorted(linked_list* list, void* value, void* userData, int
     linked_list_add(list, value);
 }
 
+bool linked_list_merge_sorted(linked_list* list, unsigned int start, void** values, unsigned int count, void* userData, int (*compare)(void* userData, const void* p1, const void* p2)) {
+    // values must already be sorted; the list from start onwards is walked once.
+    linked_list_node* next = linked_list_get_node(list, start);
+
+    for(unsigned int i = 0; i < count; i++) {
+        while(next != NULL && compare(userData, values[i], next->value) >= 0) {
+            next = next->next;
+        }
+
+        if(next == NULL) {
+            if(!linked_list_add(list, values[i])) {
+                return false;
+            }
+
+            continue;
+        }
+
+        linked_list_node* node = (linked_list_node*) calloc(1, sizeof(linked_list_node));
+        if(node == NULL) {
+            return false;
+        }
+
+        node->value = values[i];
+        node->prev = next->prev;
+        node->next = next;
+
+        if(next->prev != NULL) {
+            next->prev->next = node;
+        } else {
+            list->first = node;
+        }
+
+        next->prev = node;
+
+        list->size++;
+        list->modCount++;
+    }
+
+    return true;
+}
+
 static void linked_list_remove_node(linked_list* list, linked_list_node* node) {
     if(node->prev != NULL) {
         node->prev->next = node->next;
@@ -177,6 +223,7 @@ static void linked_list_remove_node(linked_list* list, linked_list_node* node) {
     }
 
     list->size--;
+    list->modCount++;
 
     free(node);
 }
@@ -211,6 +258,24 @@ bool linked_list_remove_at(linked_list* list, unsigned int index) {
 }
 
 void linked_list_sort(linked_list* list, void* userData, int (*compare)(void* userData, const void* p1, const void* p2)) {
+    // Merge sort a copy of the values and write them back, so nodes stay where they are. Falls back to bubble sort without memory.
+    array_list values;
+    array_list_init(&values);
+
+    if(list->size > 1 && array_list_add_all(&values, list) && array_list_size(&values) == list->size && array_list_sort(&values, userData, compare)) {
+        unsigned int i = 0;
+        for(linked_list_node* node = list->first; node != NULL; node = node->next) {
+            node->value = array_list_get(&values, i++);
+        }
+
+        list->modCount++;
+
+        array_list_destroy(&values);
+        return;
+    }
+
+    array_list_destroy(&values);
+
     bool swapped = true;
     while(swapped) {
         swapped = false;
@@ -228,6 +293,7 @@ void linked_list_sort(linked_list* list, void* userData, int (*compare)(void* us
                 next->value = temp;
 
                 swapped = true;
+                list->modCount++;
             }
 
             curr = next;
@@ -12,6 +12,9 @@ typedef struct linked_list_s {
     linked_list_node* first;
     linked_list_node* last;
     unsigned int size;
+
+    // Bumped whenever nodes are added, removed or reordered, so index caches can tell when to rebuild.
+    unsigned int modCount;
 } linked_list;
 
 typedef struct linked_list_iter_s {
@@ -31,6 +34,7 @@ void* linked_list_get(linked_list* list, unsigned int index);
 bool linked_list_add(linked_list* list, void* value);
 bool linked_list_add_at(linked_list* list, unsigned int index, void* value);
 void linked_list_add_sorted(linked_list* list, void* value, void* userData, int (*compare)(void* userData, const void* p1, const void* p2));
+bool linked_list_merge_sorted(linked_list* list, unsigned int start, void** values, unsigned int count, void* userData, int (*compare)(void* userData, const void* p1, const void* p2));
 bool linked_list_remove(linked_list* list, void* value);
 bool linked_list_remove_at(linked_list* list, unsigned int index);
 void linked_list_sort(linked_list* list, void* userData, int (*compare)(void* userData, const void* p1, const void* p2));
@@ -8,10 +8,19 @@
 
 #include "error.h"
 #include "screen.h"
+#include "spritebatch.h"
+#include "textlayout.h"
+#include "textureids.h"
 #include "../libs/stb_image/stb_image.h"
 
 #include "default_shbin.h"
 
+// Quads per frame across both screens; further quads are dropped until the next frame.
+#define SCREEN_MAX_QUADS 4096
+
+#define SCREEN_BLEND_RGB 0x1
+#define SCREEN_BLEND_ALPHA 0x2
+
 static bool c3d_initialized;
 
 static bool shader_initialized;
@@ -23,21 +32,36 @@ static C3D_RenderTarget* target_bottom;
 static C3D_Mtx projection_top;
 static C3D_Mtx projection_bottom;
 
+static float* batch_vertices;
+static u16* batch_indices;
+static sprite_batch batch;
+static bool batch_initialized;
+
+static u32 blend_color;
+static u32 blend_flags;
+
+static float screen_width;
+static float screen_height;
+
 static C3D_Tex* glyph_sheets;
 static u32 glyph_count;
 static float font_scale;
+static float glyph_cell_height;
 
 static u8 base_alpha = 0xFF;
 
 static u32 color_config[MAX_COLORS] = {0xFF000000};
 
 static struct {
-    bool allocated;
     C3D_Tex tex;
     u32 width;
     u32 height;
 } textures[MAX_TEXTURES];
 
+static const char* texture_format_names[SCREEN_TEXTURE_FORMATS] = {
+    "RGBA8", "RGB8", "RGBA5551", "RGB565", "RGBA4", "LA8", "HILO8", "L8", "A8", "LA4", "L4", "A4", "ETC1", "ETC1A4"
+};
+
 static void screen_set_blend(u32 color, bool rgb, bool alpha) {
     C3D_TexEnv* env = C3D_GetTexEnv(0);
     if(env == NULL) {
@@ -64,9 +88,29 @@ static void screen_set_blend(u32 color, bool rgb, bool alpha) {
     }
 
     C3D_TexEnvColor(env, color);
+
+    blend_color = color;
+    blend_flags = (rgb ? SCREEN_BLEND_RGB : 0) | (alpha ? SCREEN_BLEND_ALPHA : 0);
+}
+
+static void screen_draw_batch(void* data, const sprite_batch_draw* draw) {
+    C3D_Tex* tex = (C3D_Tex*) draw->texture;
+    if(tex == NULL || tex->data == NULL) {
+        return;
+    }
+
+    if(draw->color != blend_color || draw->flags != blend_flags) {
+        screen_set_blend(draw->color, (draw->flags & SCREEN_BLEND_RGB) != 0, (draw->flags & SCREEN_BLEND_ALPHA) != 0);
+    }
+
+    C3D_TexBind(0, tex);
+
+    C3D_DrawElements(GPU_TRIANGLES, (int) draw->indexCount, C3D_UNSIGNED_SHORT, &batch_indices[draw->firstIndex]);
 }
 
 void screen_init() {
+    texture_ids_init();
+
     if(!C3D_Init(C3D_DEFAULT_CMDBUF_SIZE * 4)) {
         error_panic("Failed to initialize the GPU.");
         return;
@@ -127,6 +171,29 @@ void screen_init() {
     AttrInfo_AddLoader(attrInfo, 0, GPU_FLOAT, 3);
     AttrInfo_AddLoader(attrInfo, 1, GPU_FLOAT, 2);
 
+    batch_vertices = (float*) linearAlloc(SCREEN_MAX_QUADS * SPRITE_BATCH_QUAD_VERTICES * SPRITE_BATCH_VERTEX_FLOATS * sizeof(float));
+    batch_indices = (u16*) linearAlloc(SCREEN_MAX_QUADS * SPRITE_BATCH_QUAD_INDICES * sizeof(u16));
+    if(batch_vertices == NULL || batch_indices == NULL) {
+        error_panic("Failed to allocate vertex buffers.");
+        return;
+    }
+
+    if(!sprite_batch_init(&batch, batch_vertices, batch_indices, SCREEN_MAX_QUADS, screen_draw_batch, NULL)) {
+        error_panic("Failed to initialize sprite batch.");
+        return;
+    }
+
+    batch_initialized = true;
+
+    C3D_BufInfo* bufInfo = C3D_GetBufInfo();
+    if(bufInfo == NULL) {
+        error_panic("Failed to retrieve buffer info.");
+        return;
+    }
+
+    BufInfo_Init(bufInfo);
+    BufInfo_Add(bufInfo, batch_vertices, SPRITE_BATCH_VERTEX_FLOATS * sizeof(float), 2, 0x10);
+
     C3D_DepthTest(true, GPU_GEQUAL, GPU_WRITE_ALL);
 
     screen_set_blend(0, false, false);
@@ -157,9 +224,14 @@ void screen_init() {
     }
 
     font_scale = 30.0f / glyphInfo->cellHeight; // 30 is cellHeight in J machines
+    glyph_cell_height = glyphInfo->cellHeight;
+
+    text_layout_init(glyph_count, font_scale);
 }
 
 void screen_exit() {
+    text_layout_exit();
+
     for(u32 id = 0; id < MAX_TEXTURES; id++) {
         screen_unload_texture(id);
     }
@@ -169,6 +241,21 @@ void screen_exit() {
         glyph_sheets = NULL;
     }
 
+    if(batch_initialized) {
+        sprite_batch_destroy(&batch);
+        batch_initialized = false;
+    }
+
+    if(batch_vertices != NULL) {
+        linearFree(batch_vertices);
+        batch_vertices = NULL;
+    }
+
+    if(batch_indices != NULL) {
+        linearFree(batch_indices);
+        batch_indices = NULL;
+    }
+
     if(shader_initialized) {
         shaderProgramFree(&program);
         shader_initialized = false;
@@ -220,17 +307,14 @@ static u32 screen_next_pow_2(u32 i) {
     return i;
 }
 
-u32 screen_allocate_free_texture() {
-    u32 id = 0;
-    for(u32 i = 1; i < MAX_TEXTURES; i++) {
-        if(!textures[i].allocated) {
-            textures[i].allocated = true;
-
-            id = i;
-            break;
-        }
+static void screen_track_texture(C3D_Tex* tex, bool created) {
+    if(tex->data != NULL) {
+        texture_ids_track(tex->fmt, tex->size, created);
     }
+}
 
+u32 screen_allocate_free_texture() {
+    u32 id = texture_ids_allocate();
     if(id == 0) {
         error_panic("Out of free textures.");
         return 0;
@@ -256,18 +340,24 @@ static void screen_prepare_texture(u32* pow2WidthOut, u32* pow2HeightOut, u32 id
     }
 
     if(textures[id].tex.data != NULL && (textures[id].tex.width != pow2Width || textures[id].tex.height != pow2Height || textures[id].tex.fmt != format)) {
+        screen_track_texture(&textures[id].tex, false);
+
         C3D_TexDelete(&textures[id].tex);
         textures[id].tex.data = NULL;
     }
 
-    if(textures[id].tex.data == NULL && !C3D_TexInit(&textures[id].tex, (u16) pow2Width, (u16) pow2Height, format)) {
-        error_panic("Failed to initialize texture with ID \"%lu\".", id);
-        return;
+    if(textures[id].tex.data == NULL) {
+        if(!C3D_TexInit(&textures[id].tex, (u16) pow2Width, (u16) pow2Height, format)) {
+            error_panic("Failed to initialize texture with ID \"%lu\".", id);
+            return;
+        }
+
+        screen_track_texture(&textures[id].tex, true);
     }
 
     C3D_TexSetFilter(&textures[id].tex, linearFilter ? GPU_LINEAR : GPU_NEAREST, GPU_NEAREST);
 
-    textures[id].allocated = true;
+    texture_ids_set_allocated(id, true);
     textures[id].width = width;
     textures[id].height = height;
 
@@ -322,6 +412,53 @@ void screen_load_texture_untiled(u32 id, void* data, u32 size, u32 width, u32 he
     C3D_TexFlush(&textures[id].tex);
 }
 
+void screen_create_texture(u32 id, u32 width, u32 height, GPU_TEXCOLOR format, bool linearFilter) {
+    screen_prepare_texture(NULL, NULL, id, width, height, format, linearFilter);
+
+    memset(textures[id].tex.data, 0, textures[id].tex.size);
+    C3D_TexFlush(&textures[id].tex);
+}
+
+void screen_load_texture_region(u32 id, void* data, u32 size, u32 x, u32 y, u32 width, u32 height, bool tiled) {
+    if(id >= MAX_TEXTURES) {
+        error_panic("Attempted to load region of invalid texture ID \"%lu\".", id);
+        return;
+    }
+
+    C3D_Tex* tex = &textures[id].tex;
+    if(tex->data == NULL || width == 0 || height == 0 || x + width > tex->width || y + height > tex->height || ((x | y | width | height) & 7) != 0) {
+        error_panic("Attempted to load invalid region of texture ID \"%lu\".", id);
+        return;
+    }
+
+    u32 pixelSize = size / width / height;
+    u32 tileRowSize = tex->width * 8 * pixelSize;
+
+    if(tiled) {
+        // Rows of 8x8 tiles are contiguous in both the source and the texture.
+        for(u32 row = 0; row < height; row += 8) {
+            u32 dstPos = (y + row) * tex->width * pixelSize + x * 8 * pixelSize;
+            u32 srcPos = row * width * pixelSize;
+
+            memcpy(&((u8*) tex->data)[dstPos], &((u8*) data)[srcPos], width * 8 * pixelSize);
+        }
+    } else {
+        for(u32 srcX = 0; srcX < width; srcX++) {
+            for(u32 srcY = 0; srcY < height; srcY++) {
+                u32 dstX = x + srcX;
+                u32 dstY = y + srcY;
+
+                u32 dstPos = ((((dstY >> 3) * (tex->width >> 3) + (dstX >> 3)) << 6) + ((dstX & 1) | ((dstY & 1) << 1) | ((dstX & 2) << 1) | ((dstY & 2) << 2) | ((dstX & 4) << 2) | ((dstY & 4) << 3))) * pixelSize;
+                u32 srcPos = (srcY * width + srcX) * pixelSize;
+
+                memcpy(&((u8*) tex->data)[dstPos], &((u8*) data)[srcPos], pixelSize);
+            }
+        }
+    }
+
+    GSPGPU_FlushDataCache(&((u8*) tex->data)[(y / 8) * tileRowSize], (height / 8) * tileRowSize);
+}
+
 void screen_load_texture_path(u32 id, const char* path, bool linearFilter) {
     if(id >= MAX_TEXTURES) {
         error_panic("Attempted to load path \"%s\" to invalid texture ID \"%lu\".", path, id);
@@ -382,10 +519,12 @@ void screen_unload_texture(u32 id) {
         return;
     }
 
+    screen_track_texture(&textures[id].tex, false);
+
     C3D_TexDelete(&textures[id].tex);
     textures[id].tex.data = NULL;
 
-    textures[id].allocated = false;
+    texture_ids_set_allocated(id, false);
     textures[id].width = 0;
     textures[id].height = 0;
 }
@@ -405,20 +544,64 @@ void screen_get_texture_size(u32* width, u32* height, u32 id) {
     }
 }
 
+void screen_get_texture_stats(screen_texture_stats* stats) {
+    texture_ids_get_stats(stats);
+}
+
+void screen_dump_texture_stats(FILE* fd) {
+    if(fd == NULL) {
+        return;
+    }
+
+    screen_texture_stats texture_stats;
+    texture_ids_get_stats(&texture_stats);
+
+    fprintf(fd, "Textures: %lu (peak %lu)\n", texture_stats.liveTextures, texture_stats.peakTextures);
+    fprintf(fd, "Bytes: %lu (peak %lu)\n\n", texture_stats.liveBytes, texture_stats.peakBytes);
+
+    fprintf(fd, "Format    Textures  Bytes\n");
+    for(u32 format = 0; format < SCREEN_TEXTURE_FORMATS; format++) {
+        if(texture_stats.formatTextures[format] > 0) {
+            fprintf(fd, "%-9s %-9lu %lu\n", texture_format_names[format], texture_stats.formatTextures[format], texture_stats.formatBytes[format]);
+        }
+    }
+
+    fprintf(fd, "\nID    Size       Texture    Format    Bytes\n");
+    for(u32 id = 0; id < MAX_TEXTURES; id++) {
+        C3D_Tex* tex = &textures[id].tex;
+        if(tex->data != NULL) {
+            char size[16];
+            snprintf(size, sizeof(size), "%lux%lu", textures[id].width, textures[id].height);
+
+            char texSize[16];
+            snprintf(texSize, sizeof(texSize), "%ux%u", tex->width, tex->height);
+
+            fprintf(fd, "%-5lu %-10s %-10s %-9s %lu\n", id, size, texSize, tex->fmt < SCREEN_TEXTURE_FORMATS ? texture_format_names[tex->fmt] : "?", tex->size);
+        }
+    }
+}
+
 void screen_begin_frame() {
     if(!C3D_FrameBegin(C3D_FRAME_SYNCDRAW)) {
         error_panic("Failed to begin frame.");
         return;
     }
+
+    // The previous frame has finished drawing, so its vertices can be overwritten.
+    sprite_batch_reset(&batch);
 }
 
 void screen_end_frame() {
+    sprite_batch_flush(&batch);
+
     C3D_FrameEnd(0);
 }
 
 void screen_select(gfxScreen_t screen) {
     C3D_RenderTarget* target = screen == GFX_TOP ? target_top : target_bottom;
 
+    sprite_batch_flush(&batch);
+
     C3D_RenderTargetClear(target, C3D_CLEAR_ALL, 0, 0);
     if(!C3D_FrameDrawOn(target)) {
         error_panic("Failed to select render target.");
@@ -426,24 +609,18 @@ void screen_select(gfxScreen_t screen) {
     }
 
     C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, shaderInstanceGetUniformLocation(program.vertexShader, "projection"), screen == GFX_TOP ? &projection_top : &projection_bottom);
-}
-
-static void screen_draw_quad(float x1, float y1, float x2, float y2, float left, float bottom, float right, float top) {
-    C3D_ImmDrawBegin(GPU_TRIANGLE_STRIP);
-
-    C3D_ImmSendAttrib(x1, y2, 0.5f, 0.0f);
-    C3D_ImmSendAttrib(left, bottom, 0.0f, 0.0f);
-
-    C3D_ImmSendAttrib(x2, y2, 0.5f, 0.0f);
-    C3D_ImmSendAttrib(right, bottom, 0.0f, 0.0f);
 
-    C3D_ImmSendAttrib(x1, y1, 0.5f, 0.0f);
-    C3D_ImmSendAttrib(left, top, 0.0f, 0.0f);
+    screen_width = screen == GFX_TOP ? TOP_SCREEN_WIDTH : BOTTOM_SCREEN_WIDTH;
+    screen_height = screen == GFX_TOP ? TOP_SCREEN_HEIGHT : BOTTOM_SCREEN_HEIGHT;
+}
 
-    C3D_ImmSendAttrib(x2, y1, 0.5f, 0.0f);
-    C3D_ImmSendAttrib(right, top, 0.0f, 0.0f);
+static void screen_draw_quad(C3D_Tex* tex, u32 color, u32 flags, float x1, float y1, float x2, float y2, float left, float bottom, float right, float top) {
+    // Quads entirely off screen, such as the tails of long strings, are never queued.
+    if((x1 < x2 ? x2 : x1) <= 0 || (x1 < x2 ? x1 : x2) >= screen_width || (y1 < y2 ? y2 : y1) <= 0 || (y1 < y2 ? y1 : y2) >= screen_height) {
+        return;
+    }
 
-    C3D_ImmDrawEnd();
+    sprite_batch_add(&batch, tex, color, flags, x1, y1, x2, y2, left, bottom, right, top);
 }
 
 void screen_draw_texture(u32 id, float x, float y, float width, float height) {
@@ -456,16 +633,8 @@ void screen_draw_texture(u32 id, float x, float y, float width, float height) {
         return;
     }
 
-    if(base_alpha != 0xFF) {
-        screen_set_blend(base_alpha << 24, false, true);
-    }
-
-    C3D_TexBind(0, &textures[id].tex);
-    screen_draw_quad(x, y, x + width, y + height, 0, (float) (textures[id].tex.height - textures[id].height) / (float) textures[id].tex.height, (float) textures[id].width / (float) textures[id].tex.width, 1.0f);
-
-    if(base_alpha != 0xFF) {
-        screen_set_blend(0, false, false);
-    }
+    bool blendAlpha = base_alpha != 0xFF;
+    screen_draw_quad(&textures[id].tex, blendAlpha ? (u32) base_alpha << 24 : 0, blendAlpha ? SCREEN_BLEND_ALPHA : 0, x, y, x + width, y + height, 0, (float) (textures[id].tex.height - textures[id].height) / (float) textures[id].tex.height, (float) textures[id].width / (float) textures[id].tex.width, 1.0f);
 }
 
 void screen_draw_texture_crop(u32 id, float x, float y, float width, float height) {
@@ -478,159 +647,49 @@ void screen_draw_texture_crop(u32 id, float x, float y, float width, float heigh
         return;
     }
 
-    if(base_alpha != 0xFF) {
-        screen_set_blend(base_alpha << 24, false, true);
-    }
-
-    C3D_TexBind(0, &textures[id].tex);
-    screen_draw_quad(x, y, x + width, y + height, 0, (float) (textures[id].tex.height - textures[id].height) / (float) textures[id].tex.height, width / (float) textures[id].tex.width, (textures[id].tex.height - textures[id].height + height) / (float) textures[id].tex.height);
-
-    if(base_alpha != 0xFF) {
-        screen_set_blend(0, false, false);
-    }
+    bool blendAlpha = base_alpha != 0xFF;
+    screen_draw_quad(&textures[id].tex, blendAlpha ? (u32) base_alpha << 24 : 0, blendAlpha ? SCREEN_BLEND_ALPHA : 0, x, y, x + width, y + height, 0, (float) (textures[id].tex.height - textures[id].height) / (float) textures[id].tex.height, width / (float) textures[id].tex.width, (textures[id].tex.height - textures[id].height + height) / (float) textures[id].tex.height);
 }
 
-float screen_get_font_height(float scaleY) {
-    return scaleY * fontGetInfo()->lineFeed;
-}
-
-#define MAX_LINES 64
-
-inline static void screen_wrap_string_finish_line(float* w, float* h, float* lw, float* lh, u32* line, u32* linePos, u32* lastAlignPos,
-                                                  u32* lines, float* lineWidths, float* lineHeights,
-                                                  u32 maxLines) {
-    if(*lw > *w) {
-        *w = *lw;
+void screen_draw_texture_region(u32 id, float x, float y, float width, float height, u32 srcX, u32 srcY, u32 srcWidth, u32 srcHeight) {
+    if(id >= MAX_TEXTURES) {
+        error_panic("Attempted to draw invalid texture ID \"%lu\".", id);
+        return;
     }
 
-    *h += *lh;
-
-    if(*line < maxLines)  {
-        if(lines != NULL) {
-            lines[*line] = *linePos;
-        }
-
-        if(lineWidths != NULL) {
-            lineWidths[*line] = *lw;
-        }
-
-        if(lineHeights != NULL) {
-            lineHeights[*line] = *lh;
-        }
-
-        (*line)++;
+    if(textures[id].tex.data == NULL) {
+        return;
     }
 
-    *lw = 0;
-    *lh = 0;
-    *linePos = 0;
-    *lastAlignPos = 0;
-}
-
-static void screen_wrap_string(u32* lines, float* lineWidths, float* lineHeights, u32* numLines, float* totalWidth, float* totalHeight,
-                               const char* text, u32 maxLines, float maxWidth, float scaleX, float scaleY, bool wordWrap) {
-    scaleX *= font_scale;
-    scaleY *= font_scale;
-
-    float w = 0;
-    float h = 0;
-
-    u32 line = 0;
-    float lw = 0;
-    float lh = 0;
-    u32 linePos = 0;
-    u32 lastAlignPos = 0;
-    int wordPos = -1;
-    float ww = 0;
-
-    const uint8_t* p = (const uint8_t*) text;
-    u32 code = 0;
-    ssize_t units = -1;
-
-    while(*p && (units = decode_utf8(&code, p)) != -1 && code > 0) {
-        p += units;
-
-        float charWidth = 1;
-        if(code == '\t') {
-            code = ' ';
-            charWidth = 4 - (linePos - lastAlignPos) % 4;
-
-            lastAlignPos = linePos;
-        }
-
-        charWidth *= scaleX * fontGetCharWidthInfo(fontGlyphIndexFromCodePoint(code))->charWidth;
-
-        if(code == '\n' || (wordWrap && lw + charWidth >= maxWidth)) {
-            if(code == '\n') {
-                linePos++;
-                lh = scaleY * fontGetInfo()->lineFeed;
-            }
-
-            u32 oldLinePos = linePos;
-
-            if(code != '\n' && wordPos != -1) {
-                linePos = (u32) wordPos;
-                lw -= ww;
-            }
-
-            screen_wrap_string_finish_line(&w, &h, &lw, &lh, &line, &linePos, &lastAlignPos,
-                                           lines, lineWidths, lineHeights,
-                                           maxLines);
+    float texWidth = textures[id].tex.width;
+    float texHeight = textures[id].tex.height;
 
-            if(code != '\n' && wordPos != -1) {
-                linePos = oldLinePos - wordPos;
-                lw = ww;
-            }
-
-            wordPos = -1;
-            ww = 0;
-        }
-
-        if(code == ' ') {
-            wordPos = -1;
-            ww = 0;
-        } else if(wordPos == -1) {
-            wordPos = (int) linePos;
-            ww = 0;
-        }
-
-        if(code != '\n') {
-            if(wordPos != -1) {
-                ww += charWidth;
-            }
-
-            lw += charWidth;
-            lh = scaleY * fontGetInfo()->lineFeed;
-
-            linePos++;
-        }
-    }
+    bool blendAlpha = base_alpha != 0xFF;
+    screen_draw_quad(&textures[id].tex, blendAlpha ? (u32) base_alpha << 24 : 0, blendAlpha ? SCREEN_BLEND_ALPHA : 0, x, y, x + width, y + height, srcX / texWidth, 1.0f - (srcY + srcHeight) / texHeight, (srcX + srcWidth) / texWidth, 1.0f - srcY / texHeight);
+}
 
-    if(linePos > 0)  {
-        screen_wrap_string_finish_line(&w, &h, &lw, &lh, &line, &linePos, &lastAlignPos,
-                                       lines, lineWidths, lineHeights,
-                                       maxLines);
-    }
+float screen_get_font_height(float scaleY) {
+    return scaleY * fontGetInfo()->lineFeed;
+}
 
-    if(numLines != NULL) {
-        *numLines = line;
-    }
+static void screen_get_string_size_internal(float* width, float* height, const char* text, float scaleX, float scaleY, bool wrap, float wrapWidth) {
+    const text_layout* layout = text_layout_get(text, scaleX, scaleY, wrap, wrapWidth);
 
-    if(totalWidth != NULL) {
-        *totalWidth = w;
+    if(width != NULL) {
+        *width = layout->totalWidth;
     }
 
-    if(totalHeight != NULL) {
-        *totalHeight = h;
+    if(height != NULL) {
+        *height = layout->totalHeight;
     }
 }
 
 void screen_get_string_size(float* width, float* height, const char* text, float scaleX, float scaleY) {
-    screen_wrap_string(NULL, NULL, NULL, NULL, width, height, text, 0, 0, scaleX, scaleY, false);
+    screen_get_string_size_internal(width, height, text, scaleX, scaleY, false, 0);
 }
 
 void screen_get_string_size_wrap(float* width, float* height, const char* text, float scaleX, float scaleY, float wrapWidth) {
-    screen_wrap_string(NULL, NULL, NULL, NULL, width, height, text, 0, wrapWidth, scaleX, scaleY, true);
+    screen_get_string_size_internal(width, height, text, scaleX, scaleY, true, wrapWidth);
 }
 
 static void screen_draw_string_internal(const char* text, float x, float y, float scaleX, float scaleY, u32 colorId, bool centerLines, bool wrap, float wrapX) {
@@ -652,15 +711,11 @@ static void screen_draw_string_internal(const char* text, float x, float y, floa
         blendColor = (((u32) (blendedAlpha * 0xFF)) << 24) | (blendColor & 0x00FFFFFF);
     }
 
-    screen_set_blend(blendColor, true, true);
+    const text_layout* layout = text_layout_get(text, scaleX, scaleY, wrap, wrapX - x);
 
-    u32 lines[MAX_LINES];
-    float lineWidths[MAX_LINES];
-    float lineHeights[MAX_LINES];
-    u32 numLines = 0;
-    float totalWidth = 0;
-    float totalHeight = 0;
-    screen_wrap_string(lines, lineWidths, lineHeights, &numLines, &totalWidth, &totalHeight, text, MAX_LINES, wrapX - x, scaleX, scaleY, wrap);
+    float glyphScaleX = scaleX * font_scale;
+    float glyphScaleY = scaleY * font_scale;
+    float glyphHeight = glyphScaleY * glyph_cell_height;
 
     float currX = x;
     float currY = y;
@@ -673,13 +728,13 @@ static void screen_draw_string_internal(const char* text, float x, float y, floa
     u32 code = 0;
     ssize_t units = -1;
 
-    for(u32 i = 0; i < numLines; i++) {
+    for(u32 i = 0; i < layout->numLines; i++) {
         currX = x;
         if(centerLines) {
-            currX += (totalWidth - lineWidths[i]) / 2;
+            currX += (layout->totalWidth - layout->lineWidths[i]) / 2;
         }
 
-        while(linePos < lines[i] && *p && (units = decode_utf8(&code, p)) != -1 && code > 0) {
+        while(linePos < layout->lines[i] && *p && (units = decode_utf8(&code, p)) != -1 && code > 0) {
             p += units;
 
             if(code != '\n') {
@@ -691,35 +746,32 @@ static void screen_draw_string_internal(const char* text, float x, float y, floa
                     lastAlignPos = linePos;
                 }
 
-                fontGlyphPos_s data;
-                fontCalcGlyphPos(&data, fontGlyphIndexFromCodePoint(code), GLYPH_POS_CALC_VTXCOORD, scaleX * font_scale, scaleY * font_scale);
+                const text_glyph* glyph = text_layout_get_glyph(code);
 
-                if(data.sheetIndex >= glyph_count) {
-                    fontCalcGlyphPos(&data, fontGlyphIndexFromCodePoint(0xFFFD), GLYPH_POS_CALC_VTXCOORD, scaleX * font_scale, scaleY * font_scale);
+                if(glyph->sheetIndex < glyph_count && (int) glyph->sheetIndex != lastSheet) {
+                    lastSheet = glyph->sheetIndex;
                 }
 
-                if(data.sheetIndex < glyph_count && data.sheetIndex != lastSheet) {
-                    lastSheet = data.sheetIndex;
-                    C3D_TexBind(0, &glyph_sheets[lastSheet]);
-                }
+                float glyphLeft = glyphScaleX * glyph->left;
+                float glyphRight = glyphLeft + glyphScaleX * glyph->glyphWidth;
+                float xAdvance = glyphScaleX * glyph->charWidth;
 
+                C3D_Tex* sheet = lastSheet != -1 ? &glyph_sheets[lastSheet] : NULL;
                 for(u32 j = 0; j < num; j++) {
-                    screen_draw_quad(currX + data.vtxcoord.left, currY + data.vtxcoord.top, currX + data.vtxcoord.right, currY + data.vtxcoord.bottom, data.texcoord.left, data.texcoord.bottom, data.texcoord.right, data.texcoord.top);
+                    screen_draw_quad(sheet, blendColor, SCREEN_BLEND_RGB | SCREEN_BLEND_ALPHA, currX + glyphLeft, currY, currX + glyphRight, currY + glyphHeight, glyph->texLeft, glyph->texBottom, glyph->texRight, glyph->texTop);
 
-                    currX += data.xAdvance;
+                    currX += xAdvance;
                 }
             }
 
             linePos++;
         }
 
-        currY += lineHeights[i];
+        currY += layout->lineHeights[i];
 
         linePos = 0;
         lastAlignPos = 0;
     }
-
-    screen_set_blend(0, false, false);
 }
 
 void screen_draw_string(const char* text, float x, float y, float scaleX, float scaleY, u32 colorId, bool centerLines) {
@@ -13,22 +13,44 @@ typedef struct __sFILE FILE;
 
 #define COLOR_TEXT 0
 
+// Number of GPU_TEXCOLOR formats, GPU_RGBA8 through GPU_ETC1A4.
+#define SCREEN_TEXTURE_FORMATS 14
+
+// Linear memory held by loaded textures.
+typedef struct screen_texture_stats_s {
+    u32 liveTextures;
+    u32 peakTextures;
+    u32 liveBytes;
+    u32 peakBytes;
+
+    u32 formatTextures[SCREEN_TEXTURE_FORMATS];
+    u32 formatBytes[SCREEN_TEXTURE_FORMATS];
+} screen_texture_stats;
+
 void screen_init();
 void screen_exit();
 void screen_set_base_alpha(u8 alpha);
 void screen_set_color(u32 id, u32 color);
 u32 screen_allocate_free_texture();
+// Creates a blank texture whose regions are then filled by screen_load_texture_region.
+void screen_create_texture(u32 id, u32 width, u32 height, GPU_TEXCOLOR format, bool linearFilter);
+// Region bounds must be multiples of 8; tiled data is laid out as in SMDH icons.
+void screen_load_texture_region(u32 id, void* data, u32 size, u32 x, u32 y, u32 width, u32 height, bool tiled);
 void screen_load_texture_untiled(u32 id, void* data, u32 size, u32 width, u32 height, GPU_TEXCOLOR format, bool linearFilter);
 void screen_load_texture_path(u32 id, const char* path, bool linearFilter);
 void screen_load_texture_file(u32 id, FILE* fd, bool linearFilter);
 void screen_load_texture_tiled(u32 id, void* data, u32 size, u32 width, u32 height, GPU_TEXCOLOR format, bool linearFilter);
 void screen_unload_texture(u32 id);
 void screen_get_texture_size(u32* width, u32* height, u32 id);
+void screen_get_texture_stats(screen_texture_stats* stats);
+// Writes the totals followed by one line per loaded texture.
+void screen_dump_texture_stats(FILE* fd);
 void screen_begin_frame();
 void screen_end_frame();
 void screen_select(gfxScreen_t screen);
 void screen_draw_texture(u32 id, float x, float y, float width, float height);
 void screen_draw_texture_crop(u32 id, float x, float y, float width, float height);
+void screen_draw_texture_region(u32 id, float x, float y, float width, float height, u32 srcX, u32 srcY, u32 srcWidth, u32 srcHeight);
 float screen_get_font_height(float scaleY);
 void screen_get_string_size(float* width, float* height, const char* text, float scaleX, float scaleY);
 void screen_get_string_size_wrap(float* width, float* height, const char* text, float scaleX, float scaleY, float wrapWidth);
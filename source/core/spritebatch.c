@@ -0,0 +1,194 @@
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <3ds.h>
+
+#include "spritebatch.h"
+
+// Quad vertices are addressed through 16-bit indices.
+#define SPRITE_BATCH_MAX_QUADS (0x10000 / SPRITE_BATCH_QUAD_VERTICES)
+
+bool sprite_batch_init(sprite_batch* batch, float* vertices, u16* indices, u32 maxQuads, void (*draw)(void* data, const sprite_batch_draw* draw), void* drawData) {
+    memset(batch, 0, sizeof(*batch));
+
+    if(vertices == NULL || indices == NULL || maxQuads == 0 || maxQuads > SPRITE_BATCH_MAX_QUADS) {
+        return false;
+    }
+
+    batch->quadGroups = (u8*) calloc(maxQuads, sizeof(u8));
+    if(batch->quadGroups == NULL) {
+        return false;
+    }
+
+    batch->vertices = vertices;
+    batch->indices = indices;
+    batch->maxQuads = maxQuads;
+
+    batch->draw = draw;
+    batch->drawData = drawData;
+
+    return true;
+}
+
+void sprite_batch_destroy(sprite_batch* batch) {
+    if(batch->quadGroups != NULL) {
+        free(batch->quadGroups);
+    }
+
+    memset(batch, 0, sizeof(*batch));
+}
+
+void sprite_batch_reset(sprite_batch* batch) {
+    batch->quadCount = 0;
+    batch->pendingQuad = 0;
+    batch->groupCount = 0;
+
+    batch->lastTexture = NULL;
+
+    batch->draws = 0;
+    batch->textureSwitches = 0;
+    batch->droppedQuads = 0;
+}
+
+static bool sprite_batch_overlaps(sprite_batch_group* group, float x1, float y1, float x2, float y2) {
+    return group->quadCount > 0 && x1 < group->x2 && x2 > group->x1 && y1 < group->y2 && y2 > group->y1;
+}
+
+static u32 sprite_batch_find_group(sprite_batch* batch, const void* texture, u32 color, u32 flags, float x1, float y1, float x2, float y2) {
+    u32 oldest = batch->groupCount > SPRITE_BATCH_LOOKBACK ? batch->groupCount - SPRITE_BATCH_LOOKBACK : 0;
+
+    for(u32 i = batch->groupCount; i > oldest; i--) {
+        sprite_batch_group* group = &batch->groups[i - 1];
+        if(group->texture == texture && group->color == color && group->flags == flags) {
+            return i - 1;
+        }
+
+        // Anything drawn after an overlapping group has to stay after it.
+        if(sprite_batch_overlaps(group, x1, y1, x2, y2)) {
+            break;
+        }
+    }
+
+    if(batch->groupCount >= SPRITE_BATCH_MAX_GROUPS) {
+        sprite_batch_flush(batch);
+    }
+
+    sprite_batch_group* group = &batch->groups[batch->groupCount];
+    group->texture = texture;
+    group->color = color;
+    group->flags = flags;
+    group->x1 = x1;
+    group->y1 = y1;
+    group->x2 = x2;
+    group->y2 = y2;
+    group->quadCount = 0;
+
+    return batch->groupCount++;
+}
+
+void sprite_batch_add(sprite_batch* batch, const void* texture, u32 color, u32 flags, float x1, float y1, float x2, float y2, float left, float bottom, float right, float top) {
+    if(batch->quadCount >= batch->maxQuads) {
+        batch->droppedQuads++;
+        return;
+    }
+
+    float minX = x1 < x2 ? x1 : x2;
+    float maxX = x1 < x2 ? x2 : x1;
+    float minY = y1 < y2 ? y1 : y2;
+    float maxY = y1 < y2 ? y2 : y1;
+
+    u32 groupIndex = sprite_batch_find_group(batch, texture, color, flags, minX, minY, maxX, maxY);
+    sprite_batch_group* group = &batch->groups[groupIndex];
+
+    if(minX < group->x1) {
+        group->x1 = minX;
+    }
+
+    if(minY < group->y1) {
+        group->y1 = minY;
+    }
+
+    if(maxX > group->x2) {
+        group->x2 = maxX;
+    }
+
+    if(maxY > group->y2) {
+        group->y2 = maxY;
+    }
+
+    group->quadCount++;
+
+    u32 quad = batch->quadCount++;
+    batch->quadGroups[quad] = (u8) groupIndex;
+
+    // Same corner order as a triangle strip: bottom-left, bottom-right, top-left, top-right.
+    float* v = &batch->vertices[quad * SPRITE_BATCH_QUAD_VERTICES * SPRITE_BATCH_VERTEX_FLOATS];
+    float vertices[SPRITE_BATCH_QUAD_VERTICES * SPRITE_BATCH_VERTEX_FLOATS] = {
+        x1, y2, 0.5f, left, bottom,
+        x2, y2, 0.5f, right, bottom,
+        x1, y1, 0.5f, left, top,
+        x2, y1, 0.5f, right, top
+    };
+
+    memcpy(v, vertices, sizeof(vertices));
+}
+
+void sprite_batch_flush(sprite_batch* batch) {
+    if(batch->pendingQuad >= batch->quadCount) {
+        batch->groupCount = 0;
+        return;
+    }
+
+    u32 next[SPRITE_BATCH_MAX_GROUPS];
+
+    u32 start = batch->pendingQuad;
+    for(u32 i = 0; i < batch->groupCount; i++) {
+        next[i] = start;
+        start += batch->groups[i].quadCount;
+    }
+
+    for(u32 quad = batch->pendingQuad; quad < batch->quadCount; quad++) {
+        u16* indices = &batch->indices[next[batch->quadGroups[quad]]++ * SPRITE_BATCH_QUAD_INDICES];
+        u16 base = (u16) (quad * SPRITE_BATCH_QUAD_VERTICES);
+
+        indices[0] = base;
+        indices[1] = (u16) (base + 1);
+        indices[2] = (u16) (base + 2);
+        indices[3] = (u16) (base + 2);
+        indices[4] = (u16) (base + 1);
+        indices[5] = (u16) (base + 3);
+    }
+
+    start = batch->pendingQuad;
+    for(u32 i = 0; i < batch->groupCount; i++) {
+        sprite_batch_group* group = &batch->groups[i];
+        if(group->quadCount == 0) {
+            continue;
+        }
+
+        sprite_batch_draw draw = {
+            .texture = group->texture,
+            .color = group->color,
+            .flags = group->flags,
+            .firstIndex = start * SPRITE_BATCH_QUAD_INDICES,
+            .indexCount = group->quadCount * SPRITE_BATCH_QUAD_INDICES
+        };
+
+        if(group->texture != batch->lastTexture) {
+            batch->lastTexture = group->texture;
+            batch->textureSwitches++;
+        }
+
+        batch->draws++;
+
+        if(batch->draw != NULL) {
+            batch->draw(batch->drawData, &draw);
+        }
+
+        start += group->quadCount;
+    }
+
+    batch->pendingQuad = batch->quadCount;
+    batch->groupCount = 0;
+}
\ No newline at end of file
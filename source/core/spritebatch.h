@@ -0,0 +1,68 @@
+#pragma once
+
+// Position (x, y, z) followed by texture coordinate (u, v).
+#define SPRITE_BATCH_VERTEX_FLOATS 5
+#define SPRITE_BATCH_QUAD_VERTICES 4
+#define SPRITE_BATCH_QUAD_INDICES 6
+
+#define SPRITE_BATCH_MAX_GROUPS 64
+#define SPRITE_BATCH_LOOKBACK 16
+
+typedef struct sprite_batch_draw_s {
+    const void* texture;
+    u32 color;
+    u32 flags;
+
+    u32 firstIndex;
+    u32 indexCount;
+} sprite_batch_draw;
+
+typedef struct sprite_batch_group_s {
+    const void* texture;
+    u32 color;
+    u32 flags;
+
+    // Union of the group's quads, used to tell whether later quads may be drawn before other groups.
+    float x1;
+    float y1;
+    float x2;
+    float y2;
+
+    u32 quadCount;
+} sprite_batch_group;
+
+// Collects textured quads into one vertex buffer and draws them grouped by texture and blend state.
+// A quad joins an earlier group only when it overlaps nothing queued since, so the drawn result matches submission order.
+typedef struct sprite_batch_s {
+    float* vertices;
+    u16* indices;
+    u8* quadGroups;
+    u32 maxQuads;
+
+    // Quads written since the last reset; quads from pendingQuad on have not been drawn yet.
+    u32 quadCount;
+    u32 pendingQuad;
+
+    sprite_batch_group groups[SPRITE_BATCH_MAX_GROUPS];
+    u32 groupCount;
+
+    void (*draw)(void* data, const sprite_batch_draw* draw);
+    void* drawData;
+
+    const void* lastTexture;
+
+    u32 draws;
+    u32 textureSwitches;
+    u32 droppedQuads;
+} sprite_batch;
+
+// vertices and indices are owned by the caller and must hold maxQuads quads; on the GPU, both live in linear memory.
+// draw is passed each group as it is flushed.
+bool sprite_batch_init(sprite_batch* batch, float* vertices, u16* indices, u32 maxQuads, void (*draw)(void* data, const sprite_batch_draw* draw), void* drawData);
+void sprite_batch_destroy(sprite_batch* batch);
+
+// Starts over at the beginning of the buffers; only call once the GPU has finished with every previous draw.
+void sprite_batch_reset(sprite_batch* batch);
+void sprite_batch_add(sprite_batch* batch, const void* texture, u32 color, u32 flags, float x1, float y1, float x2, float y2, float left, float bottom, float right, float top);
+// Writes the pending quads' indices in group order and passes each group to draw.
+void sprite_batch_flush(sprite_batch* batch);
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include <string.h>
+
+#include <3ds.h>
+
+#include "chunktuner.h"
+
+// Transfers per measurement; enough to average out per-call jitter without lingering on a bad size.
+#define TUNER_WINDOW_CALLS 8
+// A larger or smaller size must beat the best by this much to be adopted.
+#define TUNER_GAIN 1.05
+// Settled windows between probes, so that a change of medium or load is noticed.
+// Probes that keep finding the same size back off up to the maximum, as each one costs a few slower windows.
+#define TUNER_REPROBE_WINDOWS 32
+#define TUNER_REPROBE_WINDOWS_MAX 1024
+
+static void task_chunk_tuner_settle(chunk_tuner* tuner) {
+    if(tuner->bestSize == tuner->probeSize) {
+        if(tuner->reprobeWindows < TUNER_REPROBE_WINDOWS_MAX) {
+            tuner->reprobeWindows *= 2;
+        }
+    } else {
+        tuner->reprobeWindows = TUNER_REPROBE_WINDOWS;
+    }
+
+    tuner->size = tuner->bestSize;
+    tuner->settled = true;
+    tuner->settledWindows = 0;
+}
+
+static void task_chunk_tuner_probe(chunk_tuner* tuner) {
+    tuner->settled = false;
+    tuner->triedDown = false;
+    tuner->probeSize = tuner->bestSize;
+
+    if(tuner->bestSize * 2 <= tuner->maxSize) {
+        tuner->direction = 1;
+        tuner->size = tuner->bestSize * 2;
+    } else if(tuner->bestSize / 2 >= tuner->minSize) {
+        tuner->direction = -1;
+        tuner->triedDown = true;
+        tuner->size = tuner->bestSize / 2;
+    } else {
+        task_chunk_tuner_settle(tuner);
+    }
+}
+
+static void task_chunk_tuner_step(chunk_tuner* tuner, double throughput) {
+    if(tuner->bestThroughput == 0) {
+        tuner->bestSize = tuner->size;
+        tuner->bestThroughput = throughput;
+
+        task_chunk_tuner_probe(tuner);
+    } else if(tuner->settled) {
+        // Keep the baseline current; the medium may have sped up or slowed down since it was measured.
+        tuner->bestThroughput = throughput;
+
+        if(++tuner->settledWindows >= tuner->reprobeWindows) {
+            task_chunk_tuner_probe(tuner);
+        }
+    } else if(throughput > tuner->bestThroughput * TUNER_GAIN) {
+        tuner->bestSize = tuner->size;
+        tuner->bestThroughput = throughput;
+
+        u32 next = tuner->direction > 0 ? tuner->size * 2 : tuner->size / 2;
+        if(next >= tuner->minSize && next <= tuner->maxSize) {
+            tuner->size = next;
+        } else {
+            task_chunk_tuner_settle(tuner);
+        }
+    } else if(tuner->direction > 0 && !tuner->triedDown && tuner->bestSize / 2 >= tuner->minSize) {
+        tuner->direction = -1;
+        tuner->triedDown = true;
+        tuner->size = tuner->bestSize / 2;
+    } else {
+        task_chunk_tuner_settle(tuner);
+    }
+}
+
+void task_chunk_tuner_init(chunk_tuner* tuner, u32 size, u32 minSize, u32 maxSize, u64 ticksPerSecond) {
+    memset(tuner, 0, sizeof(*tuner));
+
+    tuner->minSize = minSize;
+    tuner->maxSize = maxSize;
+    tuner->ticksPerSecond = ticksPerSecond;
+
+    tuner->size = size < minSize ? minSize : size > maxSize ? maxSize : size;
+    tuner->bestSize = tuner->size;
+    tuner->reprobeWindows = TUNER_REPROBE_WINDOWS;
+}
+
+void task_chunk_tuner_record(chunk_tuner* tuner, u32 bytes, u64 ticks) {
+    tuner->windowBytes += bytes;
+    tuner->windowTicks += ticks;
+
+    if(++tuner->windowCalls < TUNER_WINDOW_CALLS) {
+        return;
+    }
+
+    if(tuner->windowTicks > 0) {
+        double throughput = (double) tuner->windowBytes / (double) tuner->windowTicks;
+        tuner->bytesPerSecond = (u32) (throughput * tuner->ticksPerSecond);
+
+        task_chunk_tuner_step(tuner, throughput);
+    }
+
+    tuner->windowBytes = 0;
+    tuner->windowTicks = 0;
+    tuner->windowCalls = 0;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+// Hill-climbs a transfer chunk size over powers of two, keeping whichever size measured the best throughput.
+typedef struct chunk_tuner_s {
+    u32 minSize;
+    u32 maxSize;
+    u64 ticksPerSecond;
+
+    // Size to use for the next transfer.
+    volatile u32 size;
+
+    u32 bestSize;
+    double bestThroughput;
+    u32 bytesPerSecond;
+
+    s32 direction;
+    bool triedDown;
+    u32 probeSize;
+    bool settled;
+    u32 settledWindows;
+    u32 reprobeWindows;
+
+    u64 windowBytes;
+    u64 windowTicks;
+    u32 windowCalls;
+} chunk_tuner;
+
+void task_chunk_tuner_init(chunk_tuner* tuner, u32 size, u32 minSize, u32 maxSize, u64 ticksPerSecond);
+// Records one transfer of bytes that took ticks; transfers not made at the current size should not be recorded.
+void task_chunk_tuner_record(chunk_tuner* tuner, u32 bytes, u64 ticks);
\ No newline at end of file
@@ -0,0 +1,281 @@
+#include <malloc.h>
+#include <string.h>
+
+#include <3ds.h>
+#include <mbedtls/sha256.h>
+
+#include "ciaverify.h"
+#include "../data/data.h"
+#include "../error.h"
+
+#define CIA_HEADER_SIZE 0x2020
+#define CIA_VERIFY_BLOCKS 3
+
+typedef struct {
+    u64 offset;
+    u64 size;
+    u8 hash[TMD_CONTENT_HASH_SIZE];
+} cia_verify_content;
+
+typedef struct {
+    u8* buffer;
+    u32 size;
+} cia_verify_block;
+
+struct cia_verifier_s {
+    cia_verify_content* contents;
+    u32 contentCount;
+
+    u32 currContent;
+    u64 offset;
+    mbedtls_sha256_context sha;
+
+    cia_verify_block blocks[CIA_VERIFY_BLOCKS];
+    u32 blockSize;
+    u32 writeBlock;
+
+    Handle freeSemaphore;
+    Handle filledSemaphore;
+    Thread thread;
+
+    volatile Result result;
+};
+
+static void task_cia_verify_process(cia_verifier* verifier, u8* buffer, u32 size) {
+    while(verifier->currContent < verifier->contentCount) {
+        cia_verify_content* content = &verifier->contents[verifier->currContent];
+
+        // Encrypted contents and the meta region are passed over without hashing.
+        if(verifier->offset < content->offset) {
+            if(size == 0) {
+                break;
+            }
+
+            u64 skip = content->offset - verifier->offset;
+            u32 n = skip < size ? (u32) skip : size;
+
+            verifier->offset += n;
+            buffer += n;
+            size -= n;
+            continue;
+        }
+
+        u64 remaining = content->offset + content->size - verifier->offset;
+        u32 n = remaining < size ? (u32) remaining : size;
+        if(n > 0) {
+            mbedtls_sha256_update(&verifier->sha, buffer, n);
+
+            verifier->offset += n;
+            buffer += n;
+            size -= n;
+        }
+
+        if(verifier->offset < content->offset + content->size) {
+            break;
+        }
+
+        u8 hash[TMD_CONTENT_HASH_SIZE];
+        mbedtls_sha256_finish(&verifier->sha, hash);
+        if(memcmp(hash, content->hash, TMD_CONTENT_HASH_SIZE) != 0) {
+            verifier->result = R_APP_HASH_MISMATCH;
+            break;
+        }
+
+        verifier->currContent++;
+        mbedtls_sha256_starts(&verifier->sha, 0);
+    }
+}
+
+static void task_cia_verify_thread(void* arg) {
+    cia_verifier* verifier = (cia_verifier*) arg;
+
+    u32 curr = 0;
+    while(true) {
+        svcWaitSynchronization(verifier->filledSemaphore, U64_MAX);
+
+        // An empty block marks the end of the stream.
+        cia_verify_block* block = &verifier->blocks[curr];
+        if(block->size == 0) {
+            break;
+        }
+
+        if(R_SUCCEEDED(verifier->result)) {
+            task_cia_verify_process(verifier, block->buffer, block->size);
+        }
+
+        curr = (curr + 1) % CIA_VERIFY_BLOCKS;
+
+        s32 count = 0;
+        svcReleaseSemaphore(&count, verifier->freeSemaphore, 1);
+    }
+}
+
+static Result task_cia_verify_parse(cia_verifier* verifier, u8* cia, u32 size) {
+    Result res = 0;
+
+    if(size < CIA_HEADER_SIZE || *(u32*) &cia[0x00] != CIA_HEADER_SIZE) {
+        return R_APP_SKIPPED;
+    }
+
+    u8* tmd = NULL;
+    size_t tmdSize = 0;
+    u16 contentCount = 0;
+    u64 offset = 0;
+    if(R_FAILED(res = cia_get_tmd(&tmd, &tmdSize, cia, size))
+       || R_FAILED(res = tmd_get_content_count(&contentCount, tmd, tmdSize))
+       || R_FAILED(res = cia_get_content_offset(&offset, cia, size))) {
+        return res;
+    }
+
+    if(contentCount == 0) {
+        return R_APP_SKIPPED;
+    }
+
+    verifier->contents = (cia_verify_content*) calloc(contentCount, sizeof(cia_verify_content));
+    if(verifier->contents == NULL) {
+        return R_APP_OUT_OF_MEMORY;
+    }
+
+    // Contents present in the CIA are stored back to back, in TMD order.
+    for(u32 i = 0; i < contentCount && R_SUCCEEDED(res); i++) {
+        u16 index = 0;
+        bool present = false;
+        u64 contentSize = 0;
+        u16 type = 0;
+        if(R_SUCCEEDED(res = tmd_get_content_index(&index, tmd, tmdSize, i))
+           && R_SUCCEEDED(res = cia_has_content(&present, cia, size, index))
+           && present
+           && R_SUCCEEDED(res = tmd_get_content_size(&contentSize, tmd, tmdSize, i))
+           && R_SUCCEEDED(res = tmd_get_content_type(&type, tmd, tmdSize, i))) {
+            // Encrypted contents are hashed over their plaintext, which needs the title key.
+            if(!(type & TMD_CONTENT_TYPE_ENCRYPTED)) {
+                cia_verify_content* content = &verifier->contents[verifier->contentCount++];
+                content->offset = offset;
+                content->size = contentSize;
+                res = tmd_get_content_hash(content->hash, tmd, tmdSize, i);
+            }
+
+            offset += contentSize;
+        }
+    }
+
+    if(R_SUCCEEDED(res) && verifier->contentCount == 0) {
+        res = R_APP_SKIPPED;
+    }
+
+    return res;
+}
+
+static void task_cia_verify_free(cia_verifier* verifier) {
+    if(verifier->freeSemaphore != 0) {
+        svcCloseHandle(verifier->freeSemaphore);
+    }
+
+    if(verifier->filledSemaphore != 0) {
+        svcCloseHandle(verifier->filledSemaphore);
+    }
+
+    for(u32 i = 0; i < CIA_VERIFY_BLOCKS; i++) {
+        if(verifier->blocks[i].buffer != NULL) {
+            free(verifier->blocks[i].buffer);
+        }
+    }
+
+    if(verifier->contents != NULL) {
+        free(verifier->contents);
+    }
+
+    mbedtls_sha256_free(&verifier->sha);
+
+    free(verifier);
+}
+
+Result task_cia_verify_open(cia_verifier** verifier, void* initialReadBlock, u32 initialSize, u32 blockSize) {
+    if(verifier == NULL || initialReadBlock == NULL || blockSize == 0) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    Result res = 0;
+
+    cia_verifier* verify = (cia_verifier*) calloc(1, sizeof(cia_verifier));
+    if(verify != NULL) {
+        mbedtls_sha256_init(&verify->sha);
+        mbedtls_sha256_starts(&verify->sha, 0);
+
+        verify->blockSize = blockSize;
+
+        if(R_SUCCEEDED(res = task_cia_verify_parse(verify, (u8*) initialReadBlock, initialSize))) {
+            for(u32 i = 0; i < CIA_VERIFY_BLOCKS && R_SUCCEEDED(res); i++) {
+                if((verify->blocks[i].buffer = (u8*) calloc(1, blockSize)) == NULL) {
+                    res = R_APP_OUT_OF_MEMORY;
+                }
+            }
+        }
+
+        if(R_SUCCEEDED(res)
+           && R_SUCCEEDED(res = svcCreateSemaphore(&verify->freeSemaphore, CIA_VERIFY_BLOCKS, CIA_VERIFY_BLOCKS))
+           && R_SUCCEEDED(res = svcCreateSemaphore(&verify->filledSemaphore, 0, CIA_VERIFY_BLOCKS))
+           && (verify->thread = threadCreate(task_cia_verify_thread, verify, 0x4000, 0x18, 1, false)) == NULL) {
+            res = R_APP_THREAD_CREATE_FAILED;
+        }
+
+        if(R_SUCCEEDED(res)) {
+            *verifier = verify;
+        } else {
+            task_cia_verify_free(verify);
+        }
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+Result task_cia_verify_feed(cia_verifier* verifier, void* buffer, u32 size) {
+    if(verifier == NULL || buffer == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    u8* src = (u8*) buffer;
+    while(size > 0 && R_SUCCEEDED(verifier->result)) {
+        svcWaitSynchronization(verifier->freeSemaphore, U64_MAX);
+
+        cia_verify_block* block = &verifier->blocks[verifier->writeBlock];
+        block->size = size < verifier->blockSize ? size : verifier->blockSize;
+        memcpy(block->buffer, src, block->size);
+
+        src += block->size;
+        size -= block->size;
+
+        verifier->writeBlock = (verifier->writeBlock + 1) % CIA_VERIFY_BLOCKS;
+
+        s32 count = 0;
+        svcReleaseSemaphore(&count, verifier->filledSemaphore, 1);
+    }
+
+    return verifier->result;
+}
+
+Result task_cia_verify_close(cia_verifier* verifier, bool complete) {
+    if(verifier == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    svcWaitSynchronization(verifier->freeSemaphore, U64_MAX);
+
+    verifier->blocks[verifier->writeBlock].size = 0;
+
+    s32 count = 0;
+    svcReleaseSemaphore(&count, verifier->filledSemaphore, 1);
+
+    threadJoin(verifier->thread, U64_MAX);
+    threadFree(verifier->thread);
+
+    Result res = verifier->result;
+    if(R_SUCCEEDED(res) && complete && verifier->currContent < verifier->contentCount) {
+        res = R_APP_BAD_DATA;
+    }
+
+    task_cia_verify_free(verifier);
+    return res;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+typedef struct cia_verifier_s cia_verifier;
+
+// Hashes the unencrypted contents of a CIA stream on a worker thread and checks them against its TMD.
+// Returns R_APP_SKIPPED when the initial block is not a CIA or holds nothing that can be checked.
+Result task_cia_verify_open(cia_verifier** verifier, void* initialReadBlock, u32 initialSize, u32 blockSize);
+// Queues the next bytes of the stream; fails with R_APP_HASH_MISMATCH once any content has been found to differ.
+Result task_cia_verify_feed(cia_verifier* verifier, void* buffer, u32 size);
+// Waits for queued bytes to be hashed; when complete is set, contents that were never fully fed are an error.
+Result task_cia_verify_close(cia_verifier* verifier, bool complete);
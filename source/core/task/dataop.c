@@ -1,5 +1,6 @@
 #include <malloc.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <3ds.h>
 #include <jansson.h>
@@ -7,6 +8,48 @@
 #include "dataop.h"
 #include "../core.h"
 
+#define DATAOP_BUFFER_MIN (16 * 1024)
+#define DATAOP_BUFFER_MAX (2 * 1024 * 1024)
+// Transfer buffers may take up to this fraction of the heap that is free when the operation starts.
+#define DATAOP_HEAP_BUDGET_DIVISOR 4
+
+extern char* fake_heap_end;
+
+static u32 task_data_op_get_free_heap() {
+    struct mallinfo info = mallinfo();
+
+    // Free blocks inside the arena, plus heap the arena has not grown into yet.
+    char* heapBreak = (char*) sbrk(0);
+    return info.fordblks + (heapBreak != (char*) -1 && fake_heap_end > heapBreak ? (u32) (fake_heap_end - heapBreak) : 0);
+}
+
+static void task_data_op_tuner_init(data_op_data* data, chunk_tuner* tuner) {
+    // Every buffer an item holds at once may grow to the largest chunk.
+    u32 buffers = data->op == DATAOP_COPY && data->bufferCount > 1 ? data->bufferCount : 1;
+    u32 budget = task_data_op_get_free_heap() / DATAOP_HEAP_BUDGET_DIVISOR / buffers;
+
+    // Without a configured size there is nothing to scale from.
+    u32 maxSize = data->bufferSize;
+    while(maxSize > 0 && maxSize * 2 <= DATAOP_BUFFER_MAX && maxSize * 2 <= budget) {
+        maxSize *= 2;
+    }
+
+    // The transfer sizes the first block of a download, so downloads can only tune upwards.
+    u32 minSize = data->op == DATAOP_DOWNLOAD || data->bufferSize < DATAOP_BUFFER_MIN ? data->bufferSize : DATAOP_BUFFER_MIN;
+
+    task_chunk_tuner_init(tuner, data->bufferSize, minSize, maxSize, SYSCLOCK_ARM11);
+
+    data->chunkSize = tuner->size;
+    data->chunkBytesPerSecond = 0;
+}
+
+static void task_data_op_tuner_record(data_op_data* data, u32 bytes, u64 ticks) {
+    task_chunk_tuner_record(data->tuner, bytes, ticks);
+
+    data->chunkSize = data->tuner->bestSize;
+    data->chunkBytesPerSecond = (u32) (data->tuner->bestThroughput * data->tuner->ticksPerSecond);
+}
+
 static Result task_data_op_check_running(data_op_data* data) {
     Result res = 0;
 
@@ -32,6 +75,333 @@ static Result task_data_op_check_running(data_op_data* data) {
     return res;
 }
 
+static void task_data_op_update_speed(data_op_data* data, u64* ioStartTime, u64* lastBytesPerSecondUpdate, u32* bytesSinceUpdate) {
+    u64 time = osGetTime();
+    u64 elapsed = time - *lastBytesPerSecondUpdate;
+    if(elapsed >= 1000) {
+        data->bytesPerSecond = (u32) (*bytesSinceUpdate / (elapsed / 1000.0f));
+
+        if(*ioStartTime != 0) {
+            data->estimatedRemainingSeconds = (u32) ((data->currTotal - data->currProcessed) / (data->currProcessed / ((time - *ioStartTime) / 1000.0f)));
+        } else {
+            data->estimatedRemainingSeconds = 0;
+        }
+
+        if(*ioStartTime == 0 && data->currProcessed > 0) {
+            *ioStartTime = time;
+        }
+
+        *bytesSinceUpdate = 0;
+        *lastBytesPerSecondUpdate = time;
+    }
+}
+
+static void task_data_op_verify_discard(data_op_data* data) {
+    if(data->verifier != NULL) {
+        task_cia_verify_close(data->verifier, false);
+        data->verifier = NULL;
+    }
+}
+
+static Result task_data_op_open_dst(data_op_data* data, u32 index, void* initialReadBlock, u32 initialSize, u32* handle) {
+    Result res = data->openDst(data->data, index, initialReadBlock, initialSize, data->currTotal, handle);
+    if(R_SUCCEEDED(res) && data->verifyCia && initialReadBlock != NULL) {
+        // Streams the verifier cannot check are left to AM's own verification on commit.
+        task_data_op_verify_discard(data);
+        task_cia_verify_open(&data->verifier, initialReadBlock, initialSize, data->bufferSize);
+    }
+
+    return res;
+}
+
+static Result task_data_op_write_dst(data_op_data* data, u32 handle, u32* bytesWritten, void* buffer, u64 offset, u32 size) {
+    Result res = data->writeDst(data->data, handle, bytesWritten, buffer, offset, size);
+    if(R_SUCCEEDED(res) && data->verifier != NULL) {
+        res = task_cia_verify_feed(data->verifier, buffer, *bytesWritten);
+    }
+
+    return res;
+}
+
+static Result task_data_op_close_dst(data_op_data* data, u32 index, bool succeeded, u32 handle) {
+    if(data->verifier != NULL) {
+        Result verifyRes = task_cia_verify_close(data->verifier, succeeded);
+        data->verifier = NULL;
+
+        if(succeeded && R_FAILED(verifyRes)) {
+            data->closeDst(data->data, index, false, handle);
+            return verifyRes;
+        }
+    }
+
+    return data->closeDst(data->data, index, succeeded, handle);
+}
+
+// Buffers need be no larger than the item, so small files do not allocate and zero the largest chunk.
+static u32 task_data_op_copy_buffer_size(data_op_data* data) {
+    return data->currTotal < data->tuner->maxSize ? (u32) data->currTotal : data->tuner->maxSize;
+}
+
+static Result task_data_op_copy_sequential(data_op_data* data, u32 index, u32 srcHandle) {
+    Result res = 0;
+
+    u32 bufferSize = task_data_op_copy_buffer_size(data);
+    u8* buffer = (u8*) calloc(1, bufferSize);
+    if(buffer != NULL) {
+        u32 dstHandle = 0;
+
+        u64 ioStartTime = 0;
+        u64 lastBytesPerSecondUpdate = osGetTime();
+        u32 bytesSinceUpdate = 0;
+
+        bool firstRun = true;
+        while(data->currProcessed < data->currTotal) {
+            if(R_FAILED(res = task_data_op_check_running(data))) {
+                break;
+            }
+
+            // The first block keeps the configured size so that openDst sees everything it expects to parse.
+            u32 chunkSize = firstRun ? data->bufferSize : data->tuner->size;
+            bool measured = !firstRun && chunkSize <= bufferSize;
+            if(chunkSize > bufferSize) {
+                chunkSize = bufferSize;
+            }
+
+            u64 startTick = svcGetSystemTick();
+
+            u32 bytesRead = 0;
+            if(R_FAILED(res = data->readSrc(data->data, srcHandle, &bytesRead, buffer, data->currProcessed, chunkSize))) {
+                break;
+            }
+
+            if(firstRun) {
+                firstRun = false;
+
+                if(R_FAILED(res = task_data_op_open_dst(data, index, buffer, bytesRead, &dstHandle))) {
+                    break;
+                }
+            }
+
+            u32 bytesWritten = 0;
+            if(R_FAILED(res = task_data_op_write_dst(data, dstHandle, &bytesWritten, buffer, data->currProcessed, bytesRead))) {
+                break;
+            }
+
+            data->currProcessed += bytesWritten;
+            bytesSinceUpdate += bytesWritten;
+
+            if(measured && bytesWritten == chunkSize) {
+                task_data_op_tuner_record(data, bytesWritten, svcGetSystemTick() - startTick);
+            }
+
+            task_data_op_update_speed(data, &ioStartTime, &lastBytesPerSecondUpdate, &bytesSinceUpdate);
+        }
+
+        if(dstHandle != 0) {
+            Result closeDstRes = task_data_op_close_dst(data, index, res == 0, dstHandle);
+            if(R_SUCCEEDED(res)) {
+                res = closeDstRes;
+            }
+        }
+
+        free(buffer);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+typedef struct {
+    u8* buffer;
+    u64 offset;
+    u32 requested;
+    u32 size;
+    Result res;
+} data_op_copy_block;
+
+typedef struct {
+    data_op_data* data;
+    u32 srcHandle;
+
+    data_op_copy_block* blocks;
+    u32 blockCount;
+    u32 blockSize;
+    // The tuned chunk size, published by the writer so the reader never reads the tuner while it is updated.
+    volatile u32 chunkSize;
+
+    Handle freeSemaphore;
+    Handle filledSemaphore;
+
+    volatile bool stop;
+} data_op_copy_pipeline;
+
+static void task_data_op_copy_read_thread(void* arg) {
+    data_op_copy_pipeline* pipeline = (data_op_copy_pipeline*) arg;
+    data_op_data* data = pipeline->data;
+
+    u64 offset = 0;
+    u32 curr = 0;
+    while(!pipeline->stop && offset < data->currTotal) {
+        svcWaitSynchronization(pipeline->freeSemaphore, U64_MAX);
+        if(pipeline->stop) {
+            break;
+        }
+
+        // Suspend/restore hooks are run by the writer; the reader only has to stay idle while paused.
+        svcWaitSynchronization(task_get_pause_event(), U64_MAX);
+
+        data_op_copy_block* block = &pipeline->blocks[curr];
+        block->offset = offset;
+        block->requested = offset == 0 ? data->bufferSize : pipeline->chunkSize;
+        if(block->requested > pipeline->blockSize) {
+            block->requested = pipeline->blockSize;
+        }
+        block->size = 0;
+
+        if(R_SUCCEEDED(block->res = data->readSrc(data->data, pipeline->srcHandle, &block->size, block->buffer, offset, block->requested)) && block->size == 0) {
+            block->res = R_APP_BAD_DATA;
+        }
+
+        offset += block->size;
+        curr = (curr + 1) % pipeline->blockCount;
+
+        s32 count = 0;
+        svcReleaseSemaphore(&count, pipeline->filledSemaphore, 1);
+
+        if(R_FAILED(block->res)) {
+            break;
+        }
+    }
+}
+
+static Result task_data_op_copy_pipelined(data_op_data* data, u32 index, u32 srcHandle) {
+    Result res = 0;
+
+    data_op_copy_pipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+
+    pipeline.data = data;
+    pipeline.srcHandle = srcHandle;
+    pipeline.blockCount = data->bufferCount;
+    pipeline.blockSize = task_data_op_copy_buffer_size(data);
+    pipeline.chunkSize = data->tuner->size;
+    pipeline.stop = false;
+
+    pipeline.blocks = (data_op_copy_block*) calloc(pipeline.blockCount, sizeof(data_op_copy_block));
+    if(pipeline.blocks != NULL) {
+        for(u32 i = 0; i < pipeline.blockCount && R_SUCCEEDED(res); i++) {
+            if((pipeline.blocks[i].buffer = (u8*) calloc(1, pipeline.blockSize)) == NULL) {
+                res = R_APP_OUT_OF_MEMORY;
+            }
+        }
+
+        if(R_SUCCEEDED(res)
+           && R_SUCCEEDED(res = svcCreateSemaphore(&pipeline.freeSemaphore, (s32) pipeline.blockCount, (s32) pipeline.blockCount))
+           && R_SUCCEEDED(res = svcCreateSemaphore(&pipeline.filledSemaphore, 0, (s32) pipeline.blockCount))) {
+            Thread readThread = threadCreate(task_data_op_copy_read_thread, &pipeline, 0x4000, 0x18, 1, false);
+            if(readThread != NULL) {
+                u32 dstHandle = 0;
+
+                u64 ioStartTime = 0;
+                u64 lastBytesPerSecondUpdate = osGetTime();
+                u32 bytesSinceUpdate = 0;
+
+                bool firstRun = true;
+                u64 lastWriteTick = 0;
+                u32 curr = 0;
+                while(data->currProcessed < data->currTotal) {
+                    if(R_FAILED(res = task_data_op_check_running(data))) {
+                        break;
+                    }
+
+                    svcWaitSynchronization(pipeline.filledSemaphore, U64_MAX);
+
+                    data_op_copy_block* block = &pipeline.blocks[curr];
+                    if(R_FAILED(res = block->res)) {
+                        break;
+                    }
+
+                    if(firstRun) {
+                        firstRun = false;
+
+                        if(R_FAILED(res = task_data_op_open_dst(data, index, block->buffer, block->size, &dstHandle))) {
+                            break;
+                        }
+                    }
+
+                    u32 bytesWritten = 0;
+                    if(R_FAILED(res = task_data_op_write_dst(data, dstHandle, &bytesWritten, block->buffer, block->offset, block->size))) {
+                        break;
+                    }
+
+                    // Blocks are read ahead of the writer, so partial writes cannot be retried from the same offset.
+                    if(bytesWritten != block->size) {
+                        res = R_APP_BAD_DATA;
+                        break;
+                    }
+
+                    data->currProcessed += bytesWritten;
+                    bytesSinceUpdate += bytesWritten;
+
+                    // Time between completed writes is the pipeline's throughput, whichever side is slower.
+                    u64 writeTick = svcGetSystemTick();
+                    if(lastWriteTick != 0 && block->size == block->requested && block->requested == data->tuner->size) {
+                        task_data_op_tuner_record(data, block->size, writeTick - lastWriteTick);
+                        pipeline.chunkSize = data->tuner->size;
+                    }
+
+                    lastWriteTick = writeTick;
+
+                    task_data_op_update_speed(data, &ioStartTime, &lastBytesPerSecondUpdate, &bytesSinceUpdate);
+
+                    curr = (curr + 1) % pipeline.blockCount;
+
+                    s32 count = 0;
+                    svcReleaseSemaphore(&count, pipeline.freeSemaphore, 1);
+                }
+
+                pipeline.stop = true;
+
+                s32 count = 0;
+                svcReleaseSemaphore(&count, pipeline.freeSemaphore, 1);
+
+                threadJoin(readThread, U64_MAX);
+                threadFree(readThread);
+
+                if(dstHandle != 0) {
+                    Result closeDstRes = task_data_op_close_dst(data, index, res == 0, dstHandle);
+                    if(R_SUCCEEDED(res)) {
+                        res = closeDstRes;
+                    }
+                }
+            } else {
+                res = R_APP_THREAD_CREATE_FAILED;
+            }
+        }
+
+        if(pipeline.freeSemaphore != 0) {
+            svcCloseHandle(pipeline.freeSemaphore);
+        }
+
+        if(pipeline.filledSemaphore != 0) {
+            svcCloseHandle(pipeline.filledSemaphore);
+        }
+
+        for(u32 i = 0; i < pipeline.blockCount; i++) {
+            if(pipeline.blocks[i].buffer != NULL) {
+                free(pipeline.blocks[i].buffer);
+            }
+        }
+
+        free(pipeline.blocks);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
 static Result task_data_op_copy(data_op_data* data, u32 index) {
     data->currProcessed = 0;
     data->currTotal = 0;
@@ -51,79 +421,16 @@ static Result task_data_op_copy(data_op_data* data, u32 index) {
                 if(data->currTotal == 0) {
                     if(data->copyEmpty) {
                         u32 dstHandle = 0;
-                        if(R_SUCCEEDED(res = data->openDst(data->data, index, NULL, data->currTotal, &dstHandle))) {
-                            res = data->closeDst(data->data, index, true, dstHandle);
+                        if(R_SUCCEEDED(res = task_data_op_open_dst(data, index, NULL, 0, &dstHandle))) {
+                            res = task_data_op_close_dst(data, index, true, dstHandle);
                         }
                     } else {
                         res = R_APP_BAD_DATA;
                     }
+                } else if(data->bufferCount > 1 && data->currTotal > data->bufferSize) {
+                    res = task_data_op_copy_pipelined(data, index, srcHandle);
                 } else {
-                    u8* buffer = (u8*) calloc(1, data->bufferSize);
-                    if(buffer != NULL) {
-                        u32 dstHandle = 0;
-
-                        u64 ioStartTime = 0;
-                        u64 lastBytesPerSecondUpdate = osGetTime();
-                        u32 bytesSinceUpdate = 0;
-
-                        bool firstRun = true;
-                        while(data->currProcessed < data->currTotal) {
-                            if(R_FAILED(res = task_data_op_check_running(data))) {
-                                break;
-                            }
-
-                            u32 bytesRead = 0;
-                            if(R_FAILED(res = data->readSrc(data->data, srcHandle, &bytesRead, buffer, data->currProcessed, data->bufferSize))) {
-                                break;
-                            }
-
-                            if(firstRun) {
-                                firstRun = false;
-
-                                if(R_FAILED(res = data->openDst(data->data, index, buffer, data->currTotal, &dstHandle))) {
-                                    break;
-                                }
-                            }
-
-                            u32 bytesWritten = 0;
-                            if(R_FAILED(res = data->writeDst(data->data, dstHandle, &bytesWritten, buffer, data->currProcessed, bytesRead))) {
-                                break;
-                            }
-
-                            data->currProcessed += bytesWritten;
-                            bytesSinceUpdate += bytesWritten;
-
-                            u64 time = osGetTime();
-                            u64 elapsed = time - lastBytesPerSecondUpdate;
-                            if(elapsed >= 1000) {
-                                data->bytesPerSecond = (u32) (bytesSinceUpdate / (elapsed / 1000.0f));
-
-                                if(ioStartTime != 0) {
-                                    data->estimatedRemainingSeconds = (u32) ((data->currTotal - data->currProcessed) / (data->currProcessed / ((time - ioStartTime) / 1000.0f)));
-                                } else {
-                                    data->estimatedRemainingSeconds = 0;
-                                }
-
-                                if(ioStartTime == 0 && data->currProcessed > 0) {
-                                    ioStartTime = time;
-                                }
-
-                                bytesSinceUpdate = 0;
-                                lastBytesPerSecondUpdate = time;
-                            }
-                        }
-
-                        if(dstHandle != 0) {
-                            Result closeDstRes = data->closeDst(data->data, index, res == 0, dstHandle);
-                            if(R_SUCCEEDED(res)) {
-                                res = closeDstRes;
-                            }
-                        }
-
-                        free(buffer);
-                    } else {
-                        res = R_APP_OUT_OF_MEMORY;
-                    }
+                    res = task_data_op_copy_sequential(data, index, srcHandle);
                 }
             }
 
@@ -137,37 +444,246 @@ static Result task_data_op_copy(data_op_data* data, u32 index) {
     return res;
 }
 
+#define DOWNLOAD_JOURNAL_PATH "/fbi/resume"
+#define DOWNLOAD_JOURNAL_MAX 16
+#define DOWNLOAD_JOURNAL_INTERVAL (4 * 1024 * 1024)
+
+typedef struct {
+    char url[DOWNLOAD_URL_MAX];
+    char validator[HTTP_VALIDATOR_MAX];
+    char path[FILE_PATH_MAX];
+    u64 committed;
+    // Order of the last write; a full journal evicts the lowest.
+    u64 sequence;
+} data_op_journal_entry;
+
+static Result task_data_op_journal_open(Handle* file) {
+    Result res = 0;
+
+    FS_Archive sdmcArchive = 0;
+    if(R_SUCCEEDED(res = FSUSER_OpenArchive(&sdmcArchive, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, "")))) {
+        if(R_SUCCEEDED(res = fs_ensure_dir(sdmcArchive, "/fbi/"))) {
+            res = FSUSER_OpenFile(file, sdmcArchive, fsMakePath(PATH_ASCII, DOWNLOAD_JOURNAL_PATH), FS_OPEN_READ | FS_OPEN_WRITE | FS_OPEN_CREATE, 0);
+        }
+
+        FSUSER_CloseArchive(sdmcArchive);
+    }
+
+    return res;
+}
+
+// Returns the slot holding url, or else a free slot, or else the least recently written one. entry receives the
+// contents of url's slot, or zeroes if it has none.
+static int task_data_op_journal_find(Handle file, data_op_journal_entry* entry, const char* url, u64* nextSequence) {
+    int found = -1;
+    int freeSlot = -1;
+    int oldest = -1;
+    u64 oldestSequence = 0;
+    u64 lastSequence = 0;
+
+    memset(entry, 0, sizeof(*entry));
+
+    data_op_journal_entry curr;
+    for(u32 i = 0; i < DOWNLOAD_JOURNAL_MAX; i++) {
+        u32 bytesRead = 0;
+        if(R_FAILED(FSFILE_Read(file, &bytesRead, i * sizeof(data_op_journal_entry), &curr, sizeof(data_op_journal_entry))) || bytesRead != sizeof(data_op_journal_entry)) {
+            if(freeSlot == -1) {
+                freeSlot = (int) i;
+            }
+
+            break;
+        }
+
+        if(string_is_empty(curr.url)) {
+            if(freeSlot == -1) {
+                freeSlot = (int) i;
+            }
+
+            continue;
+        }
+
+        if(curr.sequence > lastSequence) {
+            lastSequence = curr.sequence;
+        }
+
+        if(found == -1 && strncmp(curr.url, url, DOWNLOAD_URL_MAX) == 0) {
+            found = (int) i;
+            *entry = curr;
+        }
+
+        if(oldest == -1 || curr.sequence < oldestSequence) {
+            oldest = (int) i;
+            oldestSequence = curr.sequence;
+        }
+    }
+
+    if(nextSequence != NULL) {
+        *nextSequence = lastSequence + 1;
+    }
+
+    return found != -1 ? found : freeSlot != -1 ? freeSlot : oldest;
+}
+
+static bool task_data_op_journal_get(const char* url, u64* committed, char* validator, char* path) {
+    bool found = false;
+
+    Handle file = 0;
+    if(R_SUCCEEDED(task_data_op_journal_open(&file))) {
+        data_op_journal_entry entry;
+        task_data_op_journal_find(file, &entry, url, NULL);
+
+        if(strncmp(entry.url, url, DOWNLOAD_URL_MAX) == 0 && entry.committed > 0 && !string_is_empty(entry.path)) {
+            *committed = entry.committed;
+            string_copy(validator, entry.validator, HTTP_VALIDATOR_MAX);
+            string_copy(path, entry.path, FILE_PATH_MAX);
+
+            found = true;
+        }
+
+        FSFILE_Close(file);
+    }
+
+    return found;
+}
+
+static void task_data_op_journal_set(const char* url, const char* validator, const char* path, u64 committed) {
+    Handle file = 0;
+    if(R_SUCCEEDED(task_data_op_journal_open(&file))) {
+        data_op_journal_entry entry;
+        u64 sequence = 0;
+
+        int slot = task_data_op_journal_find(file, &entry, url, &sequence);
+        bool present = strncmp(entry.url, url, DOWNLOAD_URL_MAX) == 0;
+
+        if(committed > 0 || present) {
+            memset(&entry, 0, sizeof(entry));
+
+            if(committed > 0) {
+                string_copy(entry.url, url, DOWNLOAD_URL_MAX);
+                string_copy(entry.validator, validator, HTTP_VALIDATOR_MAX);
+                string_copy(entry.path, path, FILE_PATH_MAX);
+                entry.committed = committed;
+                entry.sequence = sequence;
+            }
+
+            u32 bytesWritten = 0;
+            FSFILE_Write(file, &bytesWritten, slot * sizeof(data_op_journal_entry), &entry, sizeof(entry), FS_WRITE_FLUSH);
+        }
+
+        FSFILE_Close(file);
+    }
+}
+
+static void task_data_op_journal_remove(const char* url) {
+    task_data_op_journal_set(url, NULL, NULL, 0);
+}
+
 typedef struct {
     data_op_data* data;
 
     u32 index;
+    char* url;
 
     u32 dstHandle;
     bool firstRun;
+    bool firstCallback;
+    bool dstFailed;
+    u32 chunkSize;
+    u64 lastCallbackTick;
     u64 ioStartTime;
     u64 lastBytesPerSecondUpdate;
     u32 bytesSinceUpdate;
 
     u64 writeOffset;
+    u64 lastJournalOffset;
+    // SD file holding the destination, journaled so a later session can resume; empty if it cannot be reopened.
+    char resumePath[FILE_PATH_MAX];
+
+    http_resume_info resume;
 } data_op_download_data;
 
+static void task_data_op_download_prefetch(data_op_data* data, u32 index) {
+    if(data->prefetch != NULL && data->prefetchIndex == index) {
+        return;
+    }
+
+    if(data->prefetch != NULL) {
+        http_prefetch_close(data->prefetch);
+        data->prefetch = NULL;
+    }
+
+    if(data->prefetchSize > 0 && index < data->total) {
+        char url[DOWNLOAD_URL_MAX];
+        if(R_SUCCEEDED(data->getSrcUrl(data->data, index, url, DOWNLOAD_URL_MAX))
+           && R_SUCCEEDED(http_prefetch_open(&data->prefetch, url, data->connections, data->prefetchSize))) {
+            data->prefetchIndex = index;
+        }
+    }
+}
+
+static void task_data_op_download_get_resume_path(data_op_download_data* downloadData) {
+    data_op_data* data = downloadData->data;
+
+    if(data->resumeDst == NULL || data->getResumePath == NULL
+       || R_FAILED(data->getResumePath(data->data, downloadData->index, downloadData->resumePath, FILE_PATH_MAX))) {
+        memset(downloadData->resumePath, '\0', sizeof(downloadData->resumePath));
+    }
+}
+
 static Result task_data_op_download_callback(void* userData, void* buffer, size_t size) {
     data_op_download_data* downloadData = (data_op_download_data*) userData;
     data_op_data* data = downloadData->data;
 
+    u64 callbackTick = svcGetSystemTick();
+    if(downloadData->lastCallbackTick != 0 && downloadData->chunkSize == data->tuner->size) {
+        task_data_op_tuner_record(data, (u32) size, callbackTick - downloadData->lastCallbackTick);
+    }
+
+    downloadData->lastCallbackTick = callbackTick;
+
+    if(downloadData->firstCallback) {
+        downloadData->firstCallback = false;
+
+        // The current item is streaming; connect to the next one in the meantime.
+        task_data_op_download_prefetch(data, downloadData->index + 1);
+
+        // The server sent the whole entity instead of the requested range; the partial destination is stale.
+        if(downloadData->resume.offset != downloadData->writeOffset) {
+            if(downloadData->dstHandle != 0) {
+                task_data_op_close_dst(data, downloadData->index, false, downloadData->dstHandle);
+                downloadData->dstHandle = 0;
+            }
+
+            downloadData->firstRun = true;
+            downloadData->writeOffset = downloadData->resume.offset;
+            downloadData->lastJournalOffset = downloadData->writeOffset;
+        }
+    }
+
     if(downloadData->firstRun) {
         downloadData->firstRun = false;
 
-        Result res = data->openDst(data->data, downloadData->index, buffer, data->currTotal, &downloadData->dstHandle);
+        Result res = task_data_op_open_dst(data, downloadData->index, buffer, size, &downloadData->dstHandle);
         if(R_FAILED(res)) {
+            downloadData->dstFailed = true;
             return res;
         }
+
+        task_data_op_download_get_resume_path(downloadData);
     }
 
     u32 bytesWritten = 0;
-    Result res = data->writeDst(data->data, downloadData->dstHandle, &bytesWritten, buffer, downloadData->writeOffset, size);
+    Result res = task_data_op_write_dst(data, downloadData->dstHandle, &bytesWritten, buffer, downloadData->writeOffset, size);
     downloadData->writeOffset += bytesWritten;
 
+    if(R_FAILED(res)) {
+        downloadData->dstFailed = true;
+    } else if(!string_is_empty(downloadData->resumePath) && !string_is_empty(downloadData->resume.validator)
+              && downloadData->writeOffset - downloadData->lastJournalOffset >= DOWNLOAD_JOURNAL_INTERVAL) {
+        task_data_op_journal_set(downloadData->url, downloadData->resume.validator, downloadData->resumePath, downloadData->writeOffset);
+        downloadData->lastJournalOffset = downloadData->writeOffset;
+    }
+
     return res;
 }
 
@@ -186,26 +702,21 @@ static Result task_data_op_download_progress(void* userData, u64 total, u64 curr
     data->currTotal = total;
     data->currProcessed = curr;
 
-    u64 time = osGetTime();
-    u64 elapsed = time - downloadData->lastBytesPerSecondUpdate;
-    if(elapsed >= 1000) {
-        data->bytesPerSecond = (u32) (downloadData->bytesSinceUpdate / (elapsed / 1000.0f));
+    task_data_op_update_speed(data, &downloadData->ioStartTime, &downloadData->lastBytesPerSecondUpdate, &downloadData->bytesSinceUpdate);
 
-        if(downloadData->ioStartTime != 0) {
-            data->estimatedRemainingSeconds = (u32) ((data->currTotal - data->currProcessed) / (data->currProcessed / ((time - downloadData->ioStartTime) / 1000.0f)));
-        } else {
-            data->estimatedRemainingSeconds = 0;
-        }
+    return 0;
+}
 
-        if(downloadData->ioStartTime == 0 && data->currProcessed > 0) {
-            downloadData->ioStartTime = time;
-        }
+static void task_data_op_download_discard(data_op_data* data) {
+    if(data->resumeHandle != 0) {
+        data->closeDst(data->data, data->resumeIndex, false, data->resumeHandle);
+        data->resumeHandle = 0;
 
-        downloadData->bytesSinceUpdate = 0;
-        downloadData->lastBytesPerSecondUpdate = time;
+        char url[DOWNLOAD_URL_MAX];
+        if(R_SUCCEEDED(data->getSrcUrl(data->data, data->resumeIndex, url, DOWNLOAD_URL_MAX))) {
+            task_data_op_journal_remove(url);
+        }
     }
-
-    return 0;
 }
 
 static Result task_data_op_download(data_op_data* data, u32 index) {
@@ -219,13 +730,81 @@ static Result task_data_op_download(data_op_data* data, u32 index) {
 
     char url[DOWNLOAD_URL_MAX];
     if(R_SUCCEEDED(res = data->getSrcUrl(data->data, index, url, DOWNLOAD_URL_MAX))) {
-        data_op_download_data downloadData = {data, index, 0, true, 0, osGetTime(), 0, 0};
-        res = http_download_callback(url, data->bufferSize, &downloadData, task_data_op_download_callback, task_data_op_download_check_running, task_data_op_download_progress);
+        data_op_download_data downloadData;
+        memset(&downloadData, 0, sizeof(downloadData));
+
+        downloadData.data = data;
+        downloadData.index = index;
+        downloadData.url = url;
+        downloadData.firstRun = true;
+        downloadData.firstCallback = true;
+        // Chunk sizes are fixed for the length of a transfer; a new size takes effect on the next item.
+        downloadData.chunkSize = data->tuner->size;
+        downloadData.lastBytesPerSecondUpdate = osGetTime();
+
+        if(data->resumeHandle != 0 && data->resumeIndex == index) {
+            // Retrying an interrupted transfer; keep writing to the destination left open by the failed attempt.
+            downloadData.dstHandle = data->resumeHandle;
+            downloadData.resume.offset = data->resumeOffset;
+            string_copy(downloadData.resume.validator, data->resumeValidator, HTTP_VALIDATOR_MAX);
+
+            data->resumeHandle = 0;
+
+            task_data_op_download_get_resume_path(&downloadData);
+        } else {
+            task_data_op_download_discard(data);
+
+            // A journal entry means an earlier session left committed bytes at the destination.
+            u64 committed = 0;
+            if(data->resumeDst != NULL && task_data_op_journal_get(url, &committed, downloadData.resume.validator, downloadData.resumePath)
+               && R_SUCCEEDED(data->resumeDst(data->data, index, downloadData.resumePath, committed, &downloadData.dstHandle))) {
+                downloadData.resume.offset = committed;
+            } else {
+                memset(downloadData.resume.validator, '\0', sizeof(downloadData.resume.validator));
+                memset(downloadData.resumePath, '\0', sizeof(downloadData.resumePath));
+            }
+        }
+
+        if(downloadData.resume.offset > 0) {
+            downloadData.firstRun = false;
+            downloadData.writeOffset = downloadData.resume.offset;
+            downloadData.lastJournalOffset = downloadData.resume.offset;
+
+            data->currProcessed = downloadData.resume.offset;
+        }
+
+        if(data->downloadSrc != NULL) {
+            res = data->downloadSrc(data->data, index, downloadData.chunkSize, &downloadData, task_data_op_download_callback, task_data_op_download_check_running, task_data_op_download_progress);
+        } else {
+            http_prefetch* prefetch = data->prefetch != NULL && data->prefetchIndex == index ? &data->prefetch : NULL;
+
+            res = http_download_callback(url, downloadData.chunkSize, data->connections, &downloadData.resume, prefetch, &downloadData, task_data_op_download_callback, task_data_op_download_check_running, task_data_op_download_progress);
+        }
 
         if(downloadData.dstHandle != 0) {
-            Result closeDstRes = data->closeDst(data->data, index, res == 0, downloadData.dstHandle);
-            if(R_SUCCEEDED(res)) {
-                res = closeDstRes;
+            if(R_FAILED(res) && res != R_APP_CANCELLED && !downloadData.dstFailed
+               && downloadData.writeOffset > 0 && !string_is_empty(downloadData.resume.validator)) {
+                // Keep the destination open so that a retry can continue with a Range request.
+                // The verifier only sees whole streams, so the resumed remainder goes unchecked.
+                task_data_op_verify_discard(data);
+
+                data->resumeIndex = index;
+                data->resumeHandle = downloadData.dstHandle;
+                data->resumeOffset = downloadData.writeOffset;
+                string_copy(data->resumeValidator, downloadData.resume.validator, HTTP_VALIDATOR_MAX);
+
+                if(!string_is_empty(downloadData.resumePath)) {
+                    task_data_op_journal_set(url, downloadData.resume.validator, downloadData.resumePath, downloadData.writeOffset);
+                }
+            } else {
+                Result closeDstRes = task_data_op_close_dst(data, index, res == 0, downloadData.dstHandle);
+                if(R_SUCCEEDED(res)) {
+                    res = closeDstRes;
+                }
+
+                if(data->resumeDst != NULL) {
+                    task_data_op_journal_remove(url);
+                }
             }
         }
     }
@@ -237,6 +816,30 @@ static Result task_data_op_delete(data_op_data* data, u32 index) {
     return data->delete(data->data, index);
 }
 
+static bool task_data_op_is_dst_current(data_op_data* data, u32 index) {
+    if(data->isDstCurrent == NULL || (data->op != DATAOP_COPY && data->op != DATAOP_DOWNLOAD)) {
+        return false;
+    }
+
+    // Checks are best effort; any failure falls through to a normal transfer.
+    bool current = false;
+    u64 size = 0;
+    if(R_FAILED(data->isDstCurrent(data->data, index, &current, &size)) || !current) {
+        return false;
+    }
+
+    data->skipped++;
+    data->skippedBytes += size;
+
+    // Nothing will take a prefetch made for this item, so release its connection now.
+    if(data->prefetch != NULL && data->prefetchIndex == index) {
+        http_prefetch_close(data->prefetch);
+        data->prefetch = NULL;
+    }
+
+    return true;
+}
+
 static void task_data_op_retry_onresponse(ui_view* view, void* data, u32 response) {
     ((data_op_data*) data)->retryResponse = response == PROMPT_YES;
 }
@@ -244,10 +847,17 @@ static void task_data_op_retry_onresponse(ui_view* view, void* data, u32 respons
 static void task_data_op_thread(void* arg) {
     data_op_data* data = (data_op_data*) arg;
 
+    // Deletes move no data, and their callers leave bufferSize unset.
+    chunk_tuner tuner;
+    if(data->op != DATAOP_DELETE) {
+        task_data_op_tuner_init(data, &tuner);
+        data->tuner = &tuner;
+    }
+
     for(data->processed = 0; data->processed < data->total; data->processed++) {
         Result res = 0;
 
-        if(R_SUCCEEDED(res = task_data_op_check_running(data))) {
+        if(R_SUCCEEDED(res = task_data_op_check_running(data)) && !task_data_op_is_dst_current(data, data->processed)) {
             switch(data->op) {
                 case DATAOP_COPY:
                     res = task_data_op_copy(data, data->processed);
@@ -295,8 +905,18 @@ static void task_data_op_thread(void* arg) {
         }
     }
 
+    if(data->op == DATAOP_DOWNLOAD) {
+        task_data_op_download_discard(data);
+
+        if(data->prefetch != NULL) {
+            http_prefetch_close(data->prefetch);
+            data->prefetch = NULL;
+        }
+    }
+
     svcCloseHandle(data->cancelEvent);
 
+    data->tuner = NULL;
     data->finished = true;
 
     aptSetSleepAllowed(true);
@@ -316,6 +936,16 @@ Result task_data_op(data_op_data* data) {
     data->result = 0;
     data->cancelEvent = 0;
 
+    data->skipped = 0;
+    data->skippedBytes = 0;
+
+    data->prefetchIndex = 0;
+    data->prefetch = NULL;
+
+    data->resumeIndex = 0;
+    data->resumeHandle = 0;
+    data->resumeOffset = 0;
+
     Result res = 0;
     if(R_SUCCEEDED(res = svcCreateEvent(&data->cancelEvent, RESET_STICKY))) {
         if(threadCreate(task_data_op_thread, data, 0x10000, 0x18, 1, true) == NULL) {
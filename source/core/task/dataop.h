@@ -4,6 +4,8 @@ typedef struct json_t json_t;
 
 typedef struct ui_view_s ui_view;
 
+#include "../http.h"
+
 #define DOWNLOAD_URL_MAX 1024
 
 typedef enum data_op_e {
@@ -27,16 +29,26 @@ typedef struct data_op_data_s {
     u32 bytesPerSecond;
     u32 estimatedRemainingSeconds;
 
+    // Size of the first block of each item, which openDst may parse; later chunks are tuned from measured throughput.
     u32 bufferSize;
 
-    Result (*openDst)(void* data, u32 index, void* initialReadBlock, u64 size, u32* handle);
+    Result (*openDst)(void* data, u32 index, void* initialReadBlock, u32 initialReadSize, u64 size, u32* handle);
     Result (*closeDst)(void* data, u32 index, bool succeeded, u32 handle);
 
     Result (*writeDst)(void* data, u32 handle, u32* bytesWritten, void* buffer, u64 offset, u32 size);
 
+    // Optional; items whose destination already matches the source are skipped, with size counted in skippedBytes.
+    Result (*isDstCurrent)(void* data, u32 index, bool* current, u64* size);
+
+    // Hashes unencrypted CIA contents against the TMD while they are written, aborting at the first mismatch.
+    bool verifyCia;
+
     // Copy
     bool copyEmpty;
 
+    // Number of read-ahead buffers; values above 1 overlap reads and writes on separate threads.
+    u32 bufferCount;
+
     Result (*isSrcDirectory)(void* data, u32 index, bool* isDirectory);
     Result (*makeDstDirectory)(void* data, u32 index);
 
@@ -47,8 +59,24 @@ typedef struct data_op_data_s {
     Result (*readSrc)(void* data, u32 handle, u32* bytesRead, void* buffer, u64 offset, u32 size);
 
     // Download
+    // Number of concurrent HTTP Range connections; servers without range support fall back to one.
+    u32 connections;
+    // Bytes of the next URL to buffer while the current one downloads; 0 disables prefetching.
+    u32 prefetchSize;
+
     Result (*getSrcUrl)(void* data, u32 index, char* url, size_t maxSize);
 
+    // Optional; names the SD file the open destination is being written to. Fails for destinations that cannot be
+    // reopened later, which are then never journaled for resumption by a later session.
+    Result (*getResumePath)(void* data, u32 index, char* path, size_t maxSize);
+    // Optional; reopens path, journaled by an interrupted earlier session, to continue writing at offset.
+    Result (*resumeDst)(void* data, u32 index, const char* path, u64 offset, u32* handle);
+
+    // Optional; feeds the item from a caller-owned stream into the download sink instead of fetching getSrcUrl over HTTP.
+    Result (*downloadSrc)(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                 Result (*checkRunning)(void* userData),
+                                                                                 Result (*progress)(void* userData, u64 total, u64 curr));
+
     // Delete
     Result (*delete)(void* data, u32 index);
 
@@ -64,8 +92,27 @@ typedef struct data_op_data_s {
     Result result;
     Handle cancelEvent;
 
+    u32 skipped;
+    u64 skippedBytes;
+
+    // Chunk size the tuner last settled on and the throughput measured at it.
+    u32 chunkSize;
+    u32 chunkBytesPerSecond;
+
     // Internal
     volatile bool retryResponse;
+
+    struct cia_verifier_s* verifier;
+
+    struct chunk_tuner_s* tuner;
+
+    u32 prefetchIndex;
+    struct http_prefetch_s* prefetch;
+
+    u32 resumeIndex;
+    u32 resumeHandle;
+    u64 resumeOffset;
+    char resumeValidator[HTTP_VALIDATOR_MAX];
 } data_op_data;
 
 Result task_data_op(data_op_data* data);
\ No newline at end of file
@@ -7,4 +7,6 @@ Handle task_get_pause_event();
 Handle task_get_suspend_event();
 
 #include "capturecam.h"
+#include "chunktuner.h"
+#include "ciaverify.h"
 #include "dataop.h"
\ No newline at end of file
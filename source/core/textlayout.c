@@ -0,0 +1,315 @@
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <3ds.h>
+
+#include "textlayout.h"
+
+// Code points below this are resolved once up front; the rest share a direct-mapped cache.
+#define TEXT_LAYOUT_TABLE_SIZE 0x100
+#define TEXT_LAYOUT_GLYPH_CACHE_SIZE 256
+
+typedef struct {
+    // Holds the line arrays followed by text.
+    u8* block;
+    char* text;
+    u32 hash;
+    float scaleX;
+    float scaleY;
+    bool wordWrap;
+    float maxWidth;
+
+    u32 lastUsed;
+    text_layout layout;
+} text_layout_entry;
+
+static u32 sheet_count;
+static float font_scale;
+static float line_feed;
+
+static text_glyph glyph_table[TEXT_LAYOUT_TABLE_SIZE];
+
+static struct {
+    bool valid;
+    u32 code;
+    text_glyph glyph;
+} glyph_cache[TEXT_LAYOUT_GLYPH_CACHE_SIZE];
+
+static text_layout_entry layout_cache[TEXT_LAYOUT_CACHE_SIZE];
+static u32 layout_clock;
+
+// Holds the most recent layout when it could not be cached.
+static u32 scratch_lines[TEXT_LAYOUT_MAX_LINES];
+static float scratch_line_widths[TEXT_LAYOUT_MAX_LINES];
+static float scratch_line_heights[TEXT_LAYOUT_MAX_LINES];
+static text_layout scratch_layout = {0, scratch_lines, scratch_line_widths, scratch_line_heights, 0, 0};
+
+static void text_layout_load_glyph(text_glyph* glyph, u32 code) {
+    int index = fontGlyphIndexFromCodePoint(code);
+    glyph->layoutWidth = fontGetCharWidthInfo(index)->charWidth;
+
+    fontGlyphPos_s pos;
+    fontCalcGlyphPos(&pos, index, 0, 1.0f, 1.0f);
+
+    if(pos.sheetIndex >= sheet_count) {
+        index = fontGlyphIndexFromCodePoint(0xFFFD);
+        fontCalcGlyphPos(&pos, index, 0, 1.0f, 1.0f);
+    }
+
+    charWidthInfo_s* info = fontGetCharWidthInfo(index);
+    glyph->sheetIndex = (u32) pos.sheetIndex;
+    glyph->left = info->left;
+    glyph->glyphWidth = info->glyphWidth;
+    glyph->charWidth = info->charWidth;
+    glyph->texLeft = pos.texcoord.left;
+    glyph->texTop = pos.texcoord.top;
+    glyph->texRight = pos.texcoord.right;
+    glyph->texBottom = pos.texcoord.bottom;
+}
+
+static void text_layout_free_entry(text_layout_entry* entry) {
+    if(entry->block != NULL) {
+        free(entry->block);
+    }
+
+    memset(entry, 0, sizeof(*entry));
+}
+
+void text_layout_init(u32 sheetCount, float scale) {
+    text_layout_exit();
+
+    sheet_count = sheetCount;
+    font_scale = scale;
+    line_feed = fontGetInfo()->lineFeed;
+
+    for(u32 code = 0; code < TEXT_LAYOUT_TABLE_SIZE; code++) {
+        text_layout_load_glyph(&glyph_table[code], code);
+    }
+}
+
+void text_layout_exit() {
+    for(u32 i = 0; i < TEXT_LAYOUT_CACHE_SIZE; i++) {
+        text_layout_free_entry(&layout_cache[i]);
+    }
+
+    memset(glyph_cache, 0, sizeof(glyph_cache));
+    layout_clock = 0;
+}
+
+const text_glyph* text_layout_get_glyph(u32 code) {
+    if(code < TEXT_LAYOUT_TABLE_SIZE) {
+        return &glyph_table[code];
+    }
+
+    u32 slot = code % TEXT_LAYOUT_GLYPH_CACHE_SIZE;
+    if(!glyph_cache[slot].valid || glyph_cache[slot].code != code) {
+        text_layout_load_glyph(&glyph_cache[slot].glyph, code);
+
+        glyph_cache[slot].code = code;
+        glyph_cache[slot].valid = true;
+    }
+
+    return &glyph_cache[slot].glyph;
+}
+
+inline static void text_layout_finish_line(float* w, float* h, float* lw, float* lh, u32* line, u32* linePos, u32* lastAlignPos,
+                                           u32* lines, float* lineWidths, float* lineHeights,
+                                           u32 maxLines) {
+    if(*lw > *w) {
+        *w = *lw;
+    }
+
+    *h += *lh;
+
+    if(*line < maxLines)  {
+        if(lines != NULL) {
+            lines[*line] = *linePos;
+        }
+
+        if(lineWidths != NULL) {
+            lineWidths[*line] = *lw;
+        }
+
+        if(lineHeights != NULL) {
+            lineHeights[*line] = *lh;
+        }
+
+        (*line)++;
+    }
+
+    *lw = 0;
+    *lh = 0;
+    *linePos = 0;
+    *lastAlignPos = 0;
+}
+
+static void text_layout_wrap(u32* lines, float* lineWidths, float* lineHeights, u32* numLines, float* totalWidth, float* totalHeight,
+                             const char* text, u32 maxLines, float maxWidth, float scaleX, float scaleY, bool wordWrap) {
+    scaleX *= font_scale;
+    scaleY *= font_scale;
+
+    float w = 0;
+    float h = 0;
+
+    u32 line = 0;
+    float lw = 0;
+    float lh = 0;
+    u32 linePos = 0;
+    u32 lastAlignPos = 0;
+    int wordPos = -1;
+    float ww = 0;
+
+    const uint8_t* p = (const uint8_t*) text;
+    u32 code = 0;
+    ssize_t units = -1;
+
+    while(*p && (units = decode_utf8(&code, p)) != -1 && code > 0) {
+        p += units;
+
+        float charWidth = 1;
+        if(code == '\t') {
+            code = ' ';
+            charWidth = 4 - (linePos - lastAlignPos) % 4;
+
+            lastAlignPos = linePos;
+        }
+
+        charWidth *= scaleX * text_layout_get_glyph(code)->layoutWidth;
+
+        if(code == '\n' || (wordWrap && lw + charWidth >= maxWidth)) {
+            if(code == '\n') {
+                linePos++;
+                lh = scaleY * line_feed;
+            }
+
+            u32 oldLinePos = linePos;
+
+            if(code != '\n' && wordPos != -1) {
+                linePos = (u32) wordPos;
+                lw -= ww;
+            }
+
+            text_layout_finish_line(&w, &h, &lw, &lh, &line, &linePos, &lastAlignPos,
+                                    lines, lineWidths, lineHeights,
+                                    maxLines);
+
+            if(code != '\n' && wordPos != -1) {
+                linePos = oldLinePos - wordPos;
+                lw = ww;
+            }
+
+            wordPos = -1;
+            ww = 0;
+        }
+
+        if(code == ' ') {
+            wordPos = -1;
+            ww = 0;
+        } else if(wordPos == -1) {
+            wordPos = (int) linePos;
+            ww = 0;
+        }
+
+        if(code != '\n') {
+            if(wordPos != -1) {
+                ww += charWidth;
+            }
+
+            lw += charWidth;
+            lh = scaleY * line_feed;
+
+            linePos++;
+        }
+    }
+
+    if(linePos > 0)  {
+        text_layout_finish_line(&w, &h, &lw, &lh, &line, &linePos, &lastAlignPos,
+                                lines, lineWidths, lineHeights,
+                                maxLines);
+    }
+
+    if(numLines != NULL) {
+        *numLines = line;
+    }
+
+    if(totalWidth != NULL) {
+        *totalWidth = w;
+    }
+
+    if(totalHeight != NULL) {
+        *totalHeight = h;
+    }
+}
+
+static u32 text_layout_hash(const char* text) {
+    // FNV-1a.
+    u32 hash = 2166136261U;
+    for(const u8* p = (const u8*) text; *p; p++) {
+        hash = (hash ^ *p) * 16777619U;
+    }
+
+    return hash;
+}
+
+const text_layout* text_layout_get(const char* text, float scaleX, float scaleY, bool wordWrap, float maxWidth) {
+    if(!wordWrap) {
+        maxWidth = 0;
+    }
+
+    u32 hash = text_layout_hash(text);
+
+    text_layout_entry* victim = &layout_cache[0];
+    for(u32 i = 0; i < TEXT_LAYOUT_CACHE_SIZE; i++) {
+        text_layout_entry* entry = &layout_cache[i];
+
+        if(entry->text != NULL && entry->hash == hash && entry->scaleX == scaleX && entry->scaleY == scaleY
+           && entry->wordWrap == wordWrap && entry->maxWidth == maxWidth && strcmp(entry->text, text) == 0) {
+            entry->lastUsed = ++layout_clock;
+            return &entry->layout;
+        }
+
+        if(victim->text != NULL && (entry->text == NULL || entry->lastUsed < victim->lastUsed)) {
+            victim = entry;
+        }
+    }
+
+    text_layout* layout = &scratch_layout;
+    text_layout_wrap(layout->lines, layout->lineWidths, layout->lineHeights, &layout->numLines, &layout->totalWidth, &layout->totalHeight,
+                     text, TEXT_LAYOUT_MAX_LINES, maxWidth, scaleX, scaleY, wordWrap);
+
+    size_t textSize = strlen(text) + 1;
+    size_t linesSize = layout->numLines * (sizeof(u32) + sizeof(float) + sizeof(float));
+
+    u8* block = (u8*) malloc(linesSize + textSize);
+    if(block == NULL) {
+        return layout;
+    }
+
+    text_layout_free_entry(victim);
+
+    victim->block = block;
+
+    victim->layout.numLines = layout->numLines;
+    victim->layout.totalWidth = layout->totalWidth;
+    victim->layout.totalHeight = layout->totalHeight;
+
+    victim->layout.lines = (u32*) block;
+    victim->layout.lineWidths = (float*) (block + layout->numLines * sizeof(u32));
+    victim->layout.lineHeights = (float*) (block + layout->numLines * (sizeof(u32) + sizeof(float)));
+    memcpy(victim->layout.lines, layout->lines, layout->numLines * sizeof(u32));
+    memcpy(victim->layout.lineWidths, layout->lineWidths, layout->numLines * sizeof(float));
+    memcpy(victim->layout.lineHeights, layout->lineHeights, layout->numLines * sizeof(float));
+
+    victim->text = (char*) (block + linesSize);
+    memcpy(victim->text, text, textSize);
+
+    victim->hash = hash;
+    victim->scaleX = scaleX;
+    victim->scaleY = scaleY;
+    victim->wordWrap = wordWrap;
+    victim->maxWidth = maxWidth;
+    victim->lastUsed = ++layout_clock;
+
+    return &victim->layout;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#define TEXT_LAYOUT_MAX_LINES 64
+#define TEXT_LAYOUT_CACHE_SIZE 64
+
+// System font metrics of one code point, unscaled.
+typedef struct text_glyph_s {
+    // Advance used when laying out lines.
+    u8 layoutWidth;
+
+    // Metrics of the glyph actually drawn, which falls back to U+FFFD when the code point's sheet is unavailable.
+    u32 sheetIndex;
+    s8 left;
+    u8 glyphWidth;
+    u8 charWidth;
+    float texLeft;
+    float texTop;
+    float texRight;
+    float texBottom;
+} text_glyph;
+
+typedef struct text_layout_s {
+    // Code points on each line, including the line break; at most TEXT_LAYOUT_MAX_LINES lines are recorded.
+    u32 numLines;
+    u32* lines;
+    float* lineWidths;
+    float* lineHeights;
+
+    float totalWidth;
+    float totalHeight;
+} text_layout;
+
+// sheetCount is the number of glyph sheets that can be drawn; scale converts font units to screen units at scale 1.
+void text_layout_init(u32 sheetCount, float scale);
+void text_layout_exit();
+
+const text_glyph* text_layout_get_glyph(u32 code);
+// Lays out text at the given scale, wrapping lines at maxWidth when wordWrap is set. The result stays valid until the next call.
+const text_layout* text_layout_get(const char* text, float scaleX, float scaleY, bool wordWrap, float maxWidth);
\ No newline at end of file
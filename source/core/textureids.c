@@ -0,0 +1,109 @@
+#include <string.h>
+
+#include <3ds.h>
+
+#include "screen.h"
+#include "textureids.h"
+
+#define TEXTURE_IDS_WORDS ((MAX_TEXTURES + 31) / 32)
+
+static LightLock texture_lock;
+// One bit per allocated texture ID.
+static u32 texture_bitmap[TEXTURE_IDS_WORDS];
+// Every word before this one is full.
+static u32 texture_free_word;
+static screen_texture_stats texture_stats;
+
+void texture_ids_init() {
+    LightLock_Init(&texture_lock);
+
+    memset(texture_bitmap, 0, sizeof(texture_bitmap));
+    texture_bitmap[0] = 0x1;
+    texture_free_word = 0;
+
+    memset(&texture_stats, 0, sizeof(texture_stats));
+}
+
+u32 texture_ids_allocate() {
+    u32 id = 0;
+
+    LightLock_Lock(&texture_lock);
+
+    for(; texture_free_word < TEXTURE_IDS_WORDS; texture_free_word++) {
+        u32 freeIds = ~texture_bitmap[texture_free_word];
+        if(freeIds != 0) {
+            u32 candidate = texture_free_word * 32 + __builtin_ctz(freeIds);
+            if(candidate < MAX_TEXTURES) {
+                texture_bitmap[texture_free_word] |= 1U << (candidate % 32);
+                id = candidate;
+            }
+
+            break;
+        }
+    }
+
+    LightLock_Unlock(&texture_lock);
+
+    return id;
+}
+
+void texture_ids_set_allocated(u32 id, bool allocated) {
+    if(id >= MAX_TEXTURES) {
+        return;
+    }
+
+    u32 word = id / 32;
+    u32 bit = 1U << (id % 32);
+
+    LightLock_Lock(&texture_lock);
+
+    if(allocated) {
+        texture_bitmap[word] |= bit;
+    } else if(id != 0) {
+        texture_bitmap[word] &= ~bit;
+
+        if(word < texture_free_word) {
+            texture_free_word = word;
+        }
+    }
+
+    LightLock_Unlock(&texture_lock);
+}
+
+void texture_ids_track(GPU_TEXCOLOR format, u32 size, bool created) {
+    u32 index = format < SCREEN_TEXTURE_FORMATS ? format : 0;
+
+    LightLock_Lock(&texture_lock);
+
+    if(created) {
+        texture_stats.liveTextures++;
+        texture_stats.liveBytes += size;
+        texture_stats.formatTextures[index]++;
+        texture_stats.formatBytes[index] += size;
+
+        if(texture_stats.liveTextures > texture_stats.peakTextures) {
+            texture_stats.peakTextures = texture_stats.liveTextures;
+        }
+
+        if(texture_stats.liveBytes > texture_stats.peakBytes) {
+            texture_stats.peakBytes = texture_stats.liveBytes;
+        }
+    } else {
+        texture_stats.liveTextures--;
+        texture_stats.liveBytes -= size;
+        texture_stats.formatTextures[index]--;
+        texture_stats.formatBytes[index] -= size;
+    }
+
+    LightLock_Unlock(&texture_lock);
+}
+
+void texture_ids_get_stats(screen_texture_stats* stats) {
+    if(stats == NULL) {
+        return;
+    }
+
+    LightLock_Lock(&texture_lock);
+    *stats = texture_stats;
+    LightLock_Unlock(&texture_lock);
+}
\ No newline at end of file
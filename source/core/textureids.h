@@ -0,0 +1,15 @@
+#pragma once
+
+typedef struct screen_texture_stats_s screen_texture_stats;
+
+// Hands out texture IDs below MAX_TEXTURES from a bitmap and accounts the memory of the textures behind them.
+// Task threads create textures too, so every call takes a lock.
+void texture_ids_init();
+
+// Returns the lowest free ID, or 0 once every ID is in use; ID 0 itself is never handed out.
+u32 texture_ids_allocate();
+// Fixed resource IDs are claimed directly, so that they are never handed out as well.
+void texture_ids_set_allocated(u32 id, bool allocated);
+
+void texture_ids_track(GPU_TEXCOLOR format, u32 size, bool created);
+void texture_ids_get_stats(screen_texture_stats* stats);
\ No newline at end of file
@@ -6,12 +6,17 @@
 #include "list.h"
 #include "ui.h"
 #include "../screen.h"
+#include "../arraylist.h"
 #include "../linkedlist.h"
 #include "../../fbi/resources.h"
 
 typedef struct {
     void* data;
     linked_list items;
+    // Items by position, rebuilt only when the list has been modified since.
+    array_list index;
+    unsigned int indexModCount;
+    bool indexValid;
     u32 selectedIndex;
     list_item* selectedItem;
     u32 selectionScroll;
@@ -23,7 +28,48 @@ typedef struct {
     void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2, list_item* selected);
 } list_data;
 
+static void list_update_index(list_data* listData) {
+    unsigned int modCount = listData->items.modCount;
+    if(listData->indexValid && listData->indexModCount == modCount) {
+        return;
+    }
+
+    array_list_clear(&listData->index);
+
+    listData->indexValid = array_list_reserve(&listData->index, linked_list_size(&listData->items));
+    if(!listData->indexValid) {
+        return;
+    }
+
+    linked_list_iter iter;
+    linked_list_iterate(&listData->items, &iter);
+
+    while(linked_list_iter_has_next(&iter)) {
+        array_list_add(&listData->index, linked_list_iter_next(&iter));
+    }
+
+    listData->indexModCount = modCount;
+}
+
+static list_item* list_get_item(list_data* listData, u32 index) {
+    if(listData->indexValid) {
+        return array_list_get(&listData->index, index);
+    }
+
+    return linked_list_get(&listData->items, index);
+}
+
+static int list_index_of(list_data* listData, list_item* item) {
+    if(listData->indexValid) {
+        return array_list_index_of(&listData->index, item);
+    }
+
+    return linked_list_index_of(&listData->items, item);
+}
+
 static void list_validate(list_data* listData, float by1, float by2) {
+    list_update_index(listData);
+
     u32 size = linked_list_size(&listData->items);
 
     if(size == 0 || listData->selectedIndex < 0) {
@@ -46,7 +92,8 @@ static void list_validate(list_data* listData, float by1, float by2) {
         if(listData->selectedItem != NULL) {
             u32 oldIndex = listData->selectedIndex;
 
-            int index = linked_list_index_of(&listData->items, listData->selectedItem);
+            // Only search when the selected item has moved.
+            int index = list_get_item(listData, oldIndex) == listData->selectedItem ? (int) oldIndex : list_index_of(listData, listData->selectedItem);
             if(index != -1) {
                 found = true;
                 listData->selectedIndex = (u32) index;
@@ -58,7 +105,7 @@ static void list_validate(list_data* listData, float by1, float by2) {
         }
 
         if(!found) {
-            listData->selectedItem = linked_list_get(&listData->items, listData->selectedIndex);
+            listData->selectedItem = list_get_item(listData, listData->selectedIndex);
 
             listData->selectionScroll = 0;
             listData->nextSelectionScrollResetTime = 0;
@@ -185,7 +232,7 @@ static void list_update(ui_view* view, void* data, float bx1, float by1, float b
         }
 
         if(listData->selectedIndex != lastSelectedIndex) {
-            listData->selectedItem = linked_list_get(&listData->items, listData->selectedIndex);
+            listData->selectedItem = list_get_item(listData, listData->selectedIndex);
 
             listData->selectionScroll = 0;
             listData->nextSelectionScrollResetTime = 0;
@@ -214,19 +261,19 @@ static void list_draw_bottom(ui_view* view, void* data, float x1, float y1, floa
 
     list_validate(listData, y1, y2);
 
+    u32 size = linked_list_size(&listData->items);
     float fontHeight = screen_get_font_height(0.5f);
-    float y = y1 - listData->scrollPos;
 
-    linked_list_iter iter;
-    linked_list_iterate(&listData->items, &iter);
+    // Start at the first row in view rather than walking every row above it.
+    u32 first = (u32) (listData->scrollPos / fontHeight);
+    float y = y1 - listData->scrollPos + first * fontHeight;
 
-    while(linked_list_iter_has_next(&iter)) {
-        if(y > y2) {
+    for(u32 i = first; i < size && y <= y2; i++) {
+        list_item* item = list_get_item(listData, i);
+        if(item == NULL) {
             break;
         }
 
-        list_item* item = linked_list_iter_next(&iter);
-
         if(y > y1 - fontHeight) {
             float x = x1 + 2;
             if(item == listData->selectedItem) {
@@ -245,7 +292,6 @@ static void list_draw_bottom(ui_view* view, void* data, float x1, float y1, floa
         y += fontHeight;
     }
 
-    u32 size = linked_list_size(&listData->items);
     if(size > 0) {
         float totalHeight = size * fontHeight;
         float viewHeight = y2 - y1;
@@ -275,6 +321,9 @@ ui_view* list_display(const char* name, const char* info, void* data, void (*upd
 
     listData->data = data;
     linked_list_init(&listData->items);
+    array_list_init(&listData->index);
+    listData->indexModCount = 0;
+    listData->indexValid = false;
     listData->selectedIndex = 0;
     listData->selectedItem = NULL;
     listData->selectionScroll = 0;
@@ -299,6 +348,7 @@ ui_view* list_display(const char* name, const char* info, void* data, void (*upd
 void list_destroy(ui_view* view) {
     if(view != NULL) {
         linked_list_destroy(&((list_data*) view->data)->items);
+        array_list_destroy(&((list_data*) view->data)->index);
 
         free(view->data);
         ui_destroy(view);
@@ -7,12 +7,15 @@
 
 #include "ui.h"
 #include "../error.h"
+#include "../fs.h"
 #include "../screen.h"
 #include "../data/smdh.h"
 #include "../../fbi/resources.h"
 
 #define MAX_UI_VIEWS 16
 
+#define TEXTURE_STATS_PATH "sdmc:/fbi/texture_stats.txt"
+
 static ui_view* ui_stack[MAX_UI_VIEWS];
 static int ui_stack_top = -1;
 
@@ -24,6 +27,11 @@ static char ui_free_space_buffer[128];
 static u64 ui_fade_begin_time = 0;
 static u8 ui_fade_alpha = 0;
 
+// Toggled with L+R; replaces the free space readout with texture memory use.
+static bool ui_texture_stats_visible = false;
+static const char* ui_texture_stats_status = "Y: Save";
+static char ui_debug_info[128];
+
 void ui_init() {
     if(ui_stack_mutex == 0) {
         svcCreateMutex(&ui_stack_mutex, false);
@@ -256,10 +264,33 @@ static void ui_draw_top(ui_view* ui) {
         ui_free_space_last_update = osGetTime();
     }
 
-    float freeSpaceHeight;
-    screen_get_string_size(NULL, &freeSpaceHeight, ui_free_space_buffer, 0.35f, 0.35f);
+    const char* bottomBarText = ui_free_space_buffer;
+
+    char textureStatsText[128];
+    if(ui_texture_stats_visible) {
+        screen_texture_stats stats;
+        screen_get_texture_stats(&stats);
+
+        snprintf(textureStatsText, sizeof(textureStatsText), "Textures: %lu (peak %lu), %.1f %s (peak %.1f %s) - %s",
+                 stats.liveTextures, stats.peakTextures,
+                 ui_get_display_size(stats.liveBytes), ui_get_display_size_units(stats.liveBytes),
+                 ui_get_display_size(stats.peakBytes), ui_get_display_size_units(stats.peakBytes),
+                 ui_texture_stats_status);
+
+        bottomBarText = textureStatsText;
+
+        if(ui_debug_info[0] != '\0') {
+            float debugInfoHeight;
+            screen_get_string_size(NULL, &debugInfoHeight, ui_debug_info, 0.35f, 0.35f);
+
+            screen_draw_string(ui_debug_info, topScreenBottomBarX + 2, topScreenBottomBarY - topScreenBottomBarShadowHeight - debugInfoHeight, 0.35f, 0.35f, COLOR_TEXT, true);
+        }
+    }
+
+    float bottomBarTextHeight;
+    screen_get_string_size(NULL, &bottomBarTextHeight, bottomBarText, 0.35f, 0.35f);
 
-    screen_draw_string(ui_free_space_buffer, topScreenBottomBarX + 2, topScreenBottomBarY + (topScreenBottomBarHeight - freeSpaceHeight) / 2, 0.35f, 0.35f, COLOR_TEXT, true);
+    screen_draw_string(bottomBarText, topScreenBottomBarX + 2, topScreenBottomBarY + (topScreenBottomBarHeight - bottomBarTextHeight) / 2, 0.35f, 0.35f, COLOR_TEXT, true);
 
     screen_set_base_alpha(0xFF);
 }
@@ -335,11 +366,48 @@ static void ui_draw_bottom(ui_view* ui) {
     screen_set_base_alpha(0xFF);
 }
 
+static void ui_save_texture_stats() {
+    FS_Archive sdmcArchive = 0;
+    if(R_SUCCEEDED(FSUSER_OpenArchive(&sdmcArchive, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, "")))) {
+        fs_ensure_dir(sdmcArchive, "/fbi/");
+
+        FSUSER_CloseArchive(sdmcArchive);
+    }
+
+    FILE* fd = fopen(TEXTURE_STATS_PATH, "w");
+    if(fd != NULL) {
+        screen_dump_texture_stats(fd);
+
+        if(ui_debug_info[0] != '\0') {
+            fprintf(fd, "\n%s\n", ui_debug_info);
+        }
+
+        fclose(fd);
+
+        ui_texture_stats_status = "Saved to " TEXTURE_STATS_PATH;
+    } else {
+        ui_texture_stats_status = "Failed to save";
+    }
+}
+
+void ui_set_debug_info(const char* text) {
+    snprintf(ui_debug_info, sizeof(ui_debug_info), "%s", text != NULL ? text : "");
+}
+
 bool ui_update() {
     ui_view* ui = NULL;
 
     hidScanInput();
 
+    if((hidKeysHeld() & (KEY_L | KEY_R)) == (KEY_L | KEY_R) && (hidKeysDown() & (KEY_L | KEY_R)) != 0) {
+        ui_texture_stats_visible = !ui_texture_stats_visible;
+        ui_texture_stats_status = "Y: Save";
+    }
+
+    if(ui_texture_stats_visible && (hidKeysDown() & KEY_Y)) {
+        ui_save_texture_stats();
+    }
+
     ui = ui_top();
     if(ui != NULL && ui->update != NULL) {
         u32 bottomScreenTopBarHeight = 0;
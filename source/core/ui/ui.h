@@ -21,6 +21,8 @@ ui_view* ui_top();
 bool ui_push(ui_view* view);
 void ui_pop();
 bool ui_update();
+// Shown above the top screen's bottom bar while the debug overlay is open, and added to its saved report.
+void ui_set_debug_info(const char* text);
 
 const char* ui_get_display_eta(u32 seconds);
 double ui_get_display_size(u64 size);
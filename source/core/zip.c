@@ -0,0 +1,586 @@
+#include <malloc.h>
+#include <string.h>
+
+#include <3ds.h>
+#include <zlib.h>
+
+#include "fs.h"
+#include "zip.h"
+#include "error.h"
+#include "stringutil.h"
+
+#define ZIP_LOCAL_HEADER_MAGIC 0x04034B50
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_DIRECTORY_ENTRY_MAGIC 0x02014B50
+#define ZIP_DIRECTORY_ENTRY_SIZE 46
+#define ZIP_END_MAGIC 0x06054B50
+#define ZIP_END_SIZE 22
+#define ZIP_END_SEARCH_MAX (ZIP_END_SIZE + 0xFFFF)
+#define ZIP64_END_LOCATOR_MAGIC 0x07064B50
+#define ZIP64_END_LOCATOR_SIZE 20
+#define ZIP64_END_MAGIC 0x06064B50
+#define ZIP64_END_SIZE 56
+#define ZIP64_EXTRA_ID 0x0001
+
+#define ZIP_FLAG_ENCRYPTED 0x1
+
+// Central directories above this are not worth indexing on a console.
+#define ZIP_DIRECTORY_MAX (8 * 1024 * 1024)
+
+#define GZIP_HEADER_SIZE 10
+#define GZIP_HEADER_MAX (64 * 1024)
+#define GZIP_TRAILER_SIZE 8
+#define GZIP_FLAG_HEADER_CRC 0x02
+#define GZIP_FLAG_EXTRA 0x04
+#define GZIP_FLAG_NAME 0x08
+#define GZIP_FLAG_COMMENT 0x10
+
+#define ZIP_INPUT_SIZE (64 * 1024)
+
+struct zip_reader_s {
+    Handle handle;
+    zip_entry entry;
+
+    u64 dataOffset;
+    u64 consumed;
+    u64 produced;
+    u32 crc;
+    bool finished;
+
+    bool inflateInit;
+    bool inflateEnded;
+    z_stream inflate;
+    u8 input[ZIP_INPUT_SIZE];
+};
+
+static u16 zip_get_u16(const u8* data) {
+    return (u16) (data[0] | (data[1] << 8));
+}
+
+static u32 zip_get_u32(const u8* data) {
+    return (u32) zip_get_u16(data) | ((u32) zip_get_u16(data + 2) << 16);
+}
+
+static u64 zip_get_u64(const u8* data) {
+    return (u64) zip_get_u32(data) | ((u64) zip_get_u32(data + 4) << 32);
+}
+
+static Result zip_read_fully(Handle handle, u64 offset, void* buffer, u32 size) {
+    Result res = 0;
+
+    u32 bytesRead = 0;
+    if(R_SUCCEEDED(res = FSFILE_Read(handle, &bytesRead, offset, buffer, size)) && bytesRead != size) {
+        res = R_APP_BAD_DATA;
+    }
+
+    return res;
+}
+
+static void zip_get_base_name(char* out, const char* path, size_t size) {
+    const char* slash = strrchr(path, '/');
+    string_copy(out, slash != NULL ? slash + 1 : path, size);
+}
+
+static Result zip_find_directory(Handle handle, u64 fileSize, u64* directoryOffset, u64* directorySize, u64* entryCount) {
+    Result res = 0;
+
+    u32 tailSize = fileSize < ZIP_END_SEARCH_MAX ? (u32) fileSize : ZIP_END_SEARCH_MAX;
+    if(tailSize < ZIP_END_SIZE) {
+        return R_APP_BAD_DATA;
+    }
+
+    u8* tail = (u8*) calloc(1, tailSize);
+    if(tail == NULL) {
+        return R_APP_OUT_OF_MEMORY;
+    }
+
+    u64 tailOffset = fileSize - tailSize;
+    if(R_SUCCEEDED(res = zip_read_fully(handle, tailOffset, tail, tailSize))) {
+        // The end record sits behind a variable-length comment, so scan back for its signature.
+        s64 end = -1;
+        for(s64 i = tailSize - ZIP_END_SIZE; i >= 0; i--) {
+            if(zip_get_u32(&tail[i]) == ZIP_END_MAGIC) {
+                end = i;
+                break;
+            }
+        }
+
+        if(end >= 0) {
+            *entryCount = zip_get_u16(&tail[end + 10]);
+            *directorySize = zip_get_u32(&tail[end + 12]);
+            *directoryOffset = zip_get_u32(&tail[end + 16]);
+
+            if(end >= ZIP64_END_LOCATOR_SIZE && zip_get_u32(&tail[end - ZIP64_END_LOCATOR_SIZE]) == ZIP64_END_LOCATOR_MAGIC) {
+                u8 zip64End[ZIP64_END_SIZE];
+                if(R_SUCCEEDED(res = zip_read_fully(handle, zip_get_u64(&tail[end - ZIP64_END_LOCATOR_SIZE + 8]), zip64End, sizeof(zip64End)))) {
+                    if(zip_get_u32(zip64End) == ZIP64_END_MAGIC) {
+                        *entryCount = zip_get_u64(&zip64End[32]);
+                        *directorySize = zip_get_u64(&zip64End[40]);
+                        *directoryOffset = zip_get_u64(&zip64End[48]);
+                    } else {
+                        res = R_APP_BAD_DATA;
+                    }
+                }
+            }
+
+            if(R_SUCCEEDED(res) && (*directorySize > ZIP_DIRECTORY_MAX || *directoryOffset + *directorySize > fileSize)) {
+                res = R_APP_BAD_DATA;
+            }
+        } else {
+            res = R_APP_BAD_DATA;
+        }
+    }
+
+    free(tail);
+    return res;
+}
+
+static void zip_parse_zip64_extra(zip_entry* entry, const u8* extra, u32 extraSize, bool sizeMissing, bool compressedSizeMissing, bool offsetMissing) {
+    u32 pos = 0;
+    while(pos + 4 <= extraSize) {
+        u16 id = zip_get_u16(&extra[pos]);
+        u16 size = zip_get_u16(&extra[pos + 2]);
+        pos += 4;
+
+        if(pos + size > extraSize) {
+            break;
+        }
+
+        // Only the fields saturated in the directory entry are present, in this order.
+        if(id == ZIP64_EXTRA_ID) {
+            u32 field = pos;
+            if(sizeMissing && field + 8 <= pos + size) {
+                entry->size = zip_get_u64(&extra[field]);
+                field += 8;
+            }
+
+            if(compressedSizeMissing && field + 8 <= pos + size) {
+                entry->compressedSize = zip_get_u64(&extra[field]);
+                field += 8;
+            }
+
+            if(offsetMissing && field + 8 <= pos + size) {
+                entry->offset = zip_get_u64(&extra[field]);
+            }
+
+            break;
+        }
+
+        pos += size;
+    }
+}
+
+static Result zip_get_zip_entries(zip_entry** entries, u32* count, Handle handle, u64 fileSize, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData) {
+    Result res = 0;
+
+    u64 directoryOffset = 0;
+    u64 directorySize = 0;
+    u64 entryCount = 0;
+    if(R_FAILED(res = zip_find_directory(handle, fileSize, &directoryOffset, &directorySize, &entryCount))) {
+        return res;
+    }
+
+    if(entryCount > directorySize / ZIP_DIRECTORY_ENTRY_SIZE) {
+        return R_APP_BAD_DATA;
+    }
+
+    // The whole directory is read at once and indexed in memory; entry data is only touched when installed.
+    u8* directory = (u8*) calloc(1, directorySize > 0 ? (size_t) directorySize : 1);
+    if(directory == NULL) {
+        return R_APP_OUT_OF_MEMORY;
+    }
+
+    zip_entry* list = NULL;
+    u32 listCount = 0;
+
+    if(R_SUCCEEDED(res = zip_read_fully(handle, directoryOffset, directory, (u32) directorySize))) {
+        list = (zip_entry*) calloc(entryCount > 0 ? (size_t) entryCount : 1, sizeof(zip_entry));
+        if(list != NULL) {
+            u32 pos = 0;
+            for(u64 i = 0; i < entryCount && R_SUCCEEDED(res); i++) {
+                if(pos + ZIP_DIRECTORY_ENTRY_SIZE > directorySize || zip_get_u32(&directory[pos]) != ZIP_DIRECTORY_ENTRY_MAGIC) {
+                    res = R_APP_BAD_DATA;
+                    break;
+                }
+
+                u8* record = &directory[pos];
+                u16 flags = zip_get_u16(&record[8]);
+                u16 method = zip_get_u16(&record[10]);
+                u16 nameLen = zip_get_u16(&record[28]);
+                u16 extraLen = zip_get_u16(&record[30]);
+                u16 commentLen = zip_get_u16(&record[32]);
+
+                u32 next = pos + ZIP_DIRECTORY_ENTRY_SIZE + nameLen + extraLen + commentLen;
+                if(next > directorySize) {
+                    res = R_APP_BAD_DATA;
+                    break;
+                }
+
+                char path[FILE_PATH_MAX];
+                u32 pathLen = nameLen < sizeof(path) - 1 ? nameLen : sizeof(path) - 1;
+                memcpy(path, &record[ZIP_DIRECTORY_ENTRY_SIZE], pathLen);
+                path[pathLen] = '\0';
+
+                size_t len = strlen(path);
+                u32 attributes = len > 0 && path[len - 1] == '/' ? FS_ATTRIBUTE_DIRECTORY : 0;
+
+                // Encrypted entries and other compression methods cannot be streamed.
+                if(!(flags & ZIP_FLAG_ENCRYPTED) && (method == ZIP_METHOD_STORED || method == ZIP_METHOD_DEFLATE)
+                   && (filter == NULL || filter(filterData, path, attributes))) {
+                    zip_entry* entry = &list[listCount++];
+                    zip_get_base_name(entry->name, path, sizeof(entry->name));
+                    entry->method = method;
+                    entry->crc = zip_get_u32(&record[16]);
+                    entry->compressedSize = zip_get_u32(&record[20]);
+                    entry->size = zip_get_u32(&record[24]);
+                    entry->offset = zip_get_u32(&record[42]);
+                    entry->gzip = false;
+
+                    zip_parse_zip64_extra(entry, &record[ZIP_DIRECTORY_ENTRY_SIZE + nameLen], extraLen,
+                                          entry->size == 0xFFFFFFFF, entry->compressedSize == 0xFFFFFFFF, entry->offset == 0xFFFFFFFF);
+                }
+
+                pos = next;
+            }
+        } else {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+    }
+
+    free(directory);
+
+    if(R_SUCCEEDED(res)) {
+        *entries = list;
+        *count = listCount;
+    } else if(list != NULL) {
+        free(list);
+    }
+
+    return res;
+}
+
+static Result zip_get_gzip_entries(zip_entry** entries, u32* count, Handle handle, u64 fileSize, const char* name, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData) {
+    Result res = 0;
+
+    u32 headerSize = fileSize < GZIP_HEADER_MAX ? (u32) fileSize : GZIP_HEADER_MAX;
+    if(headerSize < GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE) {
+        return R_APP_BAD_DATA;
+    }
+
+    u8* header = (u8*) calloc(1, headerSize);
+    if(header == NULL) {
+        return R_APP_OUT_OF_MEMORY;
+    }
+
+    zip_entry* entry = NULL;
+    u8 trailer[GZIP_TRAILER_SIZE];
+
+    if(R_SUCCEEDED(res = zip_read_fully(handle, 0, header, headerSize))
+       && R_SUCCEEDED(res = zip_read_fully(handle, fileSize - GZIP_TRAILER_SIZE, trailer, sizeof(trailer)))) {
+        if(header[2] == Z_DEFLATED) {
+            entry = (zip_entry*) calloc(1, sizeof(zip_entry));
+            if(entry != NULL) {
+                u8 flags = header[3];
+                u32 pos = GZIP_HEADER_SIZE;
+
+                if((flags & GZIP_FLAG_EXTRA) && pos + 2 <= headerSize) {
+                    pos += 2 + zip_get_u16(&header[pos]);
+                }
+
+                if(flags & GZIP_FLAG_NAME) {
+                    u32 start = pos;
+                    while(pos < headerSize && header[pos] != '\0') {
+                        pos++;
+                    }
+
+                    if(pos < headerSize) {
+                        zip_get_base_name(entry->name, (const char*) &header[start], sizeof(entry->name));
+                    }
+
+                    pos++;
+                }
+
+                if(flags & GZIP_FLAG_COMMENT) {
+                    while(pos < headerSize && header[pos] != '\0') {
+                        pos++;
+                    }
+
+                    pos++;
+                }
+
+                if(flags & GZIP_FLAG_HEADER_CRC) {
+                    pos += 2;
+                }
+
+                // Without a stored name, the member is named after the file minus its extension.
+                if(string_is_empty(entry->name)) {
+                    string_copy(entry->name, name, sizeof(entry->name));
+
+                    size_t len = strlen(entry->name);
+                    if(len >= 3 && strncasecmp(entry->name + len - 3, ".gz", 3) == 0) {
+                        entry->name[len - 3] = '\0';
+                    }
+                }
+
+                if(pos + GZIP_TRAILER_SIZE <= fileSize) {
+                    entry->offset = pos;
+                    entry->compressedSize = fileSize - pos - GZIP_TRAILER_SIZE;
+                    // ISIZE only holds the low 32 bits of the uncompressed size.
+                    entry->size = zip_get_u32(&trailer[4]);
+                    entry->method = ZIP_METHOD_DEFLATE;
+                    entry->crc = zip_get_u32(&trailer[0]);
+                    entry->gzip = true;
+                } else {
+                    res = R_APP_BAD_DATA;
+                }
+            } else {
+                res = R_APP_OUT_OF_MEMORY;
+            }
+        } else {
+            res = R_APP_BAD_DATA;
+        }
+    }
+
+    free(header);
+
+    if(R_SUCCEEDED(res)) {
+        *entries = entry;
+        *count = filter == NULL || filter(filterData, entry->name, 0) ? 1 : 0;
+    } else if(entry != NULL) {
+        free(entry);
+    }
+
+    return res;
+}
+
+Result zip_file_get_entries(zip_entry** entries, u32* count, Handle handle, const char* name, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData) {
+    if(entries == NULL || count == NULL || name == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    Result res = 0;
+
+    u64 fileSize = 0;
+    u8 magic[2];
+    if(R_SUCCEEDED(res = FSFILE_GetSize(handle, &fileSize)) && R_SUCCEEDED(res = zip_read_fully(handle, 0, magic, sizeof(magic)))) {
+        if(magic[0] == 0x1F && magic[1] == 0x8B) {
+            res = zip_get_gzip_entries(entries, count, handle, fileSize, name, filter, filterData);
+        } else {
+            res = zip_get_zip_entries(entries, count, handle, fileSize, filter, filterData);
+        }
+    }
+
+    return res;
+}
+
+static Result zip_reader_rewind(zip_reader* reader) {
+    reader->consumed = 0;
+    reader->produced = 0;
+    reader->crc = crc32(0, Z_NULL, 0);
+    reader->finished = false;
+
+    if(reader->entry.method == ZIP_METHOD_DEFLATE) {
+        if(reader->inflateInit) {
+            if(inflateReset(&reader->inflate) != Z_OK) {
+                return R_APP_BAD_DATA;
+            }
+        } else {
+            if(inflateInit2(&reader->inflate, -MAX_WBITS) != Z_OK) {
+                return R_APP_OUT_OF_MEMORY;
+            }
+
+            reader->inflateInit = true;
+        }
+
+        reader->inflate.next_in = reader->input;
+        reader->inflate.avail_in = 0;
+        reader->inflateEnded = false;
+    }
+
+    return 0;
+}
+
+static Result zip_reader_inflate(zip_reader* reader, u8* buffer, u32 size, u32* produced) {
+    Result res = 0;
+
+    reader->inflate.next_out = buffer;
+    reader->inflate.avail_out = size;
+
+    while(reader->inflate.avail_out > 0 && !reader->inflateEnded && R_SUCCEEDED(res)) {
+        if(reader->inflate.avail_in == 0) {
+            u64 remaining = reader->entry.compressedSize - reader->consumed;
+            if(remaining == 0) {
+                res = R_APP_BAD_DATA;
+                break;
+            }
+
+            u32 inputSize = remaining < ZIP_INPUT_SIZE ? (u32) remaining : ZIP_INPUT_SIZE;
+            if(R_FAILED(res = zip_read_fully(reader->handle, reader->dataOffset + reader->consumed, reader->input, inputSize))) {
+                break;
+            }
+
+            reader->consumed += inputSize;
+            reader->inflate.next_in = reader->input;
+            reader->inflate.avail_in = inputSize;
+        }
+
+        int ret = inflate(&reader->inflate, Z_NO_FLUSH);
+        if(ret == Z_STREAM_END) {
+            reader->inflateEnded = true;
+        } else if(ret != Z_OK) {
+            res = R_APP_BAD_DATA;
+        }
+    }
+
+    *produced = size - reader->inflate.avail_out;
+    return res;
+}
+
+static Result zip_reader_produce(zip_reader* reader, u8* buffer, u32 size, u32* produced) {
+    Result res = 0;
+
+    u64 remaining = reader->entry.size - reader->produced;
+    if(size > remaining) {
+        size = (u32) remaining;
+    }
+
+    if(reader->entry.method == ZIP_METHOD_STORED) {
+        res = zip_read_fully(reader->handle, reader->dataOffset + reader->produced, buffer, size);
+        *produced = R_SUCCEEDED(res) ? size : 0;
+    } else {
+        res = zip_reader_inflate(reader, buffer, size, produced);
+    }
+
+    if(R_SUCCEEDED(res)) {
+        reader->crc = crc32(reader->crc, buffer, *produced);
+        reader->produced += *produced;
+
+        // The last bytes are only handed out once the stream has been checked against its size and CRC.
+        if(reader->produced == reader->entry.size && !reader->finished) {
+            if(reader->entry.method == ZIP_METHOD_DEFLATE && !reader->inflateEnded) {
+                u8 extra = 0;
+                u32 extraProduced = 0;
+                if(R_SUCCEEDED(res = zip_reader_inflate(reader, &extra, sizeof(extra), &extraProduced))
+                   && (extraProduced != 0 || !reader->inflateEnded)) {
+                    res = R_APP_BAD_DATA;
+                }
+            }
+
+            if(R_SUCCEEDED(res) && reader->crc != reader->entry.crc) {
+                res = R_APP_BAD_DATA;
+            }
+
+            reader->finished = true;
+        } else if(size > 0 && *produced == 0) {
+            res = R_APP_BAD_DATA;
+        }
+    }
+
+    return res;
+}
+
+Result zip_reader_open(zip_reader** reader, Handle handle, zip_entry* entry) {
+    if(reader == NULL || entry == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    Result res = 0;
+
+    zip_reader* zipReader = (zip_reader*) calloc(1, sizeof(zip_reader));
+    if(zipReader != NULL) {
+        zipReader->handle = handle;
+        zipReader->entry = *entry;
+
+        if(entry->gzip) {
+            zipReader->dataOffset = entry->offset;
+        } else {
+            u8 localHeader[ZIP_LOCAL_HEADER_SIZE];
+            if(R_SUCCEEDED(res = zip_read_fully(handle, entry->offset, localHeader, sizeof(localHeader)))) {
+                if(zip_get_u32(localHeader) == ZIP_LOCAL_HEADER_MAGIC) {
+                    // Local name and extra field lengths may differ from the central directory's.
+                    zipReader->dataOffset = entry->offset + ZIP_LOCAL_HEADER_SIZE + zip_get_u16(&localHeader[26]) + zip_get_u16(&localHeader[28]);
+                } else {
+                    res = R_APP_BAD_DATA;
+                }
+            }
+        }
+
+        if(R_SUCCEEDED(res) && R_SUCCEEDED(res = zip_reader_rewind(zipReader))) {
+            *reader = zipReader;
+        } else {
+            zipReader->handle = 0;
+            zip_reader_close(zipReader);
+        }
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    if(R_FAILED(res)) {
+        FSFILE_Close(handle);
+    }
+
+    return res;
+}
+
+Result zip_reader_read(zip_reader* reader, u32* bytesRead, void* buffer, u64 offset, u32 size) {
+    if(reader == NULL || bytesRead == NULL || buffer == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    if(offset > reader->entry.size) {
+        return R_APP_OUT_OF_RANGE;
+    }
+
+    *bytesRead = 0;
+    if(size == 0) {
+        return 0;
+    }
+
+    Result res = 0;
+
+    if(offset < reader->produced && R_FAILED(res = zip_reader_rewind(reader))) {
+        return res;
+    }
+
+    // Skipped bytes are decompressed into the caller's buffer and dropped.
+    while(reader->produced < offset && R_SUCCEEDED(res)) {
+        u64 skip = offset - reader->produced;
+
+        u32 skipped = 0;
+        res = zip_reader_produce(reader, (u8*) buffer, skip < size ? (u32) skip : size, &skipped);
+    }
+
+    if(R_SUCCEEDED(res)) {
+        res = zip_reader_produce(reader, (u8*) buffer, size, bytesRead);
+    }
+
+    return res;
+}
+
+Result zip_reader_get_size(zip_reader* reader, u64* size) {
+    if(reader == NULL || size == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    *size = reader->entry.size;
+    return 0;
+}
+
+Result zip_reader_close(zip_reader* reader) {
+    if(reader == NULL) {
+        return R_APP_INVALID_ARGUMENT;
+    }
+
+    Result res = 0;
+
+    if(reader->handle != 0) {
+        res = FSFILE_Close(reader->handle);
+    }
+
+    if(reader->inflateInit) {
+        inflateEnd(&reader->inflate);
+    }
+
+    free(reader);
+    return res;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#define ZIP_METHOD_STORED 0
+#define ZIP_METHOD_DEFLATE 8
+
+typedef struct zip_entry_s {
+    char name[FILE_NAME_MAX];
+
+    // Offset of the entry's local header; for gzip, of the deflate stream itself.
+    u64 offset;
+    u64 compressedSize;
+    u64 size;
+    u16 method;
+    u32 crc;
+    bool gzip;
+} zip_entry;
+
+typedef struct zip_reader_s zip_reader;
+
+// Lists the entries of a ZIP file from its central directory, or the single member of a gzip file named name.
+// Entries are kept when filter accepts their path; the returned array is freed by the caller.
+Result zip_file_get_entries(zip_entry** entries, u32* count, Handle handle, const char* name, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData);
+
+// Streams an entry's decompressed bytes; the reader takes ownership of handle and closes it.
+Result zip_reader_open(zip_reader** reader, Handle handle, zip_entry* entry);
+// Reads are expected in order; other offsets are reached by decompressing again from the start.
+Result zip_reader_read(zip_reader* reader, u32* bytesRead, void* buffer, u64 offset, u32 size);
+Result zip_reader_get_size(zip_reader* reader, u64* size);
+Result zip_reader_close(zip_reader* reader);
\ No newline at end of file
@@ -18,6 +18,7 @@ void action_install_cia(linked_list* items, list_item* selected);
 void action_install_cia_delete(linked_list* items, list_item* selected);
 void action_install_cias(linked_list* items, list_item* selected, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData);
 void action_install_cias_delete(linked_list* items, list_item* selected, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData);
+void action_install_zip_cias(linked_list* items, list_item* selected);
 void action_install_ticket(linked_list* items, list_item* selected);
 void action_install_ticket_delete(linked_list* items, list_item* selected);
 void action_install_tickets(linked_list* items, list_item* selected, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData);
@@ -53,4 +54,9 @@ void action_delete_secure_value(linked_list* items, list_item* selected);
 void action_install_url(const char* confirmMessage, const char* urls, const char* paths, void* userData,
                         void (*finishedURL)(void* data, u32 index),
                         void (*finishedAll)(void* data),
-                        void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2, u32 index));
\ No newline at end of file
+                        void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2, u32 index));
+void action_install_push(const char* confirmMessage, const char* names, void* userData,
+                         Result (*downloadSrc)(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                      Result (*checkRunning)(void* userData),
+                                                                                                      Result (*progress)(void* userData, u64 total, u64 curr)),
+                         void (*finishedAll)(void* data));
\ No newline at end of file
@@ -16,6 +16,7 @@ typedef struct {
     file_info* target;
 
     linked_list contents;
+    array_list contentsIndex;
 
     data_op_data deleteInfo;
 } delete_data;
@@ -25,7 +26,7 @@ static void action_delete_draw_top(ui_view* view, void* data, float x1, float y1
 
     u32 curr = deleteData->deleteInfo.processed;
     if(curr < deleteData->deleteInfo.total) {
-        task_draw_file_info(view, ((list_item*) linked_list_get(&deleteData->contents, linked_list_size(&deleteData->contents) - curr - 1))->data, x1, y1, x2, y2);
+        task_draw_file_info(view, ((list_item*) array_list_get(&deleteData->contentsIndex, array_list_size(&deleteData->contentsIndex) - curr - 1))->data, x1, y1, x2, y2);
     } else {
         task_draw_file_info(view, deleteData->target, x1, y1, x2, y2);
     }
@@ -36,7 +37,7 @@ static Result action_delete_delete(void* data, u32 index) {
 
     Result res = 0;
 
-    file_info* info = (file_info*) ((list_item*) linked_list_get(&deleteData->contents, linked_list_size(&deleteData->contents) - index - 1))->data;
+    file_info* info = (file_info*) ((list_item*) array_list_get(&deleteData->contentsIndex, array_list_size(&deleteData->contentsIndex) - index - 1))->data;
 
     FS_Path* fsPath = fs_make_path_utf8(info->path);
     if(fsPath != NULL) {
@@ -85,6 +86,7 @@ static bool action_delete_error(void* data, u32 index, Result res, ui_view** err
 static void action_delete_free_data(delete_data* data) {
     task_clear_files(&data->contents);
     linked_list_destroy(&data->contents);
+    array_list_destroy(&data->contentsIndex);
 
     if(data->targetItem != NULL) {
         task_free_file(data->targetItem);
@@ -157,13 +159,18 @@ static void action_delete_loading_update(ui_view* view, void* data, float* progr
         ui_pop();
         info_destroy(view);
 
-        if(R_SUCCEEDED(loadingData->popData.result)) {
-            loadingData->deleteData->deleteInfo.total = linked_list_size(&loadingData->deleteData->contents);
+        Result res = loadingData->popData.result;
+        if(R_SUCCEEDED(res) && !array_list_add_all(&loadingData->deleteData->contentsIndex, &loadingData->deleteData->contents)) {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+
+        if(R_SUCCEEDED(res)) {
+            loadingData->deleteData->deleteInfo.total = array_list_size(&loadingData->deleteData->contentsIndex);
             loadingData->deleteData->deleteInfo.processed = loadingData->deleteData->deleteInfo.total;
 
             prompt_display_yes_no("Confirmation", loadingData->message, COLOR_TEXT, loadingData->deleteData, action_delete_draw_top, action_delete_onresponse);
         } else {
-            error_display_res(NULL, NULL, loadingData->popData.result, "Failed to populate content list.");
+            error_display_res(NULL, NULL, res, "Failed to populate content list.");
 
             action_delete_free_data(loadingData->deleteData);
         }
@@ -214,6 +221,7 @@ static void action_delete_internal(linked_list* items, list_item* selected, cons
     data->deleteInfo.finished = false;
 
     linked_list_init(&data->contents);
+    array_list_init(&data->contentsIndex);
 
     delete_loading_data* loadingData = (delete_loading_data*) calloc(1, sizeof(delete_loading_data));
     if(loadingData == NULL) {
@@ -14,6 +14,7 @@ typedef struct {
     list_item* selected;
 
     linked_list contents;
+    array_list contentsIndex;
     bool all;
 
     data_op_data deleteInfo;
@@ -24,14 +25,14 @@ static void action_delete_pending_titles_draw_top(ui_view* view, void* data, flo
 
     u32 index = deleteData->deleteInfo.processed;
     if(index < deleteData->deleteInfo.total) {
-        task_draw_pending_title_info(view, (pending_title_info*) ((list_item*) linked_list_get(&deleteData->contents, index))->data, x1, y1, x2, y2);
+        task_draw_pending_title_info(view, (pending_title_info*) ((list_item*) array_list_get(&deleteData->contentsIndex, index))->data, x1, y1, x2, y2);
     }
 }
 
 static Result action_delete_pending_titles_delete(void* data, u32 index) {
     delete_pending_titles_data* deleteData = (delete_pending_titles_data*) data;
 
-    list_item* item = (list_item*) linked_list_get(&deleteData->contents, index);
+    list_item* item = (list_item*) array_list_get(&deleteData->contentsIndex, index);
     pending_title_info* info = (pending_title_info*) item->data;
 
     Result res = 0;
@@ -73,6 +74,7 @@ static void action_delete_pending_titles_free_data(delete_pending_titles_data* d
     }
 
     linked_list_destroy(&data->contents);
+    array_list_destroy(&data->contentsIndex);
     free(data);
 }
 
@@ -136,13 +138,18 @@ static void action_delete_pending_titles_loading_update(ui_view* view, void* dat
         ui_pop();
         info_destroy(view);
 
-        if(R_SUCCEEDED(loadingData->popData.result)) {
-            loadingData->deleteData->deleteInfo.total = linked_list_size(&loadingData->deleteData->contents);
+        Result res = loadingData->popData.result;
+        if(R_SUCCEEDED(res) && !array_list_add_all(&loadingData->deleteData->contentsIndex, &loadingData->deleteData->contents)) {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+
+        if(R_SUCCEEDED(res)) {
+            loadingData->deleteData->deleteInfo.total = array_list_size(&loadingData->deleteData->contentsIndex);
             loadingData->deleteData->deleteInfo.processed = loadingData->deleteData->deleteInfo.total;
 
             prompt_display_yes_no("Confirmation", loadingData->message, COLOR_TEXT, loadingData->deleteData, action_delete_pending_titles_draw_top, action_delete_pending_titles_onresponse);
         } else {
-            error_display_res(NULL, NULL, loadingData->popData.result, "Failed to populate pending title list.");
+            error_display_res(NULL, NULL, res, "Failed to populate pending title list.");
 
             action_delete_pending_titles_free_data(loadingData->deleteData);
         }
@@ -185,6 +192,7 @@ void action_delete_pending_titles(linked_list* items, list_item* selected, const
     data->deleteInfo.finished = true;
 
     linked_list_init(&data->contents);
+    array_list_init(&data->contentsIndex);
 
     if(all) {
         delete_pending_titles_loading_data* loadingData = (delete_pending_titles_loading_data*) calloc(1, sizeof(delete_pending_titles_loading_data));
@@ -212,8 +220,9 @@ void action_delete_pending_titles(linked_list* items, list_item* selected, const
         info_display("Loading", "Press B to cancel.", false, loadingData, action_delete_pending_titles_loading_update, action_delete_pending_titles_loading_draw_top);
     } else {
         linked_list_add(&data->contents, selected);
+        array_list_add(&data->contentsIndex, selected);
 
-        data->deleteInfo.total = 1;
+        data->deleteInfo.total = array_list_size(&data->contentsIndex);
         data->deleteInfo.processed = data->deleteInfo.total;
 
         prompt_display_yes_no("Confirmation", message, COLOR_TEXT, data, action_delete_pending_titles_draw_top, action_delete_pending_titles_onresponse);
@@ -13,6 +13,7 @@ typedef struct {
     bool unused;
 
     linked_list contents;
+    array_list contentsIndex;
 
     data_op_data deleteInfo;
 } delete_tickets_data;
@@ -22,7 +23,7 @@ static void action_delete_tickets_draw_top(ui_view* view, void* data, float x1,
 
     u32 curr = deleteData->deleteInfo.processed;
     if(curr < deleteData->deleteInfo.total) {
-        task_draw_ticket_info(view, ((list_item*) linked_list_get(&deleteData->contents, curr))->data, x1, y1, x2, y2);
+        task_draw_ticket_info(view, ((list_item*) array_list_get(&deleteData->contentsIndex, curr))->data, x1, y1, x2, y2);
     }
 }
 
@@ -31,7 +32,7 @@ static Result action_delete_tickets_delete(void* data, u32 index) {
 
     Result res = 0;
 
-    u64 titleId = ((ticket_info*) ((list_item*) linked_list_get(&deleteData->contents, index))->data)->titleId;
+    u64 titleId = ((ticket_info*) ((list_item*) array_list_get(&deleteData->contentsIndex, index))->data)->titleId;
     if(R_SUCCEEDED(res = AM_DeleteTicket(titleId))) {
         linked_list_iter iter;
         linked_list_iterate(deleteData->items, &iter);
@@ -69,6 +70,7 @@ static void action_delete_tickets_free_data(delete_tickets_data* data) {
     }
 
     linked_list_destroy(&data->contents);
+    array_list_destroy(&data->contentsIndex);
     free(data);
 }
 
@@ -145,10 +147,16 @@ static void action_delete_tickets_loading_update(ui_view* view, void* data, floa
                 }
             }
 
-            loadingData->deleteData->deleteInfo.total = linked_list_size(&loadingData->deleteData->contents);
-            loadingData->deleteData->deleteInfo.processed = loadingData->deleteData->deleteInfo.total;
+            if(array_list_add_all(&loadingData->deleteData->contentsIndex, &loadingData->deleteData->contents)) {
+                loadingData->deleteData->deleteInfo.total = array_list_size(&loadingData->deleteData->contentsIndex);
+                loadingData->deleteData->deleteInfo.processed = loadingData->deleteData->deleteInfo.total;
 
-            prompt_display_yes_no("Confirmation", loadingData->message, COLOR_TEXT, loadingData->deleteData, action_delete_tickets_draw_top, action_delete_tickets_onresponse);
+                prompt_display_yes_no("Confirmation", loadingData->message, COLOR_TEXT, loadingData->deleteData, action_delete_tickets_draw_top, action_delete_tickets_onresponse);
+            } else {
+                error_display_res(NULL, NULL, R_APP_OUT_OF_MEMORY, "Failed to populate ticket list.");
+
+                action_delete_tickets_free_data(loadingData->deleteData);
+            }
         } else {
             error_display_res(NULL, NULL, loadingData->popData.result, "Failed to populate ticket list.");
 
@@ -191,6 +199,7 @@ static void action_delete_tickets_internal(linked_list* items, list_item* select
     data->deleteInfo.finished = false;
 
     linked_list_init(&data->contents);
+    array_list_init(&data->contentsIndex);
 
     if(unused) {
         delete_tickets_loading_data* loadingData = (delete_tickets_loading_data*) calloc(1, sizeof(delete_tickets_loading_data));
@@ -218,8 +227,9 @@ static void action_delete_tickets_internal(linked_list* items, list_item* select
         info_display("Loading", "Press B to cancel.", false, loadingData, action_delete_tickets_loading_update, action_delete_tickets_loading_draw_top);
     } else {
         linked_list_add(&data->contents, selected);
+        array_list_add(&data->contentsIndex, selected);
 
-        data->deleteInfo.total = 1;
+        data->deleteInfo.total = array_list_size(&data->contentsIndex);
         data->deleteInfo.processed = data->deleteInfo.total;
 
         prompt_display_yes_no("Confirmation", message, COLOR_TEXT, data, action_delete_tickets_draw_top, action_delete_tickets_onresponse);
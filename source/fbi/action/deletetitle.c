@@ -34,6 +34,8 @@ static void action_delete_title_update(ui_view* view, void* data, float* progres
     if(R_FAILED(res)) {
         error_display_res(info, task_draw_title_info, res, "Failed to delete title.");
     } else {
+        meta_cache_remove(meta_cache_title_key(info->mediaType, info->titleId));
+
         linked_list_remove(deleteData->items, deleteData->selected);
         task_free_title(deleteData->selected);
 
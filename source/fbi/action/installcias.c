@@ -16,6 +16,10 @@ typedef struct {
     file_info* target;
 
     linked_list contents;
+    array_list contentsIndex;
+
+    // Set when installing from a ZIP or gzip file; follows the order of contentsIndex.
+    zip_entry* zipEntries;
 
     bool delete;
 
@@ -33,7 +37,7 @@ static void action_install_cias_draw_top(ui_view* view, void* data, float x1, fl
 
     u32 curr = installData->installInfo.processed;
     if(curr < installData->installInfo.total) {
-        task_draw_file_info(view, ((list_item*) linked_list_get(&installData->contents, curr))->data, x1, y1, x2, y2);
+        task_draw_file_info(view, ((list_item*) array_list_get(&installData->contentsIndex, curr))->data, x1, y1, x2, y2);
     } else {
         task_draw_file_info(view, installData->target, x1, y1, x2, y2);
     }
@@ -51,7 +55,7 @@ static Result action_install_cias_make_dst_directory(void* data, u32 index) {
 static Result action_install_cias_open_src(void* data, u32 index, u32* handle) {
     install_cias_data* installData = (install_cias_data*) data;
 
-    file_info* info = (file_info*) ((list_item*) linked_list_get(&installData->contents, index))->data;
+    file_info* info = (file_info*) ((list_item*) array_list_get(&installData->contentsIndex, index))->data;
 
     Result res = 0;
 
@@ -70,7 +74,7 @@ static Result action_install_cias_open_src(void* data, u32 index, u32* handle) {
 static Result action_install_cias_close_src(void* data, u32 index, bool succeeded, u32 handle) {
     install_cias_data* installData = (install_cias_data*) data;
 
-    file_info* info = (file_info*) ((list_item*) linked_list_get(&installData->contents, index))->data;
+    file_info* info = (file_info*) ((list_item*) array_list_get(&installData->contentsIndex, index))->data;
 
     Result res = 0;
 
@@ -109,12 +113,76 @@ static Result action_install_cias_read_src(void* data, u32 handle, u32* bytesRea
     return FSFILE_Read(handle, bytesRead, offset, buffer, size);
 }
 
-static Result action_install_cias_open_dst(void* data, u32 index, void* initialReadBlock, u64 size, u32* handle) {
+static Result action_install_cias_open_zip_src(void* data, u32 index, u32* handle) {
+    install_cias_data* installData = (install_cias_data*) data;
+
+    Result res = 0;
+
+    FS_Path* fsPath = fs_make_path_utf8(installData->target->path);
+    if(fsPath != NULL) {
+        Handle fileHandle = 0;
+        if(R_SUCCEEDED(res = FSUSER_OpenFile(&fileHandle, installData->target->archive, *fsPath, FS_OPEN_READ, 0))) {
+            zip_reader* reader = NULL;
+            if(R_SUCCEEDED(res = zip_reader_open(&reader, fileHandle, &installData->zipEntries[index]))) {
+                *handle = (u32) reader;
+            }
+        }
+
+        fs_free_path_utf8(fsPath);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+static Result action_install_cias_close_zip_src(void* data, u32 index, bool succeeded, u32 handle) {
+    return zip_reader_close((zip_reader*) handle);
+}
+
+static Result action_install_cias_get_zip_src_size(void* data, u32 handle, u64* size) {
+    return zip_reader_get_size((zip_reader*) handle, size);
+}
+
+static Result action_install_cias_read_zip_src(void* data, u32 handle, u32* bytesRead, void* buffer, u64 offset, u32 size) {
+    return zip_reader_read((zip_reader*) handle, bytesRead, buffer, offset, size);
+}
+
+static Result action_install_cias_is_dst_current(void* data, u32 index, bool* current, u64* size) {
+    install_cias_data* installData = (install_cias_data*) data;
+
+    file_info* info = (file_info*) ((list_item*) array_list_get(&installData->contentsIndex, index))->data;
+    if(!info->isCia || !info->ciaInfo.loaded) {
+        *current = false;
+        return 0;
+    }
+
+    Result res = 0;
+
+    u64 titleId = info->ciaInfo.titleId;
+    AM_TitleEntry entry;
+    if(R_SUCCEEDED(res = AM_GetTitleInfo(fs_get_title_destination(titleId), 1, &titleId, &entry))) {
+        *current = entry.version == info->ciaInfo.version;
+        *size = info->size;
+    }
+
+    return res;
+}
+
+static Result action_install_cias_open_dst(void* data, u32 index, void* initialReadBlock, u32 initialReadSize, u64 size, u32* handle) {
     install_cias_data* installData = (install_cias_data*) data;
 
     installData->n3dsContinue = false;
 
-    file_info* info = (file_info*) ((list_item*) linked_list_get(&installData->contents, index))->data;
+    file_info* info = (file_info*) ((list_item*) array_list_get(&installData->contentsIndex, index))->data;
+
+    // Archive entries are not probed while listing; take the title from the stream instead.
+    if(!info->ciaInfo.loaded) {
+        Result res = 0;
+        if(R_FAILED(res = cia_get_title_id(&info->ciaInfo.titleId, (u8*) initialReadBlock, initialReadSize))) {
+            return res;
+        }
+    }
 
     FS_MediaType dest = fs_get_title_destination(info->ciaInfo.titleId);
 
@@ -143,6 +211,9 @@ static Result action_install_cias_open_dst(void* data, u32 index, void* initialR
         }
     }
 
+    // A reinstall can keep the version the cached metadata is stamped with.
+    meta_cache_remove(meta_cache_title_key(dest, info->ciaInfo.titleId));
+
     return AM_StartCiaInstall(dest, handle);
 }
 
@@ -150,7 +221,7 @@ static Result action_install_cias_close_dst(void* data, u32 index, bool succeede
     if(succeeded) {
         install_cias_data* installData = (install_cias_data*) data;
 
-        file_info* info = (file_info*) ((list_item*) linked_list_get(&installData->contents, index))->data;
+        file_info* info = (file_info*) ((list_item*) array_list_get(&installData->contentsIndex, index))->data;
 
         Result res = 0;
         if(R_SUCCEEDED(res = AM_FinishCiaInstall(handle))) {
@@ -187,6 +258,12 @@ bool action_install_cias_error(void* data, u32 index, Result res, ui_view** erro
 static void action_install_cias_free_data(install_cias_data* data) {
     task_clear_files(&data->contents);
     linked_list_destroy(&data->contents);
+    array_list_destroy(&data->contentsIndex);
+
+    if(data->zipEntries != NULL) {
+        free(data->zipEntries);
+        data->zipEntries = NULL;
+    }
 
     if(data->targetItem != NULL) {
         task_free_file(data->targetItem);
@@ -209,7 +286,15 @@ static void action_install_cias_update(ui_view* view, void* data, float* progres
         info_destroy(view);
 
         if(R_SUCCEEDED(installData->installInfo.result)) {
-            prompt_display_notify("Success", "Install finished.", COLOR_TEXT, NULL, NULL, NULL);
+            if(installData->installInfo.skipped > 0) {
+                static char summary[128];
+                snprintf(summary, sizeof(summary), "Install finished.\nSkipped %lu up-to-date CIA(s), %.2f %s saved.", installData->installInfo.skipped,
+                         ui_get_display_size(installData->installInfo.skippedBytes), ui_get_display_size_units(installData->installInfo.skippedBytes));
+
+                prompt_display_notify("Success", summary, COLOR_TEXT, NULL, NULL, NULL);
+            } else {
+                prompt_display_notify("Success", "Install finished.", COLOR_TEXT, NULL, NULL, NULL);
+            }
         }
 
         action_install_cias_free_data(installData);
@@ -269,13 +354,18 @@ static void action_install_cias_loading_update(ui_view* view, void* data, float*
         ui_pop();
         info_destroy(view);
 
-        if(R_SUCCEEDED(loadingData->popData.result)) {
-            loadingData->installData->installInfo.total = linked_list_size(&loadingData->installData->contents);
+        Result res = loadingData->popData.result;
+        if(R_SUCCEEDED(res) && !array_list_add_all(&loadingData->installData->contentsIndex, &loadingData->installData->contents)) {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+
+        if(R_SUCCEEDED(res)) {
+            loadingData->installData->installInfo.total = array_list_size(&loadingData->installData->contentsIndex);
             loadingData->installData->installInfo.processed = loadingData->installData->installInfo.total;
 
             prompt_display_yes_no("Confirmation", loadingData->message, COLOR_TEXT, loadingData->installData, action_install_cias_draw_top, action_install_cias_onresponse);
         } else {
-            error_display_res(NULL, NULL, loadingData->popData.result, "Failed to populate CIA list.");
+            error_display_res(NULL, NULL, res, "Failed to populate CIA list.");
 
             action_install_cias_free_data(loadingData->installData);
         }
@@ -291,12 +381,12 @@ static void action_install_cias_loading_update(ui_view* view, void* data, float*
     snprintf(text, PROGRESS_TEXT_MAX, "Fetching CIA list...");
 }
 
-static void action_install_cias_internal(linked_list* items, list_item* selected, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData, const char* message, bool delete) {
+static install_cias_data* action_install_cias_create(linked_list* items, list_item* selected, bool delete) {
     install_cias_data* data = (install_cias_data*) calloc(1, sizeof(install_cias_data));
     if(data == NULL) {
         error_display(NULL, NULL, "Failed to allocate install CIAs data.");
 
-        return;
+        return NULL;
     }
 
     data->items = items;
@@ -307,7 +397,7 @@ static void action_install_cias_internal(linked_list* items, list_item* selected
         error_display_res(NULL, NULL, targetCreateRes, "Failed to create target file item.");
 
         action_install_cias_free_data(data);
-        return;
+        return NULL;
     }
 
     data->target = (file_info*) data->targetItem->data;
@@ -322,6 +412,7 @@ static void action_install_cias_internal(linked_list* items, list_item* selected
 
     data->installInfo.bufferSize = 256 * 1024;
     data->installInfo.copyEmpty = false;
+    data->installInfo.bufferCount = 4;
 
     data->installInfo.isSrcDirectory = action_install_cias_is_src_directory;
     data->installInfo.makeDstDirectory = action_install_cias_make_dst_directory;
@@ -334,6 +425,8 @@ static void action_install_cias_internal(linked_list* items, list_item* selected
     data->installInfo.openDst = action_install_cias_open_dst;
     data->installInfo.closeDst = action_install_cias_close_dst;
     data->installInfo.writeDst = action_install_cias_write_dst;
+    data->installInfo.isDstCurrent = action_install_cias_is_dst_current;
+    data->installInfo.verifyCia = true;
 
     data->installInfo.suspend = action_install_cias_suspend;
     data->installInfo.restore = action_install_cias_restore;
@@ -343,6 +436,16 @@ static void action_install_cias_internal(linked_list* items, list_item* selected
     data->installInfo.finished = true;
 
     linked_list_init(&data->contents);
+    array_list_init(&data->contentsIndex);
+
+    return data;
+}
+
+static void action_install_cias_internal(linked_list* items, list_item* selected, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData, const char* message, bool delete) {
+    install_cias_data* data = action_install_cias_create(items, selected, delete);
+    if(data == NULL) {
+        return;
+    }
 
     install_cias_loading_data* loadingData = (install_cias_loading_data*) calloc(1, sizeof(install_cias_loading_data));
     if(loadingData == NULL) {
@@ -393,4 +496,87 @@ void action_install_cias(linked_list* items, list_item* selected, bool (*filter)
 
 void action_install_cias_delete(linked_list* items, list_item* selected, bool (*filter)(void* data, const char* name, u32 attributes), void* filterData) {
     action_install_cias_internal(items, selected, filter, filterData, "Install and delete all CIAs in the current directory?", true);
+}
+
+static Result action_install_cias_add_zip_entries(install_cias_data* data) {
+    Result res = 0;
+
+    FS_Path* fsPath = fs_make_path_utf8(data->target->path);
+    if(fsPath != NULL) {
+        Handle fileHandle = 0;
+        if(R_SUCCEEDED(res = FSUSER_OpenFile(&fileHandle, data->target->archive, *fsPath, FS_OPEN_READ, 0))) {
+            // Listing only reads the central directory, so it is quick enough to do in place.
+            u32 count = 0;
+            if(R_SUCCEEDED(res = zip_file_get_entries(&data->zipEntries, &count, fileHandle, data->target->name, fs_filter_cias, NULL))) {
+                for(u32 i = 0; i < count && R_SUCCEEDED(res); i++) {
+                    list_item* item = (list_item*) calloc(1, sizeof(list_item));
+                    file_info* info = (file_info*) calloc(1, sizeof(file_info));
+                    if(item != NULL && info != NULL) {
+                        info->archive = data->target->archive;
+                        string_copy(info->name, data->zipEntries[i].name, FILE_NAME_MAX);
+                        string_copy(info->path, data->target->path, FILE_PATH_MAX);
+                        info->size = data->zipEntries[i].size;
+                        info->isCia = true;
+
+                        item->color = COLOR_FILE;
+                        string_copy(item->name, info->name, LIST_ITEM_NAME_MAX);
+                        item->data = info;
+
+                        linked_list_add(&data->contents, item);
+                    } else {
+                        free(item);
+                        free(info);
+
+                        res = R_APP_OUT_OF_MEMORY;
+                    }
+                }
+            }
+
+            FSFILE_Close(fileHandle);
+        }
+
+        fs_free_path_utf8(fsPath);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    if(R_SUCCEEDED(res) && !array_list_add_all(&data->contentsIndex, &data->contents)) {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+void action_install_zip_cias(linked_list* items, list_item* selected) {
+    install_cias_data* data = action_install_cias_create(items, selected, false);
+    if(data == NULL) {
+        return;
+    }
+
+    data->installInfo.openSrc = action_install_cias_open_zip_src;
+    data->installInfo.closeSrc = action_install_cias_close_zip_src;
+    data->installInfo.getSrcSize = action_install_cias_get_zip_src_size;
+    data->installInfo.readSrc = action_install_cias_read_zip_src;
+    // Entries carry no title metadata until they are streamed.
+    data->installInfo.isDstCurrent = NULL;
+
+    Result res = action_install_cias_add_zip_entries(data);
+    if(R_FAILED(res)) {
+        error_display_res(NULL, NULL, res, "Failed to read archive contents.");
+
+        action_install_cias_free_data(data);
+        return;
+    }
+
+    if(array_list_size(&data->contentsIndex) == 0) {
+        prompt_display_notify("Failure", "No CIAs found in archive.", COLOR_TEXT, NULL, NULL, NULL);
+
+        action_install_cias_free_data(data);
+        return;
+    }
+
+    data->installInfo.total = array_list_size(&data->contentsIndex);
+    data->installInfo.processed = data->installInfo.total;
+
+    prompt_display_yes_no("Confirmation", "Install all CIAs in the selected archive?", COLOR_TEXT, data, action_install_cias_draw_top, action_install_cias_onresponse);
 }
\ No newline at end of file
@@ -16,6 +16,7 @@ typedef struct {
     file_info* target;
 
     linked_list contents;
+    array_list contentsIndex;
 
     bool delete;
 
@@ -27,7 +28,7 @@ static void action_install_tickets_draw_top(ui_view* view, void* data, float x1,
 
     u32 curr = installData->installInfo.processed;
     if(curr < installData->installInfo.total) {
-        task_draw_file_info(view, ((list_item*) linked_list_get(&installData->contents, curr))->data, x1, y1, x2, y2);
+        task_draw_file_info(view, ((list_item*) array_list_get(&installData->contentsIndex, curr))->data, x1, y1, x2, y2);
     } else {
         task_draw_file_info(view, installData->target, x1, y1, x2, y2);
     }
@@ -45,7 +46,7 @@ static Result action_install_tickets_make_dst_directory(void* data, u32 index) {
 static Result action_install_tickets_open_src(void* data, u32 index, u32* handle) {
     install_tickets_data* installData = (install_tickets_data*) data;
 
-    file_info* info = (file_info*) ((list_item*) linked_list_get(&installData->contents, index))->data;
+    file_info* info = (file_info*) ((list_item*) array_list_get(&installData->contentsIndex, index))->data;
 
     Result res = 0;
 
@@ -64,7 +65,7 @@ static Result action_install_tickets_open_src(void* data, u32 index, u32* handle
 static Result action_install_tickets_close_src(void* data, u32 index, bool succeeded, u32 handle) {
     install_tickets_data* installData = (install_tickets_data*) data;
 
-    file_info* info = (file_info*) ((list_item*) linked_list_get(&installData->contents, index))->data;
+    file_info* info = (file_info*) ((list_item*) array_list_get(&installData->contentsIndex, index))->data;
 
     Result res = 0;
 
@@ -103,8 +104,8 @@ static Result action_install_tickets_read_src(void* data, u32 handle, u32* bytes
     return FSFILE_Read(handle, bytesRead, offset, buffer, size);
 }
 
-static Result action_install_tickets_open_dst(void* data, u32 index, void* initialReadBlock, u64 size, u32* handle) {
-    AM_DeleteTicket(((file_info*) ((list_item*) linked_list_get(&((install_tickets_data*) data)->contents, index))->data)->ticketInfo.titleId);
+static Result action_install_tickets_open_dst(void* data, u32 index, void* initialReadBlock, u32 initialReadSize, u64 size, u32* handle) {
+    AM_DeleteTicket(((file_info*) ((list_item*) array_list_get(&((install_tickets_data*) data)->contentsIndex, index))->data)->ticketInfo.titleId);
     return AM_InstallTicketBegin(handle);
 }
 
@@ -136,6 +137,7 @@ static bool action_install_tickets_error(void* data, u32 index, Result res, ui_v
 static void action_install_tickets_free_data(install_tickets_data* data) {
     task_clear_files(&data->contents);
     linked_list_destroy(&data->contents);
+    array_list_destroy(&data->contentsIndex);
 
     if(data->targetItem != NULL) {
         task_free_file(data->targetItem);
@@ -218,13 +220,18 @@ static void action_install_tickets_loading_update(ui_view* view, void* data, flo
         ui_pop();
         info_destroy(view);
 
-        if(R_SUCCEEDED(loadingData->popData.result)) {
-            loadingData->installData->installInfo.total = linked_list_size(&loadingData->installData->contents);
+        Result res = loadingData->popData.result;
+        if(R_SUCCEEDED(res) && !array_list_add_all(&loadingData->installData->contentsIndex, &loadingData->installData->contents)) {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+
+        if(R_SUCCEEDED(res)) {
+            loadingData->installData->installInfo.total = array_list_size(&loadingData->installData->contentsIndex);
             loadingData->installData->installInfo.processed = loadingData->installData->installInfo.total;
 
             prompt_display_yes_no("Confirmation", loadingData->message, COLOR_TEXT, loadingData->installData, action_install_tickets_draw_top, action_install_tickets_onresponse);
         } else {
-            error_display_res(NULL, NULL, loadingData->popData.result, "Failed to populate ticket list.");
+            error_display_res(NULL, NULL, res, "Failed to populate ticket list.");
 
             action_install_tickets_free_data(loadingData->installData);
         }
@@ -290,6 +297,7 @@ static void action_install_tickets_internal(linked_list* items, list_item* selec
     data->installInfo.finished = true;
 
     linked_list_init(&data->contents);
+    array_list_init(&data->contentsIndex);
 
     install_tickets_loading_data* loadingData = (install_tickets_loading_data*) calloc(1, sizeof(install_tickets_loading_data));
     if(loadingData == NULL) {
@@ -9,6 +9,9 @@
 #include "../task/uitask.h"
 #include "../../core/core.h"
 
+// Enough for the CIA header, certificate chain, ticket and the head of the TMD.
+#define PREFLIGHT_SIZE (32 * 1024)
+
 typedef enum content_type_e {
     CONTENT_CIA,
     CONTENT_TICKET,
@@ -24,6 +27,9 @@ typedef struct {
     void (*finishedURL)(void* data, u32 index);
     void (*finishedAll)(void* data);
     void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2, u32 index);
+    Result (*downloadSrc)(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                 Result (*checkRunning)(void* userData),
+                                                                                 Result (*progress)(void* userData, u64 total, u64 curr));
 
     content_type contentType;
     u64 currTitleId;
@@ -83,7 +89,45 @@ static Result action_install_url_get_src_url(void* data, u32 index, char* url, s
     return 0;
 }
 
-static Result action_install_url_open_dst(void* data, u32 index, void* initialReadBlock, u64 size, u32* handle) {
+static Result action_install_url_download_src(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                    Result (*checkRunning)(void* userData),
+                                                                                                    Result (*progress)(void* userData, u64 total, u64 curr)) {
+    install_url_data* installData = (install_url_data*) data;
+
+    return installData->downloadSrc(installData->userData, index, bufferSize, userData, callback, checkRunning, progress);
+}
+
+static Result action_install_url_is_dst_current(void* data, u32 index, bool* current, u64* size) {
+    install_url_data* installData = (install_url_data*) data;
+
+    Result res = 0;
+
+    u8* head = (u8*) calloc(1, PREFLIGHT_SIZE);
+    if(head != NULL) {
+        u32 headSize = 0;
+        u64 titleId = 0;
+        u16 version = 0;
+        AM_TitleEntry entry;
+
+        *current = false;
+
+        if(R_SUCCEEDED(res = http_download_head(installData->urls[index], &headSize, size, head, PREFLIGHT_SIZE))
+           && headSize >= sizeof(u16) && *(u16*) head == 0x2020
+           && R_SUCCEEDED(res = cia_get_title_id(&titleId, head, headSize))
+           && R_SUCCEEDED(res = cia_get_title_version(&version, head, headSize))
+           && R_SUCCEEDED(res = AM_GetTitleInfo(fs_get_title_destination(titleId), 1, &titleId, &entry))) {
+            *current = entry.version == version;
+        }
+
+        free(head);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+static Result action_install_url_open_dst(void* data, u32 index, void* initialReadBlock, u32 initialReadSize, u64 size, u32* handle) {
     install_url_data* installData = (install_url_data*) data;
 
     Result res = 0;
@@ -98,7 +142,7 @@ static Result action_install_url_open_dst(void* data, u32 index, void* initialRe
         installData->contentType = CONTENT_CIA;
 
         u64 titleId = 0;
-        if(R_SUCCEEDED(res = cia_get_title_id(&titleId, (u8*) initialReadBlock, installData->installInfo.bufferSize))) {
+        if(R_SUCCEEDED(res = cia_get_title_id(&titleId, (u8*) initialReadBlock, initialReadSize))) {
             FS_MediaType dest = fs_get_title_destination(titleId);
 
             bool n3ds = false;
@@ -126,12 +170,15 @@ static Result action_install_url_open_dst(void* data, u32 index, void* initialRe
                 }
             }
 
+            // A reinstall can keep the version the cached metadata is stamped with.
+            meta_cache_remove(meta_cache_title_key(dest, titleId));
+
             if(R_SUCCEEDED(res = AM_StartCiaInstall(dest, handle))) {
                 installData->currTitleId = titleId;
             }
         }
     } else if(*(u16*) initialReadBlock == 0x0100) {
-        if(R_SUCCEEDED(res = ticket_get_title_id(&installData->ticketInfo.titleId, (u8*) initialReadBlock, installData->installInfo.bufferSize))) {
+        if(R_SUCCEEDED(res = ticket_get_title_id(&installData->ticketInfo.titleId, (u8*) initialReadBlock, initialReadSize))) {
             installData->contentType = CONTENT_TICKET;
 
             installData->ticketInfo.inUse = false;
@@ -180,6 +227,51 @@ static Result action_install_url_open_dst(void* data, u32 index, void* initialRe
     return res;
 }
 
+static Result action_install_url_get_resume_path(void* data, u32 index, char* path, size_t maxSize) {
+    install_url_data* installData = (install_url_data*) data;
+
+    // CIA and ticket installs cannot be reopened once AM has dropped them; only plain SD files resume across sessions.
+    if(installData->contentType != CONTENT_3DSX_SMDH || string_is_empty(installData->currPath)) {
+        return R_APP_NOT_IMPLEMENTED;
+    }
+
+    string_copy(path, installData->currPath, maxSize);
+    return 0;
+}
+
+static Result action_install_url_resume_dst(void* data, u32 index, const char* path, u64 offset, u32* handle) {
+    install_url_data* installData = (install_url_data*) data;
+
+    FS_Path* fsPath = fs_make_path_utf8(path);
+    if(fsPath == NULL) {
+        return R_APP_OUT_OF_MEMORY;
+    }
+
+    Handle fileHandle = 0;
+    Result res = FSUSER_OpenFileDirectly(&fileHandle, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, ""), *fsPath, FS_OPEN_WRITE, 0);
+
+    fs_free_path_utf8(fsPath);
+
+    if(R_SUCCEEDED(res)) {
+        u64 size = 0;
+        if(R_SUCCEEDED(res = FSFILE_GetSize(fileHandle, &size)) && size >= offset) {
+            installData->contentType = CONTENT_3DSX_SMDH;
+            string_copy(installData->currPath, path, FILE_PATH_MAX);
+
+            *handle = fileHandle;
+            return 0;
+        }
+
+        FSFILE_Close(fileHandle);
+
+        if(R_SUCCEEDED(res)) {
+            res = R_APP_BAD_DATA;
+        }
+    }
+
+    return res;
+}
+
 static Result action_install_url_close_dst(void* data, u32 index, bool succeeded, u32 handle) {
     install_url_data* installData = (install_url_data*) data;
 
@@ -261,7 +353,15 @@ static void action_install_url_install_update(ui_view* view, void* data, float*
         info_destroy(view);
 
         if(R_SUCCEEDED(installData->installInfo.result)) {
-            prompt_display_notify("Success", "Install finished.", COLOR_TEXT, NULL, NULL, NULL);
+            if(installData->installInfo.skipped > 0) {
+                static char summary[128];
+                snprintf(summary, sizeof(summary), "Install finished.\nSkipped %lu up-to-date title(s), %.2f %s saved.", installData->installInfo.skipped,
+                         ui_get_display_size(installData->installInfo.skippedBytes), ui_get_display_size_units(installData->installInfo.skippedBytes));
+
+                prompt_display_notify("Success", summary, COLOR_TEXT, NULL, NULL, NULL);
+            } else {
+                prompt_display_notify("Success", "Install finished.", COLOR_TEXT, NULL, NULL, NULL);
+            }
         }
 
         action_install_url_free_data(installData);
@@ -301,6 +401,59 @@ static void action_install_url_confirm_onresponse(ui_view* view, void* data, u32
     }
 }
 
+static void action_install_url_start(install_url_data* data, const char* confirmMessage, void* userData,
+                                     void (*finishedURL)(void* data, u32 index),
+                                     void (*finishedAll)(void* data),
+                                     void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2, u32 index)) {
+    data->userData = userData;
+    data->finishedURL = finishedURL;
+    data->finishedAll = finishedAll;
+    data->drawTop = drawTop;
+
+    data->contentType = CONTENT_CIA;
+    data->currTitleId = 0;
+    data->n3dsContinue = false;
+    memset(&data->ticketInfo, 0, sizeof(data->ticketInfo));
+    memset(&data->currPath, 0, sizeof(data->currPath));
+
+    data->installInfo.data = data;
+
+    data->installInfo.op = DATAOP_DOWNLOAD;
+
+    data->installInfo.bufferSize = 128 * 1024;
+    data->installInfo.connections = 4;
+    data->installInfo.prefetchSize = 1024 * 1024;
+
+    data->installInfo.processed = data->installInfo.total;
+
+    data->installInfo.getSrcUrl = action_install_url_get_src_url;
+
+    if(data->downloadSrc != NULL) {
+        // Pushed bytes arrive in order over a single stream; there is nothing to prefetch or reopen later.
+        data->installInfo.connections = 1;
+        data->installInfo.prefetchSize = 0;
+        data->installInfo.downloadSrc = action_install_url_download_src;
+    }
+
+    data->installInfo.openDst = action_install_url_open_dst;
+    data->installInfo.closeDst = action_install_url_close_dst;
+    data->installInfo.writeDst = action_install_url_write_dst;
+    data->installInfo.getResumePath = data->downloadSrc == NULL ? action_install_url_get_resume_path : NULL;
+    data->installInfo.resumeDst = data->downloadSrc == NULL ? action_install_url_resume_dst : NULL;
+    // Pushed files cannot be previewed without consuming them from the stream.
+    data->installInfo.isDstCurrent = data->downloadSrc == NULL ? action_install_url_is_dst_current : NULL;
+    data->installInfo.verifyCia = true;
+
+    data->installInfo.suspend = action_install_url_suspend;
+    data->installInfo.restore = action_install_url_restore;
+
+    data->installInfo.error = action_install_url_error;
+
+    data->installInfo.finished = true;
+
+    prompt_display_yes_no("Confirmation", confirmMessage, COLOR_TEXT, data, action_install_url_draw_top, action_install_url_confirm_onresponse);
+}
+
 void action_install_url(const char* confirmMessage, const char* urls, const char* paths, void* userData,
                         void (*finishedURL)(void* data, u32 index),
                         void (*finishedAll)(void* data),
@@ -367,37 +520,49 @@ void action_install_url(const char* confirmMessage, const char* urls, const char
         }
     }
 
-    data->userData = userData;
-    data->finishedURL = finishedURL;
-    data->finishedAll = finishedAll;
-    data->drawTop = drawTop;
-
-    data->contentType = CONTENT_CIA;
-    data->currTitleId = 0;
-    data->n3dsContinue = false;
-    memset(&data->ticketInfo, 0, sizeof(data->ticketInfo));
-    memset(&data->currPath, 0, sizeof(data->currPath));
+    action_install_url_start(data, confirmMessage, userData, finishedURL, finishedAll, drawTop);
+}
 
-    data->installInfo.data = data;
+void action_install_push(const char* confirmMessage, const char* names, void* userData,
+                         Result (*downloadSrc)(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                      Result (*checkRunning)(void* userData),
+                                                                                                      Result (*progress)(void* userData, u64 total, u64 curr)),
+                         void (*finishedAll)(void* data)) {
+    install_url_data* data = (install_url_data*) calloc(1, sizeof(install_url_data));
+    if(data == NULL) {
+        error_display(NULL, NULL, "Failed to allocate push install data.");
 
-    data->installInfo.op = DATAOP_DOWNLOAD;
+        if(finishedAll != NULL) {
+            finishedAll(userData);
+        }
 
-    data->installInfo.bufferSize = 128 * 1024;
+        return;
+    }
 
-    data->installInfo.processed = data->installInfo.total;
+    data->installInfo.total = 0;
 
-    data->installInfo.getSrcUrl = action_install_url_get_src_url;
+    size_t namesLen = strlen(names);
+    if(namesLen > 0) {
+        const char* currStart = names;
+        while(data->installInfo.total < INSTALL_URLS_MAX && currStart - names < namesLen) {
+            const char* currEnd = strchr(currStart, '\n');
+            if(currEnd == NULL) {
+                currEnd = names + namesLen;
+            }
 
-    data->installInfo.openDst = action_install_url_open_dst;
-    data->installInfo.closeDst = action_install_url_close_dst;
-    data->installInfo.writeDst = action_install_url_write_dst;
+            u32 len = currEnd - currStart;
+            if(len > DOWNLOAD_URL_MAX - 1) {
+                len = DOWNLOAD_URL_MAX - 1;
+            }
 
-    data->installInfo.suspend = action_install_url_suspend;
-    data->installInfo.restore = action_install_url_restore;
+            string_copy(data->urls[data->installInfo.total], currStart, len + 1);
 
-    data->installInfo.error = action_install_url_error;
+            data->installInfo.total++;
+            currStart = currEnd + 1;
+        }
+    }
 
-    data->installInfo.finished = true;
+    data->downloadSrc = downloadSrc;
 
-    prompt_display_yes_no("Confirmation", confirmMessage, COLOR_TEXT, data, action_install_url_draw_top, action_install_url_confirm_onresponse);
+    action_install_url_start(data, confirmMessage, userData, NULL, finishedAll, NULL);
 }
\ No newline at end of file
@@ -16,6 +16,7 @@ typedef struct {
     file_info* target;
 
     linked_list contents;
+    array_list contentsIndex;
 
     data_op_data pasteInfo;
 } paste_contents_data;
@@ -25,7 +26,7 @@ static void action_paste_contents_draw_top(ui_view* view, void* data, float x1,
 
     u32 curr = pasteData->pasteInfo.processed;
     if(curr < pasteData->pasteInfo.total) {
-        task_draw_file_info(view, ((list_item*) linked_list_get(&pasteData->contents, curr))->data, x1, y1, x2, y2);
+        task_draw_file_info(view, ((list_item*) array_list_get(&pasteData->contentsIndex, curr))->data, x1, y1, x2, y2);
     } else {
         task_draw_file_info(view, pasteData->target, x1, y1, x2, y2);
     }
@@ -46,13 +47,13 @@ static void action_paste_contents_get_dst_path(paste_contents_data* data, u32 in
         string_get_parent_path(baseDstPath, data->target->path, FILE_PATH_MAX);
     }
 
-    snprintf(dstPath, FILE_PATH_MAX, "%s%s", baseDstPath, ((file_info*) ((list_item*) linked_list_get(&data->contents, index))->data)->path + strlen(baseSrcPath));
+    snprintf(dstPath, FILE_PATH_MAX, "%s%s", baseDstPath, ((file_info*) ((list_item*) array_list_get(&data->contentsIndex, index))->data)->path + strlen(baseSrcPath));
 }
 
 static Result action_paste_contents_is_src_directory(void* data, u32 index, bool* isDirectory) {
     paste_contents_data* pasteData = (paste_contents_data*) data;
 
-    *isDirectory = (bool) (((file_info*) ((list_item*) linked_list_get(&pasteData->contents, index))->data)->attributes & FS_ATTRIBUTE_DIRECTORY);
+    *isDirectory = (bool) (((file_info*) ((list_item*) array_list_get(&pasteData->contentsIndex, index))->data)->attributes & FS_ATTRIBUTE_DIRECTORY);
     return 0;
 }
 
@@ -61,7 +62,7 @@ static Result action_paste_contents_make_dst_directory(void* data, u32 index) {
 
     Result res = 0;
 
-    u32 attributes = ((file_info*) ((list_item*) linked_list_get(&pasteData->contents, index))->data)->attributes;
+    u32 attributes = ((file_info*) ((list_item*) array_list_get(&pasteData->contentsIndex, index))->data)->attributes;
 
     char dstPath[FILE_PATH_MAX];
     action_paste_contents_get_dst_path(pasteData, index, dstPath);
@@ -103,7 +104,7 @@ static Result action_paste_contents_open_src(void* data, u32 index, u32* handle)
 
     Result res = 0;
 
-    FS_Path* fsPath = fs_make_path_utf8(((file_info*) ((list_item*) linked_list_get(&pasteData->contents, index))->data)->path);
+    FS_Path* fsPath = fs_make_path_utf8(((file_info*) ((list_item*) array_list_get(&pasteData->contentsIndex, index))->data)->path);
     if(fsPath != NULL) {
         res = FSUSER_OpenFile(handle, clipboard_get_archive(), *fsPath, FS_OPEN_READ, 0);
 
@@ -127,7 +128,7 @@ static Result action_paste_contents_read_src(void* data, u32 handle, u32* bytesR
     return FSFILE_Read(handle, bytesRead, offset, buffer, size);
 }
 
-static Result action_paste_contents_open_dst(void* data, u32 index, void* initialReadBlock, u64 size, u32* handle) {
+static Result action_paste_contents_open_dst(void* data, u32 index, void* initialReadBlock, u32 initialReadSize, u64 size, u32* handle) {
     paste_contents_data* pasteData = (paste_contents_data*) data;
 
     Result res = 0;
@@ -156,7 +157,7 @@ static Result action_paste_contents_open_dst(void* data, u32 index, void* initia
             }
         }
 
-        if(R_SUCCEEDED(res) && R_SUCCEEDED(res = FSUSER_CreateFile(pasteData->target->archive, *fsPath, ((file_info*) ((list_item*) linked_list_get(&pasteData->contents, index))->data)->attributes & ~FS_ATTRIBUTE_READ_ONLY, size))) {
+        if(R_SUCCEEDED(res) && R_SUCCEEDED(res = FSUSER_CreateFile(pasteData->target->archive, *fsPath, ((file_info*) ((list_item*) array_list_get(&pasteData->contentsIndex, index))->data)->attributes & ~FS_ATTRIBUTE_READ_ONLY, size))) {
             res = FSUSER_OpenFile(handle, pasteData->target->archive, *fsPath, FS_OPEN_WRITE, 0);
         }
 
@@ -189,7 +190,7 @@ static Result action_paste_contents_close_dst(void* data, u32 index, bool succee
 
         if(strncmp(parentPath, baseDstPath, FILE_PATH_MAX) == 0) {
             list_item* dstItem = NULL;
-            if(R_SUCCEEDED(task_create_file_item(&dstItem, pasteData->target->archive, dstPath, ((file_info*) ((list_item*) linked_list_get(&pasteData->contents, index))->data)->attributes & ~FS_ATTRIBUTE_READ_ONLY, true))) {
+            if(R_SUCCEEDED(task_create_file_item(&dstItem, pasteData->target->archive, dstPath, ((file_info*) ((list_item*) array_list_get(&pasteData->contentsIndex, index))->data)->attributes & ~FS_ATTRIBUTE_READ_ONLY, true))) {
                 linked_list_add(pasteData->items, dstItem);
             }
         }
@@ -218,6 +219,7 @@ static bool action_paste_contents_error(void* data, u32 index, Result res, ui_vi
 static void action_paste_contents_free_data(paste_contents_data* data) {
     task_clear_files(&data->contents);
     linked_list_destroy(&data->contents);
+    array_list_destroy(&data->contentsIndex);
 
     if(data->targetItem != NULL) {
         task_free_file(data->targetItem);
@@ -296,13 +298,18 @@ static void action_paste_contents_loading_update(ui_view* view, void* data, floa
         ui_pop();
         info_destroy(view);
 
-        if(R_SUCCEEDED(loadingData->popData.result)) {
-            loadingData->pasteData->pasteInfo.total = linked_list_size(&loadingData->pasteData->contents);
+        Result res = loadingData->popData.result;
+        if(R_SUCCEEDED(res) && !array_list_add_all(&loadingData->pasteData->contentsIndex, &loadingData->pasteData->contents)) {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+
+        if(R_SUCCEEDED(res)) {
+            loadingData->pasteData->pasteInfo.total = array_list_size(&loadingData->pasteData->contentsIndex);
             loadingData->pasteData->pasteInfo.processed = loadingData->pasteData->pasteInfo.total;
 
             prompt_display_yes_no("Confirmation", "Paste clipboard contents to the current directory?", COLOR_TEXT, loadingData->pasteData, action_paste_contents_draw_top, action_paste_contents_onresponse);
         } else {
-            error_display_res(NULL, NULL, loadingData->popData.result, "Failed to populate clipboard content list.");
+            error_display_res(NULL, NULL, res, "Failed to populate clipboard content list.");
 
             action_paste_contents_free_data(loadingData->pasteData);
         }
@@ -350,6 +357,7 @@ void action_paste_contents(linked_list* items, list_item* selected) {
 
     data->pasteInfo.bufferSize = 256 * 1024;
     data->pasteInfo.copyEmpty = true;
+    data->pasteInfo.bufferCount = 4;
 
     data->pasteInfo.isSrcDirectory = action_paste_contents_is_src_directory;
     data->pasteInfo.makeDstDirectory = action_paste_contents_make_dst_directory;
@@ -371,6 +379,7 @@ void action_paste_contents(linked_list* items, list_item* selected) {
     data->pasteInfo.finished = true;
 
     linked_list_init(&data->contents);
+    array_list_init(&data->contentsIndex);
 
     paste_contents_loading_data* loadingData = (paste_contents_loading_data*) calloc(1, sizeof(paste_contents_loading_data));
     if(loadingData == NULL) {
@@ -35,7 +35,7 @@ static Result dumpnand_read_src(void* data, u32 handle, u32* bytesRead, void* bu
     return FSFILE_Read(handle, bytesRead, offset, buffer, size);
 }
 
-static Result dumpnand_open_dst(void* data, u32 index, void* initialReadBlock, u64 size, u32* handle) {
+static Result dumpnand_open_dst(void* data, u32 index, void* initialReadBlock, u32 initialReadSize, u64 size, u32* handle) {
     Result res = 0;
 
     FS_Archive sdmcArchive = 0;
@@ -142,6 +142,7 @@ void dumpnand_open() {
 
     data->bufferSize = 256 * 1024;
     data->copyEmpty = true;
+    data->bufferCount = 4;
 
     data->total = 1;
 
@@ -19,6 +19,8 @@ static list_item delete_file = {"Delete", COLOR_TEXT, action_delete_file};
 static list_item install_cia = {"Install CIA", COLOR_TEXT, action_install_cia};
 static list_item install_and_delete_cia = {"Install and delete CIA", COLOR_TEXT, action_install_cia_delete};
 
+static list_item install_zip_cias = {"Install CIAs from archive", COLOR_TEXT, action_install_zip_cias};
+
 static list_item install_ticket = {"Install ticket", COLOR_TEXT, action_install_ticket};
 static list_item install_and_delete_ticket = {"Install and delete ticket", COLOR_TEXT, action_install_ticket_delete};
 
@@ -159,6 +161,10 @@ static void files_action_update(ui_view* view, void* data, linked_list* items, l
                 linked_list_add(items, &install_and_delete_ticket);
             }
 
+            if(info->isCompressed) {
+                linked_list_add(items, &install_zip_cias);
+            }
+
             linked_list_add(items, &delete_file);
         }
 
@@ -306,6 +312,8 @@ static void files_free_data(files_data* data) {
 static void files_update(ui_view* view, void* data, linked_list* items, list_item* selected, bool selectedTouched) {
     files_data* listData = (files_data*) data;
 
+    listData->populateData.metaFocus = selected;
+
     if(listData->populated) {
         // Detect whether the current directory was renamed by an action.
         list_item* currDirItem = linked_list_get(items, 0);
@@ -6,6 +6,7 @@
 #include "../core/clipboard.h"
 #include "../core/error.h"
 #include "../core/fs.h"
+#include "../core/iconatlas.h"
 #include "../core/screen.h"
 #include "../core/task/task.h"
 #include "../core/ui/ui.h"
@@ -149,15 +150,23 @@ void init() {
     AM_InitializeExternalTitleDatabase(false);
 
     screen_init();
+    icon_atlas_init();
     ui_init();
     task_init();
+
+    meta_cache_init();
+    http_init();
 }
 
 void cleanup() {
     clipboard_clear();
 
+    http_exit();
+    meta_cache_exit();
+
     task_exit();
     ui_exit();
+    icon_atlas_exit();
     screen_exit();
 
     if(old_time_limit != UINT32_MAX) {
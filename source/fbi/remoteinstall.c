@@ -2,11 +2,13 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <malloc.h>
+#include <poll.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 
 #include <3ds.h>
+#include <zlib.h>
 
 #include "resources.h"
 #include "section.h"
@@ -70,9 +72,49 @@ static Result remoteinstall_set_last_urls(const char* urls) {
     return res;
 }
 
+// A push sender opens with this instead of a URL payload length; it is far above the largest accepted URL payload.
+#define PUSH_MAGIC 0x46424950 /* FBIP */
+#define PUSH_VERSION 2
+#define PUSH_POLL_MS 100
+
+// Compressed files arrive as length-prefixed frames of one deflate stream, ending with an empty frame.
+#define PUSH_FRAME_MAX (128 * 1024)
+#define PUSH_FRAME_BUFFERS 4
+
+typedef enum push_type_e {
+    PUSH_TYPE_ANY,
+    PUSH_TYPE_CIA,
+    PUSH_TYPE_TICKET,
+    PUSH_TYPE_3DSX,
+    PUSH_TYPE_SMDH,
+    PUSH_TYPE_MAX
+} push_type;
+
+typedef enum push_compression_e {
+    PUSH_COMPRESSION_NONE,
+    PUSH_COMPRESSION_DEFLATE,
+    PUSH_COMPRESSION_MAX
+} push_compression;
+
 typedef struct {
     int serverSocket;
     int clientSocket;
+
+    // Push
+    u64 pushSizes[INSTALL_URLS_MAX];
+    u8 pushTypes[INSTALL_URLS_MAX];
+    u8 pushCompression[INSTALL_URLS_MAX];
+
+    bool pushStarted;
+    // The file currently at the head of the stream and how much of it is still unread.
+    u32 pushIndex;
+    bool pushConsumed;
+    u64 pushRemaining;
+    bool pushFramesDone;
+    u8 pushFrameHeader[sizeof(u32)];
+    u32 pushFrameHeaderRead;
+    u32 pushFrameSize;
+    u32 pushFrameRemaining;
 } remoteinstall_network_data;
 
 static int remoteinstall_network_recvwait(int sockfd, void* buf, size_t len, int flags) {
@@ -123,6 +165,487 @@ static void remoteinstall_network_free_data(remoteinstall_network_data* data) {
     free(data);
 }
 
+static Result remoteinstall_network_push_recv(int sockfd, void* buf, u32 len, u32* bytesRead, void* userData, Result (*checkRunning)(void* userData)) {
+    Result res = 0;
+
+    *bytesRead = 0;
+    while(*bytesRead < len && R_SUCCEEDED(res = checkRunning(userData))) {
+        struct pollfd pollInfo = {.fd = sockfd, .events = POLLIN, .revents = 0};
+        int ready = poll(&pollInfo, 1, PUSH_POLL_MS);
+        if(ready == 0) {
+            continue;
+        }
+
+        errno = 0;
+
+        int ret = ready > 0 ? recv(sockfd, buf + *bytesRead, len - *bytesRead, 0) : -1;
+        if(ret > 0) {
+            *bytesRead += ret;
+        } else if(ret == 0 || errno != EAGAIN) {
+            res = R_APP_CONNECTION_CLOSED;
+            break;
+        }
+    }
+
+    return res;
+}
+
+static bool remoteinstall_network_push_type_matches(u8 type, void* buffer, u32 size) {
+    switch(type) {
+        case PUSH_TYPE_CIA:
+            return size >= sizeof(u16) && *(u16*) buffer == 0x2020;
+        case PUSH_TYPE_TICKET:
+            return size >= sizeof(u16) && *(u16*) buffer == 0x0100;
+        case PUSH_TYPE_3DSX:
+            return size >= sizeof(u32) && *(u32*) buffer == 0x58534433;
+        case PUSH_TYPE_SMDH:
+            return size >= sizeof(u32) && *(u32*) buffer == 0x48444D53;
+        default:
+            return true;
+    }
+}
+
+// Reads the next frame of the head file, continuing one that an earlier reader abandoned part way.
+// When discarding, the frame is read through the start of the buffer in pieces instead of being assembled.
+static Result remoteinstall_network_push_read_frame(remoteinstall_network_data* networkData, u8* buffer, u32 bufferSize, bool discard, u32* frameSize, void* userData, Result (*checkRunning)(void* userData)) {
+    Result res = 0;
+
+    while(networkData->pushFrameHeaderRead < sizeof(networkData->pushFrameHeader) && R_SUCCEEDED(res)) {
+        u32 bytesRead = 0;
+        res = remoteinstall_network_push_recv(networkData->clientSocket, &networkData->pushFrameHeader[networkData->pushFrameHeaderRead], sizeof(networkData->pushFrameHeader) - networkData->pushFrameHeaderRead, &bytesRead, userData, checkRunning);
+        networkData->pushFrameHeaderRead += bytesRead;
+
+        if(networkData->pushFrameHeaderRead == sizeof(networkData->pushFrameHeader)) {
+            u32 frameSize = 0;
+            memcpy(&frameSize, networkData->pushFrameHeader, sizeof(frameSize));
+
+            networkData->pushFrameSize = ntohl(frameSize);
+            networkData->pushFrameRemaining = networkData->pushFrameSize;
+
+            if(networkData->pushFrameSize > PUSH_FRAME_MAX || (!discard && networkData->pushFrameSize > bufferSize)) {
+                return R_APP_BAD_DATA;
+            }
+        }
+    }
+
+    while(networkData->pushFrameRemaining > 0 && R_SUCCEEDED(res)) {
+        u32 offset = discard ? 0 : networkData->pushFrameSize - networkData->pushFrameRemaining;
+        u32 size = bufferSize - offset < networkData->pushFrameRemaining ? bufferSize - offset : networkData->pushFrameRemaining;
+
+        u32 bytesRead = 0;
+        res = remoteinstall_network_push_recv(networkData->clientSocket, buffer + offset, size, &bytesRead, userData, checkRunning);
+        networkData->pushFrameRemaining -= bytesRead;
+    }
+
+    if(R_SUCCEEDED(res)) {
+        *frameSize = networkData->pushFrameSize;
+
+        networkData->pushFrameHeaderRead = 0;
+        if(networkData->pushFrameSize == 0) {
+            networkData->pushFramesDone = true;
+        }
+    }
+
+    return res;
+}
+
+static Result remoteinstall_network_push_skip(remoteinstall_network_data* networkData, u8* buffer, u32 bufferSize, void* userData, Result (*checkRunning)(void* userData)) {
+    Result res = 0;
+
+    if(networkData->pushCompression[networkData->pushIndex] == PUSH_COMPRESSION_NONE) {
+        while(networkData->pushRemaining > 0 && R_SUCCEEDED(res)) {
+            u32 bytesRead = 0;
+            res = remoteinstall_network_push_recv(networkData->clientSocket, buffer, (u32) (networkData->pushRemaining < bufferSize ? networkData->pushRemaining : bufferSize), &bytesRead, userData, checkRunning);
+            networkData->pushRemaining -= bytesRead;
+        }
+    } else {
+        while(!networkData->pushFramesDone && R_SUCCEEDED(res)) {
+            u32 frameSize = 0;
+            res = remoteinstall_network_push_read_frame(networkData, buffer, bufferSize, true, &frameSize, userData, checkRunning);
+        }
+    }
+
+    return res;
+}
+
+static Result remoteinstall_network_push_raw(remoteinstall_network_data* networkData, u32 index, u8* buffer, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                                                          Result (*checkRunning)(void* userData),
+                                                                                                                                          Result (*progress)(void* userData, u64 total, u64 curr)) {
+    Result res = 0;
+
+    u64 size = networkData->pushSizes[index];
+    while(networkData->pushRemaining > 0 && R_SUCCEEDED(res)) {
+        u32 bytesRead = 0;
+        res = remoteinstall_network_push_recv(networkData->clientSocket, buffer, (u32) (networkData->pushRemaining < bufferSize ? networkData->pushRemaining : bufferSize), &bytesRead, userData, checkRunning);
+        networkData->pushRemaining -= bytesRead;
+
+        if(R_SUCCEEDED(res)) {
+            if(size - networkData->pushRemaining == bytesRead && !remoteinstall_network_push_type_matches(networkData->pushTypes[index], buffer, bytesRead)) {
+                res = R_APP_BAD_DATA;
+            } else if(R_SUCCEEDED(res = callback(userData, buffer, bytesRead))) {
+                res = progress(userData, size, size - networkData->pushRemaining);
+            }
+        }
+    }
+
+    return res;
+}
+
+typedef struct {
+    u8* buffer;
+    u32 size;
+    Result res;
+} push_frame;
+
+typedef struct {
+    remoteinstall_network_data* networkData;
+
+    push_frame frames[PUSH_FRAME_BUFFERS];
+
+    Handle freeSemaphore;
+    Handle filledSemaphore;
+
+    volatile bool stop;
+} push_frame_pipeline;
+
+static Result remoteinstall_network_push_read_running(void* userData) {
+    push_frame_pipeline* pipeline = (push_frame_pipeline*) userData;
+
+    // Suspend/restore hooks are run by the consumer; the reader only has to stay idle while paused.
+    svcWaitSynchronization(task_get_pause_event(), U64_MAX);
+
+    return pipeline->stop ? R_APP_CANCELLED : 0;
+}
+
+static void remoteinstall_network_push_read_thread(void* arg) {
+    push_frame_pipeline* pipeline = (push_frame_pipeline*) arg;
+    remoteinstall_network_data* networkData = pipeline->networkData;
+
+    u32 curr = 0;
+    while(!pipeline->stop && !networkData->pushFramesDone) {
+        svcWaitSynchronization(pipeline->freeSemaphore, U64_MAX);
+        if(pipeline->stop) {
+            break;
+        }
+
+        push_frame* frame = &pipeline->frames[curr];
+        frame->size = 0;
+        frame->res = remoteinstall_network_push_read_frame(networkData, frame->buffer, PUSH_FRAME_MAX, false, &frame->size, pipeline, remoteinstall_network_push_read_running);
+
+        curr = (curr + 1) % PUSH_FRAME_BUFFERS;
+
+        s32 count = 0;
+        svcReleaseSemaphore(&count, pipeline->filledSemaphore, 1);
+
+        if(R_FAILED(frame->res)) {
+            break;
+        }
+    }
+}
+
+static Result remoteinstall_network_push_inflate(remoteinstall_network_data* networkData, u32 index, push_frame_pipeline* pipeline, u8* buffer, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                                                                                              Result (*checkRunning)(void* userData),
+                                                                                                                                                                              Result (*progress)(void* userData, u64 total, u64 curr)) {
+    Result res = 0;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if(inflateInit(&stream) != Z_OK) {
+        return R_APP_OUT_OF_MEMORY;
+    }
+
+    u64 size = networkData->pushSizes[index];
+    u64 received = 0;
+    u32 buffered = 0;
+    bool streamEnded = false;
+
+    u32 curr = 0;
+    while(R_SUCCEEDED(res = checkRunning(userData))) {
+        svcWaitSynchronization(pipeline->filledSemaphore, U64_MAX);
+
+        push_frame* frame = &pipeline->frames[curr];
+        if(R_FAILED(res = frame->res) || frame->size == 0) {
+            break;
+        }
+
+        stream.next_in = frame->buffer;
+        stream.avail_in = frame->size;
+
+        while(R_SUCCEEDED(res) && !streamEnded) {
+            stream.next_out = buffer + buffered;
+            stream.avail_out = bufferSize - buffered;
+
+            int ret = inflate(&stream, Z_NO_FLUSH);
+            if(ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                res = R_APP_BAD_DATA;
+                break;
+            }
+
+            buffered = bufferSize - stream.avail_out;
+            streamEnded = ret == Z_STREAM_END;
+
+            if(received + buffered > size) {
+                res = R_APP_BAD_DATA;
+            } else if(buffered == bufferSize || (streamEnded && buffered > 0)) {
+                // The first block is handed over whole; the sink identifies the content from it.
+                if(received == 0 && !remoteinstall_network_push_type_matches(networkData->pushTypes[index], buffer, buffered)) {
+                    res = R_APP_BAD_DATA;
+                } else if(R_SUCCEEDED(res = callback(userData, buffer, buffered))) {
+                    received += buffered;
+                    buffered = 0;
+
+                    res = progress(userData, size, received);
+                }
+            } else if(stream.avail_in == 0) {
+                break;
+            }
+        }
+
+        if(R_SUCCEEDED(res) && streamEnded && stream.avail_in > 0) {
+            res = R_APP_BAD_DATA;
+        }
+
+        curr = (curr + 1) % PUSH_FRAME_BUFFERS;
+
+        s32 count = 0;
+        svcReleaseSemaphore(&count, pipeline->freeSemaphore, 1);
+
+        if(R_FAILED(res)) {
+            break;
+        }
+    }
+
+    if(R_SUCCEEDED(res) && (!streamEnded || received != size)) {
+        res = R_APP_BAD_DATA;
+    }
+
+    inflateEnd(&stream);
+
+    return res;
+}
+
+static Result remoteinstall_network_push_compressed(remoteinstall_network_data* networkData, u32 index, u8* buffer, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                                                                 Result (*checkRunning)(void* userData),
+                                                                                                                                                 Result (*progress)(void* userData, u64 total, u64 curr)) {
+    Result res = 0;
+
+    push_frame_pipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+
+    pipeline.networkData = networkData;
+    pipeline.stop = false;
+
+    for(u32 i = 0; i < PUSH_FRAME_BUFFERS && R_SUCCEEDED(res); i++) {
+        if((pipeline.frames[i].buffer = (u8*) malloc(PUSH_FRAME_MAX)) == NULL) {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+    }
+
+    if(R_SUCCEEDED(res)
+       && R_SUCCEEDED(res = svcCreateSemaphore(&pipeline.freeSemaphore, PUSH_FRAME_BUFFERS, PUSH_FRAME_BUFFERS))
+       && R_SUCCEEDED(res = svcCreateSemaphore(&pipeline.filledSemaphore, 0, PUSH_FRAME_BUFFERS))) {
+        // Frames are read on their own thread so that inflating and writing never hold back the socket.
+        Thread readThread = threadCreate(remoteinstall_network_push_read_thread, &pipeline, 0x4000, 0x18, 1, false);
+        if(readThread != NULL) {
+            res = remoteinstall_network_push_inflate(networkData, index, &pipeline, buffer, bufferSize, userData, callback, checkRunning, progress);
+
+            pipeline.stop = true;
+
+            s32 count = 0;
+            svcReleaseSemaphore(&count, pipeline.freeSemaphore, 1);
+
+            threadJoin(readThread, U64_MAX);
+            threadFree(readThread);
+        } else {
+            res = R_APP_THREAD_CREATE_FAILED;
+        }
+    }
+
+    if(pipeline.freeSemaphore != 0) {
+        svcCloseHandle(pipeline.freeSemaphore);
+    }
+
+    if(pipeline.filledSemaphore != 0) {
+        svcCloseHandle(pipeline.filledSemaphore);
+    }
+
+    for(u32 i = 0; i < PUSH_FRAME_BUFFERS; i++) {
+        if(pipeline.frames[i].buffer != NULL) {
+            free(pipeline.frames[i].buffer);
+        }
+    }
+
+    return res;
+}
+
+static Result remoteinstall_network_push_src(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                  Result (*checkRunning)(void* userData),
+                                                                                                  Result (*progress)(void* userData, u64 total, u64 curr)) {
+    remoteinstall_network_data* networkData = (remoteinstall_network_data*) data;
+
+    // Pushed bytes cannot be replayed; a retried file has already left the stream.
+    if(index < networkData->pushIndex || (index == networkData->pushIndex && networkData->pushConsumed)) {
+        return R_APP_SKIPPED;
+    }
+
+    Result res = 0;
+
+    if(!networkData->pushStarted) {
+        u8 start = 1;
+        if(remoteinstall_network_sendwait(networkData->clientSocket, &start, sizeof(start), 0) != sizeof(start)) {
+            return R_APP_CONNECTION_CLOSED;
+        }
+
+        networkData->pushStarted = true;
+    }
+
+    u8* buffer = (u8*) malloc(bufferSize);
+    if(buffer != NULL) {
+        // Files that never reached the sink, or failed part way, are drained so that the next one starts in sync.
+        while(networkData->pushIndex < index && R_SUCCEEDED(res = remoteinstall_network_push_skip(networkData, buffer, bufferSize, userData, checkRunning))) {
+            networkData->pushIndex++;
+            networkData->pushRemaining = networkData->pushSizes[networkData->pushIndex];
+            networkData->pushFramesDone = false;
+            networkData->pushFrameHeaderRead = 0;
+            networkData->pushFrameRemaining = 0;
+            networkData->pushConsumed = false;
+        }
+
+        if(R_SUCCEEDED(res) && R_SUCCEEDED(res = progress(userData, networkData->pushSizes[index], 0))) {
+            networkData->pushConsumed = true;
+
+            if(networkData->pushCompression[index] == PUSH_COMPRESSION_NONE) {
+                res = remoteinstall_network_push_raw(networkData, index, buffer, bufferSize, userData, callback, checkRunning, progress);
+            } else {
+                res = remoteinstall_network_push_compressed(networkData, index, buffer, bufferSize, userData, callback, checkRunning, progress);
+            }
+        }
+
+        free(buffer);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+static bool remoteinstall_network_recv_u64(int sockfd, u64* value) {
+    u8 bytes[sizeof(u64)];
+    if(remoteinstall_network_recvwait(sockfd, bytes, sizeof(bytes), 0) != sizeof(bytes)) {
+        return false;
+    }
+
+    *value = 0;
+    for(u32 i = 0; i < sizeof(bytes); i++) {
+        *value = (*value << 8) | bytes[i];
+    }
+
+    return true;
+}
+
+static void remoteinstall_network_receive_push(remoteinstall_network_data* networkData) {
+    u32 version = 0;
+    if(remoteinstall_network_recvwait(networkData->clientSocket, &version, sizeof(version), 0) != sizeof(version)) {
+        error_display_errno(NULL, NULL, errno, "Failed to read protocol version.");
+
+        remoteinstall_network_close_client(networkData);
+        return;
+    }
+
+    version = ntohl(version);
+    if(version > PUSH_VERSION) {
+        version = PUSH_VERSION;
+    }
+
+    u32 versionReply = htonl(version);
+    if(remoteinstall_network_sendwait(networkData->clientSocket, &versionReply, sizeof(versionReply), 0) != sizeof(versionReply)) {
+        error_display_errno(NULL, NULL, errno, "Failed to send protocol version.");
+
+        remoteinstall_network_close_client(networkData);
+        return;
+    }
+
+    if(version == 0) {
+        error_display(NULL, NULL, "Unsupported push protocol version.");
+
+        remoteinstall_network_close_client(networkData);
+        return;
+    }
+
+    u32 count = 0;
+    if(remoteinstall_network_recvwait(networkData->clientSocket, &count, sizeof(count), 0) != sizeof(count)) {
+        error_display_errno(NULL, NULL, errno, "Failed to read file count.");
+
+        remoteinstall_network_close_client(networkData);
+        return;
+    }
+
+    count = ntohl(count);
+    if(count == 0 || count > INSTALL_URLS_MAX) {
+        error_display(NULL, NULL, "Invalid file count.");
+
+        remoteinstall_network_close_client(networkData);
+        return;
+    }
+
+    char* names = (char*) calloc(count, FILE_NAME_MAX);
+    if(names == NULL) {
+        error_display(NULL, NULL, "Failed to allocate file name buffer.");
+
+        remoteinstall_network_close_client(networkData);
+        return;
+    }
+
+    size_t namesLen = 0;
+    for(u32 i = 0; i < count; i++) {
+        networkData->pushCompression[i] = PUSH_COMPRESSION_NONE;
+
+        u16 nameLen = 0;
+        if(remoteinstall_network_recvwait(networkData->clientSocket, &nameLen, sizeof(nameLen), 0) != sizeof(nameLen)) {
+            error_display_errno(NULL, NULL, errno, "Failed to read file header.");
+
+            free(names);
+            remoteinstall_network_close_client(networkData);
+            return;
+        }
+
+        nameLen = ntohs(nameLen);
+        if(nameLen == 0 || nameLen >= FILE_NAME_MAX
+           || remoteinstall_network_recvwait(networkData->clientSocket, &names[namesLen], nameLen, 0) != nameLen
+           || memchr(&names[namesLen], '\n', nameLen) != NULL
+           || !remoteinstall_network_recv_u64(networkData->clientSocket, &networkData->pushSizes[i])
+           || networkData->pushSizes[i] == 0
+           || remoteinstall_network_recvwait(networkData->clientSocket, &networkData->pushTypes[i], sizeof(u8), 0) != sizeof(u8)
+           || networkData->pushTypes[i] >= PUSH_TYPE_MAX
+           || (version >= 2 && remoteinstall_network_recvwait(networkData->clientSocket, &networkData->pushCompression[i], sizeof(u8), 0) != sizeof(u8))
+           || networkData->pushCompression[i] >= PUSH_COMPRESSION_MAX) {
+            error_display(NULL, NULL, "Invalid file header.");
+
+            free(names);
+            remoteinstall_network_close_client(networkData);
+            return;
+        }
+
+        namesLen += nameLen;
+        names[namesLen++] = '\n';
+    }
+
+    names[namesLen - 1] = '\0';
+
+    networkData->pushStarted = false;
+    networkData->pushIndex = 0;
+    networkData->pushConsumed = false;
+    networkData->pushRemaining = networkData->pushSizes[0];
+    networkData->pushFramesDone = false;
+    networkData->pushFrameHeaderRead = 0;
+    networkData->pushFrameRemaining = 0;
+
+    action_install_push("Install the pushed file(s)?", names, networkData, remoteinstall_network_push_src, remoteinstall_network_close_client);
+
+    free(names);
+}
+
 static void remoteinstall_network_update(ui_view* view, void* data, float* progress, char* text) {
     remoteinstall_network_data* networkData = (remoteinstall_network_data*) data;
 
@@ -151,6 +674,11 @@ static void remoteinstall_network_update(ui_view* view, void* data, float* progr
         }
 
         size = ntohl(size);
+        if(size == PUSH_MAGIC) {
+            remoteinstall_network_receive_push(networkData);
+            return;
+        }
+
         if(size >= DOWNLOAD_URL_MAX * INSTALL_URLS_MAX) {
             error_display(NULL, NULL, "Payload too large.");
 
@@ -19,6 +19,29 @@ static int task_populate_ext_save_data_compare_ids(const void* e1, const void* e
     return id1 > id2 ? 1 : id1 < id2 ? -1 : 0;
 }
 
+// Reloads an evicted icon from the ext save data's SMDH.
+static bool task_populate_ext_save_data_load_icon(void* data, void* pixels, u32 size) {
+    ext_save_data_info* extSaveDataInfo = (ext_save_data_info*) data;
+
+    bool loaded = false;
+
+    FS_ExtSaveDataInfo info = {.mediaType = extSaveDataInfo->mediaType, .saveId = extSaveDataInfo->extSaveDataId};
+
+    SMDH* smdh = (SMDH*) calloc(1, sizeof(SMDH));
+    if(smdh != NULL) {
+        u32 smdhBytesRead = 0;
+        if(size == sizeof(smdh->largeIcon) && R_SUCCEEDED(FSUSER_ReadExtSaveDataIcon(&smdhBytesRead, info, sizeof(SMDH), (u8*) smdh)) && smdhBytesRead == sizeof(SMDH)
+           && smdh->magic[0] == 'S' && smdh->magic[1] == 'M' && smdh->magic[2] == 'D' && smdh->magic[3] == 'H') {
+            memcpy(pixels, smdh->largeIcon, size);
+            loaded = true;
+        }
+
+        free(smdh);
+    }
+
+    return loaded;
+}
+
 static Result task_populate_ext_save_data_from(populate_ext_save_data_data* data, FS_MediaType mediaType) {
     Result res = 0;
 
@@ -59,8 +82,7 @@ static Result task_populate_ext_save_data_from(populate_ext_save_data_data* data
                                     utf16_to_utf8((uint8_t*) extSaveDataInfo->meta.longDescription, smdhTitle->longDescription, sizeof(extSaveDataInfo->meta.longDescription) - 1);
                                     utf16_to_utf8((uint8_t*) extSaveDataInfo->meta.publisher, smdhTitle->publisher, sizeof(extSaveDataInfo->meta.publisher) - 1);
                                     extSaveDataInfo->meta.region = smdh->region;
-                                    extSaveDataInfo->meta.texture = screen_allocate_free_texture();
-                                    screen_load_texture_tiled(extSaveDataInfo->meta.texture, smdh->largeIcon, sizeof(smdh->largeIcon), 48, 48, GPU_RGB565, false);
+                                    extSaveDataInfo->meta.icon = icon_atlas_add(48, 48, GPU_RGB565, true, smdh->largeIcon, task_populate_ext_save_data_load_icon, extSaveDataInfo);
                                 }
                             }
 
@@ -118,7 +140,7 @@ void task_free_ext_save_data(list_item* item) {
     if(item->data != NULL) {
         ext_save_data_info* extSaveDataInfo = (ext_save_data_info*) item->data;
         if(extSaveDataInfo->hasMeta) {
-            screen_unload_texture(extSaveDataInfo->meta.texture);
+            icon_atlas_remove(extSaveDataInfo->meta.icon);
         }
 
         free(item->data);
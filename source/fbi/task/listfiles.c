@@ -10,7 +10,10 @@
 #include "../resources.h"
 #include "../../core/core.h"
 
-#define MAX_FILES 1024
+#define DIR_PAGE_ENTRIES 64
+
+#define WALK_WORKERS 3
+#define WALK_WAIT_NS 10000000
 
 int task_compare_files(void* userData, const void* p1, const void* p2) {
     list_item* info1 = (list_item*) p1;
@@ -37,6 +40,62 @@ int task_compare_files(void* userData, const void* p1, const void* p2) {
     }
 }
 
+// Cached by path, keyed on size and modification time; archives without timestamps are not cached, leaving key at 0.
+static void task_populate_files_get_cache_key(file_info* fileInfo, FS_Path* fileFsPath, u64* key, u64* stamp) {
+    *key = 0;
+    *stamp = 0;
+
+    u64 mtime = 0;
+    if(R_SUCCEEDED(FSUSER_ControlArchive(fileInfo->archive, ARCHIVE_ACTION_GET_TIMESTAMP, (void*) fileFsPath->data, fileFsPath->size, &mtime, sizeof(mtime)))) {
+        *key = meta_cache_hash(0, fileInfo->path, strlen(fileInfo->path));
+        *stamp = meta_cache_hash(meta_cache_hash(0, &fileInfo->size, sizeof(fileInfo->size)), &mtime, sizeof(mtime));
+    }
+}
+
+// Reloads an evicted icon, preferring the metadata cache over the CIA's SMDH.
+static bool task_populate_files_load_cia_icon(void* data, void* pixels, u32 size) {
+    file_info* fileInfo = (file_info*) data;
+
+    bool loaded = false;
+
+    FS_Path* fileFsPath = fs_make_path_utf8(fileInfo->path);
+    if(fileFsPath != NULL) {
+        meta_cache_entry* cacheEntry = (meta_cache_entry*) calloc(1, sizeof(meta_cache_entry));
+        if(cacheEntry != NULL) {
+            u64 cacheKey = 0;
+            u64 cacheStamp = 0;
+            task_populate_files_get_cache_key(fileInfo, fileFsPath, &cacheKey, &cacheStamp);
+
+            if(size == sizeof(cacheEntry->icon) && cacheKey != 0 && meta_cache_get(cacheKey, cacheStamp, cacheEntry) && cacheEntry->hasMeta) {
+                memcpy(pixels, cacheEntry->icon, size);
+                loaded = true;
+            }
+
+            free(cacheEntry);
+        }
+
+        Handle fileHandle;
+        if(!loaded && R_SUCCEEDED(FSUSER_OpenFile(&fileHandle, fileInfo->archive, *fileFsPath, FS_OPEN_READ, 0))) {
+            SMDH* smdh = (SMDH*) calloc(1, sizeof(SMDH));
+            if(smdh != NULL) {
+                if(size == sizeof(smdh->largeIcon) && R_SUCCEEDED(cia_file_get_smdh(smdh, fileHandle))
+                   && smdh->magic[0] == 'S' && smdh->magic[1] == 'M' && smdh->magic[2] == 'D' && smdh->magic[3] == 'H') {
+                    memcpy(pixels, smdh->largeIcon, size);
+                    loaded = true;
+                }
+
+                free(smdh);
+            }
+
+            FSFILE_Close(fileHandle);
+        }
+
+        fs_free_path_utf8(fileFsPath);
+    }
+
+    return loaded;
+}
+
 static void task_populate_files_retrieve_meta(file_info* fileInfo) {
     FS_Path* fileFsPath = fs_make_path_utf8(fileInfo->path);
     if(fileFsPath != NULL) {
@@ -49,39 +108,82 @@ static void task_populate_files_retrieve_meta(file_info* fileInfo) {
             FSFILE_GetSize(fileHandle, &fileInfo->size);
 
             if(fileInfo->isCia) {
-                AM_TitleEntry titleEntry;
-                if(R_SUCCEEDED(AM_GetCiaFileInfo(MEDIATYPE_SD, &titleEntry, fileHandle))) {
-                    fileInfo->ciaInfo.titleId = titleEntry.titleID;
-                    fileInfo->ciaInfo.version = titleEntry.version;
-                    fileInfo->ciaInfo.installedSize = titleEntry.size;
-                    fileInfo->ciaInfo.hasMeta = false;
-
-                    if(fs_get_title_destination(titleEntry.titleID) != MEDIATYPE_SD && R_SUCCEEDED(AM_GetCiaFileInfo(MEDIATYPE_NAND, &titleEntry, fileHandle))) {
-                        fileInfo->ciaInfo.installedSize = titleEntry.size;
+                u64 cacheKey = 0;
+                u64 cacheStamp = 0;
+                task_populate_files_get_cache_key(fileInfo, fileFsPath, &cacheKey, &cacheStamp);
+
+                meta_cache_entry* cacheEntry = (meta_cache_entry*) calloc(1, sizeof(meta_cache_entry));
+
+                if(cacheEntry != NULL && cacheKey != 0 && meta_cache_get(cacheKey, cacheStamp, cacheEntry)) {
+                    fileInfo->ciaInfo.titleId = cacheEntry->titleId;
+                    fileInfo->ciaInfo.version = cacheEntry->version;
+                    fileInfo->ciaInfo.installedSize = cacheEntry->installedSize;
+                    fileInfo->ciaInfo.hasMeta = cacheEntry->hasMeta;
+
+                    if(cacheEntry->hasMeta) {
+                        string_copy(fileInfo->ciaInfo.meta.shortDescription, cacheEntry->shortDescription, sizeof(fileInfo->ciaInfo.meta.shortDescription));
+                        string_copy(fileInfo->ciaInfo.meta.longDescription, cacheEntry->longDescription, sizeof(fileInfo->ciaInfo.meta.longDescription));
+                        string_copy(fileInfo->ciaInfo.meta.publisher, cacheEntry->publisher, sizeof(fileInfo->ciaInfo.meta.publisher));
+                        fileInfo->ciaInfo.meta.region = cacheEntry->region;
+                        fileInfo->ciaInfo.meta.icon = icon_atlas_add(48, 48, GPU_RGB565, true, cacheEntry->icon, task_populate_files_load_cia_icon, fileInfo);
                     }
 
-                    SMDH* smdh = (SMDH*) calloc(1, sizeof(SMDH));
-                    if(smdh != NULL) {
-                        if(R_SUCCEEDED(cia_file_get_smdh(smdh, fileHandle))) {
-                            if(smdh->magic[0] == 'S' && smdh->magic[1] == 'M' && smdh->magic[2] == 'D' && smdh->magic[3] == 'H') {
-                                SMDH_title* smdhTitle = smdh_select_title(smdh);
-
-                                fileInfo->ciaInfo.hasMeta = true;
-                                utf16_to_utf8((uint8_t*) fileInfo->ciaInfo.meta.shortDescription, smdhTitle->shortDescription, sizeof(fileInfo->ciaInfo.meta.shortDescription) - 1);
-                                utf16_to_utf8((uint8_t*) fileInfo->ciaInfo.meta.longDescription, smdhTitle->longDescription, sizeof(fileInfo->ciaInfo.meta.longDescription) - 1);
-                                utf16_to_utf8((uint8_t*) fileInfo->ciaInfo.meta.publisher, smdhTitle->publisher, sizeof(fileInfo->ciaInfo.meta.publisher) - 1);
-                                fileInfo->ciaInfo.meta.region = smdh->region;
-                                fileInfo->ciaInfo.meta.texture = screen_allocate_free_texture();
-                                screen_load_texture_tiled(fileInfo->ciaInfo.meta.texture, smdh->largeIcon, sizeof(smdh->largeIcon), 48, 48, GPU_RGB565, false);
+                    fileInfo->ciaInfo.loaded = true;
+                } else {
+                    AM_TitleEntry titleEntry;
+                    if(R_SUCCEEDED(AM_GetCiaFileInfo(MEDIATYPE_SD, &titleEntry, fileHandle))) {
+                        fileInfo->ciaInfo.titleId = titleEntry.titleID;
+                        fileInfo->ciaInfo.version = titleEntry.version;
+                        fileInfo->ciaInfo.installedSize = titleEntry.size;
+                        fileInfo->ciaInfo.hasMeta = false;
+
+                        if(fs_get_title_destination(titleEntry.titleID) != MEDIATYPE_SD && R_SUCCEEDED(AM_GetCiaFileInfo(MEDIATYPE_NAND, &titleEntry, fileHandle))) {
+                            fileInfo->ciaInfo.installedSize = titleEntry.size;
+                        }
+
+                        SMDH* smdh = (SMDH*) calloc(1, sizeof(SMDH));
+                        if(smdh != NULL) {
+                            if(R_SUCCEEDED(cia_file_get_smdh(smdh, fileHandle))) {
+                                if(smdh->magic[0] == 'S' && smdh->magic[1] == 'M' && smdh->magic[2] == 'D' && smdh->magic[3] == 'H') {
+                                    SMDH_title* smdhTitle = smdh_select_title(smdh);
+
+                                    fileInfo->ciaInfo.hasMeta = true;
+                                    utf16_to_utf8((uint8_t*) fileInfo->ciaInfo.meta.shortDescription, smdhTitle->shortDescription, sizeof(fileInfo->ciaInfo.meta.shortDescription) - 1);
+                                    utf16_to_utf8((uint8_t*) fileInfo->ciaInfo.meta.longDescription, smdhTitle->longDescription, sizeof(fileInfo->ciaInfo.meta.longDescription) - 1);
+                                    utf16_to_utf8((uint8_t*) fileInfo->ciaInfo.meta.publisher, smdhTitle->publisher, sizeof(fileInfo->ciaInfo.meta.publisher) - 1);
+                                    fileInfo->ciaInfo.meta.region = smdh->region;
+                                    fileInfo->ciaInfo.meta.icon = icon_atlas_add(48, 48, GPU_RGB565, true, smdh->largeIcon, task_populate_files_load_cia_icon, fileInfo);
+
+                                    if(cacheEntry != NULL) {
+                                        memcpy(cacheEntry->icon, smdh->largeIcon, sizeof(cacheEntry->icon));
+                                    }
+                                }
                             }
+
+                            free(smdh);
                         }
 
-                        free(smdh);
+                        fileInfo->ciaInfo.loaded = true;
+
+                        if(cacheEntry != NULL && cacheKey != 0) {
+                            cacheEntry->titleId = fileInfo->ciaInfo.titleId;
+                            cacheEntry->version = fileInfo->ciaInfo.version;
+                            cacheEntry->installedSize = fileInfo->ciaInfo.installedSize;
+                            cacheEntry->hasMeta = fileInfo->ciaInfo.hasMeta;
+                            string_copy(cacheEntry->shortDescription, fileInfo->ciaInfo.meta.shortDescription, sizeof(cacheEntry->shortDescription));
+                            string_copy(cacheEntry->longDescription, fileInfo->ciaInfo.meta.longDescription, sizeof(cacheEntry->longDescription));
+                            string_copy(cacheEntry->publisher, fileInfo->ciaInfo.meta.publisher, sizeof(cacheEntry->publisher));
+                            cacheEntry->region = fileInfo->ciaInfo.meta.region;
+
+                            meta_cache_put(cacheKey, cacheStamp, cacheEntry);
+                        }
+                    } else {
+                        fileInfo->isCia = false;
                     }
+                }
 
-                    fileInfo->ciaInfo.loaded = true;
-                } else {
-                    fileInfo->isCia = false;
+                if(cacheEntry != NULL) {
+                    free(cacheEntry);
                 }
             } else if(fileInfo->isTicket) {
                 u32 bytesRead = 0;
@@ -125,6 +227,7 @@ Result task_create_file_item(list_item** out, FS_Archive archive, const char* pa
             fileInfo->size = 0;
             fileInfo->isCia = false;
             fileInfo->isTicket = false;
+            fileInfo->isCompressed = false;
 
             if((attributes & FS_ATTRIBUTE_DIRECTORY) || fs_is_dir(archive, path)) {
                 item->color = COLOR_DIRECTORY;
@@ -148,6 +251,8 @@ Result task_create_file_item(list_item** out, FS_Archive archive, const char* pa
                     fileInfo->isCia = true;
                 } else if(fs_filter_tickets(NULL, fileInfo->path, fileInfo->attributes)) {
                     fileInfo->isTicket = true;
+                } else if(fs_filter_compressed(NULL, fileInfo->path, fileInfo->attributes)) {
+                    fileInfo->isCompressed = true;
                 }
 
                 if(meta) {
@@ -190,6 +295,388 @@ static int task_populate_files_compare_directory_entries(const void* e1, const v
     }
 }
 
+static Result task_populate_files_read_directory(populate_files_data* data, file_info* dir) {
+    Result res = 0;
+
+    FS_Path* fsPath = fs_make_path_utf8(dir->path);
+    if(fsPath != NULL) {
+        Handle dirHandle = 0;
+        if(R_SUCCEEDED(res = FSUSER_OpenDirectory(&dirHandle, dir->archive, *fsPath))) {
+            // Entries are read a page at a time; each sorted page is merged into this directory's run of the list.
+            u32 runStart = linked_list_size(data->items);
+
+            FS_DirectoryEntry* entries = (FS_DirectoryEntry*) calloc(DIR_PAGE_ENTRIES, sizeof(FS_DirectoryEntry));
+            list_item** pageItems = (list_item**) calloc(DIR_PAGE_ENTRIES, sizeof(list_item*));
+            if(entries != NULL && pageItems != NULL) {
+                bool quit = false;
+
+                u32 entryCount = 0;
+                while(!quit && R_SUCCEEDED(res) && R_SUCCEEDED(res = FSDIR_Read(dirHandle, &entryCount, DIR_PAGE_ENTRIES, entries)) && entryCount > 0) {
+                    qsort(entries, entryCount, sizeof(FS_DirectoryEntry), task_populate_files_compare_directory_entries);
+
+                    u32 pageCount = 0;
+                    for(u32 i = 0; i < entryCount && R_SUCCEEDED(res); i++) {
+                        svcWaitSynchronization(task_get_pause_event(), U64_MAX);
+                        if(task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
+                            quit = true;
+                            break;
+                        }
+
+                        char name[FILE_NAME_MAX] = {'\0'};
+                        utf16_to_utf8((uint8_t*) name, entries[i].name, FILE_NAME_MAX - 1);
+
+                        if(data->filter == NULL || data->filter(data->filterData, name, entries[i].attributes)) {
+                            char path[FILE_PATH_MAX] = {'\0'};
+                            snprintf(path, FILE_PATH_MAX, "%s%s", dir->path, name);
+
+                            list_item* item = NULL;
+                            if(R_SUCCEEDED(res = task_create_file_item(&item, dir->archive, path, entries[i].attributes, false))) {
+                                pageItems[pageCount++] = item;
+                            }
+                        }
+                    }
+
+                    if(!linked_list_merge_sorted(data->items, runStart, (void**) pageItems, pageCount, NULL, task_compare_files)) {
+                        res = R_APP_OUT_OF_MEMORY;
+                    }
+                }
+            } else {
+                res = R_APP_OUT_OF_MEMORY;
+            }
+
+            if(entries != NULL) {
+                free(entries);
+            }
+
+            if(pageItems != NULL) {
+                free(pageItems);
+            }
+
+            FSDIR_Close(dirHandle);
+        }
+
+        fs_free_path_utf8(fsPath);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+typedef struct walk_dir_s {
+    list_item* item;
+
+    // Sorted with task_compare_files.
+    array_list children;
+    // One walk_dir per directory in children, in the same order.
+    array_list subdirs;
+} walk_dir;
+
+typedef struct {
+    array_list dirs;
+    LightLock lock;
+} walk_deque;
+
+typedef struct {
+    populate_files_data* data;
+
+    walk_deque deques[WALK_WORKERS];
+
+    LightLock lock;
+    CondVar cond;
+    u32 pending;
+    volatile bool stop;
+    Result result;
+} walk_data;
+
+typedef struct {
+    walk_data* walk;
+    u32 id;
+} walk_worker;
+
+static walk_dir* task_populate_files_walk_create_dir(list_item* item) {
+    walk_dir* dir = (walk_dir*) calloc(1, sizeof(walk_dir));
+    if(dir != NULL) {
+        dir->item = item;
+        array_list_init(&dir->children);
+        array_list_init(&dir->subdirs);
+    }
+
+    return dir;
+}
+
+static walk_dir* task_populate_files_walk_take(walk_data* walk, u32 id) {
+    walk_dir* dir = NULL;
+
+    walk_deque* own = &walk->deques[id];
+
+    LightLock_Lock(&own->lock);
+
+    u32 size = array_list_size(&own->dirs);
+    if(size > 0) {
+        dir = (walk_dir*) array_list_get(&own->dirs, size - 1);
+        array_list_remove_at(&own->dirs, size - 1);
+    }
+
+    LightLock_Unlock(&own->lock);
+
+    // Steal from the oldest end of the other deques; those directories are nearest the root and carry the most work.
+    for(u32 i = 1; i < WALK_WORKERS && dir == NULL; i++) {
+        walk_deque* victim = &walk->deques[(id + i) % WALK_WORKERS];
+
+        LightLock_Lock(&victim->lock);
+
+        if(array_list_size(&victim->dirs) > 0) {
+            dir = (walk_dir*) array_list_get(&victim->dirs, 0);
+            array_list_remove_at(&victim->dirs, 0);
+        }
+
+        LightLock_Unlock(&victim->lock);
+    }
+
+    return dir;
+}
+
+static Result task_populate_files_walk_read(walk_data* walk, walk_dir* dir) {
+    populate_files_data* data = walk->data;
+    file_info* curr = (file_info*) dir->item->data;
+
+    Result res = 0;
+
+    FS_Path* fsPath = fs_make_path_utf8(curr->path);
+    if(fsPath != NULL) {
+        Handle dirHandle = 0;
+        if(R_SUCCEEDED(res = FSUSER_OpenDirectory(&dirHandle, curr->archive, *fsPath))) {
+            FS_DirectoryEntry* entries = (FS_DirectoryEntry*) calloc(DIR_PAGE_ENTRIES, sizeof(FS_DirectoryEntry));
+            if(entries != NULL) {
+                u32 entryCount = 0;
+                while(!walk->stop && R_SUCCEEDED(res) && R_SUCCEEDED(res = FSDIR_Read(dirHandle, &entryCount, DIR_PAGE_ENTRIES, entries)) && entryCount > 0) {
+                    for(u32 i = 0; i < entryCount && R_SUCCEEDED(res); i++) {
+                        svcWaitSynchronization(task_get_pause_event(), U64_MAX);
+                        if(walk->stop || task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
+                            walk->stop = true;
+                            break;
+                        }
+
+                        char name[FILE_NAME_MAX] = {'\0'};
+                        utf16_to_utf8((uint8_t*) name, entries[i].name, FILE_NAME_MAX - 1);
+
+                        if(data->filter == NULL || data->filter(data->filterData, name, entries[i].attributes)) {
+                            char path[FILE_PATH_MAX] = {'\0'};
+                            snprintf(path, FILE_PATH_MAX, "%s%s", curr->path, name);
+
+                            list_item* item = NULL;
+                            if(R_SUCCEEDED(res = task_create_file_item(&item, curr->archive, path, entries[i].attributes, false)) && !array_list_add(&dir->children, item)) {
+                                task_free_file(item);
+                                res = R_APP_OUT_OF_MEMORY;
+                            }
+                        }
+                    }
+                }
+
+                free(entries);
+            } else {
+                res = R_APP_OUT_OF_MEMORY;
+            }
+
+            FSDIR_Close(dirHandle);
+        }
+
+        fs_free_path_utf8(fsPath);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    if(R_SUCCEEDED(res) && !array_list_sort(&dir->children, NULL, task_compare_files)) {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    for(u32 i = 0; i < array_list_size(&dir->children) && R_SUCCEEDED(res); i++) {
+        list_item* child = (list_item*) array_list_get(&dir->children, i);
+        if(((file_info*) child->data)->attributes & FS_ATTRIBUTE_DIRECTORY) {
+            walk_dir* subdir = task_populate_files_walk_create_dir(child);
+            if(subdir == NULL || !array_list_add(&dir->subdirs, subdir)) {
+                if(subdir != NULL) {
+                    free(subdir);
+                }
+
+                res = R_APP_OUT_OF_MEMORY;
+            }
+        }
+    }
+
+    return res;
+}
+
+static void task_populate_files_walk_thread(void* arg) {
+    walk_worker* worker = (walk_worker*) arg;
+    walk_data* walk = worker->walk;
+
+    while(true) {
+        walk_dir* dir = task_populate_files_walk_take(walk, worker->id);
+        if(dir == NULL) {
+            LightLock_Lock(&walk->lock);
+
+            bool done = walk->stop || walk->pending == 0;
+            if(!done) {
+                CondVar_WaitTimeout(&walk->cond, &walk->lock, WALK_WAIT_NS);
+            }
+
+            LightLock_Unlock(&walk->lock);
+
+            if(done) {
+                break;
+            }
+
+            continue;
+        }
+
+        Result res = 0;
+        if(!walk->stop) {
+            res = task_populate_files_walk_read(walk, dir);
+        }
+
+        // Subdirectories are counted before they become visible to thieves, so pending cannot reach zero early.
+        u32 count = R_SUCCEEDED(res) && !walk->stop ? array_list_size(&dir->subdirs) : 0;
+
+        LightLock_Lock(&walk->lock);
+        walk->pending += count;
+        LightLock_Unlock(&walk->lock);
+
+        walk_deque* own = &walk->deques[worker->id];
+
+        LightLock_Lock(&own->lock);
+
+        if(array_list_reserve(&own->dirs, array_list_size(&own->dirs) + count)) {
+            for(u32 i = 0; i < count; i++) {
+                array_list_add(&own->dirs, array_list_get(&dir->subdirs, i));
+            }
+        } else {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+
+        LightLock_Unlock(&own->lock);
+
+        LightLock_Lock(&walk->lock);
+
+        if(R_FAILED(res)) {
+            walk->pending -= count;
+
+            if(R_SUCCEEDED(walk->result)) {
+                walk->result = res;
+            }
+
+            walk->stop = true;
+        }
+
+        walk->pending--;
+
+        CondVar_Broadcast(&walk->cond);
+
+        LightLock_Unlock(&walk->lock);
+    }
+}
+
+static Result task_populate_files_walk_emit(walk_dir* dir, linked_list* items, Result res) {
+    // Pre-order with children in sorted order, so every directory precedes its contents.
+    // Each walk_dir is freed once emitted; children that cannot be added are freed with it.
+    u32 nextSubdir = 0;
+    for(u32 i = 0; i < array_list_size(&dir->children); i++) {
+        list_item* child = (list_item*) array_list_get(&dir->children, i);
+
+        walk_dir* subdir = NULL;
+        if(nextSubdir < array_list_size(&dir->subdirs) && ((walk_dir*) array_list_get(&dir->subdirs, nextSubdir))->item == child) {
+            subdir = (walk_dir*) array_list_get(&dir->subdirs, nextSubdir++);
+        }
+
+        if(R_SUCCEEDED(res) && !linked_list_add(items, child)) {
+            res = R_APP_OUT_OF_MEMORY;
+        }
+
+        if(R_FAILED(res)) {
+            task_free_file(child);
+        }
+
+        if(subdir != NULL) {
+            res = task_populate_files_walk_emit(subdir, items, res);
+        }
+    }
+
+    array_list_destroy(&dir->children);
+    array_list_destroy(&dir->subdirs);
+    free(dir);
+
+    return res;
+}
+
+static Result task_populate_files_walk(populate_files_data* data, list_item* baseItem) {
+    walk_data* walk = (walk_data*) calloc(1, sizeof(walk_data));
+    if(walk == NULL) {
+        return R_APP_OUT_OF_MEMORY;
+    }
+
+    walk_dir* root = task_populate_files_walk_create_dir(baseItem);
+    if(root == NULL) {
+        free(walk);
+        return R_APP_OUT_OF_MEMORY;
+    }
+
+    walk->data = data;
+    walk->pending = 1;
+    walk->stop = false;
+    walk->result = 0;
+
+    LightLock_Init(&walk->lock);
+    CondVar_Init(&walk->cond);
+
+    for(u32 i = 0; i < WALK_WORKERS; i++) {
+        array_list_init(&walk->deques[i].dirs);
+        LightLock_Init(&walk->deques[i].lock);
+    }
+
+    Result res = 0;
+
+    if(array_list_add(&walk->deques[0].dirs, root)) {
+        walk_worker workers[WALK_WORKERS];
+        Thread threads[WALK_WORKERS];
+        memset(threads, 0, sizeof(threads));
+
+        for(u32 i = 0; i < WALK_WORKERS; i++) {
+            workers[i].walk = walk;
+            workers[i].id = i;
+        }
+
+        // This thread is worker 0; if a helper cannot be created the walk continues with fewer workers.
+        for(u32 i = 1; i < WALK_WORKERS; i++) {
+            threads[i] = threadCreate(task_populate_files_walk_thread, &workers[i], 0x4000, 0x19, 1, false);
+        }
+
+        task_populate_files_walk_thread(&workers[0]);
+
+        for(u32 i = 1; i < WALK_WORKERS; i++) {
+            if(threads[i] != NULL) {
+                threadJoin(threads[i], U64_MAX);
+                threadFree(threads[i]);
+            }
+        }
+
+        res = walk->result;
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    // Directories left queued after a stop are already linked into the tree, so emitting it releases everything.
+    res = task_populate_files_walk_emit(root, data->items, res);
+
+    for(u32 i = 0; i < WALK_WORKERS; i++) {
+        array_list_destroy(&walk->deques[i].dirs);
+    }
+
+    free(walk);
+
+    return res;
+}
+
 static void task_populate_files_thread(void* arg) {
     populate_files_data* data = (populate_files_data*) arg;
 
@@ -204,96 +691,87 @@ static void task_populate_files_thread(void* arg) {
             string_copy(baseItem->name, "<current file>", LIST_ITEM_NAME_MAX);
         }
 
-        linked_list queue;
-        linked_list_init(&queue);
-
-        linked_list_add(&queue, baseItem);
-
-        bool quit = false;
-        while(!quit && R_SUCCEEDED(res) && linked_list_size(&queue) > 0) {
-            u32 tail = linked_list_size(&queue) - 1;
-            list_item* currItem = (list_item*) linked_list_get(&queue, tail);
-            file_info* curr = (file_info*) currItem->data;
-            linked_list_remove_at(&queue, tail);
+        if(data->includeBase) {
+            linked_list_add(data->items, baseItem);
+        }
 
-            if(data->includeBase || currItem != baseItem) {
-                linked_list_add(data->items, currItem);
+        if(baseInfo->attributes & FS_ATTRIBUTE_DIRECTORY) {
+            if(data->recursive) {
+                res = task_populate_files_walk(data, baseItem);
+            } else {
+                res = task_populate_files_read_directory(data, baseInfo);
             }
+        }
 
-            if(curr->attributes & FS_ATTRIBUTE_DIRECTORY) {
-                FS_Path* fsPath = fs_make_path_utf8(curr->path);
-                if(fsPath != NULL) {
-                    Handle dirHandle = 0;
-                    if(R_SUCCEEDED(res = FSUSER_OpenDirectory(&dirHandle, curr->archive, *fsPath))) {
-                        u32 entryCount = 0;
-                        FS_DirectoryEntry* entries = (FS_DirectoryEntry*) calloc(MAX_FILES, sizeof(FS_DirectoryEntry));
-                        if(entries != NULL) {
-                            if(R_SUCCEEDED(res = FSDIR_Read(dirHandle, &entryCount, MAX_FILES, entries)) && entryCount > 0) {
-                                qsort(entries, entryCount, sizeof(FS_DirectoryEntry), task_populate_files_compare_directory_entries);
-
-                                for(u32 i = 0; i < entryCount && R_SUCCEEDED(res); i++) {
-                                    svcWaitSynchronization(task_get_pause_event(), U64_MAX);
-                                    if(task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
-                                        quit = true;
-                                        break;
-                                    }
+        if(!data->includeBase) {
+            task_free_file(baseItem);
+        }
+    }
 
-                                    char name[FILE_NAME_MAX] = {'\0'};
-                                    utf16_to_utf8((uint8_t*) name, entries[i].name, FILE_NAME_MAX - 1);
-
-                                    if(data->filter == NULL || data->filter(data->filterData, name, entries[i].attributes)) {
-                                        char path[FILE_PATH_MAX] = {'\0'};
-                                        snprintf(path, FILE_PATH_MAX, "%s%s", curr->path, name);
-
-                                        list_item* item = NULL;
-                                        if(R_SUCCEEDED(res = task_create_file_item(&item, curr->archive, path, entries[i].attributes, false))) {
-                                            if(data->recursive && (((file_info*) item->data)->attributes & FS_ATTRIBUTE_DIRECTORY)) {
-                                                linked_list_add(&queue, item);
-                                            } else {
-                                                linked_list_add(data->items, item);
-                                            }
-                                        }
-                                    }
-                                }
-                            }
+    if(R_SUCCEEDED(res) && data->meta) {
+        array_list items;
+        array_list_init(&items);
+
+        bool* loaded = NULL;
+        if(array_list_add_all(&items, data->items) && (loaded = (bool*) calloc(array_list_size(&items) + 1, sizeof(bool))) != NULL) {
+            u32 count = array_list_size(&items);
+            u32 remaining = count;
+
+            // Metadata is loaded outwards from the focused row, so the rows on screen resolve first.
+            // Rows in [low, high) are loaded; the range restarts whenever the focus moves.
+            list_item* focus = NULL;
+            u32 low = 0;
+            u32 high = 0;
+            bool below = true;
+
+            while(remaining > 0) {
+                svcWaitSynchronization(task_get_pause_event(), U64_MAX);
+                if(task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
+                    break;
+                }
 
-                            free(entries);
-                        } else {
-                            res = R_APP_OUT_OF_MEMORY;
-                        }
+                list_item* currFocus = data->metaFocus;
+                if(currFocus != focus) {
+                    focus = currFocus;
 
-                        FSDIR_Close(dirHandle);
+                    int focusIndex = focus != NULL ? array_list_index_of(&items, focus) : -1;
+                    if(focusIndex != -1) {
+                        low = (u32) focusIndex;
+                        high = (u32) focusIndex;
                     }
+                }
 
-                    fs_free_path_utf8(fsPath);
-                } else {
-                    res = R_APP_OUT_OF_MEMORY;
+                while(high < count && loaded[high]) {
+                    high++;
                 }
-            }
-        }
 
-        linked_list_destroy(&queue);
+                while(low > 0 && loaded[low - 1]) {
+                    low--;
+                }
 
-        if(!data->includeBase) {
-            task_free_file(baseItem);
-        }
-    }
+                u32 index = 0;
+                if(high < count && (below || low == 0)) {
+                    index = high++;
+                } else {
+                    index = --low;
+                }
 
-    if(R_SUCCEEDED(res) && data->meta) {
-        linked_list_iter iter;
-        linked_list_iterate(data->items, &iter);
+                below = !below;
 
-        while(linked_list_iter_has_next(&iter)) {
-            svcWaitSynchronization(task_get_pause_event(), U64_MAX);
-            if(task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
-                break;
-            }
+                loaded[index] = true;
+                remaining--;
 
-            list_item* item = (list_item*) linked_list_iter_next(&iter);
-            file_info* fileInfo = (file_info*) item->data;
+                task_populate_files_retrieve_meta((file_info*) ((list_item*) array_list_get(&items, index))->data);
+            }
+        } else {
+            res = R_APP_OUT_OF_MEMORY;
+        }
 
-            task_populate_files_retrieve_meta(fileInfo);
+        if(loaded != NULL) {
+            free(loaded);
         }
+
+        array_list_destroy(&items);
     }
 
     svcCloseHandle(data->cancelEvent);
@@ -310,7 +788,7 @@ void task_free_file(list_item* item) {
     if(item->data != NULL) {
         file_info* fileInfo = (file_info*) item->data;
         if(fileInfo->isCia && fileInfo->ciaInfo.hasMeta) {
-            screen_unload_texture(fileInfo->ciaInfo.meta.texture);
+            icon_atlas_remove(fileInfo->ciaInfo.meta.icon);
         }
 
         free(item->data);
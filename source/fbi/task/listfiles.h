@@ -30,6 +30,7 @@ typedef struct file_info_s {
     cia_info ciaInfo;
     bool isTicket;
     ticket_info ticketInfo;
+    bool isCompressed;
 } file_info;
 
 typedef struct populate_files_data_s {
@@ -41,6 +42,8 @@ typedef struct populate_files_data_s {
     bool recursive;
     bool includeBase;
     bool meta;
+    // Optional; metadata for this item and its neighbours is loaded first. May be changed while populating.
+    list_item* volatile metaFocus;
 
     bool (*filter)(void* data, const char* name, u32 attributes);
     void* filterData;
@@ -10,84 +10,257 @@
 #include "../resources.h"
 #include "../../core/core.h"
 
-static Result task_populate_titles_add_ctr(populate_titles_data* data, FS_MediaType mediaType, u64 titleId) {
-    Result res = 0;
+#define TITLE_INFO_BATCH 64
 
-    AM_TitleEntry entry;
-    if(R_SUCCEEDED(res = AM_GetTitleInfo(mediaType, 1, &titleId, &entry))) {
-        list_item* item = (list_item*) calloc(1, sizeof(list_item));
-        if(item != NULL) {
-            title_info* titleInfo = (title_info*) calloc(1, sizeof(title_info));
-            if(titleInfo != NULL) {
-                titleInfo->mediaType = mediaType;
-                titleInfo->titleId = titleId;
-                AM_GetTitleProductCode(mediaType, titleId, titleInfo->productCode);
-                titleInfo->version = entry.version;
-                titleInfo->installedSize = entry.size;
-                titleInfo->twl = false;
-                titleInfo->hasMeta = false;
+static bool task_populate_titles_read_ctr_smdh(title_info* titleInfo, SMDH* smdh) {
+    static const u32 filePath[5] = {0x00000000, 0x00000000, 0x00000002, 0x6E6F6369, 0x00000000};
+    u32 archivePath[4] = {(u32) (titleInfo->titleId & 0xFFFFFFFF), (u32) ((titleInfo->titleId >> 32) & 0xFFFFFFFF), titleInfo->mediaType, 0x00000000};
 
-                static const u32 filePath[5] = {0x00000000, 0x00000000, 0x00000002, 0x6E6F6369, 0x00000000};
-                u32 archivePath[4] = {(u32) (titleId & 0xFFFFFFFF), (u32) ((titleId >> 32) & 0xFFFFFFFF), mediaType, 0x00000000};
-
-                Handle fileHandle;
-                if(R_SUCCEEDED(FSUSER_OpenFileDirectly(&fileHandle, ARCHIVE_SAVEDATA_AND_CONTENT,
-                                                       fs_make_path_binary(archivePath, sizeof(archivePath)),
-                                                       fs_make_path_binary(filePath, sizeof(filePath)), FS_OPEN_READ, 0))) {
-                    SMDH* smdh = (SMDH*) calloc(1, sizeof(SMDH));
-                    if(smdh != NULL) {
-                        u32 bytesRead = 0;
-                        if(R_SUCCEEDED(FSFILE_Read(fileHandle, &bytesRead, 0, smdh, sizeof(SMDH))) && bytesRead == sizeof(SMDH)) {
-                            if(smdh->magic[0] == 'S' && smdh->magic[1] == 'M' && smdh->magic[2] == 'D' && smdh->magic[3] == 'H') {
-                                titleInfo->hasMeta = true;
-
-                                SMDH_title* smdhTitle = smdh_select_title(smdh);
-
-                                utf16_to_utf8((uint8_t*) item->name, smdhTitle->shortDescription, LIST_ITEM_NAME_MAX - 1);
-
-                                utf16_to_utf8((uint8_t*) titleInfo->meta.shortDescription, smdhTitle->shortDescription, sizeof(titleInfo->meta.shortDescription) - 1);
-                                utf16_to_utf8((uint8_t*) titleInfo->meta.longDescription, smdhTitle->longDescription, sizeof(titleInfo->meta.longDescription) - 1);
-                                utf16_to_utf8((uint8_t*) titleInfo->meta.publisher, smdhTitle->publisher, sizeof(titleInfo->meta.publisher) - 1);
-                                titleInfo->meta.region = smdh->region;
-                                titleInfo->meta.texture = screen_allocate_free_texture();
-                                screen_load_texture_tiled(titleInfo->meta.texture, smdh->largeIcon, sizeof(smdh->largeIcon), 48, 48, GPU_RGB565, false);
-                            }
-                        }
+    bool read = false;
 
-                        free(smdh);
-                    }
+    Handle fileHandle;
+    if(R_SUCCEEDED(FSUSER_OpenFileDirectly(&fileHandle, ARCHIVE_SAVEDATA_AND_CONTENT,
+                                           fs_make_path_binary(archivePath, sizeof(archivePath)),
+                                           fs_make_path_binary(filePath, sizeof(filePath)), FS_OPEN_READ, 0))) {
+        u32 bytesRead = 0;
+        read = R_SUCCEEDED(FSFILE_Read(fileHandle, &bytesRead, 0, smdh, sizeof(SMDH))) && bytesRead == sizeof(SMDH)
+               && smdh->magic[0] == 'S' && smdh->magic[1] == 'M' && smdh->magic[2] == 'D' && smdh->magic[3] == 'H';
 
-                    FSFILE_Close(fileHandle);
-                }
+        FSFILE_Close(fileHandle);
+    }
 
-                if(string_is_empty(item->name)) {
-                    snprintf(item->name, LIST_ITEM_NAME_MAX, "%016llX", titleId);
-                }
+    return read;
+}
+
+// Reloads an evicted icon, preferring the metadata cache over the title's SMDH.
+static bool task_populate_titles_load_ctr_icon(void* data, void* pixels, u32 size) {
+    title_info* titleInfo = (title_info*) data;
+
+    bool loaded = false;
+
+    meta_cache_entry* cacheEntry = (meta_cache_entry*) calloc(1, sizeof(meta_cache_entry));
+    if(cacheEntry != NULL) {
+        if(size == sizeof(cacheEntry->icon) && meta_cache_get(meta_cache_title_key(titleInfo->mediaType, titleInfo->titleId), titleInfo->version, cacheEntry) && cacheEntry->hasMeta) {
+            memcpy(pixels, cacheEntry->icon, size);
+            loaded = true;
+        }
 
-                if(mediaType == MEDIATYPE_NAND) {
-                    item->color = COLOR_NAND;
-                } else if(mediaType == MEDIATYPE_SD) {
-                    item->color = COLOR_SD;
-                } else if(mediaType == MEDIATYPE_GAME_CARD) {
-                    item->color = COLOR_GAME_CARD;
+        free(cacheEntry);
+    }
+
+    if(!loaded) {
+        SMDH* smdh = (SMDH*) calloc(1, sizeof(SMDH));
+        if(smdh != NULL) {
+            if(size == sizeof(smdh->largeIcon) && task_populate_titles_read_ctr_smdh(titleInfo, smdh)) {
+                memcpy(pixels, smdh->largeIcon, size);
+                loaded = true;
+            }
+
+            free(smdh);
+        }
+    }
+
+    return loaded;
+}
+
+static Result task_populate_titles_add_ctr(populate_titles_data* data, FS_MediaType mediaType, AM_TitleEntry* entry) {
+    Result res = 0;
+
+    list_item* item = (list_item*) calloc(1, sizeof(list_item));
+    if(item != NULL) {
+        title_info* titleInfo = (title_info*) calloc(1, sizeof(title_info));
+        if(titleInfo != NULL) {
+            titleInfo->mediaType = mediaType;
+            titleInfo->titleId = entry->titleID;
+            titleInfo->version = entry->version;
+            titleInfo->installedSize = entry->size;
+            titleInfo->twl = false;
+            titleInfo->hasMeta = false;
+
+            // Only cached metadata is used here; the product code and uncached SMDHs are loaded once the list is shown.
+            meta_cache_entry* cacheEntry = (meta_cache_entry*) calloc(1, sizeof(meta_cache_entry));
+            if(cacheEntry != NULL) {
+                if(meta_cache_get(meta_cache_title_key(mediaType, entry->titleID), entry->version, cacheEntry) && cacheEntry->hasMeta) {
+                    titleInfo->hasMeta = true;
+
+                    string_copy(item->name, cacheEntry->shortDescription, LIST_ITEM_NAME_MAX);
+
+                    string_copy(titleInfo->meta.shortDescription, cacheEntry->shortDescription, sizeof(titleInfo->meta.shortDescription));
+                    string_copy(titleInfo->meta.longDescription, cacheEntry->longDescription, sizeof(titleInfo->meta.longDescription));
+                    string_copy(titleInfo->meta.publisher, cacheEntry->publisher, sizeof(titleInfo->meta.publisher));
+                    titleInfo->meta.region = cacheEntry->region;
+                    titleInfo->meta.icon = icon_atlas_add(48, 48, GPU_RGB565, true, cacheEntry->icon, task_populate_titles_load_ctr_icon, titleInfo);
                 }
 
-                item->data = titleInfo;
+                free(cacheEntry);
+            }
 
-                linked_list_add_sorted(data->items, item, data->userData, data->compare);
-            } else {
-                free(item);
+            if(string_is_empty(item->name)) {
+                snprintf(item->name, LIST_ITEM_NAME_MAX, "%016llX", entry->titleID);
+            }
 
-                res = R_APP_OUT_OF_MEMORY;
+            if(mediaType == MEDIATYPE_NAND) {
+                item->color = COLOR_NAND;
+            } else if(mediaType == MEDIATYPE_SD) {
+                item->color = COLOR_SD;
+            } else if(mediaType == MEDIATYPE_GAME_CARD) {
+                item->color = COLOR_GAME_CARD;
             }
+
+            item->data = titleInfo;
+
+            linked_list_add_sorted(data->items, item, data->userData, data->compare);
         } else {
+            free(item);
+
             res = R_APP_OUT_OF_MEMORY;
         }
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
     }
 
     return res;
 }
 
+struct title_name_update_s {
+    list_item* item;
+    char name[LIST_ITEM_NAME_MAX];
+
+    title_name_update* next;
+};
+
+static void task_populate_titles_queue_name(populate_titles_data* data, list_item* item, const char* name) {
+    title_name_update* update = (title_name_update*) calloc(1, sizeof(title_name_update));
+    if(update != NULL) {
+        update->item = item;
+        string_copy(update->name, name, LIST_ITEM_NAME_MAX);
+
+        LightLock_Lock(&data->nameUpdatesLock);
+
+        update->next = data->nameUpdates;
+        data->nameUpdates = update;
+
+        LightLock_Unlock(&data->nameUpdatesLock);
+    }
+}
+
+// Copies queued names into their items; call from the thread that draws the list.
+void task_populate_titles_apply_names(populate_titles_data* data) {
+    if(data == NULL || data->nameUpdates == NULL) {
+        return;
+    }
+
+    LightLock_Lock(&data->nameUpdatesLock);
+
+    title_name_update* update = data->nameUpdates;
+    data->nameUpdates = NULL;
+
+    LightLock_Unlock(&data->nameUpdatesLock);
+
+    while(update != NULL) {
+        title_name_update* next = update->next;
+
+        string_copy(update->item->name, update->name, LIST_ITEM_NAME_MAX);
+        free(update);
+
+        update = next;
+    }
+}
+
+static void task_populate_titles_load_ctr_meta(populate_titles_data* data, list_item* item) {
+    title_info* titleInfo = (title_info*) item->data;
+
+    AM_GetTitleProductCode(titleInfo->mediaType, titleInfo->titleId, titleInfo->productCode);
+
+    if(titleInfo->hasMeta) {
+        return;
+    }
+
+    SMDH* smdh = (SMDH*) calloc(1, sizeof(SMDH));
+    if(smdh != NULL) {
+        if(task_populate_titles_read_ctr_smdh(titleInfo, smdh)) {
+            SMDH_title* smdhTitle = smdh_select_title(smdh);
+
+            utf16_to_utf8((uint8_t*) titleInfo->meta.shortDescription, smdhTitle->shortDescription, sizeof(titleInfo->meta.shortDescription) - 1);
+            utf16_to_utf8((uint8_t*) titleInfo->meta.longDescription, smdhTitle->longDescription, sizeof(titleInfo->meta.longDescription) - 1);
+            utf16_to_utf8((uint8_t*) titleInfo->meta.publisher, smdhTitle->publisher, sizeof(titleInfo->meta.publisher) - 1);
+            titleInfo->meta.region = smdh->region;
+            titleInfo->meta.icon = icon_atlas_add(48, 48, GPU_RGB565, true, smdh->largeIcon, task_populate_titles_load_ctr_icon, titleInfo);
+
+            titleInfo->hasMeta = true;
+
+            char name[LIST_ITEM_NAME_MAX] = {'\0'};
+            utf16_to_utf8((uint8_t*) name, smdhTitle->shortDescription, LIST_ITEM_NAME_MAX - 1);
+            if(!string_is_empty(name)) {
+                task_populate_titles_queue_name(data, item, name);
+            }
+
+            meta_cache_entry* cacheEntry = (meta_cache_entry*) calloc(1, sizeof(meta_cache_entry));
+            if(cacheEntry != NULL) {
+                cacheEntry->titleId = titleInfo->titleId;
+                cacheEntry->version = titleInfo->version;
+                cacheEntry->installedSize = titleInfo->installedSize;
+                cacheEntry->hasMeta = true;
+                string_copy(cacheEntry->shortDescription, titleInfo->meta.shortDescription, sizeof(cacheEntry->shortDescription));
+                string_copy(cacheEntry->longDescription, titleInfo->meta.longDescription, sizeof(cacheEntry->longDescription));
+                string_copy(cacheEntry->publisher, titleInfo->meta.publisher, sizeof(cacheEntry->publisher));
+                cacheEntry->region = smdh->region;
+                memcpy(cacheEntry->icon, smdh->largeIcon, sizeof(cacheEntry->icon));
+
+                meta_cache_put(meta_cache_title_key(titleInfo->mediaType, titleInfo->titleId), titleInfo->version, cacheEntry);
+
+                free(cacheEntry);
+            }
+        }
+
+        free(smdh);
+    }
+}
+
+static void task_populate_titles_convert_twl_icon(u8* icon, BNR* bnr) {
+    for(u32 x = 0; x < 32; x++) {
+        for(u32 y = 0; y < 32; y++) {
+            u32 srcPos = (((y >> 3) * 4 + (x >> 3)) * 8 + (y & 7)) * 4 + ((x & 7) >> 1);
+            u32 srcShift = (x & 1) * 4;
+            u16 srcPx = bnr->mainIconPalette[(bnr->mainIconBitmap[srcPos] >> srcShift) & 0xF];
+
+            u8 r = (u8) (srcPx & 0x1F);
+            u8 g = (u8) ((srcPx >> 5) & 0x1F);
+            u8 b = (u8) ((srcPx >> 10) & 0x1F);
+
+            u16 reversedPx = (u16) ((r << 11) | (g << 6) | (b << 1) | 1);
+
+            u32 dstPos = (y * 32 + x) * 2;
+            icon[dstPos + 0] = (u8) (reversedPx & 0xFF);
+            icon[dstPos + 1] = (u8) ((reversedPx >> 8) & 0xFF);
+        }
+    }
+}
+
+// Reloads an evicted icon from the title's banner.
+static bool task_populate_titles_load_twl_icon(void* data, void* pixels, u32 size) {
+    title_info* titleInfo = (title_info*) data;
+
+    if(size != 32 * 32 * 2) {
+        return false;
+    }
+
+    bool loaded = false;
+
+    BNR* bnr = (BNR*) calloc(1, sizeof(BNR));
+    if(bnr != NULL) {
+        u64 titleId = titleInfo->mediaType == MEDIATYPE_GAME_CARD ? 0 : titleInfo->titleId;
+        if(R_SUCCEEDED(FSUSER_GetLegacyBannerData(titleInfo->mediaType, titleId, (u8*) bnr))) {
+            task_populate_titles_convert_twl_icon((u8*) pixels, bnr);
+            loaded = true;
+        }
+
+        free(bnr);
+    }
+
+    return loaded;
+}
+
 static Result task_populate_titles_add_twl(populate_titles_data* data, FS_MediaType mediaType, u64 titleId) {
     Result res = 0;
 
@@ -170,33 +343,16 @@ static Result task_populate_titles_add_twl(populate_titles_data* data, FS_MediaT
                             }
                         }
 
-                        u8 icon[32 * 32 * 2];
-                        for(u32 x = 0; x < 32; x++) {
-                            for(u32 y = 0; y < 32; y++) {
-                                u32 srcPos = (((y >> 3) * 4 + (x >> 3)) * 8 + (y & 7)) * 4 + ((x & 7) >> 1);
-                                u32 srcShift = (x & 1) * 4;
-                                u16 srcPx = bnr->mainIconPalette[(bnr->mainIconBitmap[srcPos] >> srcShift) & 0xF];
-
-                                u8 r = (u8) (srcPx & 0x1F);
-                                u8 g = (u8) ((srcPx >> 5) & 0x1F);
-                                u8 b = (u8) ((srcPx >> 10) & 0x1F);
-
-                                u16 reversedPx = (u16) ((r << 11) | (g << 6) | (b << 1) | 1);
-
-                                u32 dstPos = (y * 32 + x) * 2;
-                                icon[dstPos + 0] = (u8) (reversedPx & 0xFF);
-                                icon[dstPos + 1] = (u8) ((reversedPx >> 8) & 0xFF);
-                            }
-                        }
-
                         if(R_SUCCEEDED(headerRes)) {
                             memcpy(&titleInfo->meta.region, &header[0x1B0], sizeof(titleInfo->meta.region));
                         } else {
                             titleInfo->meta.region = 0;
                         }
 
-                        titleInfo->meta.texture = screen_allocate_free_texture();
-                        screen_load_texture_untiled(titleInfo->meta.texture, icon, sizeof(icon), 32, 32, GPU_RGBA5551, false);
+                        u8 icon[32 * 32 * 2];
+                        task_populate_titles_convert_twl_icon(icon, bnr);
+
+                        titleInfo->meta.icon = icon_atlas_add(32, 32, GPU_RGBA5551, false, icon, task_populate_titles_load_twl_icon, titleInfo);
                     }
 
                     free(bnr);
@@ -240,34 +396,74 @@ static Result task_populate_titles_from(populate_titles_data* data, FS_MediaType
     Result res = 0;
 
     if(mediaType != MEDIATYPE_GAME_CARD || type == CARD_CTR) {
+        u64 listStart = osGetTime();
+
         u32 titleCount = 0;
         if(R_SUCCEEDED(res = AM_GetTitleCount(mediaType, &titleCount))) {
             u64* titleIds = (u64*) calloc(titleCount, sizeof(u64));
-            if(titleIds != NULL) {
+            AM_TitleEntry* entries = (AM_TitleEntry*) calloc(TITLE_INFO_BATCH, sizeof(AM_TitleEntry));
+            if(titleIds != NULL && entries != NULL) {
                 if(R_SUCCEEDED(res = AM_GetTitleList(&titleCount, mediaType, titleCount, titleIds))) {
                     qsort(titleIds, titleCount, sizeof(u64), task_populate_titles_compare_ids);
 
-                    for(u32 i = 0; i < titleCount && R_SUCCEEDED(res); i++) {
-                        svcWaitSynchronization(task_get_pause_event(), U64_MAX);
-                        if(task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
-                            break;
+                    u32 count = 0;
+                    for(u32 i = 0; i < titleCount; i++) {
+                        bool dsiWare = ((titleIds[i] >> 32) & 0x8000) != 0;
+                        if(dsiWare == useDSiWare && (data->filter == NULL || data->filter(data->userData, titleIds[i], mediaType))) {
+                            titleIds[count++] = titleIds[i];
                         }
+                    }
 
-                        if(data->filter == NULL || data->filter(data->userData, titleIds[i], mediaType)) {
-                            bool dsiWare = ((titleIds[i] >> 32) & 0x8000) != 0;
-                            if(dsiWare != useDSiWare) {
-                                continue;
+                    data->listTime += osGetTime() - listStart;
+
+                    u64 infoStart = osGetTime();
+
+                    if(useDSiWare) {
+                        for(u32 i = 0; i < count && R_SUCCEEDED(res); i++) {
+                            svcWaitSynchronization(task_get_pause_event(), U64_MAX);
+                            if(task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
+                                break;
+                            }
+
+                            res = task_populate_titles_add_twl(data, mediaType, titleIds[i]);
+                        }
+                    } else {
+                        bool quit = false;
+                        for(u32 i = 0; i < count && R_SUCCEEDED(res) && !quit; i += TITLE_INFO_BATCH) {
+                            u32 batchCount = count - i < TITLE_INFO_BATCH ? count - i : TITLE_INFO_BATCH;
+
+                            if(R_FAILED(AM_GetTitleInfo(mediaType, batchCount, &titleIds[i], entries))) {
+                                // One unreadable title fails the whole batch, so fall back to fetching this batch singly.
+                                for(u32 j = 0; j < batchCount && R_SUCCEEDED(res); j++) {
+                                    res = AM_GetTitleInfo(mediaType, 1, &titleIds[i + j], &entries[j]);
+                                }
                             }
 
-                            res = dsiWare ? task_populate_titles_add_twl(data, mediaType, titleIds[i]) : task_populate_titles_add_ctr(data, mediaType, titleIds[i]);
+                            for(u32 j = 0; j < batchCount && R_SUCCEEDED(res); j++) {
+                                svcWaitSynchronization(task_get_pause_event(), U64_MAX);
+                                if(task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
+                                    quit = true;
+                                    break;
+                                }
+
+                                res = task_populate_titles_add_ctr(data, mediaType, &entries[j]);
+                            }
                         }
                     }
-                }
 
-                free(titleIds);
+                    data->infoTime += osGetTime() - infoStart;
+                }
             } else {
                 res = R_APP_OUT_OF_MEMORY;
             }
+
+            if(titleIds != NULL) {
+                free(titleIds);
+            }
+
+            if(entries != NULL) {
+                free(entries);
+            }
         }
     } else {
         res = task_populate_titles_add_twl(data, mediaType, 0);
@@ -276,6 +472,83 @@ static Result task_populate_titles_from(populate_titles_data* data, FS_MediaType
     return res;
 }
 
+static Result task_populate_titles_load_meta(populate_titles_data* data) {
+    Result res = 0;
+
+    // Items are only updated in place here; the list is on screen, so the owner re-sorts it once population finishes.
+    array_list items;
+    array_list_init(&items);
+
+    bool* loaded = NULL;
+    if(array_list_add_all(&items, data->items) && (loaded = (bool*) calloc(array_list_size(&items) + 1, sizeof(bool))) != NULL) {
+        u32 count = array_list_size(&items);
+        u32 remaining = 0;
+
+        for(u32 i = 0; i < count; i++) {
+            loaded[i] = ((title_info*) ((list_item*) array_list_get(&items, i))->data)->twl;
+            if(!loaded[i]) {
+                remaining++;
+            }
+        }
+
+        // Metadata is loaded outwards from the focused row, as in task_populate_files.
+        list_item* focus = NULL;
+        u32 low = 0;
+        u32 high = 0;
+        bool below = true;
+
+        while(remaining > 0) {
+            svcWaitSynchronization(task_get_pause_event(), U64_MAX);
+            if(task_is_quit_all() || svcWaitSynchronization(data->cancelEvent, 0) == 0) {
+                break;
+            }
+
+            list_item* currFocus = data->metaFocus;
+            if(currFocus != focus) {
+                focus = currFocus;
+
+                int focusIndex = focus != NULL ? array_list_index_of(&items, focus) : -1;
+                if(focusIndex != -1) {
+                    low = (u32) focusIndex;
+                    high = (u32) focusIndex;
+                }
+            }
+
+            while(high < count && loaded[high]) {
+                high++;
+            }
+
+            while(low > 0 && loaded[low - 1]) {
+                low--;
+            }
+
+            u32 index = 0;
+            if(high < count && (below || low == 0)) {
+                index = high++;
+            } else {
+                index = --low;
+            }
+
+            below = !below;
+
+            loaded[index] = true;
+            remaining--;
+
+            task_populate_titles_load_ctr_meta(data, (list_item*) array_list_get(&items, index));
+        }
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    if(loaded != NULL) {
+        free(loaded);
+    }
+
+    array_list_destroy(&items);
+
+    return res;
+}
+
 static void task_populate_titles_thread(void* arg) {
     populate_titles_data* data = (populate_titles_data*) arg;
 
@@ -289,6 +562,12 @@ static void task_populate_titles_thread(void* arg) {
         }
     }
 
+    if(R_SUCCEEDED(res)) {
+        u64 metaStart = osGetTime();
+        res = task_populate_titles_load_meta(data);
+        data->metaTime = osGetTime() - metaStart;
+    }
+
     svcCloseHandle(data->cancelEvent);
 
     data->result = res;
@@ -303,7 +582,7 @@ void task_free_title(list_item* item) {
     if(item->data != NULL) {
         title_info* titleInfo = (title_info*) item->data;
         if(titleInfo->hasMeta) {
-            screen_unload_texture(titleInfo->meta.texture);
+            icon_atlas_remove(titleInfo->meta.icon);
         }
 
         free(item->data);
@@ -333,11 +612,19 @@ Result task_populate_titles(populate_titles_data* data) {
         return R_APP_INVALID_ARGUMENT;
     }
 
+    // Queued names still point at the items about to be cleared.
+    task_populate_titles_apply_names(data);
     task_clear_titles(data->items);
 
+    LightLock_Init(&data->nameUpdatesLock);
+    data->nameUpdates = NULL;
+
     data->finished = false;
     data->result = 0;
     data->cancelEvent = 0;
+    data->listTime = 0;
+    data->infoTime = 0;
+    data->metaTime = 0;
 
     Result res = 0;
     if(R_SUCCEEDED(res = svcCreateEvent(&data->cancelEvent, RESET_STICKY))) {
@@ -2,6 +2,7 @@
 
 typedef struct linked_list_s linked_list;
 typedef struct list_item_s list_item;
+typedef struct title_name_update_s title_name_update;
 
 typedef struct title_info_s {
     FS_MediaType mediaType;
@@ -20,12 +21,26 @@ typedef struct populate_titles_data_s {
     void* userData;
     bool (*filter)(void* data, u64 titleId, FS_MediaType mediaType);
     int (*compare)(void* data, const void* p1, const void* p2);
+    // Optional; metadata for this item and its neighbours is loaded first. May be changed while populating.
+    list_item* volatile metaFocus;
 
+    // Names loaded after the first paint are queued here rather than written into items the UI is drawing.
+    LightLock nameUpdatesLock;
+    title_name_update* volatile nameUpdates;
+
+    // Metadata loaded after the first paint does not move items; sort them with compare once this is set.
     volatile bool finished;
     Result result;
     Handle cancelEvent;
+
+    // Milliseconds spent listing IDs, fetching title info up to the first complete list, and loading remaining metadata.
+    // Shown in the debug overlay once population finishes.
+    u64 listTime;
+    u64 infoTime;
+    u64 metaTime;
 } populate_titles_data;
 
 void task_free_title(list_item* item);
 void task_clear_titles(linked_list* items);
-Result task_populate_titles(populate_titles_data* data);
\ No newline at end of file
+Result task_populate_titles(populate_titles_data* data);
+void task_populate_titles_apply_names(populate_titles_data* data);
\ No newline at end of file
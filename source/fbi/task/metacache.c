@@ -0,0 +1,336 @@
+#include <malloc.h>
+#include <string.h>
+
+#include <3ds.h>
+
+#include "uitask.h"
+#include "../../core/core.h"
+
+#define META_CACHE_PATH "/fbi/cache/meta.bin"
+
+#define META_CACHE_MAGIC 0x4D434246 // FBCM
+#define META_CACHE_VERSION 1
+
+#define META_CACHE_SLOTS 1024
+#define META_CACHE_PROBES 8
+
+#define META_CACHE_SLOT_SIZE 0x10
+#define META_CACHE_TABLE_OFFSET META_CACHE_HEADER_SIZE
+#define META_CACHE_RECORDS_OFFSET (META_CACHE_TABLE_OFFSET + META_CACHE_SLOTS * META_CACHE_SLOT_SIZE)
+
+typedef struct {
+    u64 key;
+    u64 stamp;
+} meta_cache_slot;
+
+static LightLock meta_cache_lock;
+static Handle meta_cache_file = 0;
+static meta_cache_slot* meta_cache_slots = NULL;
+
+static void meta_cache_write_u16(u8* out, u16 value) {
+    out[0] = (u8) value;
+    out[1] = (u8) (value >> 8);
+}
+
+static void meta_cache_write_u32(u8* out, u32 value) {
+    for(u32 i = 0; i < 4; i++) {
+        out[i] = (u8) (value >> (i * 8));
+    }
+}
+
+static void meta_cache_write_u64(u8* out, u64 value) {
+    for(u32 i = 0; i < 8; i++) {
+        out[i] = (u8) (value >> (i * 8));
+    }
+}
+
+static u16 meta_cache_read_u16(const u8* in) {
+    return (u16) (in[0] | (in[1] << 8));
+}
+
+static u32 meta_cache_read_u32(const u8* in) {
+    u32 value = 0;
+    for(u32 i = 0; i < 4; i++) {
+        value |= (u32) in[i] << (i * 8);
+    }
+
+    return value;
+}
+
+static u64 meta_cache_read_u64(const u8* in) {
+    u64 value = 0;
+    for(u32 i = 0; i < 8; i++) {
+        value |= (u64) in[i] << (i * 8);
+    }
+
+    return value;
+}
+
+u64 meta_cache_hash(u64 hash, const void* data, size_t size) {
+    // FNV-1a; pass 0 to start a new hash.
+    if(hash == 0) {
+        hash = 0xCBF29CE484222325ULL;
+    }
+
+    for(size_t i = 0; i < size; i++) {
+        hash ^= ((const u8*) data)[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+u64 meta_cache_title_key(FS_MediaType mediaType, u64 titleId) {
+    return meta_cache_hash(meta_cache_hash(0, &mediaType, sizeof(mediaType)), &titleId, sizeof(titleId));
+}
+
+void meta_cache_encode_header(u8* out, u32 slotCount) {
+    meta_cache_write_u32(out + 0x0, META_CACHE_MAGIC);
+    meta_cache_write_u32(out + 0x4, META_CACHE_VERSION);
+    meta_cache_write_u32(out + 0x8, slotCount);
+    meta_cache_write_u32(out + 0xC, META_CACHE_RECORD_SIZE);
+}
+
+bool meta_cache_decode_header(const u8* in, u32 slotCount) {
+    return meta_cache_read_u32(in + 0x0) == META_CACHE_MAGIC
+           && meta_cache_read_u32(in + 0x4) == META_CACHE_VERSION
+           && meta_cache_read_u32(in + 0x8) == slotCount
+           && meta_cache_read_u32(in + 0xC) == META_CACHE_RECORD_SIZE;
+}
+
+void meta_cache_encode_record(u8* out, u64 key, u64 stamp, const meta_cache_entry* entry) {
+    memset(out, 0, META_CACHE_RECORD_SIZE);
+
+    meta_cache_write_u64(out + 0x00, key);
+    meta_cache_write_u64(out + 0x08, stamp);
+    meta_cache_write_u64(out + 0x10, entry->titleId);
+    meta_cache_write_u64(out + 0x18, entry->installedSize);
+    meta_cache_write_u16(out + 0x20, entry->version);
+    meta_cache_write_u16(out + 0x22, entry->hasMeta ? 1 : 0);
+    meta_cache_write_u32(out + 0x24, entry->region);
+
+    u8* strings = out + 0x28;
+    string_copy((char*) strings, entry->shortDescription, 0x100);
+    string_copy((char*) strings + 0x100, entry->longDescription, 0x200);
+    string_copy((char*) strings + 0x300, entry->publisher, 0x100);
+
+    memcpy(strings + 0x400, entry->icon, META_CACHE_ICON_SIZE);
+}
+
+bool meta_cache_decode_record(const u8* in, u64 key, u64 stamp, meta_cache_entry* entry) {
+    // The record repeats its key and stamp, so a record torn by an interrupted write is never used.
+    if(meta_cache_read_u64(in + 0x00) != key || meta_cache_read_u64(in + 0x08) != stamp) {
+        return false;
+    }
+
+    entry->titleId = meta_cache_read_u64(in + 0x10);
+    entry->installedSize = meta_cache_read_u64(in + 0x18);
+    entry->version = meta_cache_read_u16(in + 0x20);
+    entry->hasMeta = (meta_cache_read_u16(in + 0x22) & 1) != 0;
+    entry->region = meta_cache_read_u32(in + 0x24);
+
+    const u8* strings = in + 0x28;
+    string_copy(entry->shortDescription, (const char*) strings, sizeof(entry->shortDescription));
+    string_copy(entry->longDescription, (const char*) strings + 0x100, sizeof(entry->longDescription));
+    string_copy(entry->publisher, (const char*) strings + 0x300, sizeof(entry->publisher));
+
+    memcpy(entry->icon, strings + 0x400, META_CACHE_ICON_SIZE);
+
+    return true;
+}
+
+static Result meta_cache_reset() {
+    Result res = 0;
+
+    u8 header[META_CACHE_HEADER_SIZE];
+    meta_cache_encode_header(header, META_CACHE_SLOTS);
+
+    memset(meta_cache_slots, 0, META_CACHE_SLOTS * sizeof(meta_cache_slot));
+
+    u8* table = (u8*) calloc(META_CACHE_SLOTS, META_CACHE_SLOT_SIZE);
+    if(table != NULL) {
+        u32 bytesWritten = 0;
+        if(R_SUCCEEDED(res = FSFILE_SetSize(meta_cache_file, META_CACHE_RECORDS_OFFSET))
+           && R_SUCCEEDED(res = FSFILE_Write(meta_cache_file, &bytesWritten, META_CACHE_TABLE_OFFSET, table, META_CACHE_SLOTS * META_CACHE_SLOT_SIZE, 0))) {
+            res = FSFILE_Write(meta_cache_file, &bytesWritten, 0, header, sizeof(header), FS_WRITE_FLUSH);
+        }
+
+        free(table);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+static Result meta_cache_load() {
+    Result res = 0;
+
+    u8 header[META_CACHE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+
+    u32 bytesRead = 0;
+    if(R_FAILED(FSFILE_Read(meta_cache_file, &bytesRead, 0, header, sizeof(header))) || bytesRead != sizeof(header) || !meta_cache_decode_header(header, META_CACHE_SLOTS)) {
+        // Missing, foreign or older format; start over.
+        return meta_cache_reset();
+    }
+
+    u8* table = (u8*) malloc(META_CACHE_SLOTS * META_CACHE_SLOT_SIZE);
+    if(table != NULL) {
+        if(R_SUCCEEDED(res = FSFILE_Read(meta_cache_file, &bytesRead, META_CACHE_TABLE_OFFSET, table, META_CACHE_SLOTS * META_CACHE_SLOT_SIZE))) {
+            if(bytesRead == META_CACHE_SLOTS * META_CACHE_SLOT_SIZE) {
+                for(u32 i = 0; i < META_CACHE_SLOTS; i++) {
+                    meta_cache_slots[i].key = meta_cache_read_u64(table + i * META_CACHE_SLOT_SIZE);
+                    meta_cache_slots[i].stamp = meta_cache_read_u64(table + i * META_CACHE_SLOT_SIZE + 8);
+                }
+            } else {
+                res = meta_cache_reset();
+            }
+        }
+
+        free(table);
+    } else {
+        res = R_APP_OUT_OF_MEMORY;
+    }
+
+    return res;
+}
+
+void meta_cache_init() {
+    LightLock_Init(&meta_cache_lock);
+
+    if((meta_cache_slots = (meta_cache_slot*) calloc(META_CACHE_SLOTS, sizeof(meta_cache_slot))) == NULL) {
+        return;
+    }
+
+    Result res = 0;
+
+    FS_Archive sdmcArchive = 0;
+    if(R_SUCCEEDED(res = FSUSER_OpenArchive(&sdmcArchive, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, "")))) {
+        if(R_SUCCEEDED(res = fs_ensure_dir(sdmcArchive, "/fbi/")) && R_SUCCEEDED(res = fs_ensure_dir(sdmcArchive, "/fbi/cache/"))) {
+            res = FSUSER_OpenFile(&meta_cache_file, sdmcArchive, fsMakePath(PATH_ASCII, META_CACHE_PATH), FS_OPEN_READ | FS_OPEN_WRITE | FS_OPEN_CREATE, 0);
+        }
+
+        FSUSER_CloseArchive(sdmcArchive);
+    }
+
+    if(R_SUCCEEDED(res)) {
+        res = meta_cache_load();
+    }
+
+    // The cache is an optimization only; run without it if the SD card is unavailable.
+    if(R_FAILED(res)) {
+        meta_cache_exit();
+    }
+}
+
+void meta_cache_exit() {
+    if(meta_cache_file != 0) {
+        FSFILE_Close(meta_cache_file);
+        meta_cache_file = 0;
+    }
+
+    if(meta_cache_slots != NULL) {
+        free(meta_cache_slots);
+        meta_cache_slots = NULL;
+    }
+}
+
+static int meta_cache_find(u64 key, bool insert) {
+    int freeSlot = -1;
+
+    for(u32 i = 0; i < META_CACHE_PROBES; i++) {
+        u32 slot = (u32) ((key + i) % META_CACHE_SLOTS);
+        if(meta_cache_slots[slot].key == key) {
+            return (int) slot;
+        }
+
+        if(freeSlot == -1 && meta_cache_slots[slot].key == 0) {
+            freeSlot = (int) slot;
+        }
+    }
+
+    if(!insert) {
+        return -1;
+    }
+
+    // Probe window is full; evict the home slot.
+    return freeSlot != -1 ? freeSlot : (int) (key % META_CACHE_SLOTS);
+}
+
+static Result meta_cache_write_slot(u32 slot) {
+    u8 data[META_CACHE_SLOT_SIZE];
+    meta_cache_write_u64(data, meta_cache_slots[slot].key);
+    meta_cache_write_u64(data + 8, meta_cache_slots[slot].stamp);
+
+    u32 bytesWritten = 0;
+    return FSFILE_Write(meta_cache_file, &bytesWritten, META_CACHE_TABLE_OFFSET + slot * META_CACHE_SLOT_SIZE, data, sizeof(data), FS_WRITE_FLUSH);
+}
+
+bool meta_cache_get(u64 key, u64 stamp, meta_cache_entry* entry) {
+    if(key == 0 || entry == NULL) {
+        return false;
+    }
+
+    bool found = false;
+
+    LightLock_Lock(&meta_cache_lock);
+
+    int slot = -1;
+    if(meta_cache_file != 0 && (slot = meta_cache_find(key, false)) != -1 && meta_cache_slots[slot].stamp == stamp) {
+        u8* record = (u8*) malloc(META_CACHE_RECORD_SIZE);
+        if(record != NULL) {
+            u32 bytesRead = 0;
+            if(R_SUCCEEDED(FSFILE_Read(meta_cache_file, &bytesRead, META_CACHE_RECORDS_OFFSET + (u64) slot * META_CACHE_RECORD_SIZE, record, META_CACHE_RECORD_SIZE))
+               && bytesRead == META_CACHE_RECORD_SIZE) {
+                found = meta_cache_decode_record(record, key, stamp, entry);
+            }
+
+            free(record);
+        }
+    }
+
+    LightLock_Unlock(&meta_cache_lock);
+
+    return found;
+}
+
+void meta_cache_put(u64 key, u64 stamp, const meta_cache_entry* entry) {
+    if(key == 0 || entry == NULL) {
+        return;
+    }
+
+    LightLock_Lock(&meta_cache_lock);
+
+    int slot = -1;
+    if(meta_cache_file != 0 && (slot = meta_cache_find(key, true)) != -1) {
+        u8* record = (u8*) malloc(META_CACHE_RECORD_SIZE);
+        if(record != NULL) {
+            meta_cache_encode_record(record, key, stamp, entry);
+
+            u32 bytesWritten = 0;
+            if(R_SUCCEEDED(FSFILE_Write(meta_cache_file, &bytesWritten, META_CACHE_RECORDS_OFFSET + (u64) slot * META_CACHE_RECORD_SIZE, record, META_CACHE_RECORD_SIZE, 0))) {
+                meta_cache_slots[slot].key = key;
+                meta_cache_slots[slot].stamp = stamp;
+                meta_cache_write_slot((u32) slot);
+            }
+
+            free(record);
+        }
+    }
+
+    LightLock_Unlock(&meta_cache_lock);
+}
+
+void meta_cache_remove(u64 key) {
+    LightLock_Lock(&meta_cache_lock);
+
+    int slot = -1;
+    if(meta_cache_file != 0 && (slot = meta_cache_find(key, false)) != -1) {
+        meta_cache_slots[slot].key = 0;
+        meta_cache_slots[slot].stamp = 0;
+        meta_cache_write_slot((u32) slot);
+    }
+
+    LightLock_Unlock(&meta_cache_lock);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#define META_CACHE_ICON_SIZE (48 * 48 * 2)
+
+typedef struct meta_cache_entry_s {
+    u64 titleId;
+    u16 version;
+    u64 installedSize;
+
+    bool hasMeta;
+    char shortDescription[0x100];
+    char longDescription[0x200];
+    char publisher[0x100];
+    u32 region;
+    // Tiled RGB565, as stored in the SMDH.
+    u8 icon[META_CACHE_ICON_SIZE];
+} meta_cache_entry;
+
+#define META_CACHE_HEADER_SIZE 0x10
+#define META_CACHE_RECORD_SIZE (0x28 + 0x100 + 0x200 + 0x100 + META_CACHE_ICON_SIZE)
+
+void meta_cache_init();
+void meta_cache_exit();
+
+u64 meta_cache_hash(u64 hash, const void* data, size_t size);
+// Cached per title and media type; the title version is the stamp, so a new version invalidates the entry.
+u64 meta_cache_title_key(FS_MediaType mediaType, u64 titleId);
+
+bool meta_cache_get(u64 key, u64 stamp, meta_cache_entry* entry);
+void meta_cache_put(u64 key, u64 stamp, const meta_cache_entry* entry);
+void meta_cache_remove(u64 key);
+
+// Codec for the on-SD format; independent of the file and system services.
+void meta_cache_encode_header(u8* out, u32 slotCount);
+bool meta_cache_decode_header(const u8* in, u32 slotCount);
+void meta_cache_encode_record(u8* out, u64 key, u64 stamp, const meta_cache_entry* entry);
+bool meta_cache_decode_record(const u8* in, u64 key, u64 stamp, meta_cache_entry* entry);
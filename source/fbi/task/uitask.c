@@ -26,14 +26,14 @@ void task_draw_meta_info(ui_view* view, void* data, float x1, float y1, float x2
     float metaInfoBoxY = y1 + (y2 - y1) / 4 - metaInfoBoxHeight / 2;
     screen_draw_texture(TEXTURE_META_INFO_BOX, metaInfoBoxX, metaInfoBoxY, metaInfoBoxWidth, metaInfoBoxHeight);
 
-    if(info->texture != 0) {
+    if(info->icon != ICON_ATLAS_NONE) {
         u32 iconWidth;
         u32 iconHeight;
-        screen_get_texture_size(&iconWidth, &iconHeight, info->texture);
+        icon_atlas_get_size(&iconWidth, &iconHeight, info->icon);
 
         float iconX = metaInfoBoxX + (64 - iconWidth) / 2;
         float iconY = metaInfoBoxY + (metaInfoBoxHeight - iconHeight) / 2;
-        screen_draw_texture(info->texture, iconX, iconY, iconWidth, iconHeight);
+        icon_atlas_draw(info->icon, iconX, iconY, iconWidth, iconHeight);
     }
 
     float metaTextX = metaInfoBoxX + 64;
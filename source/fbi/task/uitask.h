@@ -7,7 +7,7 @@ typedef struct meta_info_s {
     char longDescription[0x200];
     char publisher[0x100];
     u32 region;
-    u32 texture;
+    u32 icon;
 } meta_info;
 
 void task_draw_meta_info(ui_view* view, void* data, float x1, float y1, float x2, float y2);
@@ -23,4 +23,5 @@ void task_draw_title_info(ui_view* view, void* data, float x1, float y1, float x
 #include "listsystemsavedata.h"
 #include "listtickets.h"
 #include "listtitles.h"
-#include "listfiles.h"
\ No newline at end of file
+#include "listfiles.h"
+#include "metacache.h"
\ No newline at end of file
@@ -34,6 +34,7 @@ typedef struct {
     bool sortBySize;
 
     bool populated;
+    bool sorted;
 } titles_data;
 
 typedef struct {
@@ -195,9 +196,15 @@ static void titles_draw_top(ui_view* view, void* data, float x1, float y1, float
     }
 }
 
+static int titles_compare(void* data, const void* p1, const void* p2);
+
 static void titles_update(ui_view* view, void* data, linked_list* items, list_item* selected, bool selectedTouched) {
     titles_data* listData = (titles_data*) data;
 
+    listData->populateData.metaFocus = selected;
+
+    task_populate_titles_apply_names(&listData->populateData);
+
     if(hidKeysDown() & KEY_B) {
         if(!listData->populateData.finished) {
             svcSignalEvent(listData->populateData.cancelEvent);
@@ -208,6 +215,7 @@ static void titles_update(ui_view* view, void* data, linked_list* items, list_it
 
         ui_pop();
 
+        task_populate_titles_apply_names(&listData->populateData);
         task_clear_titles(items);
         list_destroy(view);
 
@@ -235,6 +243,20 @@ static void titles_update(ui_view* view, void* data, linked_list* items, list_it
         }
 
         listData->populated = true;
+        listData->sorted = false;
+    }
+
+    if(listData->populateData.finished && !listData->sorted) {
+        // Names loaded after first paint can change the order; sort once here rather than moving items under the UI.
+        task_populate_titles_apply_names(&listData->populateData);
+        linked_list_sort(items, listData, titles_compare);
+
+        char timeInfo[128];
+        snprintf(timeInfo, sizeof(timeInfo), "Titles: list %llu ms, info %llu ms, meta %llu ms",
+                 listData->populateData.listTime, listData->populateData.infoTime, listData->populateData.metaTime);
+        ui_set_debug_info(timeInfo);
+
+        listData->sorted = true;
     }
 
     if(listData->populateData.finished && R_FAILED(listData->populateData.result)) {
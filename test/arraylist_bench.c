@@ -0,0 +1,118 @@
+#include <3ds.h>
+
+#include "core/arraylist.h"
+#include "core/linkedlist.h"
+#include "test.h"
+
+// Compares linked_list and array_list at the sizes large batches reach: indexed reads as the data op callbacks
+// make them, sorted inserts as the list UI makes them, and full iteration.
+
+// Per size, reads and inserts are sampled rather than run over every index, which would take minutes for the linked list.
+#define ARRAYLIST_BENCH_GETS 10000
+#define ARRAYLIST_BENCH_INSERTS 1000
+
+static int arraylist_bench_compare(void* userData, const void* p1, const void* p2) {
+    uintptr_t v1 = (uintptr_t) p1;
+    uintptr_t v2 = (uintptr_t) p2;
+
+    return v1 < v2 ? -1 : v1 > v2 ? 1 : 0;
+}
+
+// Spreads keys over the value range without repeating, so that sorted inserts land all over the list.
+static uintptr_t arraylist_bench_key(u32 i) {
+    return (((uintptr_t) i * 2654435761U) & 0xFFFFFFFF) | 1;
+}
+
+static void arraylist_bench_run(u32 count) {
+    linked_list linked;
+    linked_list_init(&linked);
+
+    array_list array;
+    array_list_init(&array);
+
+    // Values start at 2, as iterators stop at NULL.
+    for(u32 i = 0; i < count; i++) {
+        linked_list_add(&linked, (void*) (uintptr_t) ((i + 1) * 2));
+        array_list_add(&array, (void*) (uintptr_t) ((i + 1) * 2));
+    }
+
+    u32 stride = count / ARRAYLIST_BENCH_GETS;
+
+    uintptr_t linkedSum = 0;
+    double start = test_now_ms();
+    for(u32 i = 0; i < ARRAYLIST_BENCH_GETS; i++) {
+        linkedSum += (uintptr_t) linked_list_get(&linked, i * stride);
+    }
+
+    double linkedGetNs = (test_now_ms() - start) * 1000000.0 / ARRAYLIST_BENCH_GETS;
+
+    uintptr_t arraySum = 0;
+    start = test_now_ms();
+    for(u32 i = 0; i < ARRAYLIST_BENCH_GETS; i++) {
+        arraySum += (uintptr_t) array_list_get(&array, i * stride);
+    }
+
+    double arrayGetNs = (test_now_ms() - start) * 1000000.0 / ARRAYLIST_BENCH_GETS;
+
+    TEST_CHECK(linkedSum == arraySum, "%u items: indexed reads disagree", count);
+
+    linkedSum = 0;
+    start = test_now_ms();
+
+    linked_list_iter iter;
+    linked_list_iterate(&linked, &iter);
+    while(linked_list_iter_has_next(&iter)) {
+        linkedSum += (uintptr_t) linked_list_iter_next(&iter);
+    }
+
+    double linkedIterMs = test_now_ms() - start;
+
+    arraySum = 0;
+    start = test_now_ms();
+    for(u32 i = 0; i < array_list_size(&array); i++) {
+        arraySum += (uintptr_t) array_list_get(&array, i);
+    }
+
+    double arrayIterMs = test_now_ms() - start;
+
+    TEST_CHECK(linkedSum == arraySum, "%u items: iteration disagrees", count);
+
+    // Sorted inserts into lists that already hold count sorted values.
+    start = test_now_ms();
+    for(u32 i = 0; i < ARRAYLIST_BENCH_INSERTS; i++) {
+        linked_list_add_sorted(&linked, (void*) arraylist_bench_key(i), NULL, arraylist_bench_compare);
+    }
+
+    double linkedInsertUs = (test_now_ms() - start) * 1000.0 / ARRAYLIST_BENCH_INSERTS;
+
+    start = test_now_ms();
+    for(u32 i = 0; i < ARRAYLIST_BENCH_INSERTS; i++) {
+        array_list_add_sorted(&array, (void*) arraylist_bench_key(i), NULL, arraylist_bench_compare);
+    }
+
+    double arrayInsertUs = (test_now_ms() - start) * 1000.0 / ARRAYLIST_BENCH_INSERTS;
+
+    bool sorted = array_list_size(&array) == linked_list_size(&linked);
+    for(u32 i = 1; i < array_list_size(&array) && sorted; i++) {
+        sorted = arraylist_bench_compare(NULL, array_list_get(&array, i - 1), array_list_get(&array, i)) <= 0;
+    }
+
+    TEST_CHECK(sorted, "%u items: sorted inserts left the array list out of order", count);
+
+    printf("%7u | %10.1f %10.1f | %9.3f %9.3f | %10.2f %10.2f\n", count, linkedGetNs, arrayGetNs, linkedIterMs, arrayIterMs, linkedInsertUs, arrayInsertUs);
+
+    linked_list_destroy(&linked);
+    array_list_destroy(&array);
+}
+
+int main() {
+    printf("  items |   get (ns/op)         |  iterate (ms)       | sorted insert (us/op)\n");
+    printf("        |     linked      array |    linked     array |     linked      array\n");
+
+    static const u32 counts[] = {10000, 25000, 50000, 100000};
+    for(u32 i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        arraylist_bench_run(counts[i]);
+    }
+
+    return test_finish();
+}
\ No newline at end of file
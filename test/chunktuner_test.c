@@ -0,0 +1,137 @@
+#include <3ds.h>
+
+#include "core/task/chunktuner.h"
+#include "test.h"
+
+// Drives the chunk size tuner with simulated devices, whose per-call time is a fixed latency plus the chunk over
+// their bandwidth, slowed further past a knee where larger chunks stop paying off.
+
+#define CHUNKTUNER_TEST_TICKS_PER_SECOND 1000000ULL
+#define CHUNKTUNER_TEST_MIN (16 * 1024)
+#define CHUNKTUNER_TEST_MAX (2 * 1024 * 1024)
+
+typedef struct {
+    const char* name;
+    double latencySec;
+    double bytesPerSec;
+    // Chunks above the knee take this much longer per doubling, or 0 for none.
+    u32 knee;
+    double kneePenalty;
+} chunktuner_test_device;
+
+static u64 chunktuner_test_ticks(const chunktuner_test_device* device, u32 size) {
+    double seconds = device->latencySec + size / device->bytesPerSec;
+
+    for(u32 over = device->knee; device->knee != 0 && over < size; over *= 2) {
+        seconds *= 1 + device->kneePenalty;
+    }
+
+    return (u64) (seconds * CHUNKTUNER_TEST_TICKS_PER_SECOND);
+}
+
+// Records calls transfers at whatever size the tuner currently asks for.
+static void chunktuner_test_run(chunk_tuner* tuner, const chunktuner_test_device* device, u32 calls) {
+    for(u32 i = 0; i < calls; i++) {
+        u32 size = tuner->size;
+        task_chunk_tuner_record(tuner, size, chunktuner_test_ticks(device, size));
+    }
+}
+
+static void chunktuner_test_converges(const chunktuner_test_device* device, u32 start, u32 expected) {
+    chunk_tuner tuner;
+    task_chunk_tuner_init(&tuner, start, CHUNKTUNER_TEST_MIN, CHUNKTUNER_TEST_MAX, CHUNKTUNER_TEST_TICKS_PER_SECOND);
+
+    chunktuner_test_run(&tuner, device, 400);
+
+    TEST_CHECK(tuner.settled && tuner.bestSize == expected, "%s from %u KiB: settled %d at %u KiB, expected %u KiB", device->name, start / 1024, tuner.settled, tuner.bestSize / 1024, expected / 1024);
+
+    // The recorded throughput is that of the chosen size.
+    double expectedRate = (double) expected * CHUNKTUNER_TEST_TICKS_PER_SECOND / chunktuner_test_ticks(device, expected);
+    TEST_CHECK(tuner.bytesPerSecond > expectedRate * 0.95 && tuner.bytesPerSecond < expectedRate * 1.05, "%s: recorded %u B/s, expected %.0f B/s", device->name, tuner.bytesPerSecond, expectedRate);
+}
+
+// Per-call latency dominates, so the largest chunk wins.
+static const chunktuner_test_device chunktuner_test_http = {"http", 0.150, 1.0 * 1024 * 1024, 0, 0};
+// Larger chunks help until they no longer fit the card's cache.
+static const chunktuner_test_device chunktuner_test_sd = {"sd", 0.002, 12.0 * 1024 * 1024, 256 * 1024, 0.3};
+// Every byte costs the same; anything past the smallest chunk only adds overhead.
+static const chunktuner_test_device chunktuner_test_spi = {"spi", 0.0, 64.0 * 1024, 16 * 1024, 0.2};
+
+static void test_chunktuner_latency_bound() {
+    chunktuner_test_converges(&chunktuner_test_http, 128 * 1024, CHUNKTUNER_TEST_MAX);
+}
+
+static void test_chunktuner_knee() {
+    chunktuner_test_converges(&chunktuner_test_sd, 128 * 1024, 256 * 1024);
+    chunktuner_test_converges(&chunktuner_test_sd, 1024 * 1024, 256 * 1024);
+}
+
+static void test_chunktuner_minimum() {
+    chunktuner_test_converges(&chunktuner_test_spi, 64 * 1024, CHUNKTUNER_TEST_MIN);
+}
+
+static void test_chunktuner_clamped() {
+    chunk_tuner tuner;
+    task_chunk_tuner_init(&tuner, 1024, CHUNKTUNER_TEST_MIN, CHUNKTUNER_TEST_MAX, CHUNKTUNER_TEST_TICKS_PER_SECOND);
+    TEST_CHECK(tuner.size == CHUNKTUNER_TEST_MIN, "started at %u", tuner.size);
+
+    task_chunk_tuner_init(&tuner, 64 * 1024 * 1024, CHUNKTUNER_TEST_MIN, CHUNKTUNER_TEST_MAX, CHUNKTUNER_TEST_TICKS_PER_SECOND);
+    TEST_CHECK(tuner.size == CHUNKTUNER_TEST_MAX, "started at %u", tuner.size);
+
+    // Never leaves the range, whatever the device rewards.
+    chunk_tuner fixed;
+    task_chunk_tuner_init(&fixed, 128 * 1024, 128 * 1024, 128 * 1024, CHUNKTUNER_TEST_TICKS_PER_SECOND);
+
+    for(u32 i = 0; i < 200; i++) {
+        TEST_CHECK(fixed.size == 128 * 1024, "left a single-size range for %u", fixed.size);
+        task_chunk_tuner_record(&fixed, fixed.size, chunktuner_test_ticks(&chunktuner_test_http, fixed.size));
+    }
+}
+
+static void test_chunktuner_retunes() {
+    chunk_tuner tuner;
+    task_chunk_tuner_init(&tuner, 128 * 1024, CHUNKTUNER_TEST_MIN, CHUNKTUNER_TEST_MAX, CHUNKTUNER_TEST_TICKS_PER_SECOND);
+
+    chunktuner_test_run(&tuner, &chunktuner_test_sd, 400);
+    TEST_CHECK(tuner.bestSize == 256 * 1024, "settled at %u KiB on the first device", tuner.bestSize / 1024);
+
+    // A later probe notices that the medium now rewards larger chunks.
+    chunktuner_test_run(&tuner, &chunktuner_test_http, 2000);
+    TEST_CHECK(tuner.bestSize == CHUNKTUNER_TEST_MAX, "settled at %u KiB on the second device", tuner.bestSize / 1024);
+}
+
+static void test_chunktuner_reprobe_backoff() {
+    chunk_tuner tuner;
+    task_chunk_tuner_init(&tuner, 128 * 1024, CHUNKTUNER_TEST_MIN, CHUNKTUNER_TEST_MAX, CHUNKTUNER_TEST_TICKS_PER_SECOND);
+
+    // Count calls spent away from the best size once it has been found; they should thin out as probes back off.
+    chunktuner_test_run(&tuner, &chunktuner_test_sd, 400);
+
+    u32 early = 0;
+    u32 late = 0;
+    for(u32 i = 0; i < 40000; i++) {
+        if(tuner.size != 256 * 1024) {
+            if(i < 10000) {
+                early++;
+            } else if(i >= 30000) {
+                late++;
+            }
+        }
+
+        task_chunk_tuner_record(&tuner, tuner.size, chunktuner_test_ticks(&chunktuner_test_sd, tuner.size));
+    }
+
+    TEST_CHECK(late < early, "%u off-size calls late, %u early", late, early);
+    TEST_CHECK(tuner.bestSize == 256 * 1024, "drifted to %u KiB", tuner.bestSize / 1024);
+}
+
+int main() {
+    TEST_RUN(test_chunktuner_latency_bound);
+    TEST_RUN(test_chunktuner_knee);
+    TEST_RUN(test_chunktuner_minimum);
+    TEST_RUN(test_chunktuner_clamped);
+    TEST_RUN(test_chunktuner_retunes);
+    TEST_RUN(test_chunktuner_reprobe_backoff);
+
+    return test_finish();
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include <string.h>
+
+#include <3ds.h>
+#include <mbedtls/sha256.h>
+
+#include "core/core.h"
+#include "core/task/ciaverify.h"
+#include "test.h"
+
+// Feeds synthetic CIAs through the streaming verifier: a header, an empty certificate chain and ticket, a TMD
+// with one chunk record per content, then the contents that the header's index bitmap marks as present.
+
+#define CIAVERIFY_TEST_BLOCK (64 * 1024)
+#define CIAVERIFY_TEST_HEADER_SIZE 0x2020
+// Signature type 2 keeps the TMD signature short.
+#define CIAVERIFY_TEST_TMD_SIG_SIZE 0x80
+#define CIAVERIFY_TEST_CONTENTS_MAX 4
+
+typedef struct {
+    u32 size;
+    bool encrypted;
+    bool present;
+} ciaverify_test_content;
+
+typedef struct {
+    u8* data;
+    u32 size;
+
+    // Where each present content starts, or 0.
+    u32 contentOffsets[CIAVERIFY_TEST_CONTENTS_MAX];
+} ciaverify_test_cia;
+
+static void ciaverify_test_put_be(u8* out, u64 value, u32 size) {
+    for(u32 i = 0; i < size; i++) {
+        out[i] = (u8) (value >> ((size - 1 - i) * 8));
+    }
+}
+
+static u32 ciaverify_test_align(u32 value) {
+    return (value + 0x3F) & ~0x3F;
+}
+
+static void ciaverify_test_make(ciaverify_test_cia* cia, const ciaverify_test_content* contents, u32 count) {
+    u32 tmdSize = CIAVERIFY_TEST_TMD_SIG_SIZE + 0x9C4 + count * 0x30;
+
+    u32 contentSize = 0;
+    for(u32 i = 0; i < count; i++) {
+        if(contents[i].present) {
+            contentSize += contents[i].size;
+        }
+    }
+
+    u32 contentOffset = ciaverify_test_align(CIAVERIFY_TEST_HEADER_SIZE) + ciaverify_test_align(tmdSize);
+
+    memset(cia, 0, sizeof(*cia));
+    cia->size = contentOffset + contentSize;
+    cia->data = (u8*) calloc(1, cia->size);
+
+    u8* header = cia->data;
+    *(u32*) &header[0x00] = CIAVERIFY_TEST_HEADER_SIZE;
+    *(u32*) &header[0x10] = tmdSize;
+    *(u64*) &header[0x18] = contentSize;
+
+    u8* tmd = cia->data + ciaverify_test_align(CIAVERIFY_TEST_HEADER_SIZE);
+    tmd[0x03] = 2;
+
+    u8* tmdHeader = tmd + CIAVERIFY_TEST_TMD_SIG_SIZE;
+    ciaverify_test_put_be(&tmdHeader[0x4C], 0x0004000000123400ULL, sizeof(u64));
+    ciaverify_test_put_be(&tmdHeader[0x9E], count, sizeof(u16));
+
+    u32 offset = contentOffset;
+    for(u32 i = 0; i < count; i++) {
+        u8* record = &tmdHeader[0x9C4 + i * 0x30];
+        ciaverify_test_put_be(&record[0x00], i, sizeof(u32));
+        ciaverify_test_put_be(&record[0x04], i, sizeof(u16));
+        ciaverify_test_put_be(&record[0x06], contents[i].encrypted ? TMD_CONTENT_TYPE_ENCRYPTED : 0, sizeof(u16));
+        ciaverify_test_put_be(&record[0x08], contents[i].size, sizeof(u64));
+
+        u8* content = (u8*) malloc(contents[i].size);
+        for(u32 j = 0; j < contents[i].size; j++) {
+            content[j] = test_pattern(j, i + 1);
+        }
+
+        mbedtls_sha256(content, contents[i].size, &record[0x10], 0);
+
+        if(contents[i].present) {
+            header[0x20 + i / 8] |= 0x80 >> (i % 8);
+
+            memcpy(cia->data + offset, content, contents[i].size);
+            cia->contentOffsets[i] = offset;
+            offset += contents[i].size;
+        }
+
+        free(content);
+    }
+}
+
+// Feeds the first size bytes in uneven pieces, as a transfer would; fedOnError receives how far feeding got before
+// the first error was reported.
+static Result ciaverify_test_feed(const ciaverify_test_cia* cia, u32 size, bool complete, u32* fedOnError) {
+    cia_verifier* verifier = NULL;
+
+    Result res = task_cia_verify_open(&verifier, cia->data, cia->size < CIAVERIFY_TEST_BLOCK ? cia->size : CIAVERIFY_TEST_BLOCK, CIAVERIFY_TEST_BLOCK);
+    if(R_FAILED(res)) {
+        return res;
+    }
+
+    u32 pos = 0;
+    for(u32 piece = 1; pos < size && R_SUCCEEDED(res); piece++) {
+        u32 n = (piece * 7919) % (3 * CIAVERIFY_TEST_BLOCK) + 1;
+        if(n > size - pos) {
+            n = size - pos;
+        }
+
+        res = task_cia_verify_feed(verifier, cia->data + pos, n);
+        pos += n;
+    }
+
+    if(fedOnError != NULL) {
+        *fedOnError = pos;
+    }
+
+    Result closeRes = task_cia_verify_close(verifier, complete);
+    return R_SUCCEEDED(res) ? closeRes : res;
+}
+
+static void test_ciaverify_valid() {
+    ciaverify_test_content contents[] = {{300 * 1024 + 17, false, true}, {1024 * 1024, false, true}, {5, false, true}};
+
+    ciaverify_test_cia cia;
+    ciaverify_test_make(&cia, contents, 3);
+
+    Result res = ciaverify_test_feed(&cia, cia.size, true, NULL);
+    TEST_CHECK(res == 0, "valid CIA failed: 0x%08X", (u32) res);
+
+    free(cia.data);
+}
+
+static void test_ciaverify_mismatch_aborts_early() {
+    ciaverify_test_content contents[] = {{200 * 1024, false, true}, {100 * 1024, false, true}, {4 * 1024 * 1024, false, true}};
+
+    ciaverify_test_cia cia;
+    ciaverify_test_make(&cia, contents, 3);
+
+    cia.data[cia.contentOffsets[1] + 1234] ^= 0x01;
+
+    u32 fed = 0;
+    Result res = ciaverify_test_feed(&cia, cia.size, true, &fed);
+    TEST_CHECK(res == R_APP_HASH_MISMATCH, "corrupted CIA returned 0x%08X", (u32) res);
+
+    // Reported while the last content is still streaming, not at the end.
+    TEST_CHECK(fed < cia.contentOffsets[2] + contents[2].size / 2, "mismatch reported after %u of %u bytes", fed, cia.size);
+
+    free(cia.data);
+}
+
+static void test_ciaverify_encrypted_skipped() {
+    ciaverify_test_content contents[] = {{64 * 1024, true, true}, {64 * 1024, false, true}};
+
+    ciaverify_test_cia cia;
+    ciaverify_test_make(&cia, contents, 2);
+
+    // Encrypted contents cannot be hashed without the title key, so a change to one goes unnoticed.
+    cia.data[cia.contentOffsets[0] + 10] ^= 0x01;
+
+    Result res = ciaverify_test_feed(&cia, cia.size, true, NULL);
+    TEST_CHECK(res == 0, "encrypted content was checked: 0x%08X", (u32) res);
+
+    cia.data[cia.contentOffsets[1] + 10] ^= 0x01;
+
+    res = ciaverify_test_feed(&cia, cia.size, true, NULL);
+    TEST_CHECK(res == R_APP_HASH_MISMATCH, "content after an encrypted one was not checked: 0x%08X", (u32) res);
+
+    free(cia.data);
+}
+
+static void test_ciaverify_absent_content() {
+    // The absent content takes no space, so the one after it starts where it would have.
+    ciaverify_test_content contents[] = {{100 * 1024, false, true}, {50 * 1024, false, false}, {70 * 1024, false, true}};
+
+    ciaverify_test_cia cia;
+    ciaverify_test_make(&cia, contents, 3);
+
+    Result res = ciaverify_test_feed(&cia, cia.size, true, NULL);
+    TEST_CHECK(res == 0, "CIA with an absent content failed: 0x%08X", (u32) res);
+
+    free(cia.data);
+}
+
+static void test_ciaverify_truncated() {
+    ciaverify_test_content contents[] = {{100 * 1024, false, true}, {100 * 1024, false, true}};
+
+    ciaverify_test_cia cia;
+    ciaverify_test_make(&cia, contents, 2);
+
+    u32 size = cia.contentOffsets[1] + 1000;
+
+    Result res = ciaverify_test_feed(&cia, size, true, NULL);
+    TEST_CHECK(res == R_APP_BAD_DATA, "truncated CIA returned 0x%08X", (u32) res);
+
+    // An abandoned transfer is not a verification failure.
+    res = ciaverify_test_feed(&cia, size, false, NULL);
+    TEST_CHECK(res == 0, "abandoned CIA returned 0x%08X", (u32) res);
+
+    free(cia.data);
+}
+
+static void test_ciaverify_not_cia() {
+    u8 data[CIAVERIFY_TEST_BLOCK];
+    for(u32 i = 0; i < sizeof(data); i++) {
+        data[i] = test_pattern(i, 9);
+    }
+
+    cia_verifier* verifier = NULL;
+    Result res = task_cia_verify_open(&verifier, data, sizeof(data), CIAVERIFY_TEST_BLOCK);
+    TEST_CHECK(res == R_APP_SKIPPED, "non-CIA returned 0x%08X", (u32) res);
+
+    ciaverify_test_content contents[] = {{1024, true, true}};
+
+    ciaverify_test_cia cia;
+    ciaverify_test_make(&cia, contents, 1);
+
+    res = task_cia_verify_open(&verifier, cia.data, cia.size, CIAVERIFY_TEST_BLOCK);
+    TEST_CHECK(res == R_APP_SKIPPED, "CIA with only encrypted contents returned 0x%08X", (u32) res);
+
+    free(cia.data);
+}
+
+int main() {
+    TEST_RUN(test_ciaverify_valid);
+    TEST_RUN(test_ciaverify_mismatch_aborts_early);
+    TEST_RUN(test_ciaverify_encrypted_skipped);
+    TEST_RUN(test_ciaverify_absent_content);
+    TEST_RUN(test_ciaverify_truncated);
+    TEST_RUN(test_ciaverify_not_cia);
+
+    return test_finish();
+}
\ No newline at end of file
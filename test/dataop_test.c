@@ -0,0 +1,494 @@
+#include <string.h>
+#include <unistd.h>
+
+#include <3ds.h>
+
+#include "core/core.h"
+#include "test.h"
+
+// Drives task_data_op copies through in-memory callbacks whose reads and writes sleep in proportion to their size,
+// standing in for SD and NAND latency.
+
+#define DATAOP_TEST_SIZE (16 * 1024 * 1024)
+#define DATAOP_TEST_BUFFER (128 * 1024)
+// Microseconds of simulated latency per KiB on each side.
+#define DATAOP_TEST_LATENCY_PER_KB 6
+
+typedef struct {
+    u8* src;
+    u8* dst;
+    u64 size;
+
+    u32 readLatencyPerKb;
+    u32 writeLatencyPerKb;
+
+    // Reads at or past this offset fail with failRes.
+    u64 failOffset;
+    Result failRes;
+
+    u32 initialReadSize;
+    u32 reads;
+    u32 writes;
+    u32 opens;
+    u32 closes;
+    bool closeSucceeded;
+    u32 suspends;
+    u32 restores;
+    u32 errors;
+    Result errorRes;
+
+    // Set while a write is in progress; reads starting then count as overlapped.
+    u32 writing;
+    u32 overlappedReads;
+    // Holds the second read until the first write has started, and the first write until a read has overlapped
+    // it, each for up to a second. Only a pipeline can satisfy both without timing out.
+    bool awaitOverlap;
+} dataop_test_data;
+
+// TEST_RUN calls tests without arguments, so they share the buffers through this.
+static dataop_test_data* dataop_test_active;
+
+static void dataop_test_latency(u32 size, u32 perKb) {
+    u32 us = (u32) ((u64) size * perKb / 1024);
+    if(us > 0) {
+        usleep(us);
+    }
+}
+
+// A thread-safe bump for counters read by the test thread.
+static void dataop_test_count(u32* counter) {
+    __atomic_add_fetch(counter, 1, __ATOMIC_SEQ_CST);
+}
+
+static Result dataop_test_is_src_directory(void* data, u32 index, bool* isDirectory) {
+    *isDirectory = false;
+    return 0;
+}
+
+static Result dataop_test_make_dst_directory(void* data, u32 index) {
+    return 0;
+}
+
+static Result dataop_test_open_src(void* data, u32 index, u32* handle) {
+    *handle = 1;
+    return 0;
+}
+
+static Result dataop_test_close_src(void* data, u32 index, bool succeeded, u32 handle) {
+    return 0;
+}
+
+static Result dataop_test_get_src_size(void* data, u32 handle, u64* size) {
+    *size = ((dataop_test_data*) data)->size;
+    return 0;
+}
+
+static Result dataop_test_read_src(void* data, u32 handle, u32* bytesRead, void* buffer, u64 offset, u32 size) {
+    dataop_test_data* testData = (dataop_test_data*) data;
+
+    dataop_test_count(&testData->reads);
+
+    if(testData->awaitOverlap && offset > 0) {
+        double start = test_now_ms();
+        while(__atomic_load_n(&testData->writes, __ATOMIC_SEQ_CST) == 0 && test_now_ms() - start < 1000) {
+            usleep(100);
+        }
+    }
+
+    if(__atomic_load_n(&testData->writing, __ATOMIC_SEQ_CST) != 0) {
+        dataop_test_count(&testData->overlappedReads);
+    }
+
+    if(testData->failRes != 0 && offset >= testData->failOffset) {
+        return testData->failRes;
+    }
+
+    if(size > testData->size - offset) {
+        size = (u32) (testData->size - offset);
+    }
+
+    dataop_test_latency(size, testData->readLatencyPerKb);
+
+    memcpy(buffer, testData->src + offset, size);
+    *bytesRead = size;
+    return 0;
+}
+
+static Result dataop_test_open_dst(void* data, u32 index, void* initialReadBlock, u32 initialReadSize, u64 size, u32* handle) {
+    dataop_test_data* testData = (dataop_test_data*) data;
+
+    testData->opens++;
+    testData->initialReadSize = initialReadSize;
+
+    *handle = 2;
+    return 0;
+}
+
+static Result dataop_test_close_dst(void* data, u32 index, bool succeeded, u32 handle) {
+    dataop_test_data* testData = (dataop_test_data*) data;
+
+    testData->closes++;
+    testData->closeSucceeded = succeeded;
+    return 0;
+}
+
+static Result dataop_test_write_dst(void* data, u32 handle, u32* bytesWritten, void* buffer, u64 offset, u32 size) {
+    dataop_test_data* testData = (dataop_test_data*) data;
+
+    dataop_test_count(&testData->writes);
+    __atomic_store_n(&testData->writing, 1, __ATOMIC_SEQ_CST);
+
+    dataop_test_latency(size, testData->writeLatencyPerKb);
+
+    if(testData->awaitOverlap && offset == 0) {
+        double start = test_now_ms();
+        while(__atomic_load_n(&testData->overlappedReads, __ATOMIC_SEQ_CST) == 0 && test_now_ms() - start < 1000) {
+            usleep(100);
+        }
+    }
+
+    memcpy(testData->dst + offset, buffer, size);
+    *bytesWritten = size;
+
+    __atomic_store_n(&testData->writing, 0, __ATOMIC_SEQ_CST);
+    return 0;
+}
+
+static Result dataop_test_suspend(void* data, u32 index) {
+    dataop_test_count(&((dataop_test_data*) data)->suspends);
+    return 0;
+}
+
+static Result dataop_test_restore(void* data, u32 index) {
+    dataop_test_count(&((dataop_test_data*) data)->restores);
+    return 0;
+}
+
+static bool dataop_test_error(void* data, u32 index, Result res, ui_view** errorView) {
+    dataop_test_data* testData = (dataop_test_data*) data;
+
+    testData->errors++;
+    testData->errorRes = res;
+    return false;
+}
+
+// The HTTP layer has its own test; downloads here deliver DATAOP_TEST_DOWNLOAD_SIZE bytes of src in one callback,
+// and prefetches only count how many are open.
+#define DATAOP_TEST_DOWNLOAD_SIZE 1000
+#define DATAOP_TEST_DOWNLOAD_ITEMS 3
+
+static u32 dataop_test_prefetches_open;
+static u32 dataop_test_prefetches_at_download[DATAOP_TEST_DOWNLOAD_ITEMS];
+
+Result http_download_callback(const char* url, u32 bufferSize, u32 connections, http_resume_info* resume, http_prefetch* prefetch, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                                        Result (*checkRunning)(void* userData),
+                                                                                                                        Result (*progress)(void* userData, u64 total, u64 curr)) {
+    u32 index = 0;
+    if(sscanf(url, "item%u", &index) == 1 && index < DATAOP_TEST_DOWNLOAD_ITEMS) {
+        dataop_test_prefetches_at_download[index] = dataop_test_prefetches_open;
+    }
+
+    if(prefetch != NULL && *prefetch != NULL) {
+        http_prefetch_close(*prefetch);
+        *prefetch = NULL;
+    }
+
+    return callback(userData, dataop_test_active->src, DATAOP_TEST_DOWNLOAD_SIZE);
+}
+
+Result http_prefetch_open(http_prefetch* prefetch, const char* url, u32 connections, u32 headSize) {
+    dataop_test_prefetches_open++;
+
+    *prefetch = (http_prefetch) malloc(1);
+    return 0;
+}
+
+void http_prefetch_close(http_prefetch prefetch) {
+    dataop_test_prefetches_open--;
+
+    free(prefetch);
+}
+
+static void dataop_test_init(dataop_test_data* testData, data_op_data* data, u32 bufferCount) {
+    memset(testData->dst, 0, testData->size);
+
+    testData->initialReadSize = 0;
+    testData->reads = 0;
+    testData->writes = 0;
+    testData->opens = 0;
+    testData->closes = 0;
+    testData->closeSucceeded = false;
+    testData->suspends = 0;
+    testData->restores = 0;
+    testData->errors = 0;
+    testData->errorRes = 0;
+    testData->writing = 0;
+    testData->overlappedReads = 0;
+    testData->awaitOverlap = false;
+
+    memset(data, 0, sizeof(*data));
+
+    data->data = testData;
+    data->op = DATAOP_COPY;
+    data->total = 1;
+    data->bufferSize = DATAOP_TEST_BUFFER;
+    data->bufferCount = bufferCount;
+
+    data->isSrcDirectory = dataop_test_is_src_directory;
+    data->makeDstDirectory = dataop_test_make_dst_directory;
+    data->openSrc = dataop_test_open_src;
+    data->closeSrc = dataop_test_close_src;
+    data->getSrcSize = dataop_test_get_src_size;
+    data->readSrc = dataop_test_read_src;
+    data->openDst = dataop_test_open_dst;
+    data->closeDst = dataop_test_close_dst;
+    data->writeDst = dataop_test_write_dst;
+    data->suspend = dataop_test_suspend;
+    data->restore = dataop_test_restore;
+    data->error = dataop_test_error;
+}
+
+static void dataop_test_wait(data_op_data* data) {
+    while(!data->finished) {
+        usleep(1000);
+    }
+}
+
+static double dataop_test_copy(data_op_data* data) {
+    double start = test_now_ms();
+
+    TEST_CHECK(R_SUCCEEDED(task_data_op(data)), "failed to start data op");
+    dataop_test_wait(data);
+
+    return test_now_ms() - start;
+}
+
+static void test_dataop_pipelined_matches_sequential() {
+    dataop_test_data* testData = dataop_test_active;
+    data_op_data data;
+
+    dataop_test_init(testData, &data, 1);
+    dataop_test_copy(&data);
+
+    TEST_CHECK(data.result == 0, "sequential copy failed: 0x%08X", (u32) data.result);
+    TEST_CHECK(memcmp(testData->src, testData->dst, testData->size) == 0, "sequential copy corrupted data");
+    TEST_CHECK(testData->initialReadSize == DATAOP_TEST_BUFFER, "first block was %u bytes", testData->initialReadSize);
+
+    dataop_test_init(testData, &data, 4);
+    dataop_test_copy(&data);
+
+    TEST_CHECK(data.result == 0, "pipelined copy failed: 0x%08X", (u32) data.result);
+    TEST_CHECK(memcmp(testData->src, testData->dst, testData->size) == 0, "pipelined copy corrupted data");
+    TEST_CHECK(testData->initialReadSize == DATAOP_TEST_BUFFER, "first block was %u bytes", testData->initialReadSize);
+    TEST_CHECK(testData->opens == 1 && testData->closes == 1 && testData->closeSucceeded, "destination opened %u and closed %u times", testData->opens, testData->closes);
+}
+
+static void test_dataop_pipelined_overlaps() {
+    dataop_test_data* testData = dataop_test_active;
+    data_op_data data;
+
+    // Sequential copies never read while a write is in progress.
+    dataop_test_init(testData, &data, 1);
+    double sequentialMs = dataop_test_copy(&data);
+
+    TEST_CHECK(data.result == 0, "sequential copy failed: 0x%08X", (u32) data.result);
+    TEST_CHECK(testData->overlappedReads == 0, "%u sequential reads overlapped a write", testData->overlappedReads);
+
+    // The second read starts only once the first write has, and that write returns only once a read overlaps it.
+    dataop_test_init(testData, &data, 4);
+    testData->awaitOverlap = true;
+    double pipelinedMs = dataop_test_copy(&data);
+
+    printf("    sequential %.1f ms, pipelined %.1f ms\n", sequentialMs, pipelinedMs);
+
+    TEST_CHECK(data.result == 0, "pipelined copy failed: 0x%08X", (u32) data.result);
+    TEST_CHECK(memcmp(testData->src, testData->dst, testData->size) == 0, "pipelined copy corrupted data");
+    TEST_CHECK(testData->overlappedReads > 0, "no read overlapped a write");
+}
+
+static void test_dataop_cancel() {
+    dataop_test_data* testData = dataop_test_active;
+    data_op_data data;
+
+    dataop_test_init(testData, &data, 4);
+    TEST_CHECK(R_SUCCEEDED(task_data_op(&data)), "failed to start data op");
+
+    usleep(20 * 1000);
+    svcSignalEvent(data.cancelEvent);
+    dataop_test_wait(&data);
+
+    TEST_CHECK(data.result == R_APP_CANCELLED, "cancelled copy returned 0x%08X", (u32) data.result);
+    TEST_CHECK(testData->closes == 1 && !testData->closeSucceeded, "cancelled destination was not closed as failed");
+    TEST_CHECK(testData->errors == 0, "cancellation was reported as an error");
+}
+
+static void test_dataop_suspend_restore() {
+    dataop_test_data* testData = dataop_test_active;
+    data_op_data data;
+
+    dataop_test_init(testData, &data, 4);
+    TEST_CHECK(R_SUCCEEDED(task_data_op(&data)), "failed to start data op");
+
+    usleep(20 * 1000);
+    shim_apt_signal(APTHOOK_ONSUSPEND);
+
+    // Once suspended, neither side may make progress until restored.
+    usleep(20 * 1000);
+    u32 writes = __atomic_load_n(&testData->writes, __ATOMIC_SEQ_CST);
+    usleep(30 * 1000);
+    TEST_CHECK(__atomic_load_n(&testData->writes, __ATOMIC_SEQ_CST) == writes, "writes continued while suspended");
+
+    shim_apt_signal(APTHOOK_ONRESTORE);
+    dataop_test_wait(&data);
+
+    TEST_CHECK(data.result == 0, "suspended copy failed: 0x%08X", (u32) data.result);
+    TEST_CHECK(testData->suspends == 1 && testData->restores == 1, "suspend ran %u and restore %u times", testData->suspends, testData->restores);
+    TEST_CHECK(memcmp(testData->src, testData->dst, testData->size) == 0, "suspended copy corrupted data");
+}
+
+static void test_dataop_read_error() {
+    dataop_test_data* testData = dataop_test_active;
+    data_op_data data;
+
+    for(u32 bufferCount = 1; bufferCount <= 4; bufferCount += 3) {
+        dataop_test_init(testData, &data, bufferCount);
+        testData->failOffset = testData->size / 2;
+        testData->failRes = R_APP_BAD_DATA;
+
+        dataop_test_copy(&data);
+
+        TEST_CHECK(data.result == R_APP_BAD_DATA, "%u buffer(s): read error became 0x%08X", bufferCount, (u32) data.result);
+        TEST_CHECK(testData->errors == 1 && testData->errorRes == R_APP_BAD_DATA, "%u buffer(s): error callback ran %u times", bufferCount, testData->errors);
+        TEST_CHECK(testData->closes == 1 && !testData->closeSucceeded, "%u buffer(s): failed destination was not closed as failed", bufferCount);
+    }
+
+    testData->failRes = 0;
+}
+
+static void test_dataop_small_items() {
+    dataop_test_data* testData = dataop_test_active;
+    data_op_data data;
+
+    u64 size = testData->size;
+
+    // Items smaller than the tuned chunk copy through buffers sized to them, on both paths.
+    static const u32 sizes[] = {1000, DATAOP_TEST_BUFFER + 1000};
+    for(u32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for(u32 bufferCount = 1; bufferCount <= 4; bufferCount += 3) {
+            testData->size = sizes[i];
+            dataop_test_init(testData, &data, bufferCount);
+            dataop_test_copy(&data);
+
+            TEST_CHECK(data.result == 0, "%u bytes, %u buffer(s): copy failed: 0x%08X", sizes[i], bufferCount, (u32) data.result);
+            TEST_CHECK(memcmp(testData->src, testData->dst, sizes[i]) == 0, "%u bytes, %u buffer(s): copy corrupted data", sizes[i], bufferCount);
+        }
+    }
+
+    testData->size = size;
+}
+
+static Result dataop_test_get_src_url(void* data, u32 index, char* url, size_t maxSize) {
+    snprintf(url, maxSize, "item%u", index);
+    return 0;
+}
+
+static Result dataop_test_is_dst_current(void* data, u32 index, bool* current, u64* size) {
+    *current = index == 1;
+    *size = DATAOP_TEST_DOWNLOAD_SIZE;
+    return 0;
+}
+
+static void test_dataop_skip_closes_prefetch() {
+    dataop_test_data* testData = dataop_test_active;
+    data_op_data data;
+
+    dataop_test_init(testData, &data, 1);
+    data.op = DATAOP_DOWNLOAD;
+    data.total = DATAOP_TEST_DOWNLOAD_ITEMS;
+    data.prefetchSize = DATAOP_TEST_DOWNLOAD_SIZE;
+    data.connections = 1;
+    data.getSrcUrl = dataop_test_get_src_url;
+    data.isDstCurrent = dataop_test_is_dst_current;
+
+    dataop_test_prefetches_open = 0;
+    memset(dataop_test_prefetches_at_download, 0, sizeof(dataop_test_prefetches_at_download));
+
+    dataop_test_copy(&data);
+
+    // Item 0 prefetches item 1, which is already current; its prefetch must be gone before item 2 downloads.
+    TEST_CHECK(data.result == 0, "download failed: 0x%08X", (u32) data.result);
+    TEST_CHECK(data.skipped == 1, "skipped %u items", data.skipped);
+    TEST_CHECK(dataop_test_prefetches_at_download[2] == 0, "%u prefetch(es) open while downloading item 2", dataop_test_prefetches_at_download[2]);
+    TEST_CHECK(dataop_test_prefetches_open == 0, "%u prefetch(es) left open", dataop_test_prefetches_open);
+    TEST_CHECK(memcmp(testData->src, testData->dst, DATAOP_TEST_DOWNLOAD_SIZE) == 0, "download corrupted data");
+}
+
+static Result dataop_test_delete(void* data, u32 index) {
+    dataop_test_count(&((dataop_test_data*) data)->writes);
+    return 0;
+}
+
+static void test_dataop_delete() {
+    dataop_test_data* testData = dataop_test_active;
+    testData->writes = 0;
+    testData->errors = 0;
+
+    // Delete actions calloc their data and set only what deletion uses, leaving bufferSize at zero.
+    data_op_data* data = (data_op_data*) calloc(1, sizeof(data_op_data));
+    data->data = testData;
+    data->op = DATAOP_DELETE;
+    data->total = 3;
+    data->delete = dataop_test_delete;
+    data->error = dataop_test_error;
+
+    TEST_CHECK(R_SUCCEEDED(task_data_op(data)), "failed to start data op");
+
+    double start = test_now_ms();
+    while(!data->finished && test_now_ms() - start < 5000) {
+        usleep(1000);
+    }
+
+    TEST_CHECK(data->finished, "delete did not finish");
+
+    if(data->finished) {
+        TEST_CHECK(data->result == 0, "delete failed: 0x%08X", (u32) data->result);
+        TEST_CHECK(testData->writes == 3 && testData->errors == 0, "deleted %u of 3 items with %u errors", testData->writes, testData->errors);
+
+        free(data);
+    }
+}
+
+int main() {
+    task_init();
+
+    dataop_test_data testData;
+    memset(&testData, 0, sizeof(testData));
+
+    testData.size = DATAOP_TEST_SIZE;
+    testData.src = (u8*) malloc(testData.size);
+    testData.dst = (u8*) malloc(testData.size);
+    testData.readLatencyPerKb = DATAOP_TEST_LATENCY_PER_KB;
+    testData.writeLatencyPerKb = DATAOP_TEST_LATENCY_PER_KB;
+
+    for(u64 i = 0; i < testData.size; i++) {
+        testData.src[i] = test_pattern(i, 1);
+    }
+
+    dataop_test_active = &testData;
+
+    TEST_RUN(test_dataop_pipelined_matches_sequential);
+    TEST_RUN(test_dataop_pipelined_overlaps);
+    TEST_RUN(test_dataop_cancel);
+    TEST_RUN(test_dataop_suspend_restore);
+    TEST_RUN(test_dataop_read_error);
+    TEST_RUN(test_dataop_small_items);
+    TEST_RUN(test_dataop_delete);
+    TEST_RUN(test_dataop_skip_closes_prefetch);
+
+    free(testData.src);
+    free(testData.dst);
+
+    task_exit();
+
+    return test_finish();
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <string.h>
+
+#include <3ds.h>
+
+#include "core/core.h"
+#include "test.h"
+
+// Downloads from server.py and measures what the client costs on top of the transfer itself: copies on the libcurl
+// write path, reached by failing httpc certificate verification, and inflate on gzip-encoded httpc responses.
+
+#define HTTP_BENCH_ROOT "build/www_bench"
+#define HTTP_BENCH_SIZE (32 * 1024 * 1024)
+#define HTTP_BENCH_RUNS 3
+// Content and zero-filled alignment padding alternate, as in a CIA.
+#define HTTP_BENCH_REGION_SIZE (256 * 1024)
+
+static u16 http_bench_port;
+
+static u8* http_bench_data;
+static u8* http_bench_cia;
+
+typedef struct {
+    const u8* expected;
+    size_t pos;
+    bool match;
+
+    // The first block is always staged, so its pointer identifies every later delivery from the staging buffer.
+    const void* staging;
+    size_t stagedBytes;
+    u32 callbacks;
+} http_bench_sink;
+
+static Result http_bench_sink_callback(void* userData, void* buffer, size_t size) {
+    http_bench_sink* sink = (http_bench_sink*) userData;
+
+    if(sink->callbacks++ == 0) {
+        sink->staging = buffer;
+    }
+
+    if(buffer == sink->staging) {
+        sink->stagedBytes += size;
+    }
+
+    if(size > HTTP_BENCH_SIZE - sink->pos || memcmp(buffer, sink->expected + sink->pos, size) != 0) {
+        sink->match = false;
+    }
+
+    sink->pos += size;
+    return 0;
+}
+
+static void http_bench_copies(u32 bufferSize) {
+    char url[256];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%u/large.bin", http_bench_port);
+
+    double best = 0;
+
+    http_bench_sink sink;
+    for(u32 run = 0; run < HTTP_BENCH_RUNS; run++) {
+        memset(&sink, 0, sizeof(sink));
+        sink.expected = http_bench_data;
+        sink.match = true;
+
+        shim_httpc_tls_failures = 1;
+
+        double start = test_now_ms();
+        Result res = http_download_callback(url, bufferSize, 1, NULL, NULL, &sink, http_bench_sink_callback, NULL, NULL);
+        double elapsed = test_now_ms() - start;
+
+        TEST_CHECK(res == 0, "download failed: 0x%08X", (u32) res);
+        TEST_CHECK(sink.pos == HTTP_BENCH_SIZE && sink.match, "received %zu of %u bytes, match %d", sink.pos, HTTP_BENCH_SIZE, sink.match);
+
+        if(run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    double copied = (double) sink.stagedBytes / HTTP_BENCH_SIZE;
+    printf("buffer %4u KiB: %.3f bytes copied per byte, %u sink calls, %.0f MiB/s\n", bufferSize / 1024, copied, sink.callbacks, HTTP_BENCH_SIZE / 1024.0 / 1024.0 / (best / 1000.0));
+
+    // Staging everything would copy each byte once.
+    TEST_CHECK(copied < 0.5, "%.3f bytes copied per byte", copied);
+}
+
+// Returns the best time in milliseconds to download path over httpc with one connection.
+static double http_bench_httpc(const char* path, const u8* expected) {
+    char url[256];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%u/%s", http_bench_port, path);
+
+    double best = 0;
+    for(u32 run = 0; run < HTTP_BENCH_RUNS; run++) {
+        http_bench_sink sink;
+        memset(&sink, 0, sizeof(sink));
+        sink.expected = expected;
+        sink.match = true;
+
+        double start = test_now_ms();
+        Result res = http_download_callback(url, 128 * 1024, 1, NULL, NULL, &sink, http_bench_sink_callback, NULL, NULL);
+        double elapsed = test_now_ms() - start;
+
+        TEST_CHECK(res == 0, "%s: download failed: 0x%08X", path, (u32) res);
+        TEST_CHECK(sink.pos == HTTP_BENCH_SIZE && sink.match, "%s: received %zu of %u bytes, match %d", path, sink.pos, HTTP_BENCH_SIZE, sink.match);
+
+        if(run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    return best;
+}
+
+static void http_bench_inflate(const char* name, const u8* data) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s", name);
+    double plainMs = http_bench_httpc(path, data);
+
+    snprintf(path, sizeof(path), "gzip/%s", name);
+    double gzipMs = http_bench_httpc(path, data);
+
+    double mib = HTTP_BENCH_SIZE / 1024.0 / 1024.0;
+    printf("%-9s plain %4.0f MiB/s, gzip %4.0f MiB/s decoded\n", name, mib / (plainMs / 1000.0), mib / (gzipMs / 1000.0));
+}
+
+int main() {
+    http_bench_data = (u8*) malloc(HTTP_BENCH_SIZE);
+    for(u32 i = 0; i < HTTP_BENCH_SIZE; i++) {
+        http_bench_data[i] = test_pattern(i, 5);
+    }
+
+    http_bench_cia = (u8*) calloc(1, HTTP_BENCH_SIZE);
+    for(u32 i = 0; i < HTTP_BENCH_SIZE; i++) {
+        u32 region = i / HTTP_BENCH_REGION_SIZE;
+        if(region % 4 == 1) {
+            // Encrypted content.
+            http_bench_cia[i] = test_pattern(i, 6);
+        } else if(region % 4 == 2) {
+            // Tables and headers.
+            http_bench_cia[i] = (u8) (i % 64 < 8 ? test_pattern(i / 64, 7) : i % 64);
+        }
+    }
+
+    if((http_bench_port = test_server_start(HTTP_BENCH_ROOT)) == 0 || !test_write_file(HTTP_BENCH_ROOT "/large.bin", http_bench_data, HTTP_BENCH_SIZE)
+       || !test_write_file(HTTP_BENCH_ROOT "/cia.bin", http_bench_cia, HTTP_BENCH_SIZE)) {
+        fprintf(stderr, "failed to set up the test server\n");
+        test_server_stop();
+        return 1;
+    }
+
+    http_init();
+
+    http_bench_copies(64 * 1024);
+    http_bench_copies(128 * 1024);
+    http_bench_copies(1024 * 1024);
+
+    http_bench_inflate("large.bin", http_bench_data);
+    http_bench_inflate("cia.bin", http_bench_cia);
+
+    http_exit();
+
+    test_server_stop();
+
+    free(http_bench_data);
+    free(http_bench_cia);
+
+    return test_finish();
+}
\ No newline at end of file
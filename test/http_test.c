@@ -0,0 +1,350 @@
+#include <string.h>
+#include <unistd.h>
+
+#include <3ds.h>
+
+#include "core/core.h"
+#include "test.h"
+
+// Downloads from server.py through http_download_callback, over the httpc shim or, when httpc is made to fail
+// certificate verification, libcurl.
+
+#define HTTP_TEST_ROOT "build/www"
+#define HTTP_TEST_BUFFER (128 * 1024)
+// Not a multiple of the range segment size, so that the last segment is partial.
+#define HTTP_TEST_LARGE_SIZE (5 * 1024 * 1024 + 12345)
+#define HTTP_TEST_SMALL_SIZE (100 * 1024)
+// Must match HTTP_RANGE_SEGMENT_SIZE in http.c.
+#define HTTP_TEST_SEGMENT_SIZE (512 * 1024)
+
+static u16 http_test_port;
+
+static u8* http_test_large;
+static u8* http_test_small;
+
+typedef struct {
+    u8* buffer;
+    size_t size;
+    size_t pos;
+
+    u32 callbacks;
+} http_test_sink;
+
+static Result http_test_sink_callback(void* userData, void* buffer, size_t size) {
+    http_test_sink* sink = (http_test_sink*) userData;
+
+    if(size > sink->size - sink->pos) {
+        return R_APP_BAD_DATA;
+    }
+
+    memcpy(sink->buffer + sink->pos, buffer, size);
+    sink->pos += size;
+    sink->callbacks++;
+    return 0;
+}
+
+static void http_test_url(char* url, size_t size, const char* path) {
+    snprintf(url, size, "http://127.0.0.1:%u/%s", http_test_port, path);
+}
+
+// Downloads path and checks it against expected; returns the httpc requests it took.
+static u32 http_test_download(const char* path, u32 connections, const u8* expected, size_t expectedSize) {
+    char url[256];
+    http_test_url(url, sizeof(url), path);
+
+    http_test_sink sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.size = expectedSize;
+    sink.buffer = (u8*) malloc(expectedSize);
+
+    u32 requestsBefore = shim_httpc_requests;
+    Result res = http_download_callback(url, HTTP_TEST_BUFFER, connections, NULL, NULL, &sink, http_test_sink_callback, NULL, NULL);
+    u32 requests = shim_httpc_requests - requestsBefore;
+
+    TEST_CHECK(res == 0, "%s: download failed: 0x%08X", path, (u32) res);
+    TEST_CHECK(sink.pos == expectedSize, "%s: received %zu of %zu bytes", path, sink.pos, expectedSize);
+    TEST_CHECK(memcmp(sink.buffer, expected, sink.pos) == 0, "%s: data does not match", path);
+
+    free(sink.buffer);
+
+    return requests;
+}
+
+static void test_http_ranged() {
+    u32 segments = (HTTP_TEST_LARGE_SIZE + HTTP_TEST_SEGMENT_SIZE - 1) / HTTP_TEST_SEGMENT_SIZE;
+
+    for(u32 connections = 2; connections <= 8; connections *= 2) {
+        u32 requests = http_test_download("large.bin", connections, http_test_large, HTTP_TEST_LARGE_SIZE);
+        TEST_CHECK(requests == segments, "%u connections: %u requests for %u segments", connections, requests, segments);
+    }
+}
+
+static void test_http_single_connection() {
+    u32 requests = http_test_download("large.bin", 1, http_test_large, HTTP_TEST_LARGE_SIZE);
+    TEST_CHECK(requests == 1, "%u requests", requests);
+}
+
+static void test_http_single_segment() {
+    u32 requests = http_test_download("small.bin", 4, http_test_small, HTTP_TEST_SMALL_SIZE);
+    TEST_CHECK(requests == 1, "%u requests", requests);
+}
+
+static void test_http_no_range_fallback() {
+    u32 requests = http_test_download("norange/large.bin", 4, http_test_large, HTTP_TEST_LARGE_SIZE);
+    TEST_CHECK(requests == 1, "%u requests", requests);
+}
+
+static void test_http_no_total_fallback() {
+    // The probe cannot be split without a total, so the whole entity is requested again.
+    u32 requests = http_test_download("nototal/large.bin", 4, http_test_large, HTTP_TEST_LARGE_SIZE);
+    TEST_CHECK(requests == 2, "%u requests", requests);
+}
+
+static void test_http_worker_failure_fallback() {
+    // Without workers, the rest after the probe is fetched with one open-ended range request.
+    shim_thread_create_failures = 1;
+
+    u32 requests = http_test_download("large.bin", 4, http_test_large, HTTP_TEST_LARGE_SIZE);
+    TEST_CHECK(requests == 2, "%u requests", requests);
+
+    shim_thread_create_failures = 0;
+}
+
+static void test_http_gzip() {
+    // Ranges are never content-encoded, so the server's encoded reply to the probe must be read whole.
+    for(u32 connections = 1; connections <= 4; connections *= 4) {
+        u32 requests = http_test_download("gzip/large.bin", connections, http_test_large, HTTP_TEST_LARGE_SIZE);
+        TEST_CHECK(requests == 1, "%u connections: %u requests", connections, requests);
+    }
+}
+
+static void test_http_gzip_sparse() {
+    // Mostly zeros, so each receive inflates to many output buffers and the input window grows.
+    u8* sparse = (u8*) calloc(1, HTTP_TEST_LARGE_SIZE);
+    for(u32 i = 0; i < HTTP_TEST_LARGE_SIZE; i += 4096) {
+        sparse[i] = test_pattern(i, 4);
+    }
+
+    if(test_write_file(HTTP_TEST_ROOT "/sparse.bin", sparse, HTTP_TEST_LARGE_SIZE)) {
+        http_test_download("gzip/sparse.bin", 1, sparse, HTTP_TEST_LARGE_SIZE);
+    } else {
+        TEST_CHECK(false, "failed to write the sparse file");
+    }
+
+    free(sparse);
+}
+
+static void test_http_curl_fallback() {
+    shim_httpc_tls_failures = 1;
+
+    u32 requests = http_test_download("large.bin", 4, http_test_large, HTTP_TEST_LARGE_SIZE);
+    TEST_CHECK(requests == 0, "%u httpc requests", requests);
+    TEST_CHECK(shim_httpc_tls_failures == 0, "httpc was not tried first");
+
+    shim_httpc_tls_failures = 0;
+}
+
+// Cancels once a third of the file has been delivered, while workers are still fetching ahead.
+static Result http_test_cancel_check_running(void* userData) {
+    return ((http_test_sink*) userData)->pos >= HTTP_TEST_LARGE_SIZE / 3 ? R_APP_CANCELLED : 0;
+}
+
+static void test_http_cancel() {
+    char url[256];
+    http_test_url(url, sizeof(url), "large.bin");
+
+    http_test_sink sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.size = HTTP_TEST_LARGE_SIZE;
+    sink.buffer = (u8*) malloc(sink.size);
+
+    Result res = http_download_callback(url, HTTP_TEST_BUFFER, 4, NULL, NULL, &sink, http_test_sink_callback, http_test_cancel_check_running, NULL);
+    TEST_CHECK(res == R_APP_CANCELLED, "cancelled download returned 0x%08X", (u32) res);
+    TEST_CHECK(memcmp(sink.buffer, http_test_large, sink.pos) == 0, "data before cancellation does not match");
+
+    free(sink.buffer);
+}
+
+// Reads the server's connection and request counts; called while httpc fails, so it goes through the curl pool too.
+static void http_test_server_stats(u32* connections, u32* requests) {
+    char url[256];
+    http_test_url(url, sizeof(url), "stats");
+
+    char text[128] = {'\0'};
+
+    http_test_sink sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.size = sizeof(text) - 1;
+    sink.buffer = (u8*) text;
+
+    Result res = http_download_callback(url, HTTP_TEST_BUFFER, 1, NULL, NULL, &sink, http_test_sink_callback, NULL, NULL);
+    TEST_CHECK(res == 0, "stats request failed: 0x%08X", (u32) res);
+
+    *connections = 0;
+    *requests = 0;
+    sscanf(text, "connections=%u requests=%u", connections, requests);
+}
+
+static void test_http_pool_reuse() {
+    shim_httpc_tls_failures = 1000;
+
+    u32 connectionsBefore = 0;
+    u32 requestsBefore = 0;
+    http_test_server_stats(&connectionsBefore, &requestsBefore);
+
+    u32 hitsBefore = 0;
+    u32 missesBefore = 0;
+    http_get_pool_stats(&hitsBefore, &missesBefore);
+
+    for(u32 i = 0; i < 5; i++) {
+        http_test_download("small.bin", 1, http_test_small, HTTP_TEST_SMALL_SIZE);
+    }
+
+    u32 hits = 0;
+    u32 misses = 0;
+    http_get_pool_stats(&hits, &misses);
+
+    u32 connections = 0;
+    u32 requests = 0;
+    http_test_server_stats(&connections, &requests);
+
+    // The stats request left a pooled handle for this host behind, so every download reuses it.
+    TEST_CHECK(hits - hitsBefore == 5 && misses == missesBefore, "%u hits and %u misses", hits - hitsBefore, misses - missesBefore);
+    TEST_CHECK(requests - requestsBefore == 6, "server saw %u requests", requests - requestsBefore);
+    TEST_CHECK(connections == connectionsBefore, "%u new connections", connections - connectionsBefore);
+
+    shim_httpc_tls_failures = 0;
+}
+
+static void test_http_pool_other_host() {
+    shim_httpc_tls_failures = 1000;
+
+    u32 hitsBefore = 0;
+    u32 missesBefore = 0;
+    http_get_pool_stats(&hitsBefore, &missesBefore);
+
+    // Same server, but another host name, so another key.
+    char url[256];
+    snprintf(url, sizeof(url), "http://localhost:%u/small.bin", http_test_port);
+
+    http_test_sink sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.size = HTTP_TEST_SMALL_SIZE;
+    sink.buffer = (u8*) malloc(sink.size);
+
+    Result res = http_download_callback(url, HTTP_TEST_BUFFER, 1, NULL, NULL, &sink, http_test_sink_callback, NULL, NULL);
+    TEST_CHECK(res == 0 && sink.pos == HTTP_TEST_SMALL_SIZE, "download failed: 0x%08X", (u32) res);
+
+    free(sink.buffer);
+
+    u32 hits = 0;
+    u32 misses = 0;
+    http_get_pool_stats(&hits, &misses);
+
+    TEST_CHECK(hits == hitsBefore && misses - missesBefore == 1, "%u hits and %u misses", hits - hitsBefore, misses - missesBefore);
+
+    shim_httpc_tls_failures = 0;
+}
+
+// Downloads path with a prefetch opened for prefetchPath; returns the httpc requests both took.
+static u32 http_test_prefetched_download(const char* prefetchPath, const char* path, const u8* expected, size_t expectedSize) {
+    char url[256];
+    http_test_url(url, sizeof(url), prefetchPath);
+
+    u32 requestsBefore = shim_httpc_requests;
+
+    http_prefetch prefetch = NULL;
+    TEST_CHECK(R_SUCCEEDED(http_prefetch_open(&prefetch, url, 1, HTTP_TEST_BUFFER)), "%s: failed to open prefetch", prefetchPath);
+
+    http_test_url(url, sizeof(url), path);
+
+    http_test_sink sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.size = expectedSize;
+    sink.buffer = (u8*) malloc(expectedSize);
+
+    Result res = http_download_callback(url, HTTP_TEST_BUFFER, 1, NULL, &prefetch, &sink, http_test_sink_callback, NULL, NULL);
+    u32 requests = shim_httpc_requests - requestsBefore;
+
+    TEST_CHECK(res == 0, "%s: download failed: 0x%08X", path, (u32) res);
+    TEST_CHECK(prefetch == NULL, "%s: prefetch was not consumed", path);
+    TEST_CHECK(sink.pos == expectedSize, "%s: received %zu of %zu bytes", path, sink.pos, expectedSize);
+    TEST_CHECK(memcmp(sink.buffer, expected, sink.pos) == 0, "%s: data does not match", path);
+
+    free(sink.buffer);
+
+    return requests;
+}
+
+static void test_http_prefetch_handover() {
+    // The prefetched response, including the head it read ahead, is served in place of a new request.
+    u32 requests = http_test_prefetched_download("small.bin", "small.bin", http_test_small, HTTP_TEST_SMALL_SIZE);
+    TEST_CHECK(requests == 1, "matching prefetch took %u requests", requests);
+
+    // A prefetch for another item is dropped, possibly before it has made its request, and the download makes its own.
+    requests = http_test_prefetched_download("large.bin", "small.bin", http_test_small, HTTP_TEST_SMALL_SIZE);
+    TEST_CHECK(requests >= 1, "mismatched prefetch took %u requests", requests);
+}
+
+static void test_http_prefetch_close_slow() {
+    char url[256];
+    http_test_url(url, sizeof(url), "slow/small.bin");
+
+    http_prefetch prefetch = NULL;
+    TEST_CHECK(R_SUCCEEDED(http_prefetch_open(&prefetch, url, 1, HTTP_TEST_BUFFER)), "failed to open prefetch");
+
+    // The server has not answered yet; closing must not wait for it, as a cancelled operation closes its prefetch.
+    usleep(100 * 1000);
+
+    double start = test_now_ms();
+    http_prefetch_close(prefetch);
+    double closeMs = test_now_ms() - start;
+
+    TEST_CHECK(closeMs < 1000, "close waited %.1f ms for the server", closeMs);
+}
+
+int main() {
+    http_test_large = (u8*) malloc(HTTP_TEST_LARGE_SIZE);
+    for(u32 i = 0; i < HTTP_TEST_LARGE_SIZE; i++) {
+        http_test_large[i] = test_pattern(i, 2);
+    }
+
+    http_test_small = (u8*) malloc(HTTP_TEST_SMALL_SIZE);
+    for(u32 i = 0; i < HTTP_TEST_SMALL_SIZE; i++) {
+        http_test_small[i] = test_pattern(i, 3);
+    }
+
+    if((http_test_port = test_server_start(HTTP_TEST_ROOT)) == 0
+       || !test_write_file(HTTP_TEST_ROOT "/large.bin", http_test_large, HTTP_TEST_LARGE_SIZE)
+       || !test_write_file(HTTP_TEST_ROOT "/small.bin", http_test_small, HTTP_TEST_SMALL_SIZE)) {
+        fprintf(stderr, "failed to set up the test server\n");
+        test_server_stop();
+        return 1;
+    }
+
+    http_init();
+
+    TEST_RUN(test_http_ranged);
+    TEST_RUN(test_http_single_connection);
+    TEST_RUN(test_http_single_segment);
+    TEST_RUN(test_http_no_range_fallback);
+    TEST_RUN(test_http_no_total_fallback);
+    TEST_RUN(test_http_worker_failure_fallback);
+    TEST_RUN(test_http_gzip);
+    TEST_RUN(test_http_gzip_sparse);
+    TEST_RUN(test_http_curl_fallback);
+    TEST_RUN(test_http_cancel);
+    TEST_RUN(test_http_pool_reuse);
+    TEST_RUN(test_http_pool_other_host);
+    TEST_RUN(test_http_prefetch_handover);
+    TEST_RUN(test_http_prefetch_close_slow);
+
+    http_exit();
+
+    test_server_stop();
+
+    free(http_test_large);
+    free(http_test_small);
+
+    return test_finish();
+}
\ No newline at end of file
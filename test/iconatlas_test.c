@@ -0,0 +1,332 @@
+#include <string.h>
+
+#include <3ds.h>
+
+#include "core/iconatlas.h"
+#include "test.h"
+
+// Drives the icon atlas against stubbed screen calls that track the page textures it creates and which icon was last
+// uploaded to each slot, so that every draw can be checked against the icon it was asked for.
+
+#define ICONATLAS_TEST_ICON_PAGES 4
+#define ICONATLAS_TEST_ICON_SLOTS (ICONATLAS_TEST_ICON_PAGES * 100)
+#define ICONATLAS_TEST_BANNER_PAGES 2
+#define ICONATLAS_TEST_BANNER_SLOTS (ICONATLAS_TEST_BANNER_PAGES * 64)
+
+#define ICONATLAS_TEST_TEXTURES 32
+// Slot contents are tracked per 16x16 cell, the largest size both icon shapes are a multiple of.
+#define ICONATLAS_TEST_CELLS ((512 / 16) * (512 / 16))
+
+typedef struct {
+    bool created;
+    u32 width;
+    u32 height;
+    GPU_TEXCOLOR format;
+
+    u8 cells[ICONATLAS_TEST_CELLS];
+} iconatlas_test_texture;
+
+static iconatlas_test_texture iconatlas_test_textures[ICONATLAS_TEST_TEXTURES];
+static u32 iconatlas_test_next_texture;
+static u32 iconatlas_test_live_textures;
+
+// Where and what the last draw showed.
+static u32 iconatlas_test_draws;
+static u8 iconatlas_test_drawn;
+
+u32 screen_allocate_free_texture() {
+    TEST_CHECK(iconatlas_test_next_texture < ICONATLAS_TEST_TEXTURES, "too many textures allocated");
+    return iconatlas_test_next_texture < ICONATLAS_TEST_TEXTURES ? iconatlas_test_next_texture++ : 0;
+}
+
+void screen_create_texture(u32 id, u32 width, u32 height, GPU_TEXCOLOR format, bool linearFilter) {
+    iconatlas_test_texture* texture = &iconatlas_test_textures[id];
+    memset(texture, 0, sizeof(*texture));
+
+    texture->created = true;
+    texture->width = width;
+    texture->height = height;
+    texture->format = format;
+
+    iconatlas_test_live_textures++;
+}
+
+void screen_load_texture_region(u32 id, void* data, u32 size, u32 x, u32 y, u32 width, u32 height, bool tiled) {
+    iconatlas_test_texture* texture = &iconatlas_test_textures[id];
+
+    TEST_CHECK(texture->created && x + width <= texture->width && y + height <= texture->height && x % width == 0 && y % height == 0,
+               "upload of %ux%u at %u,%u outside the slots of texture %u", width, height, x, y, id);
+    TEST_CHECK(size == width * height * 2, "upload of %u bytes for %ux%u", size, width, height);
+
+    for(u32 cy = y / 16; cy < (y + height) / 16; cy++) {
+        for(u32 cx = x / 16; cx < (x + width) / 16; cx++) {
+            texture->cells[cy * (512 / 16) + cx] = ((u8*) data)[0];
+        }
+    }
+}
+
+void screen_draw_texture_region(u32 id, float x, float y, float width, float height, u32 srcX, u32 srcY, u32 srcWidth, u32 srcHeight) {
+    iconatlas_test_texture* texture = &iconatlas_test_textures[id];
+
+    TEST_CHECK(texture->created, "drew from texture %u, which was not created", id);
+
+    // Every cell of the slot holds the same icon.
+    u8 value = texture->cells[(srcY / 16) * (512 / 16) + srcX / 16];
+    for(u32 cy = srcY / 16; cy < (srcY + srcHeight) / 16; cy++) {
+        for(u32 cx = srcX / 16; cx < (srcX + srcWidth) / 16; cx++) {
+            TEST_CHECK(texture->cells[cy * (512 / 16) + cx] == value, "drew a slot spanning two icons");
+        }
+    }
+
+    iconatlas_test_draws++;
+    iconatlas_test_drawn = value;
+}
+
+void screen_unload_texture(u32 id) {
+    TEST_CHECK(iconatlas_test_textures[id].created, "unloaded texture %u twice", id);
+
+    iconatlas_test_textures[id].created = false;
+    iconatlas_test_live_textures--;
+}
+
+typedef struct {
+    u8 value;
+    bool fail;
+    u32 loads;
+} iconatlas_test_source;
+
+static bool iconatlas_test_load(void* data, void* pixels, u32 size) {
+    iconatlas_test_source* source = (iconatlas_test_source*) data;
+    source->loads++;
+
+    if(source->fail) {
+        return false;
+    }
+
+    memset(pixels, source->value, size);
+    return true;
+}
+
+// Icon values start at 1, as 0 marks an empty cell.
+static u8 iconatlas_test_value(u32 i) {
+    return (u8) (i % 255 + 1);
+}
+
+static u32 iconatlas_test_add(iconatlas_test_source* source, bool withPixels) {
+    u8 pixels[48 * 48 * 2];
+    memset(pixels, source->value, sizeof(pixels));
+
+    return icon_atlas_add(48, 48, GPU_RGB565, true, withPixels ? pixels : NULL, iconatlas_test_load, source);
+}
+
+static void iconatlas_test_begin() {
+    memset(iconatlas_test_textures, 0, sizeof(iconatlas_test_textures));
+    iconatlas_test_next_texture = 1;
+    iconatlas_test_live_textures = 0;
+
+    icon_atlas_init();
+}
+
+// Draws the icon and returns what was shown, or 0 when nothing was.
+static u8 iconatlas_test_draw(u32 icon) {
+    u32 draws = iconatlas_test_draws;
+    icon_atlas_draw(icon, 0, 0, 48, 48);
+
+    return iconatlas_test_draws != draws ? iconatlas_test_drawn : 0;
+}
+
+static void test_iconatlas_packing() {
+    iconatlas_test_begin();
+
+    static iconatlas_test_source sources[1000];
+
+    for(u32 i = 0; i < 1000; i++) {
+        sources[i].value = iconatlas_test_value(i);
+
+        u32 icon = iconatlas_test_add(&sources[i], true);
+        TEST_CHECK(icon == i + 1, "icon %u got handle %u", i, icon);
+    }
+
+    TEST_CHECK(iconatlas_test_live_textures == ICONATLAS_TEST_ICON_PAGES, "%u pages created", iconatlas_test_live_textures);
+    for(u32 id = 1; id <= ICONATLAS_TEST_ICON_PAGES; id++) {
+        iconatlas_test_texture* texture = &iconatlas_test_textures[id];
+        TEST_CHECK(texture->width == 512 && texture->height == 512 && texture->format == GPU_RGB565, "page %u is %ux%u format %u", id, texture->width, texture->height, texture->format);
+    }
+
+    u32 width = 0;
+    u32 height = 0;
+    icon_atlas_get_size(&width, &height, 1000);
+    TEST_CHECK(width == 48 && height == 48, "icon is %ux%u", width, height);
+
+    // The first icons fit and were stored when added.
+    for(u32 i = 0; i < ICONATLAS_TEST_ICON_SLOTS; i++) {
+        u8 drawn = iconatlas_test_draw(i + 1);
+        TEST_CHECK(drawn == sources[i].value && sources[i].loads == 0, "icon %u drew %u after %u loads", i, drawn, sources[i].loads);
+    }
+
+    // The rest are loaded when drawn, in place of the least recently drawn.
+    for(u32 i = ICONATLAS_TEST_ICON_SLOTS; i < 1000; i++) {
+        u8 drawn = iconatlas_test_draw(i + 1);
+        TEST_CHECK(drawn == sources[i].value && sources[i].loads == 1, "icon %u drew %u after %u loads", i, drawn, sources[i].loads);
+    }
+
+    TEST_CHECK(iconatlas_test_live_textures == ICONATLAS_TEST_ICON_PAGES, "%u pages after eviction", iconatlas_test_live_textures);
+
+    icon_atlas_exit();
+    TEST_CHECK(iconatlas_test_live_textures == 0, "%u pages left after exit", iconatlas_test_live_textures);
+}
+
+static void test_iconatlas_lru() {
+    iconatlas_test_begin();
+
+    static iconatlas_test_source sources[ICONATLAS_TEST_ICON_SLOTS + 1];
+    u32 icons[ICONATLAS_TEST_ICON_SLOTS + 1];
+
+    for(u32 i = 0; i <= ICONATLAS_TEST_ICON_SLOTS; i++) {
+        sources[i].value = iconatlas_test_value(i);
+        icons[i] = iconatlas_test_add(&sources[i], true);
+    }
+
+    // Drawn in reverse, the first icon is the most recent and the second-to-last the least.
+    for(u32 i = ICONATLAS_TEST_ICON_SLOTS; i > 0; i--) {
+        iconatlas_test_draw(icons[i - 1]);
+    }
+
+    // The icon that did not fit displaces the least recently drawn.
+    TEST_CHECK(iconatlas_test_draw(icons[ICONATLAS_TEST_ICON_SLOTS]) == sources[ICONATLAS_TEST_ICON_SLOTS].value, "extra icon not drawn");
+    TEST_CHECK(iconatlas_test_draw(icons[0]) == sources[0].value && sources[0].loads == 0, "most recent icon was evicted");
+
+    TEST_CHECK(iconatlas_test_draw(icons[ICONATLAS_TEST_ICON_SLOTS - 1]) == sources[ICONATLAS_TEST_ICON_SLOTS - 1].value && sources[ICONATLAS_TEST_ICON_SLOTS - 1].loads == 1,
+               "least recent icon was not the one evicted");
+
+    // Resident icons are not loaded again.
+    iconatlas_test_draw(icons[ICONATLAS_TEST_ICON_SLOTS - 1]);
+    TEST_CHECK(sources[ICONATLAS_TEST_ICON_SLOTS - 1].loads == 1, "resident icon loaded %u times", sources[ICONATLAS_TEST_ICON_SLOTS - 1].loads);
+
+    icon_atlas_exit();
+}
+
+static void test_iconatlas_load_failure() {
+    iconatlas_test_begin();
+
+    iconatlas_test_source missing = {iconatlas_test_value(7), true, 0};
+    u32 icon = iconatlas_test_add(&missing, false);
+
+    TEST_CHECK(iconatlas_test_draw(icon) == 0, "icon drawn although it failed to load");
+    TEST_CHECK(iconatlas_test_draw(icon) == 0 && missing.loads == 1, "failed icon loaded %u times", missing.loads);
+
+    // The slot taken for the failed load is free again.
+    iconatlas_test_source present = {iconatlas_test_value(8), false, 0};
+    u32 other = iconatlas_test_add(&present, false);
+
+    TEST_CHECK(iconatlas_test_draw(other) == present.value, "icon after a failure not drawn");
+    TEST_CHECK(iconatlas_test_live_textures == 1, "%u pages for one icon", iconatlas_test_live_textures);
+
+    icon_atlas_exit();
+}
+
+static void test_iconatlas_handles() {
+    iconatlas_test_begin();
+
+    static iconatlas_test_source sources[ICONATLAS_TEST_ICON_SLOTS];
+    u32 icons[ICONATLAS_TEST_ICON_SLOTS];
+
+    for(u32 i = 0; i < ICONATLAS_TEST_ICON_SLOTS; i++) {
+        sources[i].value = iconatlas_test_value(i);
+        icons[i] = iconatlas_test_add(&sources[i], true);
+    }
+
+    icon_atlas_remove(icons[10]);
+
+    u32 width = 1;
+    icon_atlas_get_size(&width, NULL, icons[10]);
+    TEST_CHECK(width == 0 && iconatlas_test_draw(icons[10]) == 0, "removed icon is still usable");
+
+    // The handle and the slot both go to the next icon, which is stored without evicting another.
+    iconatlas_test_source replacement = {iconatlas_test_value(500), false, 0};
+    u32 icon = iconatlas_test_add(&replacement, true);
+
+    TEST_CHECK(icon == icons[10], "handle %u given rather than the removed %u", icon, icons[10]);
+    TEST_CHECK(iconatlas_test_draw(icon) == replacement.value && replacement.loads == 0, "replacement icon was not stored");
+
+    for(u32 i = 0; i < ICONATLAS_TEST_ICON_SLOTS; i++) {
+        if(i != 10) {
+            TEST_CHECK(iconatlas_test_draw(icons[i]) == sources[i].value && sources[i].loads == 0, "icon %u was disturbed", i);
+        }
+    }
+
+    // Unknown handles are ignored.
+    icon_atlas_remove(ICON_ATLAS_NONE);
+    icon_atlas_remove(100000);
+    TEST_CHECK(iconatlas_test_draw(ICON_ATLAS_NONE) == 0 && iconatlas_test_draw(100000) == 0, "unknown handle drew");
+
+    // Handles outlast any number of icons.
+    static iconatlas_test_source many[20000];
+    for(u32 i = 0; i < 20000; i++) {
+        many[i].value = iconatlas_test_value(i);
+
+        u32 added = iconatlas_test_add(&many[i], false);
+        TEST_CHECK(added != ICON_ATLAS_NONE, "ran out of handles after %u icons", i);
+        if(added == ICON_ATLAS_NONE) {
+            break;
+        }
+    }
+
+    icon_atlas_exit();
+}
+
+static void test_iconatlas_shapes() {
+    iconatlas_test_begin();
+
+    u8 pixels[48 * 48 * 2];
+    memset(pixels, 1, sizeof(pixels));
+
+    TEST_CHECK(icon_atlas_add(64, 64, GPU_RGB565, true, pixels, NULL, NULL) == ICON_ATLAS_NONE, "accepted a 64x64 icon");
+    TEST_CHECK(icon_atlas_add(48, 48, GPU_RGBA8, true, pixels, NULL, NULL) == ICON_ATLAS_NONE, "accepted an RGBA8 icon");
+    TEST_CHECK(icon_atlas_add(48, 48, GPU_RGB565, false, pixels, NULL, NULL) == ICON_ATLAS_NONE, "accepted an untiled icon");
+
+    // Banner icons have pools of their own, as do titles.
+    static iconatlas_test_source sources[ICONATLAS_TEST_BANNER_SLOTS + 1];
+    u32 icons[ICONATLAS_TEST_BANNER_SLOTS + 1];
+
+    for(u32 i = 0; i <= ICONATLAS_TEST_BANNER_SLOTS; i++) {
+        sources[i].value = iconatlas_test_value(i);
+        memset(pixels, sources[i].value, 32 * 32 * 2);
+
+        icons[i] = icon_atlas_add(32, 32, GPU_RGBA5551, false, pixels, iconatlas_test_load, &sources[i]);
+    }
+
+    TEST_CHECK(iconatlas_test_live_textures == ICONATLAS_TEST_BANNER_PAGES, "%u pages for banner icons", iconatlas_test_live_textures);
+    for(u32 id = 1; id <= ICONATLAS_TEST_BANNER_PAGES; id++) {
+        iconatlas_test_texture* texture = &iconatlas_test_textures[id];
+        TEST_CHECK(texture->width == 256 && texture->height == 256 && texture->format == GPU_RGBA5551, "page %u is %ux%u format %u", id, texture->width, texture->height, texture->format);
+    }
+
+    u32 width = 0;
+    u32 height = 0;
+    icon_atlas_get_size(&width, &height, icons[0]);
+    TEST_CHECK(width == 32 && height == 32, "banner icon is %ux%u", width, height);
+
+    for(u32 i = 0; i <= ICONATLAS_TEST_BANNER_SLOTS; i++) {
+        TEST_CHECK(iconatlas_test_draw(icons[i]) == sources[i].value, "banner icon %u not drawn", i);
+    }
+
+    TEST_CHECK(sources[ICONATLAS_TEST_BANNER_SLOTS].loads == 1, "banner icon that did not fit loaded %u times", sources[ICONATLAS_TEST_BANNER_SLOTS].loads);
+
+    // A title icon gets a page of its own pool.
+    iconatlas_test_source title = {iconatlas_test_value(300), false, 0};
+    TEST_CHECK(iconatlas_test_draw(iconatlas_test_add(&title, true)) == title.value, "title icon not drawn");
+    TEST_CHECK(iconatlas_test_live_textures == ICONATLAS_TEST_BANNER_PAGES + 1, "%u pages for both pools", iconatlas_test_live_textures);
+
+    icon_atlas_exit();
+}
+
+int main() {
+    TEST_RUN(test_iconatlas_packing);
+    TEST_RUN(test_iconatlas_lru);
+    TEST_RUN(test_iconatlas_load_failure);
+    TEST_RUN(test_iconatlas_handles);
+    TEST_RUN(test_iconatlas_shapes);
+
+    return test_finish();
+}
\ No newline at end of file
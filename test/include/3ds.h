@@ -0,0 +1,572 @@
+#pragma once
+
+// Host stand-in for the parts of libctru used by the modules under test.
+// Kernel objects, threads and the FS service are emulated by shim/ctru.c, and httpc by shim/httpc.c.
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+// The sources forward-declare newlib's FILE.
+#define __sFILE _IO_FILE
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+
+typedef s32 Result;
+typedef u32 Handle;
+
+#define U64_MAX UINT64_MAX
+
+#define BIT(n) (1U << (n))
+
+#define R_SUCCEEDED(res) ((res) >= 0)
+#define R_FAILED(res) ((res) < 0)
+#define R_LEVEL(res) (((res) >> 27) & 0x1F)
+#define R_SUMMARY(res) (((res) >> 21) & 0x3F)
+#define R_MODULE(res) (((res) >> 10) & 0xFF)
+#define R_DESCRIPTION(res) ((res) & 0x3FF)
+
+#define MAKERESULT(level, summary, module, description) \
+    ((Result) ((((level) & 0x1F) << 27) | (((summary) & 0x3F) << 21) | (((module) & 0xFF) << 10) | ((description) & 0x3FF)))
+
+enum {
+    RL_SUCCESS = 0,
+    RL_INFO = 1,
+    RL_FATAL = 31,
+    RL_RESET = 30,
+    RL_REINITIALIZE = 29,
+    RL_USAGE = 28,
+    RL_PERMANENT = 27,
+    RL_TEMPORARY = 26,
+    RL_STATUS = 25
+};
+
+enum {
+    RS_SUCCESS = 0,
+    RS_NOP = 1,
+    RS_WOULDBLOCK = 2,
+    RS_OUTOFRESOURCE = 3,
+    RS_NOTFOUND = 4,
+    RS_INVALIDSTATE = 5,
+    RS_NOTSUPPORTED = 6,
+    RS_INVALIDARG = 7,
+    RS_WRONGARG = 8,
+    RS_CANCELED = 9,
+    RS_STATUSCHANGED = 10,
+    RS_INTERNAL = 11
+};
+
+enum {
+    RM_COMMON = 0,
+    RM_KERNEL = 1,
+    RM_OS = 6,
+    RM_FS = 17,
+    RM_HTTP = 40,
+    RM_APPLICATION = 254
+};
+
+enum {
+    RD_SUCCESS = 0,
+    RD_TIMEOUT = 1022,
+    RD_OUT_OF_RANGE = 1021,
+    RD_ALREADY_EXISTS = 1020,
+    RD_NOT_FOUND = 1018,
+    RD_NOT_IMPLEMENTED = 1012,
+    RD_OUT_OF_MEMORY = 1011,
+    RD_INVALID_SIZE = 1004
+};
+
+// Kernel objects
+
+typedef enum {
+    RESET_ONESHOT = 0,
+    RESET_STICKY = 1,
+    RESET_PULSE = 2
+} ResetType;
+
+Result svcCreateEvent(Handle* event, ResetType resetType);
+Result svcSignalEvent(Handle handle);
+Result svcClearEvent(Handle handle);
+Result svcCreateSemaphore(Handle* semaphore, s32 initialCount, s32 maxCount);
+Result svcReleaseSemaphore(s32* count, Handle semaphore, s32 releaseCount);
+Result svcCreateMutex(Handle* mutex, bool initiallyLocked);
+Result svcReleaseMutex(Handle handle);
+Result svcWaitSynchronization(Handle handle, s64 nanoseconds);
+Result svcWaitSynchronizationN(s32* out, const Handle* handles, s32 handlesCount, bool waitAll, s64 nanoseconds);
+Result svcCloseHandle(Handle handle);
+void svcSleepThread(s64 ns);
+u64 svcGetSystemTick();
+Result svcSendSyncRequest(Handle session);
+u32* getThreadCommandBuffer();
+
+#define SYSCLOCK_ARM11 268111856
+#define CPU_TICKS_PER_MSEC (SYSCLOCK_ARM11 / 1000.0)
+
+u64 osGetTime();
+u8 osGetWifiStrength();
+
+// Threads and user-mode synchronization
+
+typedef void (*ThreadFunc)(void* arg);
+typedef struct Thread_tag* Thread;
+
+Thread threadCreate(ThreadFunc entrypoint, void* arg, size_t stackSize, int prio, int coreId, bool detached);
+Result threadJoin(Thread thread, u64 timeoutNs);
+void threadFree(Thread thread);
+void threadDetach(Thread thread);
+
+typedef pthread_mutex_t LightLock;
+typedef pthread_cond_t CondVar;
+
+void LightLock_Init(LightLock* lock);
+void LightLock_Lock(LightLock* lock);
+void LightLock_Unlock(LightLock* lock);
+
+void CondVar_Init(CondVar* cv);
+void CondVar_Wait(CondVar* cv, LightLock* lock);
+int CondVar_WaitTimeout(CondVar* cv, LightLock* lock, s64 timeoutNs);
+void CondVar_Signal(CondVar* cv);
+void CondVar_Broadcast(CondVar* cv);
+
+// HID and APT
+
+#define KEY_A BIT(0)
+#define KEY_B BIT(1)
+#define KEY_SELECT BIT(2)
+#define KEY_START BIT(3)
+#define KEY_DRIGHT BIT(4)
+#define KEY_DLEFT BIT(5)
+#define KEY_DUP BIT(6)
+#define KEY_DDOWN BIT(7)
+#define KEY_R BIT(8)
+#define KEY_L BIT(9)
+#define KEY_X BIT(10)
+#define KEY_Y BIT(11)
+#define KEY_ZL BIT(14)
+#define KEY_ZR BIT(15)
+#define KEY_TOUCH BIT(20)
+#define KEY_CSTICK_RIGHT BIT(24)
+#define KEY_CSTICK_LEFT BIT(25)
+#define KEY_CSTICK_UP BIT(26)
+#define KEY_CSTICK_DOWN BIT(27)
+#define KEY_CPAD_RIGHT BIT(28)
+#define KEY_CPAD_LEFT BIT(29)
+#define KEY_CPAD_UP BIT(30)
+#define KEY_CPAD_DOWN BIT(31)
+#define KEY_UP (KEY_DUP | KEY_CPAD_UP)
+#define KEY_DOWN (KEY_DDOWN | KEY_CPAD_DOWN)
+#define KEY_LEFT (KEY_DLEFT | KEY_CPAD_LEFT)
+#define KEY_RIGHT (KEY_DRIGHT | KEY_CPAD_RIGHT)
+
+typedef struct {
+    u16 px;
+    u16 py;
+} touchPosition;
+
+void hidScanInput();
+u32 hidKeysDown();
+u32 hidKeysHeld();
+u32 hidKeysUp();
+void hidTouchRead(touchPosition* pos);
+
+typedef enum {
+    APTHOOK_ONSUSPEND = 0,
+    APTHOOK_ONRESTORE,
+    APTHOOK_ONSLEEP,
+    APTHOOK_ONWAKEUP,
+    APTHOOK_ONEXIT,
+    APTHOOK_COUNT
+} APT_HookType;
+
+typedef void (*aptHookFn)(APT_HookType hook, void* param);
+
+typedef struct tag_aptHookCookie {
+    struct tag_aptHookCookie* next;
+    aptHookFn callback;
+    void* param;
+} aptHookCookie;
+
+typedef u32 NS_APPID;
+
+bool aptMainLoop();
+void aptHook(aptHookCookie* cookie, aptHookFn callback, void* param);
+void aptUnhook(aptHookCookie* cookie);
+void aptSetSleepAllowed(bool allowed);
+Result APT_CheckNew3DS(bool* out);
+Result APT_GetAppletInfo(NS_APPID appID, u64* pProgramID, u8* pMediaType, bool* pRegistered, bool* pLoadState, u32* pAttributes);
+
+bool envIsHomebrew();
+u32 envGetAptAppId();
+
+// GPU and GFX
+
+typedef enum {
+    GPU_RGBA8 = 0x0,
+    GPU_RGB8 = 0x1,
+    GPU_RGBA5551 = 0x2,
+    GPU_RGB565 = 0x3,
+    GPU_RGBA4 = 0x4,
+    GPU_LA8 = 0x5,
+    GPU_HILO8 = 0x6,
+    GPU_L8 = 0x7,
+    GPU_A8 = 0x8,
+    GPU_LA4 = 0x9,
+    GPU_L4 = 0xA,
+    GPU_A4 = 0xB,
+    GPU_ETC1 = 0xC,
+    GPU_ETC1A4 = 0xD
+} GPU_TEXCOLOR;
+
+typedef enum {
+    GFX_TOP = 0,
+    GFX_BOTTOM = 1
+} gfxScreen_t;
+
+typedef enum {
+    GFX_LEFT = 0,
+    GFX_RIGHT = 1
+} gfx3dSide_t;
+
+// Software keyboard
+
+typedef enum {
+    SWKBD_TYPE_NORMAL = 0,
+    SWKBD_TYPE_QWERTY,
+    SWKBD_TYPE_NUMPAD,
+    SWKBD_TYPE_WESTERN
+} SwkbdType;
+
+typedef enum {
+    SWKBD_ANYTHING = 0,
+    SWKBD_NOTEMPTY,
+    SWKBD_NOTEMPTY_NOTBLANK,
+    SWKBD_NOTBLANK_NOTEMPTY = SWKBD_NOTEMPTY_NOTBLANK,
+    SWKBD_NOTBLANK,
+    SWKBD_FIXEDLEN
+} SwkbdValidInput;
+
+enum {
+    SWKBD_PARENTAL = 1 << 0,
+    SWKBD_DARKEN_TOP_SCREEN = 1 << 1,
+    SWKBD_PREDICTIVE_INPUT = 1 << 2,
+    SWKBD_MULTILINE = 1 << 3,
+    SWKBD_FIXED_WIDTH = 1 << 4,
+    SWKBD_ALLOW_HOME = 1 << 5,
+    SWKBD_ALLOW_RESET = 1 << 6,
+    SWKBD_ALLOW_POWER = 1 << 7
+};
+
+typedef enum {
+    SWKBD_BUTTON_LEFT = 0,
+    SWKBD_BUTTON_MIDDLE,
+    SWKBD_BUTTON_RIGHT,
+    SWKBD_BUTTON_CONFIRM = SWKBD_BUTTON_RIGHT,
+    SWKBD_BUTTON_NONE
+} SwkbdButton;
+
+// Text
+
+ssize_t utf8_to_utf16(u16* out, const u8* in, size_t len);
+ssize_t utf16_to_utf8(u8* out, const u16* in, size_t len);
+ssize_t decode_utf8(u32* out, const u8* in);
+
+// System font; not emulated, so programs that lay out text provide these themselves.
+
+typedef struct {
+    s8 left;
+    u8 glyphWidth;
+    u8 charWidth;
+} charWidthInfo_s;
+
+typedef struct {
+    u8 fontType;
+    u8 lineFeed;
+    u16 alterCharIndex;
+    charWidthInfo_s defaultWidth;
+    u8 height;
+    u8 width;
+    u8 ascent;
+} FINF_s;
+
+typedef struct {
+    int sheetIndex;
+    float xOffset;
+    float xAdvance;
+    float width;
+    struct {
+        float left;
+        float top;
+        float right;
+        float bottom;
+    } texcoord, vtxcoord;
+} fontGlyphPos_s;
+
+enum {
+    GLYPH_POS_CALC_VTXCOORD = BIT(0),
+    GLYPH_POS_AT_BASELINE = BIT(1),
+    GLYPH_POS_Y_POINTS_UP = BIT(2)
+};
+
+FINF_s* fontGetInfo();
+int fontGlyphIndexFromCodePoint(u32 codePoint);
+charWidthInfo_s* fontGetCharWidthInfo(int glyphIndex);
+void fontCalcGlyphPos(fontGlyphPos_s* out, int glyphIndex, u32 flags, float scaleX, float scaleY);
+
+// FS
+
+typedef u64 FS_Archive;
+
+typedef enum {
+    PATH_INVALID = 0,
+    PATH_EMPTY = 1,
+    PATH_BINARY = 2,
+    PATH_ASCII = 3,
+    PATH_UTF16 = 4
+} FS_PathType;
+
+typedef struct {
+    FS_PathType type;
+    u32 size;
+    const void* data;
+} FS_Path;
+
+typedef enum {
+    ARCHIVE_ROMFS = 0x00000003,
+    ARCHIVE_SAVEDATA = 0x00000004,
+    ARCHIVE_EXTDATA = 0x00000006,
+    ARCHIVE_SHARED_EXTDATA = 0x00000007,
+    ARCHIVE_SYSTEM_SAVEDATA = 0x00000008,
+    ARCHIVE_SDMC = 0x00000009,
+    ARCHIVE_SDMC_WRITE_ONLY = 0x0000000A,
+    ARCHIVE_BOSS_EXTDATA = 0x12345678,
+    ARCHIVE_CARD_SPIFS = 0x12345679,
+    ARCHIVE_NAND_RW = 0x1234567D,
+    ARCHIVE_NAND_RO = 0x1234567E,
+    ARCHIVE_NAND_RO_WRITE_ACCESS = 0x1234567F,
+    ARCHIVE_SAVEDATA_AND_CONTENT = 0x2345678A,
+    ARCHIVE_SAVEDATA_AND_CONTENT2 = 0x2345678E,
+    ARCHIVE_NAND_CTR_FS = 0x567890AB,
+    ARCHIVE_TWL_PHOTO = 0x567890AC,
+    ARCHIVE_TWL_SOUND = 0x567890AD,
+    ARCHIVE_NAND_TWL_FS = 0x567890AE,
+    ARCHIVE_NAND_W_FS = 0x567890AF,
+    ARCHIVE_GAMECARD_SAVEDATA = 0x567890B1,
+    ARCHIVE_USER_SAVEDATA = 0x567890B2,
+    ARCHIVE_DEMO_SAVEDATA = 0x567890B4
+} FS_ArchiveID;
+
+typedef enum {
+    MEDIATYPE_NAND = 0,
+    MEDIATYPE_SD = 1,
+    MEDIATYPE_GAME_CARD = 2
+} FS_MediaType;
+
+typedef enum {
+    FS_OPEN_READ = BIT(0),
+    FS_OPEN_WRITE = BIT(1),
+    FS_OPEN_CREATE = BIT(2)
+} FS_OpenFlags;
+
+typedef enum {
+    FS_WRITE_FLUSH = BIT(0),
+    FS_WRITE_UPDATE_TIME = BIT(8)
+} FS_WriteFlags;
+
+typedef enum {
+    FS_ATTRIBUTE_DIRECTORY = BIT(0),
+    FS_ATTRIBUTE_HIDDEN = BIT(8),
+    FS_ATTRIBUTE_ARCHIVE = BIT(16),
+    FS_ATTRIBUTE_READ_ONLY = BIT(24)
+} FS_Attribute;
+
+typedef enum {
+    ARCHIVE_ACTION_COMMIT_SAVE_DATA = 0,
+    ARCHIVE_ACTION_GET_TIMESTAMP = 1
+} FS_ArchiveAction;
+
+typedef struct {
+    u16 name[0x106];
+    char shortName[0x0A];
+    char shortExt[0x04];
+    u8 valid;
+    u8 reserved;
+    u32 attributes;
+    u64 fileSize;
+} FS_DirectoryEntry;
+
+typedef struct {
+    u32 sectorSize;
+    u32 clusterSize;
+    u32 totalClusters;
+    u32 freeClusters;
+} FS_ArchiveResource;
+
+typedef enum {
+    SYSTEM_MEDIATYPE_CTR_NAND = 0,
+    SYSTEM_MEDIATYPE_TWL_NAND = 1,
+    SYSTEM_MEDIATYPE_SD = 2,
+    SYSTEM_MEDIATYPE_TWL_PHOTO = 3
+} FS_SystemMediaType;
+
+FS_Path fsMakePath(FS_PathType type, const void* path);
+
+Result FSUSER_OpenArchive(FS_Archive* archive, FS_ArchiveID id, FS_Path path);
+Result FSUSER_CloseArchive(FS_Archive archive);
+Result FSUSER_ControlArchive(FS_Archive archive, FS_ArchiveAction action, void* input, u32 inputSize, void* output, u32 outputSize);
+Result FSUSER_OpenFile(Handle* out, FS_Archive archive, FS_Path path, u32 openFlags, u32 attributes);
+Result FSUSER_OpenFileDirectly(Handle* out, FS_ArchiveID archiveId, FS_Path archivePath, FS_Path filePath, u32 openFlags, u32 attributes);
+Result FSUSER_DeleteFile(FS_Archive archive, FS_Path path);
+Result FSUSER_RenameFile(FS_Archive srcArchive, FS_Path srcPath, FS_Archive dstArchive, FS_Path dstPath);
+Result FSUSER_CreateFile(FS_Archive archive, FS_Path path, u32 attributes, u64 fileSize);
+Result FSUSER_CreateDirectory(FS_Archive archive, FS_Path path, u32 attributes);
+Result FSUSER_DeleteDirectory(FS_Archive archive, FS_Path path);
+Result FSUSER_DeleteDirectoryRecursively(FS_Archive archive, FS_Path path);
+Result FSUSER_OpenDirectory(Handle* out, FS_Archive archive, FS_Path path);
+Result FSUSER_GetArchiveResource(FS_ArchiveResource* archiveResource, FS_SystemMediaType mediaType);
+
+Result FSFILE_Read(Handle handle, u32* bytesRead, u64 offset, void* buffer, u32 size);
+Result FSFILE_Write(Handle handle, u32* bytesWritten, u64 offset, const void* buffer, u32 size, u32 flags);
+Result FSFILE_GetSize(Handle handle, u64* size);
+Result FSFILE_SetSize(Handle handle, u64 size);
+Result FSFILE_GetAttributes(Handle handle, u32* attributes);
+Result FSFILE_Close(Handle handle);
+
+Result FSDIR_Read(Handle handle, u32* entriesRead, u32 entryCount, FS_DirectoryEntry* entries);
+Result FSDIR_Close(Handle handle);
+
+Handle* fsGetSessionHandle();
+
+// CFG
+
+typedef enum {
+    CFG_REGION_JPN = 0,
+    CFG_REGION_USA = 1,
+    CFG_REGION_EUR = 2,
+    CFG_REGION_AUS = 3,
+    CFG_REGION_CHN = 4,
+    CFG_REGION_KOR = 5,
+    CFG_REGION_TWN = 6
+} CFG_Region;
+
+typedef enum {
+    CFG_LANGUAGE_JP = 0,
+    CFG_LANGUAGE_EN = 1,
+    CFG_LANGUAGE_FR = 2,
+    CFG_LANGUAGE_DE = 3,
+    CFG_LANGUAGE_IT = 4,
+    CFG_LANGUAGE_ES = 5,
+    CFG_LANGUAGE_ZH = 6,
+    CFG_LANGUAGE_KO = 7,
+    CFG_LANGUAGE_NL = 8,
+    CFG_LANGUAGE_PT = 9,
+    CFG_LANGUAGE_RU = 10,
+    CFG_LANGUAGE_TW = 11
+} CFG_Language;
+
+Result CFGU_SecureInfoGetRegion(u8* region);
+Result CFGU_GetSystemLanguage(u8* language);
+
+// AM
+
+typedef struct {
+    u64 titleID;
+    u64 size;
+    u16 version;
+    u8 unk[6];
+} AM_TitleEntry;
+
+typedef struct {
+    u64 titleId;
+    u16 version;
+    u16 unk;
+    u32 type;
+} AM_PendingTitleEntry;
+
+Result AM_GetTitleInfo(FS_MediaType mediaType, u32 titleCount, u64* titleIds, AM_TitleEntry* titleInfo);
+Result AM_GetTitleList(u32* titlesRead, FS_MediaType mediaType, u32 titleCount, u64* titleIds);
+Result AM_GetTitleProductCode(FS_MediaType mediaType, u64 titleId, char* productCode);
+Result AM_GetCiaFileInfo(FS_MediaType mediaType, AM_TitleEntry* titleEntry, Handle fileHandle);
+Result AM_StartCiaInstall(FS_MediaType mediaType, Handle* ciaHandle);
+Result AM_FinishCiaInstall(Handle ciaHandle);
+Result AM_CancelCIAInstall(Handle ciaHandle);
+Result AM_DeleteTitle(FS_MediaType mediaType, u64 titleID);
+Result AM_DeleteTicket(u64 ticketId);
+Result AM_InstallTicketBegin(Handle* ticketHandle);
+Result AM_InstallTicketAbort(Handle ticketHandle);
+Result AM_InstallTicketFinish(Handle ticketHandle);
+Result AM_InstallFirm(u64 titleID);
+Result AM_QueryAvailableExternalTitleDatabase(bool* available);
+
+// HTTPC
+
+typedef struct {
+    Handle servhandle;
+    u32 httpchandle;
+} httpcContext;
+
+typedef enum {
+    HTTPC_METHOD_GET = 1,
+    HTTPC_METHOD_POST = 2,
+    HTTPC_METHOD_HEAD = 3,
+    HTTPC_METHOD_PUT = 4,
+    HTTPC_METHOD_DELETE = 5
+} HTTPC_RequestMethod;
+
+typedef enum {
+    HTTPC_KEEPALIVE_DISABLED = 0,
+    HTTPC_KEEPALIVE_ENABLED = 1
+} HTTPC_KeepAlive;
+
+#define SSLCOPT_DisableVerify BIT(9)
+
+#define HTTPC_RESULTCODE_DOWNLOADPENDING 0xD840A02B
+#define HTTPC_RESULTCODE_NOTFOUND 0xD840A028
+#define HTTPC_RESULTCODE_TIMEDOUT 0xD820A069
+
+Result httpcInit(u32 sharedMemSize);
+void httpcExit();
+
+Result httpcOpenContext(httpcContext* context, HTTPC_RequestMethod method, const char* url, u32 useDefaultProxy);
+Result httpcCloseContext(httpcContext* context);
+Result httpcAddRequestHeaderField(httpcContext* context, const char* name, const char* value);
+Result httpcSetSSLOpt(httpcContext* context, u32 options);
+Result httpcSetKeepAlive(httpcContext* context, HTTPC_KeepAlive option);
+Result httpcBeginRequest(httpcContext* context);
+Result httpcGetResponseStatusCode(httpcContext* context, u32* out);
+Result httpcGetResponseStatusCodeTimeout(httpcContext* context, u32* out, u64 timeout);
+Result httpcGetResponseHeader(httpcContext* context, const char* name, char* value, u32 valueSize);
+Result httpcGetDownloadSizeState(httpcContext* context, u32* downloadedSize, u32* contentSize);
+Result httpcReceiveData(httpcContext* context, u8* buffer, u32 size);
+Result httpcReceiveDataTimeout(httpcContext* context, u8* buffer, u32 size, u64 timeout);
+
+// Test controls
+
+// Host directory standing in for the SD card; defaults to "sd" under the working directory.
+extern const char* shim_sd_root;
+// Added to every FS directory and file call, to stand in for SD round trips.
+extern volatile u32 shim_fs_latency_us;
+// Keys reported by hidKeysDown and hidKeysHeld.
+extern volatile u32 shim_keys;
+// Runs the registered APT hooks, as the system does when the application is suspended, restored, slept or woken.
+void shim_apt_signal(APT_HookType hook);
+// Answer given by every yes/no and multiple choice prompt; PROMPT_NO unless a test changes it.
+extern u32 shim_prompt_response;
+// Text of the last error that would have been displayed.
+extern char shim_last_error[512];
+// Makes the next threadCreate calls fail, as when the system is out of threads or stack memory.
+extern volatile u32 shim_thread_create_failures;
+// Makes the next httpcBeginRequest calls fail as if the server's certificate could not be verified.
+extern volatile u32 shim_httpc_tls_failures;
+// Requests begun through httpc, for checking how many connections a download used.
+extern volatile u32 shim_httpc_requests;
\ No newline at end of file
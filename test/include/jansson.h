@@ -0,0 +1,28 @@
+#pragma once
+
+// Host stand-in for jansson; nothing under test parses JSON, so loading always fails.
+
+#include <stddef.h>
+
+typedef struct json_t json_t;
+
+typedef struct {
+    int line;
+    int column;
+    int position;
+    char source[80];
+    char text[160];
+} json_error_t;
+
+json_t* json_loads(const char* input, size_t flags, json_error_t* error);
+void json_decref(json_t* json);
+
+int json_is_object(const json_t* json);
+int json_is_array(const json_t* json);
+int json_is_string(const json_t* json);
+
+json_t* json_object_get(const json_t* object, const char* key);
+size_t json_array_size(const json_t* array);
+json_t* json_array_get(const json_t* array, size_t index);
+const char* json_string_value(const json_t* string);
+size_t json_string_length(const json_t* string);
\ No newline at end of file
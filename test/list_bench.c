@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <3ds.h>
+
+#include "core/core.h"
+#include "fbi/resources.h"
+#include "test.h"
+
+// Runs list views of 10 to 100,000 items through frames of update, drawTop and drawBottom as the UI loop would, with
+// the selection on the last item, and reports the cost per frame; drawing is stubbed to count the rows it is given.
+
+#define LIST_BENCH_FRAMES 2000
+#define LIST_BENCH_FONT_HEIGHT 30.0f
+
+static u32 list_bench_rows;
+static const char* list_bench_last_row;
+
+float screen_get_font_height(float scaleY) {
+    return LIST_BENCH_FONT_HEIGHT * scaleY;
+}
+
+void screen_get_string_size(float* width, float* height, const char* text, float scaleX, float scaleY) {
+    if(width != NULL) {
+        *width = strlen(text) * 8 * scaleX;
+    }
+
+    if(height != NULL) {
+        *height = LIST_BENCH_FONT_HEIGHT * scaleY;
+    }
+}
+
+void screen_draw_string(const char* text, float x, float y, float scaleX, float scaleY, u32 colorId, bool centerLines) {
+    list_bench_rows++;
+    list_bench_last_row = text;
+}
+
+void screen_get_texture_size(u32* width, u32* height, u32 id) {
+    if(width != NULL) {
+        *width = id == TEXTURE_SCROLL_BAR ? 8 : 320;
+    }
+
+    if(height != NULL) {
+        *height = 16;
+    }
+}
+
+void screen_draw_texture(u32 id, float x, float y, float width, float height) {
+}
+
+typedef struct {
+    u32 count;
+    list_item* items;
+
+    // Inserted ahead of every other item once populated, moving the selection down by one.
+    bool insertFront;
+    list_item front;
+
+    list_item* selected;
+} list_bench_data;
+
+static void list_bench_update(ui_view* view, void* data, linked_list* items, list_item* selected, bool selectedTouched) {
+    list_bench_data* benchData = (list_bench_data*) data;
+
+    if(linked_list_size(items) == 0) {
+        for(u32 i = 0; i < benchData->count; i++) {
+            linked_list_add(items, &benchData->items[i]);
+        }
+    }
+
+    if(benchData->insertFront) {
+        linked_list_add_at(items, 0, &benchData->front);
+        benchData->insertFront = false;
+    }
+
+    benchData->selected = selected;
+}
+
+static void list_bench_draw_top(ui_view* view, void* data, float x1, float y1, float x2, float y2, list_item* selected) {
+}
+
+static void list_bench_frame(ui_view* view) {
+    view->update(view, view->data, 0, 0, 320, 240);
+    view->drawTop(view, view->data, 0, 0, 400, 240);
+    view->drawBottom(view, view->data, 0, 0, 320, 240);
+}
+
+static double list_bench_run(u32 count) {
+    list_bench_data benchData;
+    memset(&benchData, 0, sizeof(benchData));
+
+    benchData.count = count;
+    benchData.items = (list_item*) calloc(count, sizeof(list_item));
+    for(u32 i = 0; i < count; i++) {
+        snprintf(benchData.items[i].name, LIST_ITEM_NAME_MAX, "Item %u", i);
+    }
+
+    snprintf(benchData.front.name, LIST_ITEM_NAME_MAX, "Front");
+
+    ui_view* view = list_display("Bench", "", &benchData, list_bench_update, list_bench_draw_top);
+
+    // Populate, then wrap the selection around to the last item.
+    list_bench_frame(view);
+
+    shim_keys = KEY_UP;
+    list_bench_frame(view);
+    shim_keys = 0;
+    list_bench_frame(view);
+
+    list_item* last = &benchData.items[count - 1];
+    TEST_CHECK(benchData.selected == last, "%u items: selected %s rather than the last item", count, benchData.selected != NULL ? benchData.selected->name : "nothing");
+
+    list_bench_rows = 0;
+
+    double start = test_now_ms();
+    for(u32 i = 0; i < LIST_BENCH_FRAMES; i++) {
+        list_bench_frame(view);
+    }
+
+    double frameUs = (test_now_ms() - start) * 1000.0 / LIST_BENCH_FRAMES;
+    u32 rows = list_bench_rows / LIST_BENCH_FRAMES;
+
+    // The last row is the selected one, at the bottom of the view.
+    TEST_CHECK(list_bench_last_row == last->name, "%u items: last row drawn was %s", count, list_bench_last_row);
+
+    // An insert ahead of the selection moves it down without losing it.
+    benchData.insertFront = true;
+    list_bench_frame(view);
+    list_bench_frame(view);
+
+    TEST_CHECK(benchData.selected == last && list_bench_last_row == last->name, "%u items: selection lost after an insert", count);
+
+    printf("%7u | %12.2f | %5u\n", count, frameUs, rows);
+
+    list_destroy(view);
+    free(benchData.items);
+
+    return frameUs;
+}
+
+int main() {
+    printf("  items | frame (us)   | rows\n");
+
+    static const u32 counts[] = {10, 1000, 10000, 100000};
+    double frameUs[sizeof(counts) / sizeof(counts[0])];
+    for(u32 i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        frameUs[i] = list_bench_run(counts[i]);
+    }
+
+    // Walking the largest list from its head each frame costs over a millisecond.
+    TEST_CHECK(frameUs[3] < frameUs[0] * 4 + 1, "frame cost grew from %.2f us to %.2f us", frameUs[0], frameUs[3]);
+
+    return test_finish();
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include <unistd.h>
+
+#include <3ds.h>
+
+// Included rather than linked, to run the populate thread body and its walker directly.
+#include "../source/fbi/task/listfiles.c"
+
+#include "test.h"
+
+// Walks a synthetic tree on the shim SD card, whose directory and file calls each wait as an SD round trip would,
+// with the worker pool and with the walk held to one worker by failing its helper threads.
+
+#define LISTFILES_BENCH_SD "build/listfiles_sd"
+#define LISTFILES_BENCH_DEPTH 4
+#define LISTFILES_BENCH_DIRS 4
+#define LISTFILES_BENCH_FILES 8
+#define LISTFILES_BENCH_LATENCY_US 300
+
+// Metadata is not loaded, so no icons are ever added.
+u32 icon_atlas_add(u32 width, u32 height, GPU_TEXCOLOR format, bool tiled, const void* pixels, icon_atlas_loader load, void* data) {
+    return ICON_ATLAS_NONE;
+}
+
+void icon_atlas_remove(u32 icon) {
+}
+
+static u32 listfiles_bench_make_tree(const char* path, u32 depth) {
+    mkdir(path, 0755);
+
+    u32 count = 0;
+
+    char child[FILE_PATH_MAX];
+    for(u32 i = 0; i < LISTFILES_BENCH_FILES; i++) {
+        // Mixed case and widths, so that the sort order differs from creation order.
+        snprintf(child, sizeof(child), "%s/%cfile%u.bin", path, i % 2 ? 'F' : 'f', LISTFILES_BENCH_FILES - i);
+        test_write_file(child, child, strlen(child));
+        count++;
+    }
+
+    if(depth > 0) {
+        for(u32 i = 0; i < LISTFILES_BENCH_DIRS; i++) {
+            snprintf(child, sizeof(child), "%s/%cdir%u", path, i % 2 ? 'D' : 'd', LISTFILES_BENCH_DIRS - i);
+            count += 1 + listfiles_bench_make_tree(child, depth - 1);
+        }
+    }
+
+    return count;
+}
+
+static double listfiles_bench_walk(linked_list* items, u32 failedHelpers) {
+    populate_files_data data;
+    memset(&data, 0, sizeof(data));
+
+    data.items = items;
+    data.archive = 0;
+    string_copy(data.path, "/tree/", FILE_PATH_MAX);
+    data.recursive = true;
+    data.includeBase = false;
+    data.meta = false;
+
+    svcCreateEvent(&data.cancelEvent, RESET_STICKY);
+    FSUSER_OpenArchive(&data.archive, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, ""));
+
+    shim_thread_create_failures = failedHelpers;
+
+    double start = test_now_ms();
+    task_populate_files_thread(&data);
+    double elapsed = test_now_ms() - start;
+
+    shim_thread_create_failures = 0;
+
+    FSUSER_CloseArchive(data.archive);
+
+    TEST_CHECK(data.result == 0, "walk failed: 0x%08X", (u32) data.result);
+    return elapsed;
+}
+
+// Every item must come after its parent directory, and siblings must be in task_compare_files order.
+static bool listfiles_bench_check_order(linked_list* items) {
+    u32 count = linked_list_size(items);
+    for(u32 i = 1; i < count; i++) {
+        file_info* prev = (file_info*) ((list_item*) linked_list_get(items, i - 1))->data;
+        file_info* curr = (file_info*) ((list_item*) linked_list_get(items, i))->data;
+
+        char prevParent[FILE_PATH_MAX];
+        char currParent[FILE_PATH_MAX];
+        string_get_parent_path(prevParent, prev->path, FILE_PATH_MAX);
+        string_get_parent_path(currParent, curr->path, FILE_PATH_MAX);
+
+        bool intoDir = (prev->attributes & FS_ATTRIBUTE_DIRECTORY) && strcmp(currParent, prev->path) == 0;
+        bool sibling = strcmp(prevParent, currParent) == 0;
+        bool backUp = strncmp(prev->path, currParent, strlen(currParent)) == 0;
+        if(!intoDir && !sibling && !backUp) {
+            return false;
+        }
+
+        if(sibling && task_compare_files(NULL, linked_list_get(items, i - 1), linked_list_get(items, i)) > 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    task_init();
+
+    shim_sd_root = LISTFILES_BENCH_SD;
+    mkdir(LISTFILES_BENCH_SD, 0755);
+
+    char treePath[FILE_PATH_MAX];
+    snprintf(treePath, sizeof(treePath), "%s/tree", LISTFILES_BENCH_SD);
+
+    u32 expected = listfiles_bench_make_tree(treePath, LISTFILES_BENCH_DEPTH);
+
+    shim_fs_latency_us = LISTFILES_BENCH_LATENCY_US;
+
+    linked_list single;
+    linked_list_init(&single);
+
+    linked_list pooled;
+    linked_list_init(&pooled);
+
+    double singleMs = listfiles_bench_walk(&single, WALK_WORKERS - 1);
+    double pooledMs = listfiles_bench_walk(&pooled, 0);
+
+    printf("%u items, %u us per FS call: 1 worker %.1f ms, %u workers %.1f ms (%.2fx)\n", expected, LISTFILES_BENCH_LATENCY_US, singleMs, WALK_WORKERS, pooledMs, WALK_WORKERS, singleMs / pooledMs);
+
+    TEST_CHECK(linked_list_size(&single) == expected && linked_list_size(&pooled) == expected, "listed %u and %u of %u items", linked_list_size(&single), linked_list_size(&pooled), expected);
+
+    bool same = linked_list_size(&single) == linked_list_size(&pooled);
+    for(u32 i = 0; i < linked_list_size(&single) && same; i++) {
+        same = strcmp(((file_info*) ((list_item*) linked_list_get(&single, i))->data)->path, ((file_info*) ((list_item*) linked_list_get(&pooled, i))->data)->path) == 0;
+    }
+
+    TEST_CHECK(same, "the worker count changed the listing order");
+    TEST_CHECK(listfiles_bench_check_order(&pooled), "listing is not sorted pre-order");
+
+    task_clear_files(&single);
+    task_clear_files(&pooled);
+
+    task_exit();
+
+    return test_finish();
+}
\ No newline at end of file
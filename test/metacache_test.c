@@ -0,0 +1,166 @@
+#include <string.h>
+#include <unistd.h>
+
+#include <3ds.h>
+
+#include "fbi/task/uitask.h"
+#include "core/core.h"
+#include "test.h"
+
+// The codec on its own, then the cache file on the shim SD card.
+
+#define METACACHE_TEST_SD "build/metacache_sd"
+#define METACACHE_TEST_FILE METACACHE_TEST_SD "/fbi/cache/meta.bin"
+
+static void metacache_test_entry(meta_cache_entry* entry, u32 seed) {
+    memset(entry, 0, sizeof(*entry));
+
+    entry->titleId = 0x0004000000030000ULL + seed;
+    entry->version = (u16) (seed * 16);
+    entry->installedSize = 0x12345678ULL * seed;
+    entry->hasMeta = true;
+    snprintf(entry->shortDescription, sizeof(entry->shortDescription), "Title %u", seed);
+    snprintf(entry->longDescription, sizeof(entry->longDescription), "A longer description of title %u", seed);
+    snprintf(entry->publisher, sizeof(entry->publisher), "Publisher \xC3\xA9 %u", seed);
+    entry->region = 0x7F;
+
+    for(u32 i = 0; i < META_CACHE_ICON_SIZE; i++) {
+        entry->icon[i] = test_pattern(i, seed);
+    }
+}
+
+static bool metacache_test_equal(const meta_cache_entry* a, const meta_cache_entry* b) {
+    return a->titleId == b->titleId && a->version == b->version && a->installedSize == b->installedSize && a->hasMeta == b->hasMeta
+           && strcmp(a->shortDescription, b->shortDescription) == 0 && strcmp(a->longDescription, b->longDescription) == 0
+           && strcmp(a->publisher, b->publisher) == 0 && a->region == b->region && memcmp(a->icon, b->icon, META_CACHE_ICON_SIZE) == 0;
+}
+
+static void test_metacache_header() {
+    u8 header[META_CACHE_HEADER_SIZE];
+    meta_cache_encode_header(header, 1024);
+
+    TEST_CHECK(memcmp(header, "FBCM", 4) == 0, "header does not start with the magic");
+    TEST_CHECK(meta_cache_decode_header(header, 1024), "header did not round-trip");
+    TEST_CHECK(!meta_cache_decode_header(header, 512), "header accepted for another slot count");
+
+    // Version, then record size.
+    header[0x4]++;
+    TEST_CHECK(!meta_cache_decode_header(header, 1024), "header accepted with another version");
+    header[0x4]--;
+
+    header[0xC]++;
+    TEST_CHECK(!meta_cache_decode_header(header, 1024), "header accepted with another record size");
+}
+
+static void test_metacache_record() {
+    static u8 record[META_CACHE_RECORD_SIZE];
+
+    meta_cache_entry entry;
+    metacache_test_entry(&entry, 7);
+
+    meta_cache_encode_record(record, 0x1122334455667788ULL, 42, &entry);
+
+    // Fields are little-endian regardless of the host.
+    TEST_CHECK(record[0] == 0x88 && record[7] == 0x11, "key is not stored little-endian");
+
+    meta_cache_entry decoded;
+    TEST_CHECK(meta_cache_decode_record(record, 0x1122334455667788ULL, 42, &decoded), "record did not decode");
+    TEST_CHECK(metacache_test_equal(&entry, &decoded), "record did not round-trip");
+
+    TEST_CHECK(!meta_cache_decode_record(record, 0x1122334455667789ULL, 42, &decoded), "record decoded for another key");
+    TEST_CHECK(!meta_cache_decode_record(record, 0x1122334455667788ULL, 43, &decoded), "record decoded for another stamp");
+}
+
+static void test_metacache_record_long_strings() {
+    static u8 record[META_CACHE_RECORD_SIZE];
+
+    meta_cache_entry entry;
+    metacache_test_entry(&entry, 1);
+    memset(entry.shortDescription, 'a', sizeof(entry.shortDescription));
+    memset(entry.publisher, 'b', sizeof(entry.publisher));
+
+    meta_cache_encode_record(record, 1, 1, &entry);
+
+    meta_cache_entry decoded;
+    TEST_CHECK(meta_cache_decode_record(record, 1, 1, &decoded), "record did not decode");
+    TEST_CHECK(strlen(decoded.shortDescription) == sizeof(decoded.shortDescription) - 1, "short description was not truncated in place");
+    TEST_CHECK(strlen(decoded.publisher) == sizeof(decoded.publisher) - 1, "publisher was not truncated in place");
+    TEST_CHECK(strcmp(decoded.longDescription, entry.longDescription) == 0, "an overlong field spilled into the next");
+}
+
+static void test_metacache_file() {
+    meta_cache_init();
+
+    meta_cache_entry entries[3];
+    u64 keys[3];
+    for(u32 i = 0; i < 3; i++) {
+        metacache_test_entry(&entries[i], i + 1);
+        keys[i] = meta_cache_title_key(MEDIATYPE_SD, entries[i].titleId);
+
+        meta_cache_put(keys[i], entries[i].version, &entries[i]);
+    }
+
+    meta_cache_entry loaded;
+    TEST_CHECK(meta_cache_get(keys[0], entries[0].version, &loaded) && metacache_test_equal(&entries[0], &loaded), "entry not found after put");
+    TEST_CHECK(!meta_cache_get(keys[0], entries[0].version + 1, &loaded), "entry found for a newer version");
+    TEST_CHECK(!meta_cache_get(meta_cache_title_key(MEDIATYPE_NAND, entries[0].titleId), entries[0].version, &loaded), "entry found for another media type");
+
+    meta_cache_remove(keys[1]);
+    TEST_CHECK(!meta_cache_get(keys[1], entries[1].version, &loaded), "entry found after removal");
+
+    meta_cache_exit();
+
+    // Entries persist across sessions.
+    meta_cache_init();
+
+    TEST_CHECK(meta_cache_get(keys[2], entries[2].version, &loaded) && metacache_test_equal(&entries[2], &loaded), "entry lost across sessions");
+    TEST_CHECK(!meta_cache_get(keys[1], entries[1].version, &loaded), "removed entry came back across sessions");
+
+    meta_cache_exit();
+}
+
+static void test_metacache_file_bad_header() {
+    meta_cache_init();
+
+    meta_cache_entry entry;
+    metacache_test_entry(&entry, 9);
+    u64 key = meta_cache_title_key(MEDIATYPE_SD, entry.titleId);
+    meta_cache_put(key, entry.version, &entry);
+
+    meta_cache_exit();
+
+    // A file from another format version is discarded rather than misread.
+    FILE* fd = fopen(METACACHE_TEST_FILE, "r+b");
+    TEST_CHECK(fd != NULL, "cache file was not created");
+    if(fd != NULL) {
+        u8 version = 0xFF;
+        fseek(fd, 4, SEEK_SET);
+        fwrite(&version, 1, 1, fd);
+        fclose(fd);
+    }
+
+    meta_cache_init();
+
+    meta_cache_entry loaded;
+    TEST_CHECK(!meta_cache_get(key, entry.version, &loaded), "entry read from a file with another version");
+
+    meta_cache_put(key, entry.version, &entry);
+    TEST_CHECK(meta_cache_get(key, entry.version, &loaded), "reset cache does not take new entries");
+
+    meta_cache_exit();
+}
+
+int main() {
+    shim_sd_root = METACACHE_TEST_SD;
+
+    mkdir(METACACHE_TEST_SD, 0755);
+    unlink(METACACHE_TEST_FILE);
+
+    TEST_RUN(test_metacache_header);
+    TEST_RUN(test_metacache_record);
+    TEST_RUN(test_metacache_record_long_strings);
+    TEST_RUN(test_metacache_file);
+    TEST_RUN(test_metacache_file_bad_header);
+
+    return test_finish();
+}
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <3ds.h>
+
+// Every receive on the listener's side goes through the simulated link.
+static ssize_t remoteinstall_bench_recv(int sockfd, void* buf, size_t len, int flags);
+
+#define recv remoteinstall_bench_recv
+#include "../source/fbi/remoteinstall.c"
+#undef recv
+
+#include "test.h"
+
+// Pushes a CIA-like file with pushfiles.py, raw and deflated, over loopback limited to 20 Mbit/s as a 3DS on Wi-Fi
+// would see it, and reports the effective install throughput through the push source.
+
+#define REMOTEINSTALL_BENCH_FILES "build/remoteinstall_bench_files"
+#define REMOTEINSTALL_BENCH_SIZE (8 * 1024 * 1024)
+// Content and zero-filled alignment padding alternate, as in a CIA.
+#define REMOTEINSTALL_BENCH_REGION_SIZE (256 * 1024)
+#define REMOTEINSTALL_BENCH_BUFFER (128 * 1024)
+#define REMOTEINSTALL_BENCH_LINK_BPS (20 * 1000 * 1000)
+#define REMOTEINSTALL_BENCH_TIMEOUT_MS 10000
+
+// The link is shared by every receive since the last reset.
+static double remoteinstall_bench_link_start;
+static u64 remoteinstall_bench_link_bytes;
+
+static ssize_t remoteinstall_bench_recv(int sockfd, void* buf, size_t len, int flags) {
+    // Small slices keep the pacing even.
+    ssize_t ret = recv(sockfd, buf, len < 16 * 1024 ? len : 16 * 1024, flags);
+    if(ret > 0) {
+        remoteinstall_bench_link_bytes += ret;
+
+        double due = remoteinstall_bench_link_start + remoteinstall_bench_link_bytes * 8 * 1000.0 / REMOTEINSTALL_BENCH_LINK_BPS;
+        double now = test_now_ms();
+        if(due > now) {
+            usleep((useconds_t) ((due - now) * 1000));
+        }
+    }
+
+    return ret;
+}
+
+Result task_capture_cam(capture_cam_data* data) {
+    return R_APP_NOT_IMPLEMENTED;
+}
+
+u32 screen_allocate_free_texture() {
+    return 0;
+}
+
+void screen_load_texture_untiled(u32 id, void* data, u32 size, u32 width, u32 height, GPU_TEXCOLOR format, bool linearFilter) {
+}
+
+void screen_unload_texture(u32 id) {
+}
+
+void screen_draw_texture(u32 id, float x, float y, float width, float height) {
+}
+
+void action_install_url(const char* confirmMessage, const char* urls, const char* paths, void* userData,
+                        void (*finishedURL)(void* data, u32 index),
+                        void (*finishedAll)(void* data),
+                        void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2, u32 index)) {
+}
+
+static bool remoteinstall_bench_received;
+static Result (*remoteinstall_bench_src)(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                         Result (*checkRunning)(void* userData),
+                                         Result (*progress)(void* userData, u64 total, u64 curr));
+static void (*remoteinstall_bench_finished)(void* data);
+
+void action_install_push(const char* confirmMessage, const char* names, void* userData,
+                         Result (*downloadSrc)(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                      Result (*checkRunning)(void* userData),
+                                                                                                      Result (*progress)(void* userData, u64 total, u64 curr)),
+                         void (*finishedAll)(void* data)) {
+    remoteinstall_bench_received = true;
+    remoteinstall_bench_src = downloadSrc;
+    remoteinstall_bench_finished = finishedAll;
+}
+
+typedef struct {
+    const u8* expected;
+    size_t pos;
+    bool match;
+} remoteinstall_bench_sink;
+
+static Result remoteinstall_bench_sink_callback(void* userData, void* buffer, size_t size) {
+    remoteinstall_bench_sink* sink = (remoteinstall_bench_sink*) userData;
+
+    if(size > REMOTEINSTALL_BENCH_SIZE - sink->pos || memcmp(buffer, sink->expected + sink->pos, size) != 0) {
+        sink->match = false;
+    }
+
+    sink->pos += size;
+    return 0;
+}
+
+static Result remoteinstall_bench_check_running(void* userData) {
+    return 0;
+}
+
+static Result remoteinstall_bench_progress(void* userData, u64 total, u64 curr) {
+    return 0;
+}
+
+// Returns the milliseconds from the sender's confirmation to the last byte reaching the sink.
+static double remoteinstall_bench_push(const char* flags, const u8* expected) {
+    remoteinstall_network_data* data = (remoteinstall_network_data*) calloc(1, sizeof(remoteinstall_network_data));
+
+    data->serverSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+
+    struct sockaddr_in server;
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    socklen_t serverLen = sizeof(server);
+    bind(data->serverSocket, (struct sockaddr*) &server, sizeof(server));
+    listen(data->serverSocket, 1);
+    getsockname(data->serverSocket, (struct sockaddr*) &server, &serverLen);
+    fcntl(data->serverSocket, F_SETFL, fcntl(data->serverSocket, F_GETFL, 0) | O_NONBLOCK);
+
+    char command[512];
+    snprintf(command, sizeof(command), "exec python3 ../servefiles/pushfiles.py %s 127.0.0.1 '%s' %u > /dev/null", flags, REMOTEINSTALL_BENCH_FILES, ntohs(server.sin_port));
+
+    FILE* sender = popen(command, "r");
+
+    remoteinstall_bench_received = false;
+
+    float progress = 0;
+    char text[PROGRESS_TEXT_MAX];
+
+    double start = test_now_ms();
+    while(!remoteinstall_bench_received && test_now_ms() - start < REMOTEINSTALL_BENCH_TIMEOUT_MS) {
+        remoteinstall_network_update(NULL, data, &progress, text);
+        usleep(1000);
+    }
+
+    double elapsed = 0;
+
+    TEST_CHECK(remoteinstall_bench_received, "the push did not reach the install action");
+    if(remoteinstall_bench_received) {
+        remoteinstall_bench_sink sink = {expected, 0, true};
+
+        remoteinstall_bench_link_start = test_now_ms();
+        remoteinstall_bench_link_bytes = 0;
+
+        Result res = remoteinstall_bench_src(data, 0, REMOTEINSTALL_BENCH_BUFFER, &sink, remoteinstall_bench_sink_callback, remoteinstall_bench_check_running, remoteinstall_bench_progress);
+
+        elapsed = test_now_ms() - remoteinstall_bench_link_start;
+
+        TEST_CHECK(res == 0, "push failed: 0x%08X", (u32) res);
+        TEST_CHECK(sink.pos == REMOTEINSTALL_BENCH_SIZE && sink.match, "received %zu of %u bytes, match %d", sink.pos, REMOTEINSTALL_BENCH_SIZE, sink.match);
+
+        remoteinstall_bench_finished(data);
+    }
+
+    pclose(sender);
+
+    remoteinstall_network_free_data(data);
+
+    return elapsed;
+}
+
+int main() {
+    task_init();
+
+    u8* cia = (u8*) calloc(1, REMOTEINSTALL_BENCH_SIZE);
+    for(u32 i = 0; i < REMOTEINSTALL_BENCH_SIZE; i++) {
+        u32 region = i / REMOTEINSTALL_BENCH_REGION_SIZE;
+        if(region % 4 == 1) {
+            // Encrypted content.
+            cia[i] = test_pattern(i, 6);
+        } else if(region % 4 == 2) {
+            // Tables and headers.
+            cia[i] = (u8) (i % 64 < 8 ? test_pattern(i / 64, 7) : i % 64);
+        }
+    }
+
+    cia[0] = 0x20;
+    cia[1] = 0x20;
+
+    mkdir(REMOTEINSTALL_BENCH_FILES, 0755);
+    if(!test_write_file(REMOTEINSTALL_BENCH_FILES "/bench.cia", cia, REMOTEINSTALL_BENCH_SIZE)) {
+        fprintf(stderr, "failed to write the pushed file\n");
+        return 1;
+    }
+
+    double rawMs = remoteinstall_bench_push("--no-compression", cia);
+    u64 rawBytes = remoteinstall_bench_link_bytes;
+
+    double deflateMs = remoteinstall_bench_push("", cia);
+    u64 deflateBytes = remoteinstall_bench_link_bytes;
+
+    double mib = REMOTEINSTALL_BENCH_SIZE / 1024.0 / 1024.0;
+    printf("%u MiB CIA-like file at %u Mbit/s:\n", REMOTEINSTALL_BENCH_SIZE / 1024 / 1024, REMOTEINSTALL_BENCH_LINK_BPS / 1000 / 1000);
+    printf("  raw     %5.2f MiB/s (%.1f MiB on the wire)\n", mib / (rawMs / 1000.0), rawBytes / 1024.0 / 1024.0);
+    printf("  deflate %5.2f MiB/s (%.1f MiB on the wire, %.2fx)\n", mib / (deflateMs / 1000.0), deflateBytes / 1024.0 / 1024.0, rawMs / deflateMs);
+
+    TEST_CHECK(deflateMs < rawMs, "deflate was no faster than raw");
+
+    free(cia);
+
+    task_exit();
+
+    return test_finish();
+}
\ No newline at end of file
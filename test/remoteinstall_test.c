@@ -0,0 +1,430 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <3ds.h>
+
+// Included rather than linked, to drive the network listener and the push source directly.
+#include "../source/fbi/remoteinstall.c"
+
+#include "test.h"
+
+// Runs the port 5000 listener on a loopback port, with servefiles/pushfiles.py or a raw socket as the sender, and
+// reads pushed files through the source that the install action would be given.
+
+#define REMOTEINSTALL_TEST_SD "build/remoteinstall_sd"
+#define REMOTEINSTALL_TEST_FILES "build/remoteinstall_files"
+#define REMOTEINSTALL_TEST_BUFFER (128 * 1024)
+#define REMOTEINSTALL_TEST_TIMEOUT_MS 10000
+
+// The QR scanner is not driven here.
+Result task_capture_cam(capture_cam_data* data) {
+    return R_APP_NOT_IMPLEMENTED;
+}
+
+u32 screen_allocate_free_texture() {
+    return 0;
+}
+
+void screen_load_texture_untiled(u32 id, void* data, u32 size, u32 width, u32 height, GPU_TEXCOLOR format, bool linearFilter) {
+}
+
+void screen_unload_texture(u32 id) {
+}
+
+void screen_draw_texture(u32 id, float x, float y, float width, float height) {
+}
+
+// What the listener handed to the install actions.
+static struct {
+    bool received;
+    char names[FILE_NAME_MAX * 4];
+    char urls[DOWNLOAD_URL_MAX];
+    void* data;
+    Result (*src)(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                  Result (*checkRunning)(void* userData),
+                  Result (*progress)(void* userData, u64 total, u64 curr));
+    void (*finished)(void* data);
+} remoteinstall_test_action;
+
+void action_install_url(const char* confirmMessage, const char* urls, const char* paths, void* userData,
+                        void (*finishedURL)(void* data, u32 index),
+                        void (*finishedAll)(void* data),
+                        void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2, u32 index)) {
+    remoteinstall_test_action.received = true;
+    string_copy(remoteinstall_test_action.urls, urls, sizeof(remoteinstall_test_action.urls));
+    remoteinstall_test_action.data = userData;
+    remoteinstall_test_action.finished = finishedAll;
+}
+
+void action_install_push(const char* confirmMessage, const char* names, void* userData,
+                         Result (*downloadSrc)(void* data, u32 index, u32 bufferSize, void* userData, Result (*callback)(void* userData, void* buffer, size_t size),
+                                                                                                      Result (*checkRunning)(void* userData),
+                                                                                                      Result (*progress)(void* userData, u64 total, u64 curr)),
+                         void (*finishedAll)(void* data)) {
+    remoteinstall_test_action.received = true;
+    string_copy(remoteinstall_test_action.names, names, sizeof(remoteinstall_test_action.names));
+    remoteinstall_test_action.data = userData;
+    remoteinstall_test_action.src = downloadSrc;
+    remoteinstall_test_action.finished = finishedAll;
+}
+
+typedef struct {
+    const u8* expected;
+    size_t size;
+    size_t pos;
+    bool match;
+} remoteinstall_test_sink;
+
+static Result remoteinstall_test_sink_callback(void* userData, void* buffer, size_t size) {
+    remoteinstall_test_sink* sink = (remoteinstall_test_sink*) userData;
+
+    if(size > sink->size - sink->pos || memcmp(buffer, sink->expected + sink->pos, size) != 0) {
+        sink->match = false;
+    }
+
+    sink->pos += size;
+    return 0;
+}
+
+static Result remoteinstall_test_check_running(void* userData) {
+    return 0;
+}
+
+static Result remoteinstall_test_progress(void* userData, u64 total, u64 curr) {
+    return 0;
+}
+
+// Sparse files are mostly zeros, like CIA padding, so the sender compresses them.
+static u8* remoteinstall_test_make_file(const char* dir, const char* name, const u8* magic, u32 magicSize, u32 size, u32 seed, bool sparse) {
+    u8* data = (u8*) calloc(1, size);
+    for(u32 i = 0; i < size; i += sparse ? 512 : 1) {
+        data[i] = test_pattern(i, seed);
+    }
+
+    memcpy(data, magic, magicSize);
+
+    char path[FILE_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    mkdir(REMOTEINSTALL_TEST_FILES, 0755);
+    mkdir(dir, 0755);
+    TEST_CHECK(test_write_file(path, data, size), "failed to write %s", path);
+
+    return data;
+}
+
+// Opens the listener on a free loopback port, as remoteinstall_receive_urls_network does on port 5000.
+static remoteinstall_network_data* remoteinstall_test_listen(u16* port) {
+    remoteinstall_network_data* data = (remoteinstall_network_data*) calloc(1, sizeof(remoteinstall_network_data));
+
+    data->serverSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+
+    struct sockaddr_in server;
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = 0;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    socklen_t serverLen = sizeof(server);
+    if(bind(data->serverSocket, (struct sockaddr*) &server, sizeof(server)) < 0 || listen(data->serverSocket, 5) < 0
+       || getsockname(data->serverSocket, (struct sockaddr*) &server, &serverLen) < 0) {
+        TEST_CHECK(false, "failed to open the listener");
+    }
+
+    fcntl(data->serverSocket, F_SETFL, fcntl(data->serverSocket, F_GETFL, 0) | O_NONBLOCK);
+
+    *port = ntohs(server.sin_port);
+
+    memset(&remoteinstall_test_action, 0, sizeof(remoteinstall_test_action));
+    return data;
+}
+
+// Runs the listener's update until a sender's request reaches an install action.
+static bool remoteinstall_test_accept(remoteinstall_network_data* data) {
+    float progress = 0;
+    char text[PROGRESS_TEXT_MAX];
+
+    double start = test_now_ms();
+    while(!remoteinstall_test_action.received && test_now_ms() - start < REMOTEINSTALL_TEST_TIMEOUT_MS) {
+        remoteinstall_network_update(NULL, data, &progress, text);
+        usleep(1000);
+    }
+
+    TEST_CHECK(remoteinstall_test_action.received, "no request reached an install action");
+    return remoteinstall_test_action.received;
+}
+
+static FILE* remoteinstall_test_push(const char* dir, u16 port) {
+    char command[512];
+    snprintf(command, sizeof(command), "exec python3 ../servefiles/pushfiles.py 127.0.0.1 '%s' %u", dir, port);
+
+    return popen(command, "r");
+}
+
+// Returns the sender's exit status, after letting it run to completion.
+static int remoteinstall_test_push_finish(FILE* sender) {
+    char line[256];
+    while(fgets(line, sizeof(line), sender) != NULL) {
+    }
+
+    int status = pclose(sender);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static Result remoteinstall_test_receive(u32 index, const u8* expected, u32 size) {
+    remoteinstall_test_sink sink = {expected, size, 0, true};
+
+    Result res = remoteinstall_test_action.src(remoteinstall_test_action.data, index, REMOTEINSTALL_TEST_BUFFER, &sink, remoteinstall_test_sink_callback, remoteinstall_test_check_running, remoteinstall_test_progress);
+    if(R_SUCCEEDED(res)) {
+        TEST_CHECK(sink.pos == size && sink.match, "file %u: received %zu of %u bytes, match %d", index, sink.pos, size, sink.match);
+    }
+
+    return res;
+}
+
+static const u8 remoteinstall_test_cia_magic[] = {0x20, 0x20, 0x00, 0x00};
+static const u8 remoteinstall_test_3dsx_magic[] = {'3', 'D', 'S', 'X'};
+
+static void test_remoteinstall_push() {
+    const char* dir = REMOTEINSTALL_TEST_FILES "/push";
+
+    // Random content does not compress, so both are sent raw.
+    u32 sizes[2] = {3 * 1024 * 1024 + 77, 200 * 1024};
+    u8* files[2] = {remoteinstall_test_make_file(dir, "a.cia", remoteinstall_test_cia_magic, sizeof(remoteinstall_test_cia_magic), sizes[0], 1, false),
+                    remoteinstall_test_make_file(dir, "b.3dsx", remoteinstall_test_3dsx_magic, sizeof(remoteinstall_test_3dsx_magic), sizes[1], 2, false)};
+
+    u16 port = 0;
+    remoteinstall_network_data* data = remoteinstall_test_listen(&port);
+
+    FILE* sender = remoteinstall_test_push(dir, port);
+    if(remoteinstall_test_accept(data)) {
+        TEST_CHECK(strcmp(remoteinstall_test_action.names, "a.cia\nb.3dsx") == 0, "names: %s", remoteinstall_test_action.names);
+
+        for(u32 i = 0; i < 2; i++) {
+            Result res = remoteinstall_test_receive(i, files[i], sizes[i]);
+            TEST_CHECK(res == 0, "file %u: 0x%08X", i, (u32) res);
+        }
+
+        // Pushed bytes cannot be read twice.
+        TEST_CHECK(remoteinstall_test_receive(0, files[0], sizes[0]) == R_APP_SKIPPED, "file 0 was read again");
+
+        remoteinstall_test_action.finished(remoteinstall_test_action.data);
+    }
+
+    TEST_CHECK(remoteinstall_test_push_finish(sender) == 0, "sender failed");
+
+    remoteinstall_network_free_data(data);
+
+    free(files[0]);
+    free(files[1]);
+}
+
+static void test_remoteinstall_push_skip() {
+    const char* dir = REMOTEINSTALL_TEST_FILES "/skip";
+
+    u32 sizes[2] = {1024 * 1024, 300 * 1024 + 5};
+    u8* files[2] = {remoteinstall_test_make_file(dir, "a.cia", remoteinstall_test_cia_magic, sizeof(remoteinstall_test_cia_magic), sizes[0], 3, false),
+                    remoteinstall_test_make_file(dir, "b.cia", remoteinstall_test_cia_magic, sizeof(remoteinstall_test_cia_magic), sizes[1], 4, false)};
+
+    u16 port = 0;
+    remoteinstall_network_data* data = remoteinstall_test_listen(&port);
+
+    FILE* sender = remoteinstall_test_push(dir, port);
+    if(remoteinstall_test_accept(data)) {
+        // The first file is drained so that the second starts in sync.
+        Result res = remoteinstall_test_receive(1, files[1], sizes[1]);
+        TEST_CHECK(res == 0, "file 1: 0x%08X", (u32) res);
+
+        TEST_CHECK(remoteinstall_test_receive(0, files[0], sizes[0]) == R_APP_SKIPPED, "skipped file was read");
+
+        remoteinstall_test_action.finished(remoteinstall_test_action.data);
+    }
+
+    TEST_CHECK(remoteinstall_test_push_finish(sender) == 0, "sender failed");
+
+    remoteinstall_network_free_data(data);
+
+    free(files[0]);
+    free(files[1]);
+}
+
+static void test_remoteinstall_push_type_mismatch() {
+    const char* dir = REMOTEINSTALL_TEST_FILES "/mismatch";
+
+    // Named as a CIA, but starts as a 3DSX.
+    u32 size = 64 * 1024;
+    u8* file = remoteinstall_test_make_file(dir, "a.cia", remoteinstall_test_3dsx_magic, sizeof(remoteinstall_test_3dsx_magic), size, 5, false);
+
+    u16 port = 0;
+    remoteinstall_network_data* data = remoteinstall_test_listen(&port);
+
+    FILE* sender = remoteinstall_test_push(dir, port);
+    if(remoteinstall_test_accept(data)) {
+        Result res = remoteinstall_test_receive(0, file, size);
+        TEST_CHECK(res == R_APP_BAD_DATA, "mismatched file returned 0x%08X", (u32) res);
+
+        remoteinstall_test_action.finished(remoteinstall_test_action.data);
+    }
+
+    // The sender may or may not have finished writing before the connection closed.
+    remoteinstall_test_push_finish(sender);
+
+    remoteinstall_network_free_data(data);
+
+    free(file);
+}
+
+static void test_remoteinstall_push_compressed() {
+    const char* dir = REMOTEINSTALL_TEST_FILES "/compressed";
+
+    // Large enough to span many frames, and with a raw file between two compressed ones.
+    u32 sizes[3] = {5 * 1024 * 1024 + 333, 100 * 1024, 2 * 1024 * 1024};
+    u8* files[3] = {remoteinstall_test_make_file(dir, "a.cia", remoteinstall_test_cia_magic, sizeof(remoteinstall_test_cia_magic), sizes[0], 6, true),
+                    remoteinstall_test_make_file(dir, "b.cia", remoteinstall_test_cia_magic, sizeof(remoteinstall_test_cia_magic), sizes[1], 7, false),
+                    remoteinstall_test_make_file(dir, "c.cia", remoteinstall_test_cia_magic, sizeof(remoteinstall_test_cia_magic), sizes[2], 8, true)};
+
+    u16 port = 0;
+    remoteinstall_network_data* data = remoteinstall_test_listen(&port);
+
+    FILE* sender = remoteinstall_test_push(dir, port);
+    if(remoteinstall_test_accept(data)) {
+        TEST_CHECK(data->pushCompression[0] == PUSH_COMPRESSION_DEFLATE && data->pushCompression[1] == PUSH_COMPRESSION_NONE
+                   && data->pushCompression[2] == PUSH_COMPRESSION_DEFLATE, "compression %u %u %u", data->pushCompression[0], data->pushCompression[1], data->pushCompression[2]);
+
+        for(u32 i = 0; i < 3; i++) {
+            Result res = remoteinstall_test_receive(i, files[i], sizes[i]);
+            TEST_CHECK(res == 0, "file %u: 0x%08X", i, (u32) res);
+        }
+
+        remoteinstall_test_action.finished(remoteinstall_test_action.data);
+    }
+
+    TEST_CHECK(remoteinstall_test_push_finish(sender) == 0, "sender failed");
+
+    remoteinstall_network_free_data(data);
+
+    for(u32 i = 0; i < 3; i++) {
+        free(files[i]);
+    }
+}
+
+static void test_remoteinstall_push_compressed_skip() {
+    const char* dir = REMOTEINSTALL_TEST_FILES "/compressed_skip";
+
+    u32 sizes[2] = {3 * 1024 * 1024, 1024 * 1024 + 1};
+    u8* files[2] = {remoteinstall_test_make_file(dir, "a.cia", remoteinstall_test_cia_magic, sizeof(remoteinstall_test_cia_magic), sizes[0], 9, true),
+                    remoteinstall_test_make_file(dir, "b.cia", remoteinstall_test_cia_magic, sizeof(remoteinstall_test_cia_magic), sizes[1], 10, true)};
+
+    u16 port = 0;
+    remoteinstall_network_data* data = remoteinstall_test_listen(&port);
+
+    FILE* sender = remoteinstall_test_push(dir, port);
+    if(remoteinstall_test_accept(data)) {
+        // The first file's frames are drained up to its empty end frame.
+        Result res = remoteinstall_test_receive(1, files[1], sizes[1]);
+        TEST_CHECK(res == 0, "file 1: 0x%08X", (u32) res);
+
+        remoteinstall_test_action.finished(remoteinstall_test_action.data);
+    }
+
+    TEST_CHECK(remoteinstall_test_push_finish(sender) == 0, "sender failed");
+
+    remoteinstall_network_free_data(data);
+
+    free(files[0]);
+    free(files[1]);
+}
+
+static int remoteinstall_test_connect(u16 port) {
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if(connect(sock, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+        TEST_CHECK(false, "failed to connect to the listener");
+    }
+
+    return sock;
+}
+
+static void test_remoteinstall_push_version() {
+    u16 port = 0;
+    remoteinstall_network_data* data = remoteinstall_test_listen(&port);
+
+    // A newer sender is answered with the highest version the listener speaks.
+    int sock = remoteinstall_test_connect(port);
+
+    u32 hello[2] = {htonl(PUSH_MAGIC), htonl(PUSH_VERSION + 5)};
+    send(sock, hello, sizeof(hello), 0);
+
+    float progress = 0;
+    char text[PROGRESS_TEXT_MAX];
+
+    // The listener goes on to wait for the file count, which never comes.
+    shutdown(sock, SHUT_WR);
+    remoteinstall_network_update(NULL, data, &progress, text);
+
+    u32 version = 0;
+    TEST_CHECK(recv(sock, &version, sizeof(version), MSG_WAITALL) == sizeof(version) && ntohl(version) == PUSH_VERSION, "version reply %u", ntohl(version));
+    TEST_CHECK(!remoteinstall_test_action.received, "an incomplete push reached the install action");
+
+    close(sock);
+
+    remoteinstall_network_free_data(data);
+}
+
+static void test_remoteinstall_urls() {
+    u16 port = 0;
+    remoteinstall_network_data* data = remoteinstall_test_listen(&port);
+
+    // The URL list protocol is unchanged.
+    const char* urls = "http://192.168.1.2:8080/a.cia\nhttp://192.168.1.2:8080/b.cia";
+
+    int sock = remoteinstall_test_connect(port);
+
+    u32 size = htonl((u32) strlen(urls));
+    send(sock, &size, sizeof(size), 0);
+    send(sock, urls, strlen(urls), 0);
+
+    if(remoteinstall_test_accept(data)) {
+        TEST_CHECK(strcmp(remoteinstall_test_action.urls, urls) == 0, "urls: %s", remoteinstall_test_action.urls);
+
+        char lastUrls[DOWNLOAD_URL_MAX];
+        TEST_CHECK(remoteinstall_get_last_urls(lastUrls, sizeof(lastUrls)) && strcmp(lastUrls, urls) == 0, "URLs were not kept for repeating");
+
+        remoteinstall_test_action.finished(remoteinstall_test_action.data);
+
+        u8 ack = 1;
+        TEST_CHECK(recv(sock, &ack, sizeof(ack), MSG_WAITALL) == sizeof(ack) && ack == 0, "no acknowledgement");
+    }
+
+    close(sock);
+
+    remoteinstall_network_free_data(data);
+}
+
+int main() {
+    shim_sd_root = REMOTEINSTALL_TEST_SD;
+    mkdir(REMOTEINSTALL_TEST_SD, 0755);
+
+    task_init();
+
+    TEST_RUN(test_remoteinstall_push);
+    TEST_RUN(test_remoteinstall_push_skip);
+    TEST_RUN(test_remoteinstall_push_type_mismatch);
+    TEST_RUN(test_remoteinstall_push_compressed);
+    TEST_RUN(test_remoteinstall_push_compressed_skip);
+    TEST_RUN(test_remoteinstall_push_version);
+    TEST_RUN(test_remoteinstall_urls);
+
+    task_exit();
+
+    return test_finish();
+}
\ No newline at end of file
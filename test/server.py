@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+# coding: utf-8 -*-
+
+# Local HTTP server for the host tests. Serves the files under the given directory, and prints its port and process
+# id once listening. Path prefixes change how a file is served:
+#   /norange/<file>  ignores Range headers, as servers without range support do
+#   /nototal/<file>  answers ranges without the entity size in Content-Range
+#   /gzip/<file>     sends the whole file gzip-encoded
+#   /slow/<file>     waits SLOW_DELAY seconds before answering, as an unresponsive server would
+#   /stats           reports the connections accepted and requests served so far
+
+import gzip
+import os
+import sys
+import threading
+import time
+
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+root = sys.argv[1] if len(sys.argv) > 1 else '.'
+
+SLOW_DELAY = 3
+
+lock = threading.Lock()
+stats = {'connections': 0, 'requests': 0}
+compressed = {}
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def setup(self):
+        BaseHTTPRequestHandler.setup(self)
+
+        with lock:
+            stats['connections'] += 1
+
+    def log_message(self, format, *args):
+        pass
+
+    def send_body(self, status, body, headers):
+        self.send_response(status)
+
+        for name, value in headers:
+            self.send_header(name, value)
+
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def parse_range(self, size):
+        header = self.headers.get('Range')
+        if header is None or not header.startswith('bytes='):
+            return None
+
+        start, _, end = header[len('bytes='):].partition('-')
+        start = int(start)
+        end = int(end) if end else size - 1
+
+        return start, min(end, size - 1)
+
+    def do_GET(self):
+        with lock:
+            stats['requests'] += 1
+
+        if self.path == '/stats':
+            with lock:
+                body = 'connections=%d requests=%d' % (stats['connections'], stats['requests'])
+
+            self.send_body(200, body.encode('ascii'), [])
+            return
+
+        mode, _, name = self.path.lstrip('/').partition('/')
+        if mode not in ('norange', 'nototal', 'gzip', 'slow'):
+            mode, name = '', self.path.lstrip('/')
+
+        if mode == 'slow':
+            time.sleep(SLOW_DELAY)
+
+        path = os.path.join(root, name)
+        if not os.path.isfile(path):
+            self.send_body(404, b'', [])
+            return
+
+        with open(path, 'rb') as f:
+            data = f.read()
+
+        etag = '"%x-%x"' % (len(data), int(os.path.getmtime(path)))
+        headers = [('ETag', etag)]
+
+        if mode == 'gzip':
+            with lock:
+                if path not in compressed:
+                    compressed[path] = gzip.compress(data, 6)
+
+                body = compressed[path]
+
+            self.send_body(200, body, headers + [('Content-Encoding', 'gzip')])
+            return
+
+        byteRange = self.parse_range(len(data)) if mode != 'norange' else None
+
+        # A stale If-Range validator gets the whole entity instead of the range.
+        ifRange = self.headers.get('If-Range')
+        if byteRange is not None and ifRange is not None and ifRange != etag:
+            byteRange = None
+
+        if byteRange is None:
+            self.send_body(200, data, headers + [('Accept-Ranges', 'bytes')] if mode != 'norange' else headers)
+            return
+
+        start, end = byteRange
+        if start >= len(data) or start > end:
+            self.send_body(416, b'', [('Content-Range', 'bytes */%d' % len(data))])
+            return
+
+        total = '*' if mode == 'nototal' else str(len(data))
+        self.send_body(206, data[start:end + 1], headers + [('Content-Range', 'bytes %d-%d/%s' % (start, end, total))])
+
+
+class Server(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def handle_error(self, request, client_address):
+        # Cancelled downloads drop their connections mid-response.
+        if not isinstance(sys.exc_info()[1], ConnectionError):
+            ThreadingHTTPServer.handle_error(self, request, client_address)
+
+
+server = Server(('127.0.0.1', 0), Handler)
+
+print('%d %d' % (server.server_address[1], os.getpid()), flush=True)
+
+server.serve_forever()
@@ -0,0 +1,1087 @@
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <3ds.h>
+
+#include "core/error.h"
+
+#define SHIM_HANDLES_MAX 4096
+
+#define SHIM_RESULT_TIMEOUT ((Result) 0x09401BFE)
+#define SHIM_RESULT_INVALID_HANDLE MAKERESULT(RL_PERMANENT, RS_WRONGARG, RM_KERNEL, 1015)
+#define SHIM_RESULT_NOT_FOUND MAKERESULT(RL_STATUS, RS_NOTFOUND, RM_FS, 120)
+#define SHIM_RESULT_ALREADY_EXISTS MAKERESULT(RL_STATUS, RS_NOP, RM_FS, 190)
+#define SHIM_RESULT_FS_ERROR MAKERESULT(RL_PERMANENT, RS_INTERNAL, RM_FS, 0)
+#define SHIM_RESULT_NOT_IMPLEMENTED MAKERESULT(RL_PERMANENT, RS_NOTSUPPORTED, RM_OS, RD_NOT_IMPLEMENTED)
+
+const char* shim_sd_root = "sd";
+volatile u32 shim_fs_latency_us = 0;
+volatile u32 shim_keys = 0;
+
+// Where newlib reports the end of the application heap; the host heap is treated as 64 MiB past the start-up break.
+char* fake_heap_end = NULL;
+
+__attribute__((constructor)) static void shim_init_heap() {
+    fake_heap_end = (char*) sbrk(0) + 64 * 1024 * 1024;
+}
+
+typedef enum {
+    SHIM_FREE,
+    SHIM_EVENT,
+    SHIM_SEMAPHORE,
+    SHIM_MUTEX,
+    SHIM_FILE,
+    SHIM_DIR
+} shim_kind;
+
+typedef struct {
+    shim_kind kind;
+
+    // Events and semaphores
+    ResetType resetType;
+    bool signaled;
+    s32 count;
+    s32 maxCount;
+
+    // Files and directories
+    int fd;
+    DIR* dir;
+    char path[1024];
+} shim_object;
+
+static pthread_mutex_t shim_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t shim_cond = PTHREAD_COND_INITIALIZER;
+static shim_object shim_objects[SHIM_HANDLES_MAX];
+
+static Handle shim_handle_create(shim_kind kind) {
+    Handle handle = 0;
+
+    pthread_mutex_lock(&shim_lock);
+
+    for(u32 i = 0; i < SHIM_HANDLES_MAX; i++) {
+        if(shim_objects[i].kind == SHIM_FREE) {
+            memset(&shim_objects[i], 0, sizeof(shim_objects[i]));
+            shim_objects[i].kind = kind;
+            shim_objects[i].fd = -1;
+
+            handle = i + 1;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&shim_lock);
+
+    if(handle == 0) {
+        error_panic("Out of shim handles.");
+    }
+
+    return handle;
+}
+
+static shim_object* shim_handle_get(Handle handle, shim_kind kind) {
+    if(handle == 0 || handle > SHIM_HANDLES_MAX || shim_objects[handle - 1].kind != kind) {
+        return NULL;
+    }
+
+    return &shim_objects[handle - 1];
+}
+
+static void shim_latency() {
+    if(shim_fs_latency_us > 0) {
+        usleep(shim_fs_latency_us);
+    }
+}
+
+static struct timespec shim_deadline(s64 ns) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    ts.tv_sec += ns / 1000000000;
+    ts.tv_nsec += ns % 1000000000;
+    if(ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+
+    return ts;
+}
+
+// Kernel objects
+
+Result svcCreateEvent(Handle* event, ResetType resetType) {
+    *event = shim_handle_create(SHIM_EVENT);
+    shim_objects[*event - 1].resetType = resetType;
+    return 0;
+}
+
+Result svcSignalEvent(Handle handle) {
+    pthread_mutex_lock(&shim_lock);
+
+    shim_object* object = shim_handle_get(handle, SHIM_EVENT);
+    if(object != NULL) {
+        object->signaled = true;
+        pthread_cond_broadcast(&shim_cond);
+    }
+
+    pthread_mutex_unlock(&shim_lock);
+
+    return object != NULL ? 0 : SHIM_RESULT_INVALID_HANDLE;
+}
+
+Result svcClearEvent(Handle handle) {
+    pthread_mutex_lock(&shim_lock);
+
+    shim_object* object = shim_handle_get(handle, SHIM_EVENT);
+    if(object != NULL) {
+        object->signaled = false;
+    }
+
+    pthread_mutex_unlock(&shim_lock);
+
+    return object != NULL ? 0 : SHIM_RESULT_INVALID_HANDLE;
+}
+
+Result svcCreateSemaphore(Handle* semaphore, s32 initialCount, s32 maxCount) {
+    *semaphore = shim_handle_create(SHIM_SEMAPHORE);
+    shim_objects[*semaphore - 1].count = initialCount;
+    shim_objects[*semaphore - 1].maxCount = maxCount;
+    return 0;
+}
+
+Result svcReleaseSemaphore(s32* count, Handle semaphore, s32 releaseCount) {
+    Result res = 0;
+
+    pthread_mutex_lock(&shim_lock);
+
+    shim_object* object = shim_handle_get(semaphore, SHIM_SEMAPHORE);
+    if(object != NULL) {
+        *count = object->count;
+
+        if(object->count + releaseCount <= object->maxCount) {
+            object->count += releaseCount;
+            pthread_cond_broadcast(&shim_cond);
+        } else {
+            res = MAKERESULT(RL_PERMANENT, RS_OUTOFRESOURCE, RM_KERNEL, 1022);
+        }
+    } else {
+        res = SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    pthread_mutex_unlock(&shim_lock);
+
+    return res;
+}
+
+Result svcCreateMutex(Handle* mutex, bool initiallyLocked) {
+    *mutex = shim_handle_create(SHIM_MUTEX);
+    shim_objects[*mutex - 1].signaled = !initiallyLocked;
+    return 0;
+}
+
+Result svcReleaseMutex(Handle handle) {
+    pthread_mutex_lock(&shim_lock);
+
+    shim_object* object = shim_handle_get(handle, SHIM_MUTEX);
+    if(object != NULL) {
+        object->signaled = true;
+        pthread_cond_broadcast(&shim_cond);
+    }
+
+    pthread_mutex_unlock(&shim_lock);
+
+    return object != NULL ? 0 : SHIM_RESULT_INVALID_HANDLE;
+}
+
+// Called with shim_lock held; consumes the signal when the object is ready.
+static bool shim_try_acquire(Handle handle) {
+    if(handle == 0 || handle > SHIM_HANDLES_MAX) {
+        return false;
+    }
+
+    shim_object* object = &shim_objects[handle - 1];
+    switch(object->kind) {
+        case SHIM_EVENT:
+            if(!object->signaled) {
+                return false;
+            }
+
+            if(object->resetType == RESET_ONESHOT) {
+                object->signaled = false;
+            }
+
+            return true;
+        case SHIM_SEMAPHORE:
+            if(object->count <= 0) {
+                return false;
+            }
+
+            object->count--;
+            return true;
+        case SHIM_MUTEX:
+            if(!object->signaled) {
+                return false;
+            }
+
+            object->signaled = false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+Result svcWaitSynchronizationN(s32* out, const Handle* handles, s32 handlesCount, bool waitAll, s64 nanoseconds) {
+    Result res = 0;
+
+    struct timespec deadline = shim_deadline(nanoseconds < 0 ? 0 : nanoseconds);
+    bool forever = nanoseconds < 0 || (u64) nanoseconds == U64_MAX;
+
+    pthread_mutex_lock(&shim_lock);
+
+    while(true) {
+        s32 ready = -1;
+        for(s32 i = 0; i < handlesCount && ready == -1; i++) {
+            if(shim_try_acquire(handles[i])) {
+                ready = i;
+            }
+        }
+
+        // Waiting on all handles is only used with a single handle here.
+        if(ready != -1 || (waitAll && handlesCount == 0)) {
+            if(out != NULL) {
+                *out = ready;
+            }
+
+            break;
+        }
+
+        if(nanoseconds == 0) {
+            res = SHIM_RESULT_TIMEOUT;
+            break;
+        }
+
+        if(forever) {
+            pthread_cond_wait(&shim_cond, &shim_lock);
+        } else if(pthread_cond_timedwait(&shim_cond, &shim_lock, &deadline) == ETIMEDOUT) {
+            res = SHIM_RESULT_TIMEOUT;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&shim_lock);
+
+    return res;
+}
+
+Result svcWaitSynchronization(Handle handle, s64 nanoseconds) {
+    return svcWaitSynchronizationN(NULL, &handle, 1, false, nanoseconds);
+}
+
+Result svcCloseHandle(Handle handle) {
+    if(handle == 0 || handle > SHIM_HANDLES_MAX) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    pthread_mutex_lock(&shim_lock);
+
+    shim_object* object = &shim_objects[handle - 1];
+    if(object->fd >= 0) {
+        close(object->fd);
+    }
+
+    if(object->dir != NULL) {
+        closedir(object->dir);
+    }
+
+    object->kind = SHIM_FREE;
+
+    pthread_mutex_unlock(&shim_lock);
+
+    return 0;
+}
+
+void svcSleepThread(s64 ns) {
+    struct timespec ts = {ns / 1000000000, ns % 1000000000};
+    nanosleep(&ts, NULL);
+}
+
+u64 svcGetSystemTick() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (u64) ((ts.tv_sec * 1000000000ULL + ts.tv_nsec) * (SYSCLOCK_ARM11 / 1000000000.0));
+}
+
+Result svcSendSyncRequest(Handle session) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+u32* getThreadCommandBuffer() {
+    static __thread u32 commandBuffer[64];
+    return commandBuffer;
+}
+
+u64 osGetTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+u8 osGetWifiStrength() {
+    return 3;
+}
+
+// Threads
+
+struct Thread_tag {
+    pthread_t thread;
+    ThreadFunc entrypoint;
+    void* arg;
+    bool detached;
+    bool finished;
+};
+
+// Guards detached and finished, which threadDetach and the exiting thread race on.
+static pthread_mutex_t shim_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* shim_thread_entry(void* arg) {
+    Thread thread = (Thread) arg;
+    thread->entrypoint(thread->arg);
+
+    pthread_mutex_lock(&shim_thread_lock);
+    thread->finished = true;
+    bool detached = thread->detached;
+    pthread_mutex_unlock(&shim_thread_lock);
+
+    if(detached) {
+        free(thread);
+    }
+
+    return NULL;
+}
+
+volatile u32 shim_thread_create_failures = 0;
+
+Thread threadCreate(ThreadFunc entrypoint, void* arg, size_t stackSize, int prio, int coreId, bool detached) {
+    u32 failures = shim_thread_create_failures;
+    while(failures > 0) {
+        if(__atomic_compare_exchange_n(&shim_thread_create_failures, &failures, failures - 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            return NULL;
+        }
+    }
+
+    Thread thread = (Thread) calloc(1, sizeof(struct Thread_tag));
+    if(thread == NULL) {
+        return NULL;
+    }
+
+    thread->entrypoint = entrypoint;
+    thread->arg = arg;
+    thread->detached = detached;
+
+    // Host stacks are larger than the 3DS ones requested; code that overflows these would overflow on hardware too.
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, stackSize < 0x10000 ? 0x10000 : stackSize);
+
+    if(detached) {
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    }
+
+    int ret = pthread_create(&thread->thread, &attr, shim_thread_entry, thread);
+    pthread_attr_destroy(&attr);
+
+    if(ret != 0) {
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+Result threadJoin(Thread thread, u64 timeoutNs) {
+    if(timeoutNs == U64_MAX) {
+        pthread_join(thread->thread, NULL);
+        return 0;
+    }
+
+    struct timespec deadline = shim_deadline((s64) timeoutNs);
+    return pthread_timedjoin_np(thread->thread, NULL, &deadline) == 0 ? 0 : SHIM_RESULT_TIMEOUT;
+}
+
+void threadFree(Thread thread) {
+    free(thread);
+}
+
+// As in libctru, a detached thread frees itself on exit, or here if it has already exited.
+void threadDetach(Thread thread) {
+    pthread_mutex_lock(&shim_thread_lock);
+    thread->detached = true;
+    bool finished = thread->finished;
+    pthread_t handle = thread->thread;
+    pthread_mutex_unlock(&shim_thread_lock);
+
+    pthread_detach(handle);
+
+    if(finished) {
+        free(thread);
+    }
+}
+
+void LightLock_Init(LightLock* lock) {
+    pthread_mutex_init(lock, NULL);
+}
+
+void LightLock_Lock(LightLock* lock) {
+    pthread_mutex_lock(lock);
+}
+
+void LightLock_Unlock(LightLock* lock) {
+    pthread_mutex_unlock(lock);
+}
+
+void CondVar_Init(CondVar* cv) {
+    pthread_cond_init(cv, NULL);
+}
+
+void CondVar_Wait(CondVar* cv, LightLock* lock) {
+    pthread_cond_wait(cv, lock);
+}
+
+int CondVar_WaitTimeout(CondVar* cv, LightLock* lock, s64 timeoutNs) {
+    struct timespec deadline = shim_deadline(timeoutNs);
+    return pthread_cond_timedwait(cv, lock, &deadline) == ETIMEDOUT ? 1 : 0;
+}
+
+void CondVar_Signal(CondVar* cv) {
+    pthread_cond_signal(cv);
+}
+
+void CondVar_Broadcast(CondVar* cv) {
+    pthread_cond_broadcast(cv);
+}
+
+// HID and APT
+
+void hidScanInput() {
+}
+
+u32 hidKeysDown() {
+    return shim_keys;
+}
+
+u32 hidKeysHeld() {
+    return shim_keys;
+}
+
+u32 hidKeysUp() {
+    return 0;
+}
+
+void hidTouchRead(touchPosition* pos) {
+    pos->px = 0;
+    pos->py = 0;
+}
+
+bool aptMainLoop() {
+    return true;
+}
+
+static aptHookCookie* shim_apt_hooks = NULL;
+
+void aptHook(aptHookCookie* cookie, aptHookFn callback, void* param) {
+    cookie->callback = callback;
+    cookie->param = param;
+    cookie->next = shim_apt_hooks;
+
+    shim_apt_hooks = cookie;
+}
+
+void aptUnhook(aptHookCookie* cookie) {
+    for(aptHookCookie** curr = &shim_apt_hooks; *curr != NULL; curr = &(*curr)->next) {
+        if(*curr == cookie) {
+            *curr = cookie->next;
+            break;
+        }
+    }
+}
+
+void shim_apt_signal(APT_HookType hook) {
+    for(aptHookCookie* curr = shim_apt_hooks; curr != NULL; curr = curr->next) {
+        curr->callback(hook, curr->param);
+    }
+}
+
+void aptSetSleepAllowed(bool allowed) {
+}
+
+Result APT_CheckNew3DS(bool* out) {
+    *out = true;
+    return 0;
+}
+
+Result APT_GetAppletInfo(NS_APPID appID, u64* pProgramID, u8* pMediaType, bool* pRegistered, bool* pLoadState, u32* pAttributes) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+bool envIsHomebrew() {
+    return true;
+}
+
+u32 envGetAptAppId() {
+    return 0;
+}
+
+// Text
+
+ssize_t decode_utf8(u32* out, const u8* in) {
+    if(in[0] < 0x80) {
+        *out = in[0];
+        return 1;
+    }
+
+    u32 len = (in[0] & 0xE0) == 0xC0 ? 2 : (in[0] & 0xF0) == 0xE0 ? 3 : (in[0] & 0xF8) == 0xF0 ? 4 : 0;
+    if(len == 0) {
+        return -1;
+    }
+
+    u32 code = in[0] & (0x7F >> len);
+    for(u32 i = 1; i < len; i++) {
+        if((in[i] & 0xC0) != 0x80) {
+            return -1;
+        }
+
+        code = (code << 6) | (in[i] & 0x3F);
+    }
+
+    *out = code;
+    return len;
+}
+
+ssize_t utf8_to_utf16(u16* out, const u8* in, size_t len) {
+    ssize_t written = 0;
+
+    u32 code = 0;
+    ssize_t units = 0;
+    while(*in != '\0' && (units = decode_utf8(&code, in)) > 0) {
+        in += units;
+
+        if(code >= 0x10000) {
+            if(out != NULL && (size_t) written + 2 <= len) {
+                out[written] = (u16) (0xD800 + ((code - 0x10000) >> 10));
+                out[written + 1] = (u16) (0xDC00 + ((code - 0x10000) & 0x3FF));
+            }
+
+            written += 2;
+        } else {
+            if(out != NULL && (size_t) written < len) {
+                out[written] = (u16) code;
+            }
+
+            written++;
+        }
+    }
+
+    return units < 0 ? -1 : written;
+}
+
+ssize_t utf16_to_utf8(u8* out, const u16* in, size_t len) {
+    ssize_t written = 0;
+
+    while(*in != 0) {
+        u32 code = *in++;
+        if(code >= 0xD800 && code < 0xDC00 && *in >= 0xDC00 && *in < 0xE000) {
+            code = 0x10000 + ((code - 0xD800) << 10) + (*in++ - 0xDC00);
+        }
+
+        u8 bytes[4];
+        u32 count = 0;
+        if(code < 0x80) {
+            bytes[count++] = (u8) code;
+        } else if(code < 0x800) {
+            bytes[count++] = (u8) (0xC0 | (code >> 6));
+            bytes[count++] = (u8) (0x80 | (code & 0x3F));
+        } else if(code < 0x10000) {
+            bytes[count++] = (u8) (0xE0 | (code >> 12));
+            bytes[count++] = (u8) (0x80 | ((code >> 6) & 0x3F));
+            bytes[count++] = (u8) (0x80 | (code & 0x3F));
+        } else {
+            bytes[count++] = (u8) (0xF0 | (code >> 18));
+            bytes[count++] = (u8) (0x80 | ((code >> 12) & 0x3F));
+            bytes[count++] = (u8) (0x80 | ((code >> 6) & 0x3F));
+            bytes[count++] = (u8) (0x80 | (code & 0x3F));
+        }
+
+        for(u32 i = 0; i < count; i++) {
+            if(out != NULL && (size_t) written < len) {
+                out[written] = bytes[i];
+            }
+
+            written++;
+        }
+    }
+
+    return written;
+}
+
+// FS, backed by a host directory standing in for the SD card. Archives other than the SD card are not available.
+
+FS_Path fsMakePath(FS_PathType type, const void* path) {
+    FS_Path fsPath = {type, 0, path};
+
+    if(type == PATH_ASCII) {
+        fsPath.size = strlen((const char*) path) + 1;
+    } else if(type == PATH_UTF16) {
+        u32 len = 0;
+        while(((const u16*) path)[len] != 0) {
+            len++;
+        }
+
+        fsPath.size = (len + 1) * sizeof(u16);
+    } else if(type == PATH_EMPTY) {
+        fsPath.size = 1;
+        fsPath.data = "";
+    }
+
+    return fsPath;
+}
+
+static bool shim_fs_host_path(char* out, size_t size, FS_Archive archive, FS_Path path) {
+    if(archive != ARCHIVE_SDMC) {
+        return false;
+    }
+
+    char relative[1024] = "";
+    if(path.type == PATH_ASCII) {
+        snprintf(relative, sizeof(relative), "%s", (const char*) path.data);
+    } else if(path.type == PATH_UTF16) {
+        ssize_t len = utf16_to_utf8((u8*) relative, (const u16*) path.data, sizeof(relative) - 1);
+        relative[len < 0 ? 0 : len < (ssize_t) sizeof(relative) ? len : (ssize_t) sizeof(relative) - 1] = '\0';
+    } else if(path.type != PATH_EMPTY) {
+        return false;
+    }
+
+    snprintf(out, size, "%s%s%s", shim_sd_root, relative[0] == '/' ? "" : "/", relative);
+    return true;
+}
+
+static Result shim_fs_errno() {
+    return errno == ENOENT || errno == ENOTDIR ? SHIM_RESULT_NOT_FOUND : errno == EEXIST ? SHIM_RESULT_ALREADY_EXISTS : SHIM_RESULT_FS_ERROR;
+}
+
+Result FSUSER_OpenArchive(FS_Archive* archive, FS_ArchiveID id, FS_Path path) {
+    if(id != ARCHIVE_SDMC) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    mkdir(shim_sd_root, 0755);
+
+    *archive = id;
+    return 0;
+}
+
+Result FSUSER_CloseArchive(FS_Archive archive) {
+    return 0;
+}
+
+Result FSUSER_ControlArchive(FS_Archive archive, FS_ArchiveAction action, void* input, u32 inputSize, void* output, u32 outputSize) {
+    return 0;
+}
+
+Result FSUSER_OpenFile(Handle* out, FS_Archive archive, FS_Path path, u32 openFlags, u32 attributes) {
+    shim_latency();
+
+    char hostPath[1024];
+    if(!shim_fs_host_path(hostPath, sizeof(hostPath), archive, path)) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    int flags = (openFlags & FS_OPEN_WRITE) ? O_RDWR : O_RDONLY;
+    if(openFlags & FS_OPEN_CREATE) {
+        flags |= O_CREAT;
+    }
+
+    int fd = open(hostPath, flags, 0644);
+    if(fd < 0) {
+        return shim_fs_errno();
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && S_ISDIR(st.st_mode)) {
+        close(fd);
+        return SHIM_RESULT_NOT_FOUND;
+    }
+
+    *out = shim_handle_create(SHIM_FILE);
+    shim_objects[*out - 1].fd = fd;
+    snprintf(shim_objects[*out - 1].path, sizeof(shim_objects[*out - 1].path), "%s", hostPath);
+    return 0;
+}
+
+Result FSUSER_OpenFileDirectly(Handle* out, FS_ArchiveID archiveId, FS_Path archivePath, FS_Path filePath, u32 openFlags, u32 attributes) {
+    if(archiveId != ARCHIVE_SDMC) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    return FSUSER_OpenFile(out, archiveId, filePath, openFlags, attributes);
+}
+
+Result FSUSER_DeleteFile(FS_Archive archive, FS_Path path) {
+    char hostPath[1024];
+    if(!shim_fs_host_path(hostPath, sizeof(hostPath), archive, path)) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    return unlink(hostPath) == 0 ? 0 : shim_fs_errno();
+}
+
+Result FSUSER_RenameFile(FS_Archive srcArchive, FS_Path srcPath, FS_Archive dstArchive, FS_Path dstPath) {
+    char srcHostPath[1024];
+    char dstHostPath[1024];
+    if(!shim_fs_host_path(srcHostPath, sizeof(srcHostPath), srcArchive, srcPath) || !shim_fs_host_path(dstHostPath, sizeof(dstHostPath), dstArchive, dstPath)) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    return rename(srcHostPath, dstHostPath) == 0 ? 0 : shim_fs_errno();
+}
+
+Result FSUSER_CreateFile(FS_Archive archive, FS_Path path, u32 attributes, u64 fileSize) {
+    char hostPath[1024];
+    if(!shim_fs_host_path(hostPath, sizeof(hostPath), archive, path)) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    int fd = open(hostPath, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if(fd < 0) {
+        return shim_fs_errno();
+    }
+
+    Result res = ftruncate(fd, (off_t) fileSize) == 0 ? 0 : shim_fs_errno();
+    close(fd);
+    return res;
+}
+
+Result FSUSER_CreateDirectory(FS_Archive archive, FS_Path path, u32 attributes) {
+    char hostPath[1024];
+    if(!shim_fs_host_path(hostPath, sizeof(hostPath), archive, path)) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    return mkdir(hostPath, 0755) == 0 ? 0 : shim_fs_errno();
+}
+
+Result FSUSER_DeleteDirectory(FS_Archive archive, FS_Path path) {
+    char hostPath[1024];
+    if(!shim_fs_host_path(hostPath, sizeof(hostPath), archive, path)) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    return rmdir(hostPath) == 0 ? 0 : shim_fs_errno();
+}
+
+Result FSUSER_DeleteDirectoryRecursively(FS_Archive archive, FS_Path path) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result FSUSER_OpenDirectory(Handle* out, FS_Archive archive, FS_Path path) {
+    shim_latency();
+
+    char hostPath[1024];
+    if(!shim_fs_host_path(hostPath, sizeof(hostPath), archive, path)) {
+        return SHIM_RESULT_NOT_IMPLEMENTED;
+    }
+
+    DIR* dir = opendir(hostPath);
+    if(dir == NULL) {
+        return shim_fs_errno();
+    }
+
+    *out = shim_handle_create(SHIM_DIR);
+    shim_objects[*out - 1].dir = dir;
+    snprintf(shim_objects[*out - 1].path, sizeof(shim_objects[*out - 1].path), "%s", hostPath);
+    return 0;
+}
+
+Result FSUSER_GetArchiveResource(FS_ArchiveResource* archiveResource, FS_SystemMediaType mediaType) {
+    archiveResource->sectorSize = 0x200;
+    archiveResource->clusterSize = 0x8000;
+    archiveResource->totalClusters = 0x100000;
+    archiveResource->freeClusters = 0x80000;
+    return 0;
+}
+
+Handle* fsGetSessionHandle() {
+    static Handle session = 0;
+    return &session;
+}
+
+Result FSFILE_Read(Handle handle, u32* bytesRead, u64 offset, void* buffer, u32 size) {
+    shim_latency();
+
+    shim_object* object = shim_handle_get(handle, SHIM_FILE);
+    if(object == NULL) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    ssize_t ret = pread(object->fd, buffer, size, (off_t) offset);
+    if(ret < 0) {
+        return shim_fs_errno();
+    }
+
+    if(bytesRead != NULL) {
+        *bytesRead = (u32) ret;
+    }
+
+    return 0;
+}
+
+Result FSFILE_Write(Handle handle, u32* bytesWritten, u64 offset, const void* buffer, u32 size, u32 flags) {
+    shim_latency();
+
+    shim_object* object = shim_handle_get(handle, SHIM_FILE);
+    if(object == NULL) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    ssize_t ret = pwrite(object->fd, buffer, size, (off_t) offset);
+    if(ret < 0) {
+        return shim_fs_errno();
+    }
+
+    if(bytesWritten != NULL) {
+        *bytesWritten = (u32) ret;
+    }
+
+    return 0;
+}
+
+Result FSFILE_GetSize(Handle handle, u64* size) {
+    shim_object* object = shim_handle_get(handle, SHIM_FILE);
+    if(object == NULL) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    struct stat st;
+    if(fstat(object->fd, &st) != 0) {
+        return shim_fs_errno();
+    }
+
+    *size = (u64) st.st_size;
+    return 0;
+}
+
+Result FSFILE_SetSize(Handle handle, u64 size) {
+    shim_object* object = shim_handle_get(handle, SHIM_FILE);
+    if(object == NULL) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    return ftruncate(object->fd, (off_t) size) == 0 ? 0 : shim_fs_errno();
+}
+
+Result FSFILE_GetAttributes(Handle handle, u32* attributes) {
+    shim_object* object = shim_handle_get(handle, SHIM_FILE);
+    if(object == NULL) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    *attributes = 0;
+    return 0;
+}
+
+Result FSFILE_Close(Handle handle) {
+    if(shim_handle_get(handle, SHIM_FILE) == NULL) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    return svcCloseHandle(handle);
+}
+
+Result FSDIR_Read(Handle handle, u32* entriesRead, u32 entryCount, FS_DirectoryEntry* entries) {
+    shim_latency();
+
+    shim_object* object = shim_handle_get(handle, SHIM_DIR);
+    if(object == NULL) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    u32 count = 0;
+
+    struct dirent* dirent = NULL;
+    while(count < entryCount && (dirent = readdir(object->dir)) != NULL) {
+        if(strcmp(dirent->d_name, ".") == 0 || strcmp(dirent->d_name, "..") == 0) {
+            continue;
+        }
+
+        char entryPath[2048];
+        snprintf(entryPath, sizeof(entryPath), "%s/%s", object->path, dirent->d_name);
+
+        struct stat st;
+        if(stat(entryPath, &st) != 0) {
+            continue;
+        }
+
+        FS_DirectoryEntry* entry = &entries[count++];
+        memset(entry, 0, sizeof(*entry));
+
+        ssize_t len = utf8_to_utf16(entry->name, (const u8*) dirent->d_name, sizeof(entry->name) / sizeof(u16) - 1);
+        entry->name[len < 0 ? 0 : len] = 0;
+        entry->valid = 1;
+        entry->attributes = S_ISDIR(st.st_mode) ? FS_ATTRIBUTE_DIRECTORY : 0;
+        entry->fileSize = S_ISDIR(st.st_mode) ? 0 : (u64) st.st_size;
+    }
+
+    *entriesRead = count;
+    return 0;
+}
+
+Result FSDIR_Close(Handle handle) {
+    if(shim_handle_get(handle, SHIM_DIR) == NULL) {
+        return SHIM_RESULT_INVALID_HANDLE;
+    }
+
+    return svcCloseHandle(handle);
+}
+
+// CFG
+
+Result CFGU_SecureInfoGetRegion(u8* region) {
+    *region = CFG_REGION_USA;
+    return 0;
+}
+
+Result CFGU_GetSystemLanguage(u8* language) {
+    *language = CFG_LANGUAGE_EN;
+    return 0;
+}
+
+// AM; no titles are installed and nothing can be installed.
+
+Result AM_GetTitleInfo(FS_MediaType mediaType, u32 titleCount, u64* titleIds, AM_TitleEntry* titleInfo) {
+    return SHIM_RESULT_NOT_FOUND;
+}
+
+Result AM_GetTitleList(u32* titlesRead, FS_MediaType mediaType, u32 titleCount, u64* titleIds) {
+    *titlesRead = 0;
+    return 0;
+}
+
+Result AM_GetTitleProductCode(FS_MediaType mediaType, u64 titleId, char* productCode) {
+    return SHIM_RESULT_NOT_FOUND;
+}
+
+Result AM_GetCiaFileInfo(FS_MediaType mediaType, AM_TitleEntry* titleEntry, Handle fileHandle) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result AM_StartCiaInstall(FS_MediaType mediaType, Handle* ciaHandle) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result AM_FinishCiaInstall(Handle ciaHandle) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result AM_CancelCIAInstall(Handle ciaHandle) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result AM_DeleteTitle(FS_MediaType mediaType, u64 titleID) {
+    return SHIM_RESULT_NOT_FOUND;
+}
+
+Result AM_DeleteTicket(u64 ticketId) {
+    return SHIM_RESULT_NOT_FOUND;
+}
+
+Result AM_InstallTicketBegin(Handle* ticketHandle) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result AM_InstallTicketAbort(Handle ticketHandle) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result AM_InstallTicketFinish(Handle ticketHandle) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result AM_InstallFirm(u64 titleID) {
+    return SHIM_RESULT_NOT_IMPLEMENTED;
+}
+
+Result AM_QueryAvailableExternalTitleDatabase(bool* available) {
+    if(available != NULL) {
+        *available = true;
+    }
+
+    return 0;
+}
+
+// Application services that would otherwise need the UI.
+
+void error_panic(const char* s, ...) {
+    va_list list;
+    va_start(list, s);
+
+    fprintf(stderr, "panic: ");
+    vfprintf(stderr, s, list);
+    fprintf(stderr, "\n");
+
+    va_end(list);
+
+    abort();
+}
+
+// JSON is never parsed by the code under test.
+
+#include <jansson.h>
+
+json_t* json_loads(const char* input, size_t flags, json_error_t* error) {
+    return NULL;
+}
+
+void json_decref(json_t* json) {
+}
+
+int json_is_object(const json_t* json) {
+    return 0;
+}
+
+int json_is_array(const json_t* json) {
+    return 0;
+}
+
+int json_is_string(const json_t* json) {
+    return 0;
+}
+
+json_t* json_object_get(const json_t* object, const char* key) {
+    return NULL;
+}
+
+size_t json_array_size(const json_t* array) {
+    return 0;
+}
+
+json_t* json_array_get(const json_t* array, size_t index) {
+    return NULL;
+}
+
+const char* json_string_value(const json_t* string) {
+    return NULL;
+}
+
+size_t json_string_length(const json_t* string) {
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,370 @@
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <3ds.h>
+
+// A blocking HTTP/1.1 client for plain http:// URLs, one connection per context like the httpc service.
+// Responses must carry a Content-Length; the local test server always sends one.
+
+#define SHIM_HTTPC_CONTEXTS_MAX 256
+#define SHIM_HTTPC_URL_MAX 1024
+#define SHIM_HTTPC_HEADERS_MAX 4096
+
+#define SHIM_HTTPC_RESULT_INVALID MAKERESULT(RL_PERMANENT, RS_INVALIDARG, RM_HTTP, 1)
+#define SHIM_HTTPC_RESULT_CONNECT_FAILED MAKERESULT(RL_PERMANENT, RS_INTERNAL, RM_HTTP, 2)
+#define SHIM_HTTPC_RESULT_TLS_VERIFY_FAILED ((Result) 0xD8A0A03C)
+
+volatile u32 shim_httpc_tls_failures = 0;
+volatile u32 shim_httpc_requests = 0;
+
+typedef struct {
+    bool used;
+
+    char url[SHIM_HTTPC_URL_MAX];
+    char requestHeaders[SHIM_HTTPC_HEADERS_MAX];
+    u32 requestHeadersSize;
+
+    int fd;
+    u32 status;
+    char responseHeaders[SHIM_HTTPC_HEADERS_MAX];
+
+    u32 contentLength;
+    u32 received;
+
+    // Body bytes that arrived with the response headers.
+    u8 pending[SHIM_HTTPC_HEADERS_MAX * 2];
+    u32 pendingSize;
+    u32 pendingPos;
+} shim_httpc_context;
+
+static pthread_mutex_t shim_httpc_lock = PTHREAD_MUTEX_INITIALIZER;
+static shim_httpc_context shim_httpc_contexts[SHIM_HTTPC_CONTEXTS_MAX];
+
+static shim_httpc_context* shim_httpc_get(httpcContext* context) {
+    if(context == NULL || context->httpchandle == 0 || context->httpchandle > SHIM_HTTPC_CONTEXTS_MAX) {
+        return NULL;
+    }
+
+    shim_httpc_context* ctx = &shim_httpc_contexts[context->httpchandle - 1];
+    return ctx->used ? ctx : NULL;
+}
+
+Result httpcInit(u32 sharedMemSize) {
+    return 0;
+}
+
+void httpcExit() {
+}
+
+Result httpcOpenContext(httpcContext* context, HTTPC_RequestMethod method, const char* url, u32 useDefaultProxy) {
+    if(method != HTTPC_METHOD_GET || strncmp(url, "http://", 7) != 0) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    pthread_mutex_lock(&shim_httpc_lock);
+
+    u32 index = 0;
+    while(index < SHIM_HTTPC_CONTEXTS_MAX && shim_httpc_contexts[index].used) {
+        index++;
+    }
+
+    if(index == SHIM_HTTPC_CONTEXTS_MAX) {
+        pthread_mutex_unlock(&shim_httpc_lock);
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    shim_httpc_context* ctx = &shim_httpc_contexts[index];
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->used = true;
+    ctx->fd = -1;
+    snprintf(ctx->url, sizeof(ctx->url), "%s", url);
+
+    pthread_mutex_unlock(&shim_httpc_lock);
+
+    context->servhandle = 0;
+    context->httpchandle = index + 1;
+    return 0;
+}
+
+Result httpcCloseContext(httpcContext* context) {
+    shim_httpc_context* ctx = shim_httpc_get(context);
+    if(ctx == NULL) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    if(ctx->fd >= 0) {
+        close(ctx->fd);
+    }
+
+    pthread_mutex_lock(&shim_httpc_lock);
+    ctx->used = false;
+    pthread_mutex_unlock(&shim_httpc_lock);
+
+    context->httpchandle = 0;
+    return 0;
+}
+
+Result httpcAddRequestHeaderField(httpcContext* context, const char* name, const char* value) {
+    shim_httpc_context* ctx = shim_httpc_get(context);
+    if(ctx == NULL) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    size_t remaining = sizeof(ctx->requestHeaders) - ctx->requestHeadersSize;
+    int len = snprintf(ctx->requestHeaders + ctx->requestHeadersSize, remaining, "%s: %s\r\n", name, value);
+    if(len < 0 || (size_t) len >= remaining) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    ctx->requestHeadersSize += (u32) len;
+    return 0;
+}
+
+Result httpcSetSSLOpt(httpcContext* context, u32 options) {
+    return shim_httpc_get(context) != NULL ? 0 : SHIM_HTTPC_RESULT_INVALID;
+}
+
+Result httpcSetKeepAlive(httpcContext* context, HTTPC_KeepAlive option) {
+    return shim_httpc_get(context) != NULL ? 0 : SHIM_HTTPC_RESULT_INVALID;
+}
+
+static bool shim_httpc_send_all(int fd, const char* data, size_t size) {
+    while(size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if(sent <= 0) {
+            return false;
+        }
+
+        data += sent;
+        size -= (size_t) sent;
+    }
+
+    return true;
+}
+
+static int shim_httpc_connect(const char* host, const char* port) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* addrs = NULL;
+    if(getaddrinfo(host, port, &hints, &addrs) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for(struct addrinfo* addr = addrs; addr != NULL && fd < 0; addr = addr->ai_next) {
+        if((fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol)) >= 0 && connect(fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    freeaddrinfo(addrs);
+
+    if(fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    return fd;
+}
+
+Result httpcBeginRequest(httpcContext* context) {
+    shim_httpc_context* ctx = shim_httpc_get(context);
+    if(ctx == NULL || ctx->fd >= 0) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    u32 failures = shim_httpc_tls_failures;
+    while(failures > 0) {
+        if(__atomic_compare_exchange_n(&shim_httpc_tls_failures, &failures, failures - 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            return SHIM_HTTPC_RESULT_TLS_VERIFY_FAILED;
+        }
+    }
+
+    __atomic_add_fetch(&shim_httpc_requests, 1, __ATOMIC_SEQ_CST);
+
+    // e.g. http://127.0.0.1:8080/file.cia
+    char host[256];
+    char port[16] = "80";
+    const char* hostStart = ctx->url + 7;
+    size_t hostLen = strcspn(hostStart, "/?#");
+    const char* path = hostStart[hostLen] == '/' ? hostStart + hostLen : "/";
+
+    snprintf(host, sizeof(host), "%.*s", (int) hostLen, hostStart);
+
+    char* portStart = strrchr(host, ':');
+    if(portStart != NULL) {
+        *portStart = '\0';
+        snprintf(port, sizeof(port), "%s", portStart + 1);
+    }
+
+    if((ctx->fd = shim_httpc_connect(host, port)) < 0) {
+        return SHIM_HTTPC_RESULT_CONNECT_FAILED;
+    }
+
+    char request[SHIM_HTTPC_URL_MAX + SHIM_HTTPC_HEADERS_MAX + 512];
+    int requestLen = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: %.*s\r\nConnection: close\r\n%s\r\n", path, (int) hostLen, hostStart, ctx->requestHeaders);
+    if(requestLen < 0 || (size_t) requestLen >= sizeof(request) || !shim_httpc_send_all(ctx->fd, request, (size_t) requestLen)) {
+        return SHIM_HTTPC_RESULT_CONNECT_FAILED;
+    }
+
+    // Read up to the end of the headers; anything past it is the start of the body.
+    char response[SHIM_HTTPC_HEADERS_MAX * 2];
+    size_t responseSize = 0;
+    char* headersEnd = NULL;
+    while(headersEnd == NULL) {
+        if(responseSize == sizeof(response) - 1) {
+            return SHIM_HTTPC_RESULT_INVALID;
+        }
+
+        ssize_t received = recv(ctx->fd, response + responseSize, sizeof(response) - 1 - responseSize, 0);
+        if(received <= 0) {
+            return SHIM_HTTPC_RESULT_CONNECT_FAILED;
+        }
+
+        responseSize += (size_t) received;
+        response[responseSize] = '\0';
+
+        headersEnd = strstr(response, "\r\n\r\n");
+    }
+
+    size_t headersSize = (size_t) (headersEnd - response) + 2;
+    size_t bodySize = responseSize - headersSize - 2;
+    if(headersSize >= sizeof(ctx->responseHeaders) || bodySize > sizeof(ctx->pending)) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    memcpy(ctx->responseHeaders, response, headersSize);
+    ctx->responseHeaders[headersSize] = '\0';
+
+    memcpy(ctx->pending, headersEnd + 4, bodySize);
+    ctx->pendingSize = (u32) bodySize;
+    ctx->pendingPos = 0;
+
+    if(sscanf(ctx->responseHeaders, "HTTP/%*s %u", &ctx->status) != 1) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    char contentLength[32];
+    if(R_SUCCEEDED(httpcGetResponseHeader(context, "Content-Length", contentLength, sizeof(contentLength)))) {
+        ctx->contentLength = (u32) strtoul(contentLength, NULL, 10);
+    }
+
+    return 0;
+}
+
+Result httpcGetResponseStatusCode(httpcContext* context, u32* out) {
+    shim_httpc_context* ctx = shim_httpc_get(context);
+    if(ctx == NULL || ctx->status == 0) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    *out = ctx->status;
+    return 0;
+}
+
+Result httpcGetResponseStatusCodeTimeout(httpcContext* context, u32* out, u64 timeout) {
+    return httpcGetResponseStatusCode(context, out);
+}
+
+Result httpcGetResponseHeader(httpcContext* context, const char* name, char* value, u32 valueSize) {
+    shim_httpc_context* ctx = shim_httpc_get(context);
+    if(ctx == NULL || valueSize == 0) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    size_t nameLen = strlen(name);
+
+    // Skip the status line; every header line ends with CRLF.
+    const char* line = strstr(ctx->responseHeaders, "\r\n");
+    while(line != NULL && line[2] != '\0') {
+        line += 2;
+
+        const char* lineEnd = strstr(line, "\r\n");
+        if(lineEnd == NULL) {
+            break;
+        }
+
+        if(strncasecmp(line, name, nameLen) == 0 && line[nameLen] == ':') {
+            const char* valueStart = line + nameLen + 1;
+            while(valueStart < lineEnd && isspace((unsigned char) *valueStart)) {
+                valueStart++;
+            }
+
+            snprintf(value, valueSize, "%.*s", (int) (lineEnd - valueStart), valueStart);
+            return 0;
+        }
+
+        line = lineEnd;
+    }
+
+    return HTTPC_RESULTCODE_NOTFOUND;
+}
+
+Result httpcGetDownloadSizeState(httpcContext* context, u32* downloadedSize, u32* contentSize) {
+    shim_httpc_context* ctx = shim_httpc_get(context);
+    if(ctx == NULL) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    if(downloadedSize != NULL) {
+        *downloadedSize = ctx->received;
+    }
+
+    if(contentSize != NULL) {
+        *contentSize = ctx->contentLength;
+    }
+
+    return 0;
+}
+
+// Like the service, fills the whole buffer unless the body ends first, and reports whether more is pending.
+Result httpcReceiveDataTimeout(httpcContext* context, u8* buffer, u32 size, u64 timeout) {
+    shim_httpc_context* ctx = shim_httpc_get(context);
+    if(ctx == NULL || ctx->fd < 0) {
+        return SHIM_HTTPC_RESULT_INVALID;
+    }
+
+    u32 pos = 0;
+    while(pos < size && ctx->received < ctx->contentLength) {
+        u32 remaining = size - pos;
+        if(remaining > ctx->contentLength - ctx->received) {
+            remaining = ctx->contentLength - ctx->received;
+        }
+
+        u32 chunk = 0;
+        if(ctx->pendingPos < ctx->pendingSize) {
+            chunk = ctx->pendingSize - ctx->pendingPos < remaining ? ctx->pendingSize - ctx->pendingPos : remaining;
+            memcpy(buffer + pos, ctx->pending + ctx->pendingPos, chunk);
+            ctx->pendingPos += chunk;
+        } else {
+            ssize_t received = recv(ctx->fd, buffer + pos, remaining, 0);
+            if(received <= 0) {
+                return HTTPC_RESULTCODE_TIMEDOUT;
+            }
+
+            chunk = (u32) received;
+        }
+
+        pos += chunk;
+        ctx->received += chunk;
+    }
+
+    return ctx->received < ctx->contentLength ? (Result) HTTPC_RESULTCODE_DOWNLOADPENDING : 0;
+}
+
+Result httpcReceiveData(httpcContext* context, u8* buffer, u32 size) {
+    return httpcReceiveDataTimeout(context, buffer, size, U64_MAX);
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <3ds.h>
+
+#include "core/core.h"
+
+// Headless views: prompts answer at once with shim_prompt_response, and errors are logged instead of shown.
+// As no view is returned, callers that would wait on one carry on immediately.
+
+u32 shim_prompt_response = PROMPT_NO;
+char shim_last_error[512];
+
+static void shim_ui_log_error(const char* prefix, const char* text, va_list list) {
+    char message[sizeof(shim_last_error)];
+    vsnprintf(message, sizeof(message), text, list);
+
+    snprintf(shim_last_error, sizeof(shim_last_error), "%s%s", prefix, message);
+    fprintf(stderr, "[ui] %s\n", shim_last_error);
+}
+
+ui_view* error_display(void* data, void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2), const char* text, ...) {
+    va_list list;
+    va_start(list, text);
+    shim_ui_log_error("", text, list);
+    va_end(list);
+
+    return NULL;
+}
+
+ui_view* error_display_res(void* data, void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2), Result result, const char* text, ...) {
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "0x%08X: ", (u32) result);
+
+    va_list list;
+    va_start(list, text);
+    shim_ui_log_error(prefix, text, list);
+    va_end(list);
+
+    return NULL;
+}
+
+ui_view* error_display_errno(void* data, void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2), int err, const char* text, ...) {
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "%s: ", strerror(err));
+
+    va_list list;
+    va_start(list, text);
+    shim_ui_log_error(prefix, text, list);
+    va_end(list);
+
+    return NULL;
+}
+
+ui_view* prompt_display_multi_choice(const char* name, const char* text, u32 color, const char** options, u32* optionButtons, u32 numOptions, void* data, void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2),
+                                                                                                                                                          void (*onResponse)(ui_view* view, void* data, u32 response)) {
+    if(onResponse != NULL) {
+        onResponse(NULL, data, shim_prompt_response < numOptions ? shim_prompt_response : 0);
+    }
+
+    return NULL;
+}
+
+ui_view* prompt_display_notify(const char* name, const char* text, u32 color, void* data, void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2),
+                                                                                          void (*onResponse)(ui_view* view, void* data, u32 response)) {
+    if(onResponse != NULL) {
+        onResponse(NULL, data, PROMPT_OK);
+    }
+
+    return NULL;
+}
+
+ui_view* prompt_display_yes_no(const char* name, const char* text, u32 color, void* data, void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2),
+                                                                                         void (*onResponse)(ui_view* view, void* data, u32 response)) {
+    if(onResponse != NULL) {
+        onResponse(NULL, data, shim_prompt_response);
+    }
+
+    return NULL;
+}
+
+ui_view* info_display(const char* name, const char* info, bool bar, void* data, void (*update)(ui_view* view, void* data, float* progress, char* text),
+                                                                                void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2)) {
+    return NULL;
+}
+
+void info_destroy(ui_view* view) {
+}
+
+ui_view* ui_create() {
+    ui_view* view = (ui_view*) calloc(1, sizeof(ui_view));
+    if(view == NULL) {
+        error_panic("Failed to allocate UI view.");
+    }
+
+    svcCreateEvent(&view->active, RESET_STICKY);
+    return view;
+}
+
+void ui_destroy(ui_view* view) {
+    if(view != NULL) {
+        svcCloseHandle(view->active);
+        free(view);
+    }
+}
+
+bool ui_push(ui_view* view) {
+    return true;
+}
+
+void ui_pop() {
+}
+
+ui_view* ui_top() {
+    return NULL;
+}
+
+void ui_set_debug_info(const char* text) {
+}
+
+ui_view* kbd_display(const char* hint, const char* initialText, SwkbdType type, u32 features, SwkbdValidInput validation, u32 maxSize, void* data, void (*onResponse)(ui_view* view, void* data, SwkbdButton button, const char* response)) {
+    return NULL;
+}
+
+// Weak, so that a program built with the real list view uses it instead.
+__attribute__((weak)) ui_view* list_display(const char* name, const char* info, void* data, void (*update)(ui_view* view, void* data, linked_list* items, list_item* selected, bool selectedTouched),
+                                                                      void (*drawTop)(ui_view* view, void* data, float x1, float y1, float x2, float y2, list_item* selected)) {
+    return NULL;
+}
+
+__attribute__((weak)) void list_destroy(ui_view* view) {
+}
\ No newline at end of file
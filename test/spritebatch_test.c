@@ -0,0 +1,297 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <3ds.h>
+
+#include "core/spritebatch.h"
+#include "test.h"
+
+// Queues quads as the screens would and replays the recorded draws through the index buffer, checking that quads
+// are grouped into few draws without any overlapping pair changing its relative order.
+
+#define SPRITEBATCH_TEST_MAX_QUADS 4096
+#define SPRITEBATCH_TEST_SHEETS 4
+
+typedef struct {
+    float vertices[SPRITEBATCH_TEST_MAX_QUADS * SPRITE_BATCH_QUAD_VERTICES * SPRITE_BATCH_VERTEX_FLOATS];
+    u16 indices[SPRITEBATCH_TEST_MAX_QUADS * SPRITE_BATCH_QUAD_INDICES];
+
+    // Quads in the order their indices were drawn.
+    u32 drawn[SPRITEBATCH_TEST_MAX_QUADS];
+    u32 drawnCount;
+    const void* drawnTextures[SPRITEBATCH_TEST_MAX_QUADS];
+} spritebatch_test_gpu;
+
+// Submission order and bounds of every queued quad.
+typedef struct {
+    float x1;
+    float y1;
+    float x2;
+    float y2;
+    const void* texture;
+} spritebatch_test_quad;
+
+static spritebatch_test_quad spritebatch_test_quads[SPRITEBATCH_TEST_MAX_QUADS];
+static u32 spritebatch_test_quad_count;
+
+static u8 spritebatch_test_textures[SPRITEBATCH_TEST_SHEETS + 128];
+
+static void spritebatch_test_draw(void* data, const sprite_batch_draw* draw) {
+    spritebatch_test_gpu* gpu = (spritebatch_test_gpu*) data;
+
+    TEST_CHECK(draw->indexCount % SPRITE_BATCH_QUAD_INDICES == 0, "draw of %u indices", draw->indexCount);
+
+    for(u32 i = draw->firstIndex; i < draw->firstIndex + draw->indexCount; i += SPRITE_BATCH_QUAD_INDICES) {
+        u32 quad = gpu->indices[i] / SPRITE_BATCH_QUAD_VERTICES;
+
+        gpu->drawnTextures[gpu->drawnCount] = draw->texture;
+        gpu->drawn[gpu->drawnCount++] = quad;
+    }
+}
+
+static void spritebatch_test_add(sprite_batch* batch, const void* texture, float x1, float y1, float x2, float y2) {
+    if(spritebatch_test_quad_count < SPRITEBATCH_TEST_MAX_QUADS) {
+        spritebatch_test_quads[spritebatch_test_quad_count++] = (spritebatch_test_quad) {x1, y1, x2, y2, texture};
+    }
+
+    sprite_batch_add(batch, texture, 0xFFFFFFFF, 0, x1, y1, x2, y2, 0, 0, 1, 1);
+}
+
+static spritebatch_test_gpu* spritebatch_test_begin(sprite_batch* batch, u32 maxQuads) {
+    spritebatch_test_gpu* gpu = (spritebatch_test_gpu*) calloc(1, sizeof(spritebatch_test_gpu));
+
+    sprite_batch_init(batch, gpu->vertices, gpu->indices, maxQuads, spritebatch_test_draw, gpu);
+    sprite_batch_reset(batch);
+
+    spritebatch_test_quad_count = 0;
+
+    return gpu;
+}
+
+static bool spritebatch_test_overlap(const spritebatch_test_quad* a, const spritebatch_test_quad* b) {
+    return a->x1 < b->x2 && a->x2 > b->x1 && a->y1 < b->y2 && a->y2 > b->y1;
+}
+
+// Every quad is drawn exactly once, with its own texture, and overlapping quads keep their submission order.
+static void spritebatch_test_check_order(spritebatch_test_gpu* gpu, u32 expected) {
+    TEST_CHECK(gpu->drawnCount == expected, "drew %u of %u quads", gpu->drawnCount, expected);
+
+    u32* position = (u32*) malloc(expected * sizeof(u32));
+    memset(position, 0xFF, expected * sizeof(u32));
+
+    for(u32 i = 0; i < gpu->drawnCount; i++) {
+        u32 quad = gpu->drawn[i];
+        TEST_CHECK(quad < expected && position[quad] == 0xFFFFFFFF, "quad %u drawn twice or out of range", quad);
+        TEST_CHECK(gpu->drawnTextures[i] == spritebatch_test_quads[quad].texture, "quad %u drawn with the wrong texture", quad);
+
+        if(quad < expected) {
+            position[quad] = i;
+        }
+    }
+
+    u32 reordered = 0;
+    for(u32 a = 0; a < expected; a++) {
+        for(u32 b = a + 1; b < expected; b++) {
+            if(spritebatch_test_overlap(&spritebatch_test_quads[a], &spritebatch_test_quads[b]) && position[a] > position[b]) {
+                reordered++;
+            }
+        }
+    }
+
+    TEST_CHECK(reordered == 0, "%u overlapping pairs drawn out of order", reordered);
+
+    free(position);
+}
+
+// A background, a selection bar, and rows of an icon followed by a name spread over the glyph sheets.
+static void spritebatch_test_list_screen(sprite_batch* batch, u32 rows, u32 glyphs) {
+    const void* background = &spritebatch_test_textures[SPRITEBATCH_TEST_SHEETS];
+    const void* selection = &spritebatch_test_textures[SPRITEBATCH_TEST_SHEETS + 1];
+
+    spritebatch_test_add(batch, background, 0, 0, 320, 240);
+    spritebatch_test_add(batch, selection, 0, 3 * 16, 320, 4 * 16);
+
+    for(u32 row = 0; row < rows; row++) {
+        float y = row * 16.0f;
+
+        spritebatch_test_add(batch, &spritebatch_test_textures[SPRITEBATCH_TEST_SHEETS + 2 + row], 0, y, 16, y + 16);
+
+        for(u32 glyph = 0; glyph < glyphs; glyph++) {
+            float x = 18 + glyph * 5.0f;
+            spritebatch_test_add(batch, &spritebatch_test_textures[(row * 7 + glyph * 13) % SPRITEBATCH_TEST_SHEETS], x, y + 2, x + 5, y + 14);
+        }
+    }
+}
+
+static void test_spritebatch_list_screen() {
+    sprite_batch batch;
+    spritebatch_test_gpu* gpu = spritebatch_test_begin(&batch, SPRITEBATCH_TEST_MAX_QUADS);
+
+    spritebatch_test_list_screen(&batch, 15, 60);
+    sprite_batch_flush(&batch);
+
+    u32 quads = 2 + 15 * (1 + 60);
+    spritebatch_test_check_order(gpu, quads);
+
+    printf("%u quads in %u draws, %u texture switches\n", quads, batch.draws, batch.textureSwitches);
+
+    // The background and bar, then per row an icon and one draw per glyph sheet, at most.
+    TEST_CHECK(batch.draws <= 2 + 15 * (1 + SPRITEBATCH_TEST_SHEETS), "%u draws for %u quads", batch.draws, quads);
+    TEST_CHECK(batch.textureSwitches <= batch.draws, "%u texture switches for %u draws", batch.textureSwitches, batch.draws);
+    TEST_CHECK(batch.droppedQuads == 0, "%u quads dropped", batch.droppedQuads);
+
+    sprite_batch_destroy(&batch);
+    free(gpu);
+}
+
+static void test_spritebatch_overlap_order() {
+    sprite_batch batch;
+    spritebatch_test_gpu* gpu = spritebatch_test_begin(&batch, SPRITEBATCH_TEST_MAX_QUADS);
+
+    const void* a = &spritebatch_test_textures[0];
+    const void* b = &spritebatch_test_textures[1];
+
+    // Text over a panel over text: the second A must not join the first, as B lies between them.
+    spritebatch_test_add(&batch, a, 0, 0, 10, 10);
+    spritebatch_test_add(&batch, b, 5, 5, 15, 15);
+    spritebatch_test_add(&batch, a, 8, 8, 12, 12);
+    // Clear of everything, so it joins a group rather than starting one.
+    spritebatch_test_add(&batch, a, 100, 100, 110, 110);
+    sprite_batch_flush(&batch);
+
+    spritebatch_test_check_order(gpu, 4);
+    TEST_CHECK(batch.draws == 3, "%u draws", batch.draws);
+
+    sprite_batch_destroy(&batch);
+    free(gpu);
+}
+
+static void test_spritebatch_vertices() {
+    sprite_batch batch;
+    spritebatch_test_gpu* gpu = spritebatch_test_begin(&batch, 4);
+
+    sprite_batch_add(&batch, &spritebatch_test_textures[0], 0xFFFFFFFF, 0, 10, 20, 30, 40, 0.25f, 0.75f, 0.5f, 1.0f);
+
+    float expected[SPRITE_BATCH_QUAD_VERTICES * SPRITE_BATCH_VERTEX_FLOATS] = {
+        10, 40, 0.5f, 0.25f, 0.75f,
+        30, 40, 0.5f, 0.5f, 0.75f,
+        10, 20, 0.5f, 0.25f, 1.0f,
+        30, 20, 0.5f, 0.5f, 1.0f
+    };
+
+    TEST_CHECK(memcmp(gpu->vertices, expected, sizeof(expected)) == 0, "unexpected quad vertices");
+
+    sprite_batch_flush(&batch);
+
+    u16 indices[SPRITE_BATCH_QUAD_INDICES] = {0, 1, 2, 2, 1, 3};
+    TEST_CHECK(memcmp(gpu->indices, indices, sizeof(indices)) == 0, "unexpected quad indices");
+
+    sprite_batch_destroy(&batch);
+    free(gpu);
+}
+
+static void test_spritebatch_group_table_full() {
+    sprite_batch batch;
+    spritebatch_test_gpu* gpu = spritebatch_test_begin(&batch, SPRITEBATCH_TEST_MAX_QUADS);
+
+    // Every quad needs its own group; the table flushes itself rather than losing any.
+    u32 quads = SPRITE_BATCH_MAX_GROUPS * 2 + 5;
+    for(u32 i = 0; i < quads; i++) {
+        float x = (i % 32) * 10.0f;
+        float y = (i / 32) * 10.0f;
+        spritebatch_test_add(&batch, &spritebatch_test_textures[i % 128], x, y, x + 10, y + 10);
+    }
+
+    sprite_batch_flush(&batch);
+
+    spritebatch_test_check_order(gpu, quads);
+    TEST_CHECK(batch.draws == quads, "%u draws for %u quads", batch.draws, quads);
+
+    sprite_batch_destroy(&batch);
+    free(gpu);
+}
+
+static void test_spritebatch_flush_continues() {
+    sprite_batch batch;
+    spritebatch_test_gpu* gpu = spritebatch_test_begin(&batch, SPRITEBATCH_TEST_MAX_QUADS);
+
+    // As on a render target change: the second screen's quads follow the first's in the buffer.
+    spritebatch_test_list_screen(&batch, 4, 10);
+    sprite_batch_flush(&batch);
+
+    u32 first = gpu->drawnCount;
+
+    spritebatch_test_list_screen(&batch, 4, 10);
+    sprite_batch_flush(&batch);
+
+    TEST_CHECK(first == 2 + 4 * 11 && gpu->drawnCount == 2 * first, "drew %u then %u quads", first, gpu->drawnCount - first);
+
+    u32 reused = 0;
+    for(u32 i = first; i < gpu->drawnCount; i++) {
+        if(gpu->drawn[i] < first) {
+            reused++;
+        }
+    }
+
+    TEST_CHECK(reused == 0, "%u quads redrawn after their flush", reused);
+
+    // Flushing with nothing queued draws nothing.
+    u32 draws = batch.draws;
+    sprite_batch_flush(&batch);
+    TEST_CHECK(batch.draws == draws, "empty flush drew %u", batch.draws - draws);
+
+    sprite_batch_destroy(&batch);
+    free(gpu);
+}
+
+static void test_spritebatch_overflow() {
+    sprite_batch batch;
+    spritebatch_test_gpu* gpu = spritebatch_test_begin(&batch, 16);
+
+    for(u32 i = 0; i < 20; i++) {
+        spritebatch_test_add(&batch, &spritebatch_test_textures[0], i * 10.0f, 0, i * 10.0f + 10, 10);
+    }
+
+    sprite_batch_flush(&batch);
+
+    TEST_CHECK(gpu->drawnCount == 16 && batch.droppedQuads == 4, "drew %u, dropped %u", gpu->drawnCount, batch.droppedQuads);
+
+    // A new frame starts with the whole buffer again.
+    sprite_batch_reset(&batch);
+    gpu->drawnCount = 0;
+    spritebatch_test_quad_count = 0;
+
+    spritebatch_test_add(&batch, &spritebatch_test_textures[0], 0, 0, 10, 10);
+    sprite_batch_flush(&batch);
+
+    TEST_CHECK(gpu->drawnCount == 1 && gpu->drawn[0] == 0 && batch.droppedQuads == 0, "drew %u after reset, dropped %u", gpu->drawnCount, batch.droppedQuads);
+
+    sprite_batch_destroy(&batch);
+    free(gpu);
+}
+
+static void test_spritebatch_init_limits() {
+    sprite_batch batch;
+    float vertices[SPRITE_BATCH_QUAD_VERTICES * SPRITE_BATCH_VERTEX_FLOATS];
+    u16 indices[SPRITE_BATCH_QUAD_INDICES];
+
+    TEST_CHECK(!sprite_batch_init(&batch, NULL, indices, 1, NULL, NULL), "accepted no vertex buffer");
+    TEST_CHECK(!sprite_batch_init(&batch, vertices, indices, 0, NULL, NULL), "accepted no quads");
+    // 16-bit indices reach 16384 quads.
+    TEST_CHECK(!sprite_batch_init(&batch, vertices, indices, 0x10000 / SPRITE_BATCH_QUAD_VERTICES + 1, NULL, NULL), "accepted more quads than indices reach");
+
+    TEST_CHECK(sprite_batch_init(&batch, vertices, indices, 1, NULL, NULL), "rejected a one-quad buffer");
+    sprite_batch_destroy(&batch);
+}
+
+int main() {
+    TEST_RUN(test_spritebatch_list_screen);
+    TEST_RUN(test_spritebatch_overlap_order);
+    TEST_RUN(test_spritebatch_vertices);
+    TEST_RUN(test_spritebatch_group_table_full);
+    TEST_RUN(test_spritebatch_flush_continues);
+    TEST_RUN(test_spritebatch_overflow);
+    TEST_RUN(test_spritebatch_init_limits);
+
+    return test_finish();
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+// Shared by the host tests and benchmarks; each one is a single translation unit built against the shims.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+
+static int test_failures = 0;
+
+#define TEST_CHECK(cond, ...)                                                \
+    do {                                                                     \
+        if(!(cond)) {                                                        \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, "    " __VA_ARGS__);                             \
+            fprintf(stderr, "\n");                                           \
+            test_failures++;                                                 \
+        }                                                                    \
+    } while(0)
+
+#define TEST_RUN(fn)                                \
+    do {                                            \
+        int failuresBefore = test_failures;         \
+        fn();                                       \
+        printf("%s %s\n", test_failures == failuresBefore ? "PASS" : "FAIL", #fn); \
+    } while(0)
+
+static inline double test_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Deterministic filler, so that tests can check copied data without keeping a reference copy.
+static inline u8 test_pattern(u64 offset, u32 seed) {
+    u64 x = (offset + 1) * 0x9E3779B97F4A7C15ULL + seed;
+    x ^= x >> 29;
+    return (u8) (x ^ (x >> 17));
+}
+
+static inline bool test_write_file(const char* path, const void* data, size_t size) {
+    FILE* fd = fopen(path, "wb");
+    if(fd == NULL) {
+        return false;
+    }
+
+    bool written = fwrite(data, 1, size, fd) == size;
+    return fclose(fd) == 0 && written;
+}
+
+static pid_t test_server_pid = 0;
+static FILE* test_server_pipe = NULL;
+
+// Starts server.py on a free local port, serving the files under root; returns the port, or 0 on failure.
+static inline u16 test_server_start(const char* root) {
+    mkdir(root, 0755);
+
+    char command[512];
+    snprintf(command, sizeof(command), "exec python3 server.py '%s'", root);
+
+    if((test_server_pipe = popen(command, "r")) == NULL) {
+        return 0;
+    }
+
+    unsigned int port = 0;
+    int pid = 0;
+    if(fscanf(test_server_pipe, "%u %d", &port, &pid) != 2) {
+        pclose(test_server_pipe);
+        test_server_pipe = NULL;
+        return 0;
+    }
+
+    test_server_pid = (pid_t) pid;
+    return (u16) port;
+}
+
+static inline void test_server_stop() {
+    if(test_server_pipe != NULL) {
+        kill(test_server_pid, SIGTERM);
+        pclose(test_server_pipe);
+
+        test_server_pipe = NULL;
+        test_server_pid = 0;
+    }
+}
+
+static inline int test_finish() {
+    if(test_failures > 0) {
+        printf("%d check(s) failed\n", test_failures);
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include <string.h>
+
+#include <3ds.h>
+
+#include "core/textlayout.h"
+#include "test.h"
+
+// Lays out text against a mock system font whose metrics follow from the code point: Latin glyphs are 10 units wide
+// and others 12 to 16, glyphs are 256 to a sheet, and every call into the font is counted.
+
+#define TEXTLAYOUT_TEST_LINE_FEED 20
+#define TEXTLAYOUT_TEST_SHEETS 2
+
+static u32 textlayout_test_font_calls;
+
+static FINF_s textlayout_test_info = {.lineFeed = TEXTLAYOUT_TEST_LINE_FEED};
+static charWidthInfo_s textlayout_test_width;
+
+static u8 textlayout_test_char_width(u32 code) {
+    return (u8) (code < 0x100 ? 10 : 12 + code % 5);
+}
+
+FINF_s* fontGetInfo() {
+    textlayout_test_font_calls++;
+    return &textlayout_test_info;
+}
+
+int fontGlyphIndexFromCodePoint(u32 codePoint) {
+    textlayout_test_font_calls++;
+    return (int) codePoint;
+}
+
+charWidthInfo_s* fontGetCharWidthInfo(int glyphIndex) {
+    textlayout_test_font_calls++;
+
+    textlayout_test_width.charWidth = textlayout_test_char_width((u32) glyphIndex);
+    textlayout_test_width.glyphWidth = (u8) (textlayout_test_width.charWidth - 1);
+    textlayout_test_width.left = (s8) (glyphIndex % 3 - 1);
+    return &textlayout_test_width;
+}
+
+void fontCalcGlyphPos(fontGlyphPos_s* out, int glyphIndex, u32 flags, float scaleX, float scaleY) {
+    textlayout_test_font_calls++;
+
+    // The replacement glyph lives on the first sheet.
+    u32 slot = glyphIndex == 0xFFFD ? 0xFD : (u32) glyphIndex % 0x100;
+
+    memset(out, 0, sizeof(*out));
+    out->sheetIndex = glyphIndex == 0xFFFD ? 0 : glyphIndex / 0x100;
+    out->texcoord.left = (slot % 16) / 16.0f;
+    out->texcoord.top = 1 - (slot / 16) / 16.0f;
+    out->texcoord.right = out->texcoord.left + 1 / 16.0f;
+    out->texcoord.bottom = out->texcoord.top - 1 / 16.0f;
+}
+
+static void textlayout_test_check_lines(const char* text, const text_layout* layout, u32 numLines, const u32* lines, const float* widths) {
+    TEST_CHECK(layout->numLines == numLines, "\"%s\": %u lines, expected %u", text, layout->numLines, numLines);
+
+    float totalWidth = 0;
+    for(u32 i = 0; i < numLines && i < layout->numLines; i++) {
+        TEST_CHECK(layout->lines[i] == lines[i] && layout->lineWidths[i] == widths[i], "\"%s\" line %u: %u code points %.1f wide, expected %u %.1f wide",
+                   text, i, layout->lines[i], layout->lineWidths[i], lines[i], widths[i]);
+
+        if(widths[i] > totalWidth) {
+            totalWidth = widths[i];
+        }
+    }
+
+    TEST_CHECK(layout->totalWidth == totalWidth, "\"%s\": %.1f wide, expected %.1f", text, layout->totalWidth, totalWidth);
+}
+
+static void test_textlayout_lines() {
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 1.0f);
+
+    const text_layout* layout = text_layout_get("abc", 1.0f, 1.0f, false, 0);
+    textlayout_test_check_lines("abc", layout, 1, (u32[]) {3}, (float[]) {30});
+    TEST_CHECK(layout->totalHeight == TEXTLAYOUT_TEST_LINE_FEED, "one line is %.1f high", layout->totalHeight);
+
+    // The break counts towards the line it ends.
+    layout = text_layout_get("ab\ncd", 1.0f, 1.0f, false, 0);
+    textlayout_test_check_lines("ab\\ncd", layout, 2, (u32[]) {3, 2}, (float[]) {20, 20});
+    TEST_CHECK(layout->totalHeight == 2 * TEXTLAYOUT_TEST_LINE_FEED && layout->lineHeights[1] == TEXTLAYOUT_TEST_LINE_FEED, "two lines are %.1f high", layout->totalHeight);
+
+    layout = text_layout_get("ab\n", 1.0f, 1.0f, false, 0);
+    textlayout_test_check_lines("ab\\n", layout, 1, (u32[]) {3}, (float[]) {20});
+
+    // Tabs advance to the next multiple of four spaces.
+    layout = text_layout_get("a\tb", 1.0f, 1.0f, false, 0);
+    textlayout_test_check_lines("a\\tb", layout, 1, (u32[]) {3}, (float[]) {50});
+
+    // Both the caller's scale and the font's scale apply.
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 0.5f);
+
+    layout = text_layout_get("abc", 2.0f, 3.0f, false, 0);
+    textlayout_test_check_lines("abc scaled", layout, 1, (u32[]) {3}, (float[]) {30});
+    TEST_CHECK(layout->totalHeight == TEXTLAYOUT_TEST_LINE_FEED * 1.5f, "scaled line is %.1f high", layout->totalHeight);
+
+    text_layout_exit();
+}
+
+static void test_textlayout_wrap() {
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 1.0f);
+
+    // The word that crosses the width moves to the next line; the space stays behind.
+    const text_layout* layout = text_layout_get("hello world foo", 1.0f, 1.0f, true, 100);
+    textlayout_test_check_lines("hello world foo", layout, 2, (u32[]) {6, 9}, (float[]) {60, 90});
+
+    // Without wrapping, the width is ignored.
+    layout = text_layout_get("hello world foo", 1.0f, 1.0f, false, 100);
+    textlayout_test_check_lines("hello world foo unwrapped", layout, 1, (u32[]) {15}, (float[]) {150});
+
+    text_layout_exit();
+}
+
+static void test_textlayout_multibyte() {
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 1.0f);
+
+    // U+00E9 from the Latin table and U+20AC from the cache, counted as one code point each.
+    const text_layout* layout = text_layout_get("\xC3\xA9\xE2\x82\xAC", 1.0f, 1.0f, false, 0);
+    textlayout_test_check_lines("e-acute euro", layout, 1, (u32[]) {2}, (float[]) {10.0f + textlayout_test_char_width(0x20AC)});
+
+    text_layout_exit();
+}
+
+static void textlayout_test_check_glyph(u32 code, u32 drawnCode) {
+    const text_glyph* glyph = text_layout_get_glyph(code);
+
+    fontGlyphPos_s pos;
+    fontCalcGlyphPos(&pos, (int) drawnCode, 0, 1.0f, 1.0f);
+
+    TEST_CHECK(glyph->layoutWidth == textlayout_test_char_width(code), "U+%04X advances %u", code, glyph->layoutWidth);
+    TEST_CHECK(glyph->sheetIndex == (u32) pos.sheetIndex && glyph->charWidth == textlayout_test_char_width(drawnCode) && glyph->left == (s8) (drawnCode % 3 - 1),
+               "U+%04X drawn from sheet %u, %u wide", code, glyph->sheetIndex, glyph->charWidth);
+    TEST_CHECK(glyph->texLeft == pos.texcoord.left && glyph->texTop == pos.texcoord.top && glyph->texRight == pos.texcoord.right && glyph->texBottom == pos.texcoord.bottom,
+               "U+%04X has the wrong texture coordinates", code);
+}
+
+static void test_textlayout_glyphs() {
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 1.0f);
+
+    textlayout_test_check_glyph('A', 'A');
+    textlayout_test_check_glyph(0xE9, 0xE9);
+
+    // Both map to the same cache slot.
+    for(u32 i = 0; i < 3; i++) {
+        textlayout_test_check_glyph(0x141, 0x141);
+        textlayout_test_check_glyph(0x41 + 0x100 * TEXTLAYOUT_TEST_SHEETS, 0xFFFD);
+    }
+
+    // Past the loaded sheets, the replacement glyph is drawn in the code point's own advance.
+    textlayout_test_check_glyph(0x2345, 0xFFFD);
+
+    text_layout_exit();
+}
+
+static void test_textlayout_font_calls() {
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 1.0f);
+
+    u32 calls = textlayout_test_font_calls;
+
+    const char* ascii = "The quick brown fox jumps over the lazy dog.\tCaf\xC3\xA9 \xC2\xA9 2016\n";
+    text_layout_get(ascii, 1.0f, 1.0f, true, 120);
+    text_layout_get(ascii, 0.5f, 0.5f, false, 0);
+
+    TEST_CHECK(textlayout_test_font_calls == calls, "%u font calls laying out Latin text", textlayout_test_font_calls - calls);
+
+    // Other code points are looked up once.
+    const char* other = "\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC \xE3\x81\x82";
+    text_layout_get(other, 1.0f, 1.0f, false, 0);
+
+    u32 firstCalls = textlayout_test_font_calls - calls;
+    calls = textlayout_test_font_calls;
+
+    text_layout_get(other, 0.5f, 1.0f, false, 0);
+
+    TEST_CHECK(firstCalls > 0 && textlayout_test_font_calls == calls, "%u font calls then %u", firstCalls, textlayout_test_font_calls - calls);
+
+    text_layout_exit();
+}
+
+static void test_textlayout_cache_keys() {
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 1.0f);
+
+    const char* text = "Install and delete CIA";
+
+    const text_layout* layout = text_layout_get(text, 0.5f, 0.5f, true, 100);
+    TEST_CHECK(text_layout_get(text, 0.5f, 0.5f, true, 100) == layout, "same layout was not cached");
+
+    // Equal text at another address is the same key.
+    char copy[64];
+    strcpy(copy, text);
+    TEST_CHECK(text_layout_get(copy, 0.5f, 0.5f, true, 100) == layout, "copied text missed the cache");
+
+    TEST_CHECK(text_layout_get(text, 0.6f, 0.5f, true, 100) != layout, "another scale hit the cache");
+    TEST_CHECK(text_layout_get(text, 0.5f, 0.5f, true, 80) != layout, "another wrap width hit the cache");
+
+    const text_layout* unwrapped = text_layout_get(text, 0.5f, 0.5f, false, 100);
+    TEST_CHECK(unwrapped != layout && text_layout_get(text, 0.5f, 0.5f, false, 200) == unwrapped, "unwrapped text is keyed on its width");
+
+    // Text edited in place is laid out again.
+    char name[16] = "abc";
+    layout = text_layout_get(name, 1.0f, 1.0f, false, 0);
+    textlayout_test_check_lines("abc", layout, 1, (u32[]) {3}, (float[]) {30});
+
+    name[1] = '\n';
+    layout = text_layout_get(name, 1.0f, 1.0f, false, 0);
+    textlayout_test_check_lines("a\\nc", layout, 2, (u32[]) {2, 1}, (float[]) {10, 10});
+
+    text_layout_exit();
+}
+
+static void test_textlayout_lru() {
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 1.0f);
+
+    char texts[TEXT_LAYOUT_CACHE_SIZE + 2][16];
+    const text_layout* layouts[TEXT_LAYOUT_CACHE_SIZE + 2];
+
+    for(u32 i = 0; i < TEXT_LAYOUT_CACHE_SIZE; i++) {
+        snprintf(texts[i], sizeof(texts[i]), "text %u", i);
+        layouts[i] = text_layout_get(texts[i], 1.0f, 1.0f, false, 0);
+    }
+
+    // The first is used again, so the second is now the least recently used.
+    TEST_CHECK(text_layout_get(texts[0], 1.0f, 1.0f, false, 0) == layouts[0], "first layout was not cached");
+
+    snprintf(texts[TEXT_LAYOUT_CACHE_SIZE], sizeof(texts[0]), "text %u", TEXT_LAYOUT_CACHE_SIZE);
+    layouts[TEXT_LAYOUT_CACHE_SIZE] = text_layout_get(texts[TEXT_LAYOUT_CACHE_SIZE], 1.0f, 1.0f, false, 0);
+
+    TEST_CHECK(layouts[TEXT_LAYOUT_CACHE_SIZE] == layouts[1], "evicted another entry than the least recently used");
+    TEST_CHECK(text_layout_get(texts[0], 1.0f, 1.0f, false, 0) == layouts[0], "recently used layout was evicted");
+
+    for(u32 i = 2; i < TEXT_LAYOUT_CACHE_SIZE; i++) {
+        TEST_CHECK(text_layout_get(texts[i], 1.0f, 1.0f, false, 0) == layouts[i], "layout %u was evicted", i);
+    }
+
+    // The evicted text comes back laid out the same, in place of the new least recently used entry.
+    const text_layout* layout = text_layout_get(texts[1], 1.0f, 1.0f, false, 0);
+    textlayout_test_check_lines("text 1", layout, 1, (u32[]) {6}, (float[]) {60});
+    TEST_CHECK(layout == layouts[1], "evicted layout did not take the least recently used entry");
+
+    text_layout_exit();
+}
+
+static void test_textlayout_max_lines() {
+    text_layout_init(TEXTLAYOUT_TEST_SHEETS, 1.0f);
+
+    char text[200 + 1] = "";
+    for(u32 i = 0; i < 100; i++) {
+        strcat(text, "a\n");
+    }
+
+    // Lines past the limit are not recorded but still count towards the height.
+    const text_layout* layout = text_layout_get(text, 1.0f, 1.0f, false, 0);
+    TEST_CHECK(layout->numLines == TEXT_LAYOUT_MAX_LINES, "%u lines recorded", layout->numLines);
+    TEST_CHECK(layout->totalHeight == 100 * TEXTLAYOUT_TEST_LINE_FEED, "%.1f high", layout->totalHeight);
+
+    text_layout_exit();
+}
+
+int main() {
+    TEST_RUN(test_textlayout_lines);
+    TEST_RUN(test_textlayout_wrap);
+    TEST_RUN(test_textlayout_multibyte);
+    TEST_RUN(test_textlayout_glyphs);
+    TEST_RUN(test_textlayout_font_calls);
+    TEST_RUN(test_textlayout_cache_keys);
+    TEST_RUN(test_textlayout_lru);
+    TEST_RUN(test_textlayout_max_lines);
+
+    return test_finish();
+}
\ No newline at end of file
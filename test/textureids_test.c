@@ -0,0 +1,204 @@
+#include <string.h>
+
+#include <3ds.h>
+
+#include "core/screen.h"
+#include "core/textureids.h"
+#include "test.h"
+
+// Exercises the texture ID bitmap and memory accounting behind screen.c, which hands out IDs for icons and list
+// textures from task threads while resource textures claim fixed IDs.
+
+#define TEXTUREIDS_TEST_THREADS 4
+#define TEXTUREIDS_TEST_PER_THREAD 250
+
+static void test_textureids_allocate_all() {
+    texture_ids_init();
+
+    u32 count = 0;
+    for(u32 expected = 1; expected < MAX_TEXTURES; expected++) {
+        u32 id = texture_ids_allocate();
+        TEST_CHECK(id == expected, "allocated %u, expected %u", id, expected);
+
+        if(id != 0) {
+            count++;
+        }
+    }
+
+    TEST_CHECK(count == MAX_TEXTURES - 1, "allocated %u IDs", count);
+    TEST_CHECK(texture_ids_allocate() == 0, "allocated past the last ID");
+
+    // ID 0 stays reserved even when freed.
+    texture_ids_set_allocated(0, false);
+    TEST_CHECK(texture_ids_allocate() == 0, "handed out ID 0");
+
+    // Out of range IDs are ignored.
+    texture_ids_set_allocated(MAX_TEXTURES, false);
+    texture_ids_set_allocated(MAX_TEXTURES + 100, true);
+    TEST_CHECK(texture_ids_allocate() == 0, "freeing an out of range ID freed another");
+}
+
+static void test_textureids_reuse() {
+    texture_ids_init();
+
+    for(u32 i = 1; i < MAX_TEXTURES; i++) {
+        texture_ids_allocate();
+    }
+
+    // The lowest freed ID comes back first, wherever it lies relative to the others.
+    texture_ids_set_allocated(500, false);
+    texture_ids_set_allocated(900, false);
+    texture_ids_set_allocated(37, false);
+
+    u32 first = texture_ids_allocate();
+    u32 second = texture_ids_allocate();
+    u32 third = texture_ids_allocate();
+
+    TEST_CHECK(first == 37 && second == 500 && third == 900, "reallocated %u, %u, %u", first, second, third);
+    TEST_CHECK(texture_ids_allocate() == 0, "allocated more IDs than were freed");
+
+    texture_ids_set_allocated(MAX_TEXTURES - 1, false);
+    TEST_CHECK(texture_ids_allocate() == MAX_TEXTURES - 1, "last ID not reused");
+}
+
+static void test_textureids_fixed_ids() {
+    texture_ids_init();
+
+    // Resource textures claim the low IDs as they are loaded.
+    for(u32 id = 1; id <= 15; id++) {
+        texture_ids_set_allocated(id, true);
+    }
+
+    TEST_CHECK(texture_ids_allocate() == 16, "allocated a resource ID");
+
+    // Claims made while IDs are being handed out are skipped, including ones already passed over.
+    texture_ids_set_allocated(18, true);
+    texture_ids_set_allocated(40, true);
+
+    u32 ids[30];
+    for(u32 i = 0; i < 30; i++) {
+        ids[i] = texture_ids_allocate();
+        TEST_CHECK(ids[i] != 18 && ids[i] != 40 && ids[i] > 16, "allocated claimed ID %u", ids[i]);
+    }
+
+    TEST_CHECK(ids[0] == 17 && ids[1] == 19 && ids[29] == 48, "allocated %u, %u ... %u", ids[0], ids[1], ids[29]);
+
+    // Reloading a resource into its claimed ID leaves it claimed.
+    texture_ids_set_allocated(5, true);
+    texture_ids_set_allocated(5, false);
+    texture_ids_set_allocated(5, true);
+    TEST_CHECK(texture_ids_allocate() == 49, "reloaded resource ID was handed out");
+}
+
+static void test_textureids_stats() {
+    texture_ids_init();
+
+    screen_texture_stats stats;
+    texture_ids_get_stats(&stats);
+    TEST_CHECK(stats.liveTextures == 0 && stats.peakBytes == 0, "stats not empty after init");
+
+    // Two 64x64 RGB565 icons and a 512x512 RGBA8 background.
+    texture_ids_track(GPU_RGB565, 64 * 64 * 2, true);
+    texture_ids_track(GPU_RGB565, 64 * 64 * 2, true);
+    texture_ids_track(GPU_RGBA8, 512 * 512 * 4, true);
+    texture_ids_track(GPU_RGB565, 64 * 64 * 2, false);
+
+    texture_ids_get_stats(&stats);
+
+    TEST_CHECK(stats.liveTextures == 2 && stats.peakTextures == 3, "%u live, %u peak textures", stats.liveTextures, stats.peakTextures);
+    TEST_CHECK(stats.liveBytes == 64 * 64 * 2 + 512 * 512 * 4 && stats.peakBytes == 2 * 64 * 64 * 2 + 512 * 512 * 4, "%u live, %u peak bytes", stats.liveBytes, stats.peakBytes);
+    TEST_CHECK(stats.formatTextures[GPU_RGB565] == 1 && stats.formatBytes[GPU_RGB565] == 64 * 64 * 2, "%u RGB565 textures in %u bytes", stats.formatTextures[GPU_RGB565], stats.formatBytes[GPU_RGB565]);
+    TEST_CHECK(stats.formatTextures[GPU_RGBA8] == 1 && stats.formatBytes[GPU_RGBA8] == 512 * 512 * 4, "%u RGBA8 textures in %u bytes", stats.formatTextures[GPU_RGBA8], stats.formatBytes[GPU_RGBA8]);
+
+    // The peak holds once everything is freed.
+    texture_ids_track(GPU_RGB565, 64 * 64 * 2, false);
+    texture_ids_track(GPU_RGBA8, 512 * 512 * 4, false);
+
+    texture_ids_get_stats(&stats);
+
+    TEST_CHECK(stats.liveTextures == 0 && stats.liveBytes == 0, "%u textures in %u bytes left", stats.liveTextures, stats.liveBytes);
+    TEST_CHECK(stats.peakTextures == 3 && stats.peakBytes == 2 * 64 * 64 * 2 + 512 * 512 * 4, "peak dropped to %u textures, %u bytes", stats.peakTextures, stats.peakBytes);
+
+    u32 formatTextures = 0;
+    for(u32 format = 0; format < SCREEN_TEXTURE_FORMATS; format++) {
+        formatTextures += stats.formatTextures[format];
+    }
+
+    TEST_CHECK(formatTextures == 0, "%u textures left across formats", formatTextures);
+
+    texture_ids_get_stats(NULL);
+}
+
+static u32 textureids_test_allocated[TEXTUREIDS_TEST_THREADS][TEXTUREIDS_TEST_PER_THREAD];
+
+static void* textureids_test_thread(void* arg) {
+    u32* ids = (u32*) arg;
+
+    for(u32 i = 0; i < TEXTUREIDS_TEST_PER_THREAD; i++) {
+        ids[i] = texture_ids_allocate();
+        texture_ids_track(GPU_RGB565, 64 * 64 * 2, true);
+
+        // Some are released again straight away, as a closed list would.
+        if(i % 5 == 4) {
+            texture_ids_track(GPU_RGB565, 64 * 64 * 2, false);
+            texture_ids_set_allocated(ids[i], false);
+            ids[i] = 0;
+        }
+    }
+
+    return NULL;
+}
+
+static void test_textureids_threads() {
+    texture_ids_init();
+
+    pthread_t threads[TEXTUREIDS_TEST_THREADS];
+    for(u32 i = 0; i < TEXTUREIDS_TEST_THREADS; i++) {
+        pthread_create(&threads[i], NULL, textureids_test_thread, textureids_test_allocated[i]);
+    }
+
+    for(u32 i = 0; i < TEXTUREIDS_TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    static bool seen[MAX_TEXTURES];
+    memset(seen, 0, sizeof(seen));
+
+    u32 held = 0;
+    u32 duplicates = 0;
+    for(u32 t = 0; t < TEXTUREIDS_TEST_THREADS; t++) {
+        for(u32 i = 0; i < TEXTUREIDS_TEST_PER_THREAD; i++) {
+            u32 id = textureids_test_allocated[t][i];
+            if(id != 0) {
+                duplicates += seen[id] ? 1 : 0;
+                seen[id] = true;
+                held++;
+            }
+        }
+    }
+
+    TEST_CHECK(duplicates == 0, "%u IDs handed out twice", duplicates);
+
+    screen_texture_stats stats;
+    texture_ids_get_stats(&stats);
+
+    TEST_CHECK(stats.liveTextures == held && stats.liveBytes == held * 64 * 64 * 2, "%u textures tracked for %u held IDs", stats.liveTextures, held);
+
+    // Whatever is left over is exactly what the threads did not take.
+    u32 remaining = 0;
+    while(texture_ids_allocate() != 0) {
+        remaining++;
+    }
+
+    TEST_CHECK(held + remaining == MAX_TEXTURES - 1, "%u held and %u remaining of %u", held, remaining, MAX_TEXTURES - 1);
+}
+
+int main() {
+    TEST_RUN(test_textureids_allocate_all);
+    TEST_RUN(test_textureids_reuse);
+    TEST_RUN(test_textureids_fixed_ids);
+    TEST_RUN(test_textureids_stats);
+    TEST_RUN(test_textureids_threads);
+
+    return test_finish();
+}
\ No newline at end of file
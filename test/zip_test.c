@@ -0,0 +1,393 @@
+#include <string.h>
+#include <unistd.h>
+
+#include <3ds.h>
+#include <zlib.h>
+
+#include "core/core.h"
+#include "test.h"
+
+// Writes ZIP and gzip files to the shim SD card with zlib, then lists and streams them with the archive reader.
+
+#define ZIP_TEST_SD "build/zip_sd"
+#define ZIP_TEST_LARGE_SIZE (3 * 1024 * 1024 + 99)
+#define ZIP_TEST_SMALL_SIZE (70 * 1024)
+
+typedef struct {
+    const char* path;
+    u16 method;
+    u16 flags;
+    const u8* data;
+    u32 size;
+    // Extra field bytes in the local header only, which the central directory does not account for.
+    u16 localExtra;
+} zip_test_member;
+
+static u8* zip_test_large;
+static u8* zip_test_small;
+
+static void zip_test_put(FILE* fd, u64 value, u32 size) {
+    for(u32 i = 0; i < size; i++) {
+        fputc((int) ((value >> (i * 8)) & 0xFF), fd);
+    }
+}
+
+// Raw deflate for ZIP, or a gzip member with an optional stored name.
+static u8* zip_test_deflate(const u8* data, u32 size, bool gzip, const char* gzipName, u32* compressedSize) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, 6, Z_DEFLATED, gzip ? MAX_WBITS | 16 : -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+    gz_header header;
+    memset(&header, 0, sizeof(header));
+    if(gzip && gzipName != NULL) {
+        header.name = (Bytef*) gzipName;
+        deflateSetHeader(&stream, &header);
+    }
+
+    uLong bound = deflateBound(&stream, size) + 256;
+    u8* out = (u8*) malloc(bound);
+
+    stream.next_in = (Bytef*) data;
+    stream.avail_in = size;
+    stream.next_out = out;
+    stream.avail_out = (uInt) bound;
+    deflate(&stream, Z_FINISH);
+
+    *compressedSize = (u32) stream.total_out;
+    deflateEnd(&stream);
+
+    return out;
+}
+
+static void zip_test_write_zip(const char* name, const zip_test_member* members, u32 count) {
+    char path[FILE_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", ZIP_TEST_SD, name);
+
+    FILE* fd = fopen(path, "wb");
+
+    u32 offsets[16];
+    u32 compressedSizes[16];
+    u32 crcs[16];
+
+    for(u32 i = 0; i < count; i++) {
+        const zip_test_member* member = &members[i];
+
+        u8* stored = (u8*) member->data;
+        compressedSizes[i] = member->size;
+        if(member->method == ZIP_METHOD_DEFLATE) {
+            stored = zip_test_deflate(member->data, member->size, false, NULL, &compressedSizes[i]);
+        }
+
+        crcs[i] = (u32) crc32(crc32(0, Z_NULL, 0), member->data, member->size);
+        offsets[i] = (u32) ftell(fd);
+
+        zip_test_put(fd, 0x04034B50, 4);
+        zip_test_put(fd, 20, 2);
+        zip_test_put(fd, member->flags, 2);
+        zip_test_put(fd, member->method, 2);
+        zip_test_put(fd, 0, 4);
+        zip_test_put(fd, crcs[i], 4);
+        zip_test_put(fd, compressedSizes[i], 4);
+        zip_test_put(fd, member->size, 4);
+        zip_test_put(fd, strlen(member->path), 2);
+        zip_test_put(fd, member->localExtra, 2);
+        fwrite(member->path, 1, strlen(member->path), fd);
+
+        for(u32 j = 0; j < member->localExtra; j++) {
+            fputc(0xEE, fd);
+        }
+
+        fwrite(stored, 1, compressedSizes[i], fd);
+
+        if(stored != member->data) {
+            free(stored);
+        }
+    }
+
+    u32 directoryOffset = (u32) ftell(fd);
+
+    for(u32 i = 0; i < count; i++) {
+        const zip_test_member* member = &members[i];
+
+        zip_test_put(fd, 0x02014B50, 4);
+        zip_test_put(fd, 20, 2);
+        zip_test_put(fd, 20, 2);
+        zip_test_put(fd, member->flags, 2);
+        zip_test_put(fd, member->method, 2);
+        zip_test_put(fd, 0, 4);
+        zip_test_put(fd, crcs[i], 4);
+        zip_test_put(fd, compressedSizes[i], 4);
+        zip_test_put(fd, member->size, 4);
+        zip_test_put(fd, strlen(member->path), 2);
+        zip_test_put(fd, 0, 2);
+        zip_test_put(fd, 0, 2);
+        zip_test_put(fd, 0, 2);
+        zip_test_put(fd, 0, 2);
+        zip_test_put(fd, 0, 4);
+        zip_test_put(fd, offsets[i], 4);
+        fwrite(member->path, 1, strlen(member->path), fd);
+    }
+
+    u32 directorySize = (u32) ftell(fd) - directoryOffset;
+
+    zip_test_put(fd, 0x06054B50, 4);
+    zip_test_put(fd, 0, 2);
+    zip_test_put(fd, 0, 2);
+    zip_test_put(fd, count, 2);
+    zip_test_put(fd, count, 2);
+    zip_test_put(fd, directorySize, 4);
+    zip_test_put(fd, directoryOffset, 4);
+    // A trailing comment, so that the end record is not at the very end.
+    zip_test_put(fd, 5, 2);
+    fwrite("notes", 1, 5, fd);
+
+    fclose(fd);
+}
+
+static void zip_test_write_gzip(const char* name, const char* storedName, const u8* data, u32 size) {
+    char path[FILE_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", ZIP_TEST_SD, name);
+
+    u32 compressedSize = 0;
+    u8* compressed = zip_test_deflate(data, size, true, storedName, &compressedSize);
+
+    test_write_file(path, compressed, compressedSize);
+    free(compressed);
+}
+
+static Handle zip_test_open(const char* name) {
+    char path[FILE_PATH_MAX];
+    snprintf(path, sizeof(path), "/%s", name);
+
+    Handle handle = 0;
+    Result res = FSUSER_OpenFileDirectly(&handle, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, ""), fsMakePath(PATH_ASCII, path), FS_OPEN_READ, 0);
+    TEST_CHECK(res == 0, "failed to open %s: 0x%08X", name, (u32) res);
+
+    return handle;
+}
+
+static bool zip_test_filter_cia(void* data, const char* name, u32 attributes) {
+    size_t len = strlen(name);
+    return !(attributes & FS_ATTRIBUTE_DIRECTORY) && len >= 4 && strcasecmp(name + len - 4, ".cia") == 0;
+}
+
+// Streams entry in chunks of chunkSize and compares it with expected.
+static Result zip_test_read(const char* name, zip_entry* entry, const u8* expected, u32 chunkSize) {
+    zip_reader* reader = NULL;
+
+    Result res = zip_reader_open(&reader, zip_test_open(name), entry);
+    if(R_FAILED(res)) {
+        return res;
+    }
+
+    u64 size = 0;
+    zip_reader_get_size(reader, &size);
+    TEST_CHECK(size == entry->size, "%s: size %llu, entry %llu", entry->name, size, entry->size);
+
+    u8* buffer = (u8*) malloc(chunkSize);
+
+    u64 pos = 0;
+    while(pos < size && R_SUCCEEDED(res)) {
+        u32 bytesRead = 0;
+        if(R_SUCCEEDED(res = zip_reader_read(reader, &bytesRead, buffer, pos, chunkSize))) {
+            if(bytesRead == 0 || memcmp(buffer, expected + pos, bytesRead) != 0) {
+                TEST_CHECK(false, "%s: data differs at %llu", entry->name, pos);
+                break;
+            }
+
+            pos += bytesRead;
+        }
+    }
+
+    free(buffer);
+    zip_reader_close(reader);
+
+    return res;
+}
+
+static void test_zip_entries() {
+    zip_test_member members[] = {
+        {"games/", ZIP_METHOD_STORED, 0, NULL, 0, 0},
+        {"games/large.cia", ZIP_METHOD_DEFLATE, 0, zip_test_large, ZIP_TEST_LARGE_SIZE, 0},
+        {"games/small.cia", ZIP_METHOD_STORED, 0, zip_test_small, ZIP_TEST_SMALL_SIZE, 0},
+        {"readme.txt", ZIP_METHOD_DEFLATE, 0, zip_test_small, 100, 0},
+        // Encrypted, then bzip2; neither can be streamed.
+        {"secret.cia", ZIP_METHOD_STORED, 0x1, zip_test_small, 100, 0},
+        {"bzip2.cia", 12, 0, zip_test_small, 100, 0},
+    };
+
+    zip_test_write_zip("entries.zip", members, sizeof(members) / sizeof(*members));
+
+    Handle handle = zip_test_open("entries.zip");
+
+    zip_entry* entries = NULL;
+    u32 count = 0;
+    Result res = zip_file_get_entries(&entries, &count, handle, "entries.zip", zip_test_filter_cia, NULL);
+    FSFILE_Close(handle);
+
+    TEST_CHECK(res == 0, "listing failed: 0x%08X", (u32) res);
+    TEST_CHECK(count == 2, "%u entries", count);
+
+    if(R_SUCCEEDED(res) && count == 2) {
+        TEST_CHECK(strcmp(entries[0].name, "large.cia") == 0 && entries[0].size == ZIP_TEST_LARGE_SIZE && entries[0].method == ZIP_METHOD_DEFLATE, "entry 0: %s", entries[0].name);
+        TEST_CHECK(strcmp(entries[1].name, "small.cia") == 0 && entries[1].size == ZIP_TEST_SMALL_SIZE && entries[1].method == ZIP_METHOD_STORED, "entry 1: %s", entries[1].name);
+    }
+
+    free(entries);
+}
+
+static void test_zip_read() {
+    zip_test_member members[] = {
+        {"large.cia", ZIP_METHOD_DEFLATE, 0, zip_test_large, ZIP_TEST_LARGE_SIZE, 0},
+        // The local header's extra field is longer than the directory says.
+        {"small.cia", ZIP_METHOD_STORED, 0, zip_test_small, ZIP_TEST_SMALL_SIZE, 37},
+    };
+
+    zip_test_write_zip("read.zip", members, 2);
+
+    Handle handle = zip_test_open("read.zip");
+
+    zip_entry* entries = NULL;
+    u32 count = 0;
+    Result res = zip_file_get_entries(&entries, &count, handle, "read.zip", NULL, NULL);
+    FSFILE_Close(handle);
+
+    TEST_CHECK(res == 0 && count == 2, "listing failed: 0x%08X, %u entries", (u32) res, count);
+
+    if(R_SUCCEEDED(res) && count == 2) {
+        for(u32 chunkSize = 4096; chunkSize <= 256 * 1024; chunkSize *= 8) {
+            res = zip_test_read("read.zip", &entries[0], zip_test_large, chunkSize);
+            TEST_CHECK(res == 0, "deflated entry, %u byte reads: 0x%08X", chunkSize, (u32) res);
+
+            res = zip_test_read("read.zip", &entries[1], zip_test_small, chunkSize);
+            TEST_CHECK(res == 0, "stored entry, %u byte reads: 0x%08X", chunkSize, (u32) res);
+        }
+    }
+
+    free(entries);
+}
+
+static void test_zip_read_rewind() {
+    zip_test_member members[] = {{"large.cia", ZIP_METHOD_DEFLATE, 0, zip_test_large, ZIP_TEST_LARGE_SIZE, 0}};
+    zip_test_write_zip("rewind.zip", members, 1);
+
+    Handle handle = zip_test_open("rewind.zip");
+
+    zip_entry* entries = NULL;
+    u32 count = 0;
+    Result res = zip_file_get_entries(&entries, &count, handle, "rewind.zip", NULL, NULL);
+    FSFILE_Close(handle);
+
+    zip_reader* reader = NULL;
+    if(R_SUCCEEDED(res) && count == 1 && R_SUCCEEDED(res = zip_reader_open(&reader, zip_test_open("rewind.zip"), &entries[0]))) {
+        u8 buffer[4096];
+
+        // Forwards past a gap, then back to before it.
+        u64 offsets[] = {1000, 2 * 1024 * 1024, 500};
+        for(u32 i = 0; i < sizeof(offsets) / sizeof(*offsets); i++) {
+            u32 bytesRead = 0;
+            res = zip_reader_read(reader, &bytesRead, buffer, offsets[i], sizeof(buffer));
+            TEST_CHECK(res == 0 && bytesRead == sizeof(buffer) && memcmp(buffer, zip_test_large + offsets[i], bytesRead) == 0, "read at %llu: 0x%08X", offsets[i], (u32) res);
+        }
+
+        zip_reader_close(reader);
+    }
+
+    TEST_CHECK(res == 0, "0x%08X", (u32) res);
+
+    free(entries);
+}
+
+static void test_zip_read_corrupt() {
+    u8* data = (u8*) malloc(ZIP_TEST_SMALL_SIZE);
+    memcpy(data, zip_test_small, ZIP_TEST_SMALL_SIZE);
+
+    zip_test_member members[] = {{"small.cia", ZIP_METHOD_STORED, 0, data, ZIP_TEST_SMALL_SIZE, 0}};
+    zip_test_write_zip("corrupt.zip", members, 1);
+
+    // Change a byte after the CRC was computed.
+    FILE* fd = fopen(ZIP_TEST_SD "/corrupt.zip", "r+b");
+    fseek(fd, 30 + strlen("small.cia") + 1000, SEEK_SET);
+    fputc(data[1000] ^ 0xFF, fd);
+    fclose(fd);
+
+    Handle handle = zip_test_open("corrupt.zip");
+
+    zip_entry* entries = NULL;
+    u32 count = 0;
+    Result res = zip_file_get_entries(&entries, &count, handle, "corrupt.zip", NULL, NULL);
+    FSFILE_Close(handle);
+
+    if(R_SUCCEEDED(res) && count == 1) {
+        zip_reader* reader = NULL;
+        if(R_SUCCEEDED(res = zip_reader_open(&reader, zip_test_open("corrupt.zip"), &entries[0]))) {
+            u32 bytesRead = 0;
+            res = zip_reader_read(reader, &bytesRead, data, 0, ZIP_TEST_SMALL_SIZE);
+
+            zip_reader_close(reader);
+        }
+    }
+
+    TEST_CHECK(res == R_APP_BAD_DATA, "corrupt entry returned 0x%08X", (u32) res);
+
+    free(entries);
+    free(data);
+}
+
+static void test_zip_gzip() {
+    zip_test_write_gzip("named.gz", "dir/inner.cia", zip_test_large, ZIP_TEST_LARGE_SIZE);
+    zip_test_write_gzip("game.cia.gz", NULL, zip_test_small, ZIP_TEST_SMALL_SIZE);
+
+    const char* files[] = {"named.gz", "game.cia.gz"};
+    const char* names[] = {"inner.cia", "game.cia"};
+    const u8* expected[] = {zip_test_large, zip_test_small};
+    u32 sizes[] = {ZIP_TEST_LARGE_SIZE, ZIP_TEST_SMALL_SIZE};
+
+    for(u32 i = 0; i < 2; i++) {
+        Handle handle = zip_test_open(files[i]);
+
+        zip_entry* entries = NULL;
+        u32 count = 0;
+        Result res = zip_file_get_entries(&entries, &count, handle, files[i], zip_test_filter_cia, NULL);
+        FSFILE_Close(handle);
+
+        TEST_CHECK(res == 0 && count == 1, "%s: 0x%08X, %u entries", files[i], (u32) res, count);
+
+        if(R_SUCCEEDED(res) && count == 1) {
+            TEST_CHECK(strcmp(entries[0].name, names[i]) == 0 && entries[0].gzip && entries[0].size == sizes[i], "%s: entry %s", files[i], entries[0].name);
+
+            res = zip_test_read(files[i], &entries[0], expected[i], 128 * 1024);
+            TEST_CHECK(res == 0, "%s: read failed: 0x%08X", files[i], (u32) res);
+        }
+
+        free(entries);
+    }
+}
+
+int main() {
+    shim_sd_root = ZIP_TEST_SD;
+    mkdir(ZIP_TEST_SD, 0755);
+
+    // Compressible, so that deflated entries span many input reads without being trivially small.
+    zip_test_large = (u8*) malloc(ZIP_TEST_LARGE_SIZE);
+    for(u32 i = 0; i < ZIP_TEST_LARGE_SIZE; i++) {
+        zip_test_large[i] = i % 3 == 0 ? test_pattern(i, 1) : (u8) (i / 4096);
+    }
+
+    zip_test_small = (u8*) malloc(ZIP_TEST_SMALL_SIZE);
+    for(u32 i = 0; i < ZIP_TEST_SMALL_SIZE; i++) {
+        zip_test_small[i] = test_pattern(i, 2);
+    }
+
+    TEST_RUN(test_zip_entries);
+    TEST_RUN(test_zip_read);
+    TEST_RUN(test_zip_read_rewind);
+    TEST_RUN(test_zip_read_corrupt);
+    TEST_RUN(test_zip_gzip);
+
+    free(zip_test_large);
+    free(zip_test_small);
+
+    return test_finish();
+}
\ No newline at end of file